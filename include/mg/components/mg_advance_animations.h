@@ -11,27 +11,70 @@
 #pragma once
 
 #include "mg/core/ecs/mg_entity.h"
+#include "mg/core/ecs/mg_parallel_for_each.h"
 #include "mg/components/mg_animation_component.h"
 #include "mg/components/mg_mesh_component.h"
 
 namespace Mg {
 
-inline void advance_animations(ecs::EntityCollection& collection, const float delta_time)
+/** Sample the poses of animated entities at the given time, scaled by each entity's animation
+ * speed. Entities are sampled at their level of detail (see `AnimationLod`): poses of entities that
+ * are out of view or between updates are kept as they are.
+ */
+inline void
+advance_animations(ecs::EntityCollection& collection, JobSystem& job_system, const float delta_time)
 {
-    for (auto [entity, mesh, animation] :
-         collection.get_with<MeshComponent, AnimationComponent>()) {
-        if (!animation.current_clip.has_value()) {
-            animation.pose = mesh.mesh->animation_data->skeleton.get_bind_pose();
-            continue;
-        }
-
-        animation.time_in_clip = delta_time * animation.animation_speed;
-
-        const auto clip_index = animation.current_clip.value();
-        gfx::animate_skeleton(mesh.mesh->animation_data->clips[clip_index],
-                              animation.pose,
-                              animation.time_in_clip);
-    }
+    ecs::parallel_for_each<const MeshComponent, AnimationComponent>(
+        collection,
+        job_system,
+        [delta_time](ecs::Entity, const MeshComponent& mesh, AnimationComponent& animation) {
+            const gfx::Skeleton& skeleton = mesh.mesh->animation_data->skeleton;
+
+            if (!animation.current_clip.has_value()) {
+                animation.pose = skeleton.get_bind_pose();
+                return;
+            }
+
+            AnimationLod& lod = animation.lod;
+            const bool has_pose = animation.pose.skeleton_id == skeleton.id();
+            if (has_pose && !lod.in_view) {
+                return;
+            }
+
+            // Count down even when the pose is sampled out of turn, so that the entity keeps its
+            // phase.
+            const bool is_due = lod.frames_until_update == 0;
+            lod.frames_until_update = is_due ? lod.update_interval - 1
+                                             : lod.frames_until_update - 1;
+
+            // An entity without a pose for this skeleton gets one regardless of level of detail,
+            // since there is no previous pose to keep.
+            if (!has_pose) {
+                animation.pose = skeleton.get_bind_pose();
+            }
+            else if (!is_due) {
+                return;
+            }
+
+            animation.time_in_clip = delta_time * animation.animation_speed;
+
+            const auto clip_index = animation.current_clip.value();
+            const auto& clip = mesh.mesh->animation_data->clips[clip_index];
+
+            if (lod.max_joint_depth >= skeleton.max_depth()) {
+                gfx::animate_skeleton(
+                    clip, animation.pose, animation.time_in_clip, animation.cursor);
+                return;
+            }
+
+            // Joints below the maximum depth keep the local pose they had when last sampled, or the
+            // bind pose.
+            gfx::sample_animation_clip(clip,
+                                       animation.time_in_clip,
+                                       animation.pose.joint_poses,
+                                       animation.cursor,
+                                       skeleton.joints_up_to_depth(lod.max_joint_depth));
+        });
 }
 
 
@@ -14,13 +14,41 @@
 #include "mg/core/gfx/mg_skeleton.h"
 #include "mg/utils/mg_optional.h"
 
+#include <cstdint>
+#include <limits>
+
 namespace Mg {
 
+/** Level of detail at which an entity's animation is updated. Set by `update_animation_lods`. */
+struct AnimationLod {
+    /** Whether the mesh was within the camera's view. If not, its pose is frozen. */
+    bool in_view = true;
+
+    /** The pose is sampled every `update_interval` frames, and kept in between. */
+    uint32_t update_interval = 1;
+
+    /** Only joints down to this depth in the skeleton are sampled; deeper joints keep their pose
+     * relative to their parent. See `gfx::Skeleton::joints_up_to_depth`.
+     */
+    uint32_t max_joint_depth = std::numeric_limits<uint32_t>::max();
+
+    /** Frames left until the pose is next sampled. Offset by the entity's index when the update
+     * interval changes, so that entities with the same update interval do not all sample their
+     * poses in the same frame.
+     */
+    uint32_t frames_until_update = 0;
+};
+
 struct AnimationComponent : ecs::BaseComponent<AnimationComponent> {
     Opt<uint32_t> current_clip;
     float time_in_clip = 0.0f;
     float animation_speed = 1.0f;
     gfx::SkeletonPose pose;
+
+    /** Keys used when the pose was last sampled, to speed up sampling the next frame's pose. */
+    gfx::AnimationCursor cursor;
+
+    AnimationLod lod;
 };
 
 
@@ -15,31 +15,81 @@
 #include "mg/components/mg_transform_component.h"
 #include "mg/core/ecs/mg_entity.h"
 #include "mg/core/gfx/mg_render_command_list.h"
-#include "mg/utils/mg_interpolate_transform.h"
+#include "mg/core/gfx/mg_skeleton.h"
+#include "mg/core/mg_job_system.h"
+#include "mg/core/mg_linear_arena.h"
+#include "mg/core/mg_transform.h"
 
 namespace Mg {
 
+/** Add render commands for all entities with transform and mesh. Render commands are added on the
+ * calling thread, since RenderCommandProducer is not thread-safe; the skinning matrices of
+ * animated meshes, which is where most of the time goes, are calculated in parallel.
+ *
+ * The entities' transforms are interpolated in one batch, `transforms`, which is cleared and
+ * refilled; keep it around between frames, so that it does not reallocate. Other temporary lists
+ * are allocated from `arena`, e.g. the calling thread's `FrameArena::local()`.
+ */
 inline void enqueue_meshes_for_rendering(ecs::EntityCollection& collection,
+                                         JobSystem& job_system,
                                          gfx::RenderCommandProducer& renderlist,
-                                         const float lerp_factor)
+                                         const float lerp_factor,
+                                         TransformInterpolationBatch& transforms,
+                                         LinearArena& arena)
 {
+    ArenaVector<gfx::SkinningMatricesJob> skinning_jobs{
+        ArenaAllocator<gfx::SkinningMatricesJob>{ arena }
+    };
+    ArenaVector<gfx::SkinningMatrixPalette> palettes{
+        ArenaAllocator<gfx::SkinningMatrixPalette>{ arena }
+    };
+
+    struct MeshInstance {
+        const MeshComponent* mesh;
+        const AnimationComponent* animation;
+    };
+    ArenaVector<MeshInstance> instances{ ArenaAllocator<MeshInstance>{ arena } };
+    instances.reserve(collection.num_entities());
+    transforms.clear();
+
     for (auto [entity, transform, mesh, animation] :
-         collection.get_with<TransformComponent, MeshComponent, ecs::Maybe<AnimationComponent>>()) {
-        const auto interpolated =
-            interpolate_transforms(transform.previous_transform, transform.transform, lerp_factor) *
-            mesh.mesh_transform;
+         collection.get_with<const TransformComponent,
+                             const MeshComponent,
+                             ecs::Maybe<const AnimationComponent>>()) {
+        transforms.push_back(transform.previous_transform, transform.transform);
+        instances.push_back({ &mesh, animation });
+    }
+
+    ArenaVector<glm::mat4> matrices(instances.size(), ArenaAllocator<glm::mat4>{ arena });
+    transforms.interpolate(lerp_factor, matrices);
+
+    skinning_jobs.reserve(instances.size());
+    palettes.reserve(instances.size());
+
+    for (size_t i = 0; i < instances.size(); ++i) {
+        const MeshComponent& mesh = *instances[i].mesh;
+        const AnimationComponent* animation = instances[i].animation;
+        const glm::mat4 interpolated = matrices[i] * mesh.mesh_transform;
 
         if (animation) {
-            renderlist.add_skinned_mesh(*mesh.mesh,
-                                        interpolated,
-                                        mesh.mesh->animation_data->skeleton,
-                                        animation->pose,
-                                        mesh.material_bindings);
+            const gfx::Skeleton& skeleton = mesh.mesh->animation_data->skeleton;
+            const auto palette = renderlist.allocate_skinning_matrix_palette(skeleton);
+            renderlist.add_skinned_mesh(*mesh.mesh, interpolated, mesh.material_bindings, palette);
+            skinning_jobs.push_back({ interpolated, &skeleton, &animation->pose, {} });
+            palettes.push_back(palette);
         }
         else {
             renderlist.add_mesh(*mesh.mesh, interpolated, mesh.material_bindings);
         }
     }
+
+    // All palettes are allocated, so their storage no longer moves, and the matrices can be written
+    // directly to it.
+    for (size_t i = 0; i < skinning_jobs.size(); ++i) {
+        skinning_jobs[i].skinning_matrices_out = palettes[i].skinning_matrices();
+    }
+
+    gfx::calculate_skinning_matrices(job_system, skinning_jobs);
 }
 
 
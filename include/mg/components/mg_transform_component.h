@@ -11,14 +11,19 @@
 #pragma once
 
 #include "mg/core/ecs/mg_base_component.h"
-
-#include <glm/mat4x4.hpp>
+#include "mg/core/mg_transform.h"
 
 namespace Mg {
 
+/** An entity's transform, stored decomposed so that rendering can interpolate between the
+ * previous and current simulation steps without decomposing matrices.
+ */
 struct TransformComponent : ecs::BaseComponent<TransformComponent> {
-    glm::mat4 previous_transform = glm::mat4(1.0f);
-    glm::mat4 transform = glm::mat4(1.0f);
+    /** Transform at the previous simulation step. */
+    Transform previous_transform;
+
+    /** Transform at the current simulation step. */
+    Transform transform;
 };
 
 
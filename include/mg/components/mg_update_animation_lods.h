@@ -0,0 +1,134 @@
+//**************************************************************************************************
+// This file is part of Mg Engine. Copyright (c) 2026, Magnus Bergsten.
+// Mg Engine is made available under the terms of the 3-Clause BSD License.
+// See LICENSE.txt in the project's root directory.
+//**************************************************************************************************
+
+/** @file mg_update_animation_lods.h
+ * Selection of animation level of detail by the size of meshes on screen.
+ */
+
+#pragma once
+
+#include "mg/components/mg_animation_component.h"
+#include "mg/components/mg_mesh_component.h"
+#include "mg/components/mg_transform_component.h"
+#include "mg/core/ecs/mg_entity.h"
+#include "mg/core/ecs/mg_parallel_for_each.h"
+#include "mg/core/gfx/mg_camera.h"
+#include "mg/core/gfx/mg_frustum.h"
+#include "mg/utils/mg_math_utils.h"
+
+#include <glm/geometric.hpp>
+#include <glm/mat4x4.hpp>
+#include <glm/vec4.hpp>
+
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace Mg {
+
+struct AnimationLodLevel {
+    /** Smallest size on screen, as the diameter of the mesh's bounding sphere relative to the
+     * height of the view, at which this level applies.
+     */
+    float min_screen_size = 0.0f;
+
+    /** See `AnimationLod::update_interval`. */
+    uint32_t update_interval = 1;
+
+    /** See `AnimationLod::max_joint_depth`. */
+    uint32_t max_joint_depth = std::numeric_limits<uint32_t>::max();
+};
+
+struct AnimationLodSettings {
+    /** Levels of detail, in descending order of `min_screen_size`. Meshes smaller than all levels'
+     * `min_screen_size` use the last level. With no levels, all animations are updated in full
+     * every frame.
+     */
+    std::vector<AnimationLodLevel> levels = {
+        { .min_screen_size = 0.25f, .update_interval = 1 },
+        { .min_screen_size = 0.1f, .update_interval = 2 },
+        { .min_screen_size = 0.03f, .update_interval = 4, .max_joint_depth = 8 },
+        { .min_screen_size = 0.0f, .update_interval = 8, .max_joint_depth = 4 },
+    };
+
+    /** Whether to freeze the poses of meshes outside the camera's view. */
+    bool freeze_out_of_view = true;
+};
+
+/** Get the level of detail that applies to a mesh of the given size on screen. */
+inline AnimationLodLevel select_animation_lod_level(const AnimationLodSettings& settings,
+                                                    const float screen_size)
+{
+    if (settings.levels.empty()) {
+        return {};
+    }
+
+    for (const AnimationLodLevel& level : settings.levels) {
+        if (screen_size >= level.min_screen_size) {
+            return level;
+        }
+    }
+
+    return settings.levels.back();
+}
+
+/** Select the animation level of detail of entities with transform, mesh, and animation, by
+ * whether, and how large, their meshes' bounding spheres appear from the given camera. Should run
+ * before `advance_animations`, which reads the result.
+ */
+inline void update_animation_lods(ecs::EntityCollection& collection,
+                                  JobSystem& job_system,
+                                  const gfx::ICamera& camera,
+                                  const AnimationLodSettings& settings)
+{
+    const glm::mat4 view_proj = camera.view_proj_matrix();
+
+    // For a perspective projection, clip-space w is the distance along the view direction, and the
+    // height of the view at distance d is 2d / proj[1][1]. For an orthographic projection, w is 1
+    // and the height of the view is 2 / proj[1][1]. Either way, the size on screen of a sphere is
+    // radius * proj[1][1] / w.
+    const float projection_scale = camera.proj_matrix()[1][1];
+
+    ecs::parallel_for_each<const TransformComponent, const MeshComponent, AnimationComponent>(
+        collection,
+        job_system,
+        [&](const ecs::Entity entity,
+            const TransformComponent& transform,
+            const MeshComponent& mesh,
+            AnimationComponent& animation) {
+            AnimationLod& lod = animation.lod;
+            const glm::mat4 model = transform.transform.matrix() * mesh.mesh_transform;
+            const BoundingSphere& bounds = mesh.mesh->bounding_sphere;
+            const glm::vec3 centre = model * glm::vec4(bounds.centre, 1.0f);
+            const float scale = max(glm::length(glm::vec3(model[0])),
+                                    max(glm::length(glm::vec3(model[1])),
+                                        glm::length(glm::vec3(model[2]))));
+            const float radius = bounds.radius * scale;
+
+            lod.in_view = !settings.freeze_out_of_view ||
+                          !gfx::frustum_cull(view_proj, centre, radius);
+
+            // The centre is at or behind the camera only if the camera is within the sphere, or
+            // the sphere is out of view.
+            const float w = (view_proj * glm::vec4(centre, 1.0f)).w;
+            const float screen_size = w > 0.0f ? radius * projection_scale / w
+                                               : std::numeric_limits<float>::max();
+
+            const AnimationLodLevel level = select_animation_lod_level(settings, screen_size);
+            const uint32_t update_interval = max(level.update_interval, 1u);
+
+            // Entities spawned together have consecutive indices, so they spread their updates
+            // over frames.
+            if (update_interval != lod.update_interval) {
+                lod.update_interval = update_interval;
+                lod.frames_until_update = entity.index() % update_interval;
+            }
+            lod.max_joint_depth = level.max_joint_depth;
+        });
+}
+
+
+} // namespace Mg
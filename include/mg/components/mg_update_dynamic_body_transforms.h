@@ -13,16 +13,35 @@
 #include "mg/components/mg_dynamic_body_component.h"
 #include "mg/components/mg_transform_component.h"
 #include "mg/core/ecs/mg_entity.h"
+#include "mg/core/ecs/mg_parallel_for_each.h"
 
 namespace Mg {
 
-inline void update_dynamic_body_transforms(ecs::EntityCollection& collection)
+/** Copy the transforms of dynamic bodies from the physics simulation into their
+ * TransformComponents. Bodies that are asleep are skipped, once their previous transform has
+ * caught up; the TransformComponents that are written are marked as changed.
+ */
+inline void update_dynamic_body_transforms(ecs::EntityCollection& collection,
+                                           JobSystem& job_system)
 {
-    for (auto [entity, dynamic_body, transform] :
-         collection.get_with<DynamicBodyComponent, TransformComponent>()) {
-        transform.previous_transform = transform.transform;
-        transform.transform = dynamic_body.physics_body.get_transform();
-    }
+    ecs::parallel_for_each<const DynamicBodyComponent, ecs::Tracked<TransformComponent>>(
+        collection,
+        job_system,
+        [](ecs::Entity,
+           const DynamicBodyComponent& dynamic_body,
+           ecs::TrackedRef<TransformComponent> transform) {
+            const bool is_active = dynamic_body.physics_body.is_active();
+            if (!is_active && transform->previous_transform == transform->transform) {
+                return;
+            }
+
+            TransformComponent& result = transform.write();
+            result.previous_transform = result.transform;
+            if (is_active) {
+                result.transform =
+                    Transform::from_matrix(dynamic_body.physics_body.get_transform());
+            }
+        });
 }
 
 
@@ -10,22 +10,21 @@
 
 #pragma once
 
-#include "mg/core/containers/mg_array.h"
 #include "mg/utils/mg_assert.h"
+#include "mg/utils/mg_gsl.h"
 #include "mg/utils/mg_math_utils.h"
 
 #include <cstddef>
 #include <cstdint>
 #include <iterator>
 #include <limits>
+#include <memory>
+#include <memory_resource>
+#include <new>
+#include <span>
+#include <type_traits>
 #include <utility>
 
-#if __cplusplus >= 201703L
-#    define HAVE_OVERALIGNED_NEW 1
-#else
-#    define HAVE_OVERALIGNED_NEW 0
-#endif
-
 namespace Mg {
 
 namespace detail {
@@ -84,14 +83,23 @@ private:
  * array (called the Key) of indices into the main data array, which is updated when elements
  * move.
  *
- * Limitations: not allocator-aware.
+ * The Slot_map grows as needed when inserting elements, so the capacity passed to the constructor
+ * is merely the amount of memory to allocate up-front. Growing moves the elements to a new buffer
+ * (invalidating pointers and iterators, like std::vector) but never invalidates handles. The Key
+ * never shrinks, so handles also survive reducing the capacity with `resize`.
+ *
+ * Memory for elements and keys is obtained from the Allocator. Elements themselves are constructed
+ * directly, not via the allocator, so uses-allocator construction is not supported. To allocate
+ * from an arena or another `std::pmr::memory_resource`, use `Mg::pmr::Slot_map`.
  *
  * @tparam T Element type.
+ * @tparam Allocator Allocator for the Slot_map's storage.
  */
-template<typename T> class Slot_map {
+template<typename T, typename Allocator = std::allocator<T>> class Slot_map {
 public:
     using value_type = T;
     using size_type = uint32_t;
+    using allocator_type = Allocator;
 
     using difference_type = ptrdiff_t;
 
@@ -108,34 +116,69 @@ public:
     using const_reverse_iterator = std::reverse_iterator<const_iterator>;
 
     /** Construct empty Slot_map. */
-    Slot_map() : Slot_map(0) {}
+    Slot_map() : Slot_map(size_type{ 0 }) {}
+
+    /** Construct empty Slot_map using the given allocator. */
+    explicit Slot_map(const Allocator& allocator) : Slot_map(size_type{ 0 }, allocator) {}
 
     /** Construct Slot_map.
-     * @param max_elems The capacity of the Slot_map.
+     * @param max_elems The initial capacity of the Slot_map.
+     * @param allocator Allocator to use for the Slot_map's storage.
      */
-    explicit Slot_map(size_type max_elems) { init(max_elems); }
+    explicit Slot_map(size_type max_elems, const Allocator& allocator = Allocator())
+        : m_allocator(allocator)
+    {
+        resize(max_elems);
+    }
 
     /** Copy construct Slot_map. SlotMapHandles into rhs will be valid into this copy as well. */
-    Slot_map(const Slot_map& rhs);
+    Slot_map(const Slot_map& rhs)
+        : Slot_map(rhs, Allocator_traits::select_on_container_copy_construction(rhs.m_allocator))
+    {}
+
+    /** Copy construct Slot_map using the given allocator. SlotMapHandles into rhs will be valid
+     * into this copy as well.
+     */
+    Slot_map(const Slot_map& rhs, const Allocator& allocator);
 
     /** Move construct Slot_map. N.B. moving invalidates SlotMapHandles into rhs. */
     Slot_map(Slot_map&& rhs) noexcept;
 
+    /** Move construct Slot_map using the given allocator. If the allocator differs from that of
+     * rhs, the elements are moved individually. N.B. moving invalidates SlotMapHandles into rhs.
+     */
+    Slot_map(Slot_map&& rhs, const Allocator& allocator);
+
     Slot_map& operator=(const Slot_map& rhs)
     {
-        Slot_map tmp(rhs);
-        swap(tmp);
+        constexpr bool propagate = Allocator_traits::propagate_on_container_copy_assignment::value;
+        Slot_map tmp(rhs, propagate ? rhs.m_allocator : m_allocator);
+        swap_storage(tmp);
+        if constexpr (propagate) {
+            using std::swap;
+            swap(m_allocator, tmp.m_allocator);
+        }
         return *this;
     }
 
-    Slot_map& operator=(Slot_map&& rhs) noexcept
+    Slot_map& operator=(Slot_map&& rhs) noexcept(
+        Allocator_traits::propagate_on_container_move_assignment::value ||
+        Allocator_traits::is_always_equal::value)
     {
-        Slot_map tmp(std::move(rhs));
-        swap(tmp);
+        if constexpr (Allocator_traits::propagate_on_container_move_assignment::value) {
+            Slot_map tmp(std::move(rhs));
+            swap_storage(tmp);
+            using std::swap;
+            swap(m_allocator, tmp.m_allocator);
+        }
+        else {
+            Slot_map tmp(std::move(rhs), m_allocator);
+            swap_storage(tmp);
+        }
         return *this;
     }
 
-    ~Slot_map() { clear(); }
+    ~Slot_map() { release(); }
 
     /** Insert element into this Slot_map.
      * @param rhs Object to insert.
@@ -155,25 +198,35 @@ public:
      */
     template<typename... Ts> Slot_map_handle emplace(Ts&&... args);
 
+    /** Emplace `handles_out.size()` elements into this Slot_map, each constructed from args,
+     * growing the storage at most once. If constructing an element throws, the elements emplaced
+     * so far are erased again.
+     * @param handles_out Receives the handles of the new elements.
+     * @param args... Constructor parameters. Must not refer to elements of this Slot_map.
+     */
+    template<typename... Ts>
+    void emplace_n(std::span<Slot_map_handle> handles_out, const Ts&... args);
+
     /** Destroy the element pointed to by handle. */
     void erase(Slot_map_handle handle);
 
+    /** Destroy the elements pointed to by handles, which must all be valid and distinct. */
+    void erase_n(std::span<const Slot_map_handle> handles);
+
     /** Destroy the element pointed to by iterator.
      * @return iterator to next element
      */
     iterator erase(iterator it);
 
-    /** Erase a range of elements. */
+    /** Erase a range of elements. Elements after the range may be moved into it.
+     * @return iterator to the first element after the erased elements.
+     */
     iterator erase(iterator first, iterator last);
 
-    /** Clear the Slot_map, destroying all elements. */
-    void clear() noexcept
-    {
-        for (size_type i = 0; i < size(); ++i) {
-            destroy_element_at(i);
-        }
-        m_num_elems = 0;
-    }
+    /** Clear the Slot_map, destroying all elements and invalidating all handles. Keeps the
+     * storage.
+     */
+    void clear() noexcept;
 
     /** Get reference to the element pointed to by handle. */
     reference operator[](Slot_map_handle handle);
@@ -203,12 +256,26 @@ public:
     constexpr size_type max_size() const noexcept { return detail::k_invalid_index - 1; }
 
     /** Resize the Slot_map, allocating memory for the new capacity and moving contained elements.
+     * The new capacity must be at least `size()`.
      */
     void resize(size_type new_size);
 
+    /** Make sure there is capacity for at least `new_capacity` elements. */
+    void reserve(size_type new_capacity)
+    {
+        if (new_capacity > capacity()) {
+            resize(new_capacity);
+        }
+    }
+
     /** Get whether the Slot_map is empty. */
     bool empty() const noexcept { return m_num_elems == 0; }
 
+    allocator_type get_allocator() const noexcept { return m_allocator; }
+
+    /** Swap contents with rhs. If the allocator does not propagate on swap, the allocators must
+     * compare equal.
+     */
     void swap(Slot_map& rhs) noexcept;
 
     iterator begin() noexcept { return data(); }
@@ -230,16 +297,16 @@ public:
 private:
     using counter_type = uint32_t;
 
-    /** Key is used in an auxiliary array to support element look-ups. There is one key element per
-     * slot in the Slot_map. Slot_map_handles are actually indices into the key, which holds the
-     * actual offset of the contained element (see `position` below).
+    /** Key is used in an auxiliary array to support element look-ups. There is at least one key
+     * element per slot in the Slot_map. Slot_map_handles are actually indices into the key, which
+     * holds the actual offset of the contained element (see `position` below).
      */
     struct Key {
         /* position is used for two purposes:
          * - if the Key corresponds to an existing element, position is the offset at which the
          *   element is stored.
          * - if the Key corresponds to an unused element, position acts as a linked-list of free Key
-         *   indices with m_first_free_key_index as head.
+         *   indices with m_first_free_key_index as head. The list ends with m_num_keys.
          */
         size_type position;
 
@@ -255,14 +322,34 @@ private:
         size_type inverse_index;
     };
 
-    void allocate_arrays(size_type num_elems);
+    /** Storage for element data. */
+    struct alignas(T) Elem_data {
+        char data[sizeof(T)]; // NOLINT(cppcoreguidelines-avoid-c-arrays)
+    };
+
+    using Allocator_traits = std::allocator_traits<Allocator>;
+    using Elem_allocator = typename Allocator_traits::template rebind_alloc<Elem_data>;
+    using Key_allocator = typename Allocator_traits::template rebind_alloc<Key>;
+    using Elem_allocator_traits = std::allocator_traits<Elem_allocator>;
+    using Key_allocator_traits = std::allocator_traits<Key_allocator>;
+
+    // Allocate storage like rhs's, copy its keys, and construct elements as copies of, or moved
+    // from, rhs's elements.
+    template<typename SlotMapRef> void init_from(SlotMapRef&& rhs);
 
-    void init(size_type max_elems);
+    // Destroy all elements and free all storage, leaving the Slot_map empty with zero capacity.
+    void release() noexcept;
+
+    // Swap everything but the allocators.
+    void swap_storage(Slot_map& rhs) noexcept;
 
     void erase_at(size_type position);
 
-    // Helper for element insertion: find position, create handle, and update auxiliary Key array.
-    std::pair<size_type, Slot_map_handle> insert_helper();
+    // Make sure there is capacity for inserting `count` more elements.
+    void reserve_for_insertion(size_type count);
+
+    // Assign a key to a newly constructed element at position `size()`, and return its handle.
+    Slot_map_handle link_new_element() noexcept;
 
     // Find element corresponding to handle; or nullptr, if handle is invalid.
     pointer find_element(const Slot_map_handle& handle);
@@ -272,12 +359,12 @@ private:
     reference element_at(size_type position) noexcept
     {
         MG_ASSERT(position < size());
-        return *reinterpret_cast<pointer>(&m_data[position]);
+        return *std::launder(reinterpret_cast<pointer>(&m_data[position]));
     }
     const_reference element_at(size_type position) const noexcept
     {
         MG_ASSERT(position < size());
-        return *reinterpret_cast<const_pointer>(&m_data[position]);
+        return *std::launder(reinterpret_cast<const_pointer>(&m_data[position]));
     }
 
     template<typename... Ts> void construct_element_at(size_type position, Ts&&... args)
@@ -292,30 +379,34 @@ private:
     void move_element_to(size_type from, size_type to);
 
 private:
-    /** Storage for element data. */
-    struct alignas(T) Elem_data {
-        char data[sizeof(T)]; // NOLINT(cppcoreguidelines-avoid-c-arrays)
-    };
+    [[no_unique_address]] Allocator m_allocator;
 
-    /** Data buffer, stores both elements. */
-    ArrayUnknownSize<Elem_data> m_data;
+    /** Data buffer, stores the elements. Holds m_max_elems elements. */
+    Elem_data* m_data = nullptr;
 
-    ArrayUnknownSize<Key> m_key;
+    /** Key buffer. Holds m_num_keys keys, at least as many as m_max_elems. */
+    Key* m_key = nullptr;
 
     size_type m_max_elems = 0;
+    size_type m_num_keys = 0;
     size_type m_num_elems = 0;
 
     // Head of free-key linked-list
     size_type m_first_free_key_index = 0;
 };
 
+namespace pmr {
+/** Slot_map using a polymorphic allocator, e.g. for allocating from an arena. */
+template<typename T> using Slot_map = Mg::Slot_map<T, std::pmr::polymorphic_allocator<T>>;
+} // namespace pmr
+
 /** Insertion iterator (similar to std::insert_iterator)
  * This is included -- rather than using std::back_insert_iterator, or similar -- because the
  * standard insertion iterators expect interfaces that do not quite make sense for Slot_map, e.g.
  * push_back(); or insert() with a position parameter: these would be misleading since Slot_map is
  * unordered (in the sense that order may change as elements move around).
  */
-template<typename T> class Slot_map_insert_iterator {
+template<typename T, typename Allocator = std::allocator<T>> class Slot_map_insert_iterator {
 public:
     using value_type = void;
     using difference_type = void;
@@ -323,7 +414,7 @@ public:
     using reference = void;
     using iterator_category = std::output_iterator_tag;
 
-    explicit Slot_map_insert_iterator(Slot_map<T>& sm) : m_slot_map(&sm) {}
+    explicit Slot_map_insert_iterator(Slot_map<T, Allocator>& sm) : m_slot_map(&sm) {}
 
     // No-ops for OutputIterator interface conformance
     Slot_map_insert_iterator& operator++() { return *this; }
@@ -343,137 +434,280 @@ public:
     }
 
 private:
-    Slot_map<T>* m_slot_map;
+    Slot_map<T, Allocator>* m_slot_map;
 };
 
-template<typename T> Slot_map_insert_iterator<T> slot_map_inserter(Slot_map<T>& sm)
+template<typename T, typename Allocator>
+Slot_map_insert_iterator<T, Allocator> slot_map_inserter(Slot_map<T, Allocator>& sm)
 {
-    return Slot_map_insert_iterator<T>(sm);
+    return Slot_map_insert_iterator<T, Allocator>(sm);
 }
 
 //--------------------------------------------------------------------------------------------------
 // Mg::Slot_map implementation
 //--------------------------------------------------------------------------------------------------
 
-template<typename T> void Slot_map<T>::allocate_arrays(size_type num_elems)
+template<typename T, typename A>
+template<typename SlotMapRef>
+void Slot_map<T, A>::init_from(SlotMapRef&& rhs)
 {
-    ArrayUnknownSize<Elem_data> data(nullptr);
-    ArrayUnknownSize<Key> key(nullptr);
+    Elem_allocator elem_allocator(m_allocator);
+    Key_allocator key_allocator(m_allocator);
+
+    const size_type max_elems = rhs.m_max_elems;
+    const size_type num_keys = rhs.m_num_keys;
+
+    Elem_data* data = max_elems > 0 ? Elem_allocator_traits::allocate(elem_allocator, max_elems)
+                                    : nullptr;
+    Key* key = nullptr;
+    size_type num_constructed = 0;
+
+    try {
+        if (num_keys > 0) {
+            key = Key_allocator_traits::allocate(key_allocator, num_keys);
+        }
 
-#if !HAVE_OVERALIGNED_NEW
-    static_assert(alignof(T) <= alignof(std::max_align_t),
-                  "Slot_map only supports over-aligned element types for C++17 and onwards.");
-#endif
+        // Copy key as well as elements, so that handles into rhs are valid also into this copy.
+        std::uninitialized_copy_n(rhs.m_key, num_keys, key);
 
-    if (num_elems > 0) {
-        data = ArrayUnknownSize<Elem_data>::make(num_elems);
-        key = ArrayUnknownSize<Key>::make(num_elems);
+        for (; num_constructed < rhs.size(); ++num_constructed) {
+            if constexpr (std::is_lvalue_reference_v<SlotMapRef>) {
+                new (&data[num_constructed]) T(rhs.element_at(num_constructed));
+            }
+            else {
+                new (&data[num_constructed]) T(std::move(rhs.element_at(num_constructed)));
+            }
+        }
+    }
+    catch (...) {
+        for (size_type i = 0; i < num_constructed; ++i) {
+            std::launder(reinterpret_cast<pointer>(&data[i]))->~T();
+        }
+        if (key) {
+            Key_allocator_traits::deallocate(key_allocator, key, num_keys);
+        }
+        if (data) {
+            Elem_allocator_traits::deallocate(elem_allocator, data, max_elems);
+        }
+        throw;
     }
 
-    // Allocate first, assign later, for exception safety.
-    // If allocating either array throws, then m_data and m_max_elems should still be valid.
-    m_data = std::move(data);
-    m_key = std::move(key);
-    m_max_elems = num_elems;
+    m_data = data;
+    m_key = key;
+    m_max_elems = max_elems;
+    m_num_keys = num_keys;
+    m_num_elems = rhs.m_num_elems;
+    m_first_free_key_index = rhs.m_first_free_key_index;
 }
 
-// Initialization
-template<typename T> void Slot_map<T>::init(size_type max_elems)
+// Copy constructor
+template<typename T, typename A>
+Slot_map<T, A>::Slot_map(const Slot_map& rhs, const A& allocator) : m_allocator(allocator)
 {
-    m_num_elems = 0;
-    allocate_arrays(max_elems);
+    init_from(rhs);
+}
 
-    m_first_free_key_index = 0;
+// Move constructor
+// The default-generated one would work, but would also leave rhs in an invalid state.
+template<typename T, typename A>
+Slot_map<T, A>::Slot_map(Slot_map&& rhs) noexcept : m_allocator(std::move(rhs.m_allocator))
+{
+    swap_storage(rhs);
+}
 
-    // Set initial index data
-    for (size_type i = 0; i < max_elems; ++i) {
-        Key& k = m_key[i];
-        k.position = i + 1;
-        k.counter = 0;
-        k.inverse_index = 0;
+// Move constructor with allocator
+template<typename T, typename A>
+Slot_map<T, A>::Slot_map(Slot_map&& rhs, const A& allocator) : m_allocator(allocator)
+{
+    if (m_allocator == rhs.m_allocator) {
+        swap_storage(rhs);
+        return;
     }
+
+    init_from(std::move(rhs));
+    rhs.release();
 }
 
-// Copy constructor
-template<typename T> Slot_map<T>::Slot_map(const Slot_map& rhs)
+template<typename T, typename A> void Slot_map<T, A>::release() noexcept
 {
-    try {
-        allocate_arrays(rhs.capacity());
-
-        // Copy elements and copy key.
-        // This way allows handles into rhs to be valid also into this copy.
-        for (size_type i = 0; i < rhs.size(); ++i) {
-            construct_element_at(i, rhs.element_at(i));
-            m_key[i] = rhs.m_key[i];
-        }
+    for (size_type i = 0; i < size(); ++i) {
+        destroy_element_at(i);
+    }
 
-        m_num_elems = rhs.m_num_elems;
-        m_first_free_key_index = rhs.m_first_free_key_index;
+    if (m_data) {
+        Elem_allocator elem_allocator(m_allocator);
+        Elem_allocator_traits::deallocate(elem_allocator, m_data, m_max_elems);
     }
-    catch (...) {
-        init(0);
-        throw;
+    if (m_key) {
+        Key_allocator key_allocator(m_allocator);
+        Key_allocator_traits::deallocate(key_allocator, m_key, m_num_keys);
     }
+
+    m_data = nullptr;
+    m_key = nullptr;
+    m_max_elems = 0;
+    m_num_keys = 0;
+    m_num_elems = 0;
+    m_first_free_key_index = 0;
 }
 
 // Resize Slot_map
-template<typename T> void Slot_map<T>::resize(size_type new_size)
+template<typename T, typename A> void Slot_map<T, A>::resize(size_type new_size)
 {
     MG_ASSERT(size() <= new_size);
-    Slot_map<T> tmp(new_size);
 
-    // Move elements and copy key
+    Elem_allocator elem_allocator(m_allocator);
+    Key_allocator key_allocator(m_allocator);
+
+    // The key never shrinks, since live handles may refer to any key.
+    const size_type num_keys = max(m_num_keys, new_size);
+
+    Elem_data* data = new_size > 0 ? Elem_allocator_traits::allocate(elem_allocator, new_size)
+                                   : nullptr;
+    Key* key = m_key;
+    size_type num_moved = 0;
+
+    try {
+        if (num_keys > m_num_keys) {
+            key = Key_allocator_traits::allocate(key_allocator, num_keys);
+        }
+
+        for (; num_moved < size(); ++num_moved) {
+            new (&data[num_moved]) T(std::move_if_noexcept(element_at(num_moved)));
+        }
+    }
+    catch (...) {
+        for (size_type i = 0; i < num_moved; ++i) {
+            std::launder(reinterpret_cast<pointer>(&data[i]))->~T();
+        }
+        if (key != m_key) {
+            Key_allocator_traits::deallocate(key_allocator, key, num_keys);
+        }
+        if (data) {
+            Elem_allocator_traits::deallocate(elem_allocator, data, new_size);
+        }
+        throw;
+    }
+
     for (size_type i = 0; i < size(); ++i) {
-        tmp.construct_element_at(i, std::move_if_noexcept(element_at(i)));
-        tmp.m_key[i] = m_key[i];
+        destroy_element_at(i);
     }
+    if (m_data) {
+        Elem_allocator_traits::deallocate(elem_allocator, m_data, m_max_elems);
+    }
+
+    if (key != m_key) {
+        std::uninitialized_copy_n(m_key, m_num_keys, key);
 
-    tmp.m_num_elems = m_num_elems;
-    tmp.m_first_free_key_index = m_first_free_key_index;
+        // Append the new keys to the free list, which ends with the old key count.
+        for (size_type i = m_num_keys; i < num_keys; ++i) {
+            new (&key[i]) Key{ .position = i + 1, .counter = 0, .inverse_index = 0 };
+        }
 
-    swap(tmp);
+        if (m_key) {
+            Key_allocator_traits::deallocate(key_allocator, m_key, m_num_keys);
+        }
+    }
+
+    m_data = data;
+    m_key = key;
+    m_max_elems = new_size;
+    m_num_keys = num_keys;
 }
 
-// Move constructor
-// The default-generated one would work, but would also leave rhs in an invalid state.
-template<typename T> Slot_map<T>::Slot_map(Slot_map&& rhs) noexcept
+template<typename T, typename A> void Slot_map<T, A>::reserve_for_insertion(size_type count)
 {
-    m_data = std::move(rhs.m_data);
-    m_key = std::move(rhs.m_key);
-    m_max_elems = rhs.m_max_elems;
-    m_num_elems = rhs.m_num_elems;
-    m_first_free_key_index = rhs.m_first_free_key_index;
-    rhs.init(0);
+    MG_ASSERT(count <= max_size() - size());
+
+    if (count <= capacity() - size()) {
+        return;
+    }
+
+    const auto grown_capacity = static_cast<size_type>(size() * detail::k_slot_map_growth_factor);
+    resize(max(max(2u, grown_capacity), size() + count));
+}
+
+template<typename T, typename A> Slot_map_handle Slot_map<T, A>::link_new_element() noexcept
+{
+    const size_type pos = m_num_elems;
+    ++m_num_elems;
+
+    // There is a free key whenever there is a free slot, since there are at least as many keys as
+    // slots.
+    const size_type index = m_first_free_key_index;
+    MG_ASSERT(index < m_num_keys);
+    Key& key = m_key[index];
+    m_first_free_key_index = key.position;
+    key.position = pos;
+
+    m_key[pos].inverse_index = index;
+
+    return Slot_map_handle(index, key.counter);
 }
 
 // Emplace
-template<typename T>
+template<typename T, typename A>
 template<typename... Ts>
-auto Slot_map<T>::emplace(Ts&&... args) -> Slot_map_handle
+auto Slot_map<T, A>::emplace(Ts&&... args) -> Slot_map_handle
 {
     // This copy is usually redundant, but guards against the case where args refers to elements
-    // within this Slot_map and insert_helper has to resize the storage.
+    // within this Slot_map and reserve_for_insertion has to resize the storage.
     // TODO: The copy could be avoided by refactoring such that resizing the storage first allocates
     // new buffers, constructs the new element there, and only then moves the old elements over.
     T tmp(std::forward<Ts>(args)...);
 
-    const auto [pos, handle] = insert_helper();
-    construct_element_at(pos, std::move(tmp));
-    return handle;
+    reserve_for_insertion(1);
+    construct_element_at(size(), std::move(tmp));
+    return link_new_element();
+}
+
+// Emplace several
+template<typename T, typename A>
+template<typename... Ts>
+void Slot_map<T, A>::emplace_n(std::span<Slot_map_handle> handles_out, const Ts&... args)
+{
+    const auto count = narrow<size_type>(handles_out.size());
+    reserve_for_insertion(count);
+
+    size_type num_emplaced = 0;
+    try {
+        for (; num_emplaced < count; ++num_emplaced) {
+            construct_element_at(size(), args...);
+            handles_out[num_emplaced] = link_new_element();
+        }
+    }
+    catch (...) {
+        erase_n(handles_out.first(num_emplaced));
+        throw;
+    }
+}
+
+template<typename T, typename A> void Slot_map<T, A>::swap(Slot_map& rhs) noexcept
+{
+    if constexpr (Allocator_traits::propagate_on_container_swap::value) {
+        using std::swap;
+        swap(m_allocator, rhs.m_allocator);
+    }
+    else {
+        MG_ASSERT(m_allocator == rhs.m_allocator);
+    }
+
+    swap_storage(rhs);
 }
 
-template<typename T> void Slot_map<T>::swap(Slot_map& rhs) noexcept
+template<typename T, typename A> void Slot_map<T, A>::swap_storage(Slot_map& rhs) noexcept
 {
     using std::swap;
     swap(m_data, rhs.m_data);
     swap(m_key, rhs.m_key);
     swap(m_max_elems, rhs.m_max_elems);
+    swap(m_num_keys, rhs.m_num_keys);
     swap(m_num_elems, rhs.m_num_elems);
     swap(m_first_free_key_index, rhs.m_first_free_key_index);
 }
 
 // Destroy element by position and decouple element's Key
-template<typename T> void Slot_map<T>::erase_at(size_type position)
+template<typename T, typename A> void Slot_map<T, A>::erase_at(size_type position)
 {
     // Increment counter to invalidate SlotMapHandles to destroyed element.
     const size_type old_key_index = m_key[position].inverse_index;
@@ -494,8 +728,9 @@ template<typename T> void Slot_map<T>::erase_at(size_type position)
 }
 
 // Erase element by handle
-template<typename T> void Slot_map<T>::erase(Slot_map_handle handle)
+template<typename T, typename A> void Slot_map<T, A>::erase(Slot_map_handle handle)
 {
+    MG_ASSERT(handle.index() < m_num_keys && "Slot_map::erase() called with invalid handle.");
     const Key& k = m_key[handle.index()];
 
     MG_ASSERT(k.counter == handle.counter() && k.position < m_num_elems &&
@@ -504,8 +739,17 @@ template<typename T> void Slot_map<T>::erase(Slot_map_handle handle)
     erase_at(k.position);
 }
 
+// Erase elements by handles
+template<typename T, typename A>
+void Slot_map<T, A>::erase_n(std::span<const Slot_map_handle> handles)
+{
+    for (const Slot_map_handle handle : handles) {
+        erase(handle);
+    }
+}
+
 // Erase element by iterator
-template<typename T> auto Slot_map<T>::erase(iterator it) -> iterator
+template<typename T, typename A> auto Slot_map<T, A>::erase(iterator it) -> iterator
 {
     const ptrdiff_t position_signed = std::distance(begin(), it);
     const auto position = static_cast<size_type>(position_signed);
@@ -519,55 +763,45 @@ template<typename T> auto Slot_map<T>::erase(iterator it) -> iterator
 }
 
 // Erase range
-template<typename T> auto Slot_map<T>::erase(iterator first, iterator last) -> iterator
+template<typename T, typename A>
+auto Slot_map<T, A>::erase(iterator first, iterator last) -> iterator
 {
-    MG_ASSERT((first - begin()) >= 0 && first < last);
+    MG_ASSERT(begin() <= first && first <= last && last <= end());
 
     const auto index_first = static_cast<size_type>(std::distance(begin(), first));
-    const auto erase_count = static_cast<size_type>(last - first);
-    const auto index_last = index_first + erase_count;
-    const auto num_subsequent_elems = static_cast<size_type>(std::distance(end(), last));
-
-    // Erase elements in range
-    for (auto i = index_first; i < index_last; ++i) {
-        destroy_element_at(i);
-    }
+    const auto index_last = static_cast<size_type>(std::distance(begin(), last));
 
-    // Move subsequent elements to start of erased range
-    for (auto i = index_last; i < index_last + num_subsequent_elems; ++i) {
-        move_element_to(i, i - erase_count);
+    // Erase back-to-front, so that the elements moved into the erased slots always come from
+    // beyond the range.
+    for (auto i = index_last; i > index_first; --i) {
+        erase_at(i - 1);
     }
 
-    m_num_elems -= erase_count;
-
-    return first;
-};
+    return iterator{ begin() + index_first };
+}
 
-// Insert helper: find position for insertion, create handle, and update auxiliary Key array.
-template<typename T> auto Slot_map<T>::insert_helper() -> std::pair<size_type, Slot_map_handle>
+// Clear
+template<typename T, typename A> void Slot_map<T, A>::clear() noexcept
 {
-    auto pos = m_num_elems;
+    for (size_type i = 0; i < size(); ++i) {
+        destroy_element_at(i);
 
-    if (pos == m_max_elems) {
-        resize(max(2u, static_cast<uint32_t>(size() * detail::k_slot_map_growth_factor)));
+        // Invalidate handles and return the key to the free list.
+        const size_type key_index = m_key[i].inverse_index;
+        Key& key = m_key[key_index];
+        ++key.counter;
+        key.position = m_first_free_key_index;
+        m_first_free_key_index = key_index;
     }
 
-    ++m_num_elems;
-
-    const auto index = m_first_free_key_index;
-    Key& key = m_key[index];
-    m_first_free_key_index = key.position;
-    key.position = pos;
-
-    m_key[pos].inverse_index = index;
-
-    return std::make_pair(pos, Slot_map_handle(index, key.counter));
+    m_num_elems = 0;
 }
 
 // Element finding helper
-template<typename T> auto Slot_map<T>::find_element(const Slot_map_handle& handle) -> pointer
+template<typename T, typename A>
+auto Slot_map<T, A>::find_element(const Slot_map_handle& handle) -> pointer
 {
-    MG_ASSERT(handle.index() < m_max_elems);
+    MG_ASSERT(handle.index() < m_num_keys);
     const Key& k = m_key[handle.index()];
 
     if (k.position >= m_num_elems || k.counter != handle.counter()) {
@@ -577,10 +811,10 @@ template<typename T> auto Slot_map<T>::find_element(const Slot_map_handle& handl
     return &element_at(k.position);
 }
 
-template<typename T>
-auto Slot_map<T>::find_element(const Slot_map_handle& handle) const -> const_pointer
+template<typename T, typename A>
+auto Slot_map<T, A>::find_element(const Slot_map_handle& handle) const -> const_pointer
 {
-    MG_ASSERT(handle.index() < m_max_elems);
+    MG_ASSERT(handle.index() < m_num_keys);
     const Key& k = m_key[handle.index()];
 
     if (k.position >= m_num_elems || k.counter != handle.counter()) {
@@ -591,27 +825,30 @@ auto Slot_map<T>::find_element(const Slot_map_handle& handle) const -> const_poi
 }
 
 // Get element by handle
-template<typename T> auto Slot_map<T>::operator[](Slot_map_handle handle) -> reference
+template<typename T, typename A>
+auto Slot_map<T, A>::operator[](Slot_map_handle handle) -> reference
 {
     MG_ASSERT(is_handle_valid(handle));
     return *(find_element(handle));
 }
 
 // Get element by handle, const
-template<typename T> auto Slot_map<T>::operator[](Slot_map_handle handle) const -> const_reference
+template<typename T, typename A>
+auto Slot_map<T, A>::operator[](Slot_map_handle handle) const -> const_reference
 {
     MG_ASSERT(is_handle_valid(handle));
     return *(find_element(handle));
 }
 
 // Check whether handle refers to a value that (still) exists in the Slot_map
-template<typename T> bool Slot_map<T>::is_handle_valid(Slot_map_handle handle) const
+template<typename T, typename A> bool Slot_map<T, A>::is_handle_valid(Slot_map_handle handle) const
 {
     return find_element(handle) != nullptr;
 }
 
 // Get the corresponding handle for an iterator
-template<typename T> Slot_map_handle Slot_map<T>::make_handle(const_iterator it) const
+template<typename T, typename A>
+Slot_map_handle Slot_map<T, A>::make_handle(const_iterator it) const
 {
     auto position = std::distance(begin(), it);
 
@@ -619,11 +856,11 @@ template<typename T> Slot_map_handle Slot_map<T>::make_handle(const_iterator it)
         return {};
     }
 
-    const Key& k = m_key[m_key[size_type(position)].inverse_index];
-    return Slot_map_handle(k.position, k.counter);
+    const size_type key_index = m_key[size_type(position)].inverse_index;
+    return Slot_map_handle(key_index, m_key[key_index].counter);
 };
 
-template<typename T> void Slot_map<T>::move_element_to(size_type from, size_type to)
+template<typename T, typename A> void Slot_map<T, A>::move_element_to(size_type from, size_type to)
 {
     if (from == to) {
         return;
@@ -634,13 +871,14 @@ template<typename T> void Slot_map<T>::move_element_to(size_type from, size_type
     // Update index of moved elem to match new position
     const auto from_key_index = m_key[from].inverse_index;
     m_key[from_key_index].position = to;
+    m_key[to].inverse_index = from_key_index;
 }
 
 //--------------------------------------------------------------------------------------------------
 // Non-member functions on Slot_map
 //--------------------------------------------------------------------------------------------------
 
-template<typename T> void swap(Slot_map<T>& lhs, Slot_map<T>& rhs) noexcept
+template<typename T, typename A> void swap(Slot_map<T, A>& lhs, Slot_map<T, A>& rhs) noexcept
 {
     lhs.swap(rhs);
 }
@@ -0,0 +1,287 @@
+//**************************************************************************************************
+// This file is part of Mg Engine. Copyright (c) 2026, Magnus Bergsten.
+// Mg Engine is made available under the terms of the 3-Clause BSD License.
+// See LICENSE.txt in the project's root directory.
+//**************************************************************************************************
+
+/** @file core/ecs/mg_archetype.h
+ * Storage for the components of entities with the same set of component types.
+ * @see mg_entity.h
+ */
+
+#pragma once
+
+#include "mg/core/containers/mg_slot_map.h"
+#include "mg/core/containers/mg_small_vector.h"
+#include "mg/core/ecs/mg_base_component.h"
+#include "mg/core/ecs/mg_component_mask.h"
+#include "mg/utils/mg_assert.h"
+#include "mg/utils/mg_macros.h"
+#include "mg/utils/mg_math_utils.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <new>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+namespace Mg::ecs {
+
+/** Type-erased description of a component type, so that Archetype can move and destroy components
+ * without knowing their types.
+ */
+struct ComponentTypeInfo {
+    size_t size = 0;
+    size_t alignment = 0;
+
+    // Move-construct the component at `destination` from the one at `source`, then destroy the
+    // latter.
+    void (*relocate)(void* destination, void* source) noexcept = nullptr;
+
+    void (*destroy)(void* component) noexcept = nullptr;
+
+    // Value-initialize a component at `destination`. Null if the type is not default-constructible.
+    void (*default_construct)(void* destination) = nullptr;
+
+    template<Component C> static ComponentTypeInfo make()
+    {
+        ComponentTypeInfo result = {
+            .size = sizeof(C),
+            .alignment = alignof(C),
+            .relocate =
+                [](void* destination, void* source) noexcept {
+                    C& source_component = *std::launder(static_cast<C*>(source));
+                    new (destination) C(std::move(source_component));
+                    source_component.~C();
+                },
+            .destroy =
+                [](void* component) noexcept {
+                    std::launder(static_cast<C*>(component))->~C();
+                },
+        };
+        if constexpr (std::is_default_constructible_v<C>) {
+            result.default_construct = [](void* destination) { new (destination) C{}; };
+        }
+        return result;
+    }
+};
+
+/** Archetype stores the components of all entities that have exactly the same set of component
+ * types. Entities are stored in rows, which are grouped into fixed-size chunks. Within a chunk,
+ * the components of each type are stored contiguously (structure of arrays), so iterating over
+ * some of the component types of all entities in an Archetype is a linear sweep through memory.
+ *
+ * Rows are kept dense: when a row is erased, the last row is moved into its place.
+ *
+ * Each component also has a change tick: the EntityCollection's change tick at which the component
+ * was added or last written through the change-tracking API (see `EntityCollection::change_tick`).
+ * Each chunk keeps, per component type, an upper bound of its components' change ticks, so that
+ * queries for changed components can skip unchanged chunks without visiting their rows.
+ */
+class Archetype {
+public:
+    /** Size in bytes of a chunk, unless a single row does not fit. */
+    static constexpr size_t k_chunk_size = 16 * 1024;
+
+    static constexpr uint32_t k_no_archetype = std::numeric_limits<uint32_t>::max();
+
+    /** Construct Archetype for entities with the given set of component types.
+     * @param component_type_infos Type info for each component type, indexed by component type id.
+     */
+    Archetype(ComponentMask mask, std::span<const ComponentTypeInfo> component_type_infos);
+
+    /** Destroys all components. */
+    ~Archetype();
+
+    MG_MAKE_NON_COPYABLE(Archetype);
+    MG_MAKE_NON_MOVABLE(Archetype);
+
+    ComponentMask mask() const noexcept { return m_mask; }
+
+    bool has_component(size_t component_type_id) const noexcept
+    {
+        return (m_mask & (ComponentMask{ 1u } << component_type_id)) != 0;
+    }
+
+    /** Whether this Archetype's entities have all of the components in `mask` and none of those
+     * in `not_mask`.
+     */
+    bool matches(ComponentMask mask, ComponentMask not_mask) const noexcept
+    {
+        return (m_mask & mask) == mask && (m_mask & not_mask) == 0;
+    }
+
+    /** Number of rows, i.e. entities, in this Archetype. */
+    uint32_t size() const noexcept { return m_size; }
+
+    bool empty() const noexcept { return m_size == 0; }
+
+    /** Maximum number of rows per chunk. */
+    uint32_t chunk_capacity() const noexcept { return m_chunk_capacity; }
+
+    /** Number of chunks that contain rows. */
+    size_t num_chunks() const noexcept
+    {
+        return (m_size + m_chunk_capacity - 1) / m_chunk_capacity;
+    }
+
+    /** Number of rows in the given chunk. */
+    uint32_t chunk_size(size_t chunk_index) const noexcept
+    {
+        MG_ASSERT_DEBUG(chunk_index < num_chunks());
+        const size_t first_row = chunk_index * m_chunk_capacity;
+        return uint32_t(min<size_t>(m_chunk_capacity, m_size - first_row));
+    }
+
+    /** Handles of the entities in the given chunk, one per row. */
+    Slot_map_handle* entities(size_t chunk_index) const noexcept
+    {
+        return std::launder(
+            reinterpret_cast<Slot_map_handle*>(m_chunks[chunk_index].get() + m_entities_offset));
+    }
+
+    /** Array of the components of the given type in the given chunk, one per row. Requires that
+     * this Archetype has the component type.
+     */
+    template<Component C> C* components(size_t chunk_index) const noexcept
+    {
+        return std::launder(
+            reinterpret_cast<C*>(component_array(chunk_index, C::component_type_id())));
+    }
+
+    /** Type-erased version of `components`. */
+    std::byte* component_array(size_t chunk_index, size_t component_type_id) const noexcept
+    {
+        MG_ASSERT_DEBUG(has_component(component_type_id));
+        const Column& column = m_columns[m_column_indices[component_type_id]];
+        return m_chunks[chunk_index].get() + column.offset;
+    }
+
+    /** Get the component of the given type in the given row. */
+    template<Component C> C& component(uint32_t row) const noexcept
+    {
+        return *std::launder(reinterpret_cast<C*>(component_ptr(row, C::component_type_id())));
+    }
+
+    /** Type-erased version of `component`. */
+    std::byte* component_ptr(uint32_t row, size_t component_type_id) const noexcept
+    {
+        MG_ASSERT_DEBUG(row < m_size);
+        const Column& column = m_columns[m_column_indices[component_type_id]];
+        return m_chunks[row / m_chunk_capacity].get() + column.offset +
+               (row % m_chunk_capacity) * column.type_info.size;
+    }
+
+    /** Change ticks of the components of the given type in the given chunk, one per row. */
+    uint32_t* change_ticks(size_t chunk_index, size_t component_type_id) const noexcept
+    {
+        MG_ASSERT_DEBUG(has_component(component_type_id));
+        const Column& column = m_columns[m_column_indices[component_type_id]];
+        return std::launder(
+            reinterpret_cast<uint32_t*>(m_chunks[chunk_index].get() + column.change_ticks_offset));
+    }
+
+    /** Upper bound of the change ticks of the components of the given type in the given chunk. */
+    uint32_t& chunk_change_tick(size_t chunk_index, size_t component_type_id) const noexcept
+    {
+        MG_ASSERT_DEBUG(has_component(component_type_id));
+        return chunk_change_ticks(chunk_index)[m_column_indices[component_type_id]];
+    }
+
+    /** Get the change tick of the component of the given type in the given row. */
+    uint32_t change_tick(uint32_t row, size_t component_type_id) const noexcept
+    {
+        MG_ASSERT_DEBUG(row < m_size);
+        return change_ticks(row / m_chunk_capacity, component_type_id)[row % m_chunk_capacity];
+    }
+
+    /** Set the change tick of the component of the given type in the given row. */
+    void set_change_tick(uint32_t row, size_t component_type_id, uint32_t tick) noexcept
+    {
+        MG_ASSERT_DEBUG(row < m_size);
+        const size_t chunk_index = row / m_chunk_capacity;
+        change_ticks(chunk_index, component_type_id)[row % m_chunk_capacity] = tick;
+
+        uint32_t& chunk_tick = chunk_change_tick(chunk_index, component_type_id);
+        chunk_tick = max(chunk_tick, tick);
+    }
+
+    /** Add a row for the given entity. The row's components are left uninitialized; the caller
+     * must construct them.
+     * @param change_tick Initial change tick of the row's components.
+     * @return Index of the new row.
+     */
+    uint32_t push_back_uninitialized(Slot_map_handle entity, uint32_t change_tick);
+
+    /** Erase the given row, moving the last row into its place.
+     * @param relocated_components Components in the row that have already been relocated
+     * elsewhere, and must therefore not be destroyed.
+     * @return Handle of the entity that was moved into the erased row; or an invalid handle, if
+     * the erased row was the last one.
+     */
+    Slot_map_handle erase(uint32_t row, ComponentMask relocated_components = 0) noexcept;
+
+    /** Destroy all rows. */
+    void clear() noexcept;
+
+    /** Cached result of looking up the Archetype with `component_type_id` added or removed,
+     * k_no_archetype if not yet known. Maintained by EntityCollection.
+     */
+    uint32_t& transition(size_t component_type_id) noexcept
+    {
+        return m_transitions[component_type_id];
+    }
+
+private:
+    struct Column {
+        ComponentTypeInfo type_info;
+        size_t component_type_id = 0;
+
+        // Byte offset of the column's component array within a chunk.
+        size_t offset = 0;
+
+        // Byte offset of the column's array of change ticks within a chunk.
+        size_t change_ticks_offset = 0;
+    };
+
+    struct ChunkDeleter {
+        size_t alignment;
+        void operator()(std::byte* chunk) const noexcept
+        {
+            ::operator delete(chunk, std::align_val_t{ alignment });
+        }
+    };
+
+    using Chunk = std::unique_ptr<std::byte[], ChunkDeleter>;
+
+    // Each chunk starts with the chunk change tick of each column.
+    uint32_t* chunk_change_ticks(size_t chunk_index) const noexcept
+    {
+        return std::launder(reinterpret_cast<uint32_t*>(m_chunks[chunk_index].get()));
+    }
+
+    ComponentMask m_mask = 0;
+
+    small_vector<Column, 8> m_columns;
+
+    // Index into m_columns for each component type id in m_mask.
+    std::array<uint8_t, k_max_component_types> m_column_indices = {};
+
+    std::vector<Chunk> m_chunks;
+    size_t m_chunk_size_bytes = 0;
+    size_t m_entities_offset = 0;
+    // At least cache-line aligned, so that different chunks can be written concurrently without
+    // false sharing.
+    size_t m_chunk_alignment = 64;
+    uint32_t m_chunk_capacity = 0;
+
+    uint32_t m_size = 0;
+
+    std::array<uint32_t, k_max_component_types> m_transitions;
+};
+
+} // namespace Mg::ecs
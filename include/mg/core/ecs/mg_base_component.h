@@ -15,6 +15,7 @@
 
 #include <concepts>
 #include <cstdlib>
+#include <type_traits>
 
 namespace Mg::ecs {
 
@@ -55,28 +56,67 @@ inline size_t BaseComponent<Derived>::s_component_type_id = k_unset_component_ta
 template<typename T>
 concept Component = std::derived_from<T, BaseComponent<T>>;
 
+/** A component type, optionally const-qualified to indicate read-only access. */
+template<typename T>
+concept ComponentAccess = Component<std::remove_const_t<T>>;
+
 /** Tag type used to indicate when we want entities containing a particular component to _not_ be
  * included.
  */
-template<Component C> struct Not {
+template<ComponentAccess C> struct Not {
     using component_type = C;
 };
 
 /** Tag type used to indicate when we want particular component to be included when iterating over
  * an entity if it is present, without disqualifying the entity if the component is not included.
  */
-template<Component C> struct Maybe {
+template<ComponentAccess C> struct Maybe {
+    using component_type = C;
+};
+
+/** Tag type used to include only entities whose component of type C has changed since a given
+ * change tick (see `EntityCollection::get_with`). The component is otherwise accessed as if
+ * designated by C itself.
+ */
+template<ComponentAccess C> struct Changed {
+    using component_type = C;
+};
+
+/** Tag type used to access a component through a TrackedRef, which marks the component as changed
+ * when it is written.
+ */
+template<Component C> struct Tracked {
     using component_type = C;
 };
 
 /** Tag-type used to designate which component types we want to include when iterating over
  * entities. Those which we want to include are designated by the component type itself, and those
  * we want to exclude are designated by wrapping the component type in Mg::ecs::Not<> or
- * Mg::ecs::Maybe<>.
+ * Mg::ecs::Maybe<>. Const-qualified component types are accessed by const reference (or pointer).
+ * Mg::ecs::Changed<> and Mg::ecs::Tracked<> designate components for change tracking.
  */
 template<typename T>
-concept ComponentTypeDesignator = Component<T> || InstantiationOf<T, Not> ||
-                                  InstantiationOf<T, Maybe>;
+concept ComponentTypeDesignator = ComponentAccess<T> || InstantiationOf<T, Not> ||
+                                  InstantiationOf<T, Maybe> || InstantiationOf<T, Changed> ||
+                                  InstantiationOf<T, Tracked>;
+
+/** The (non-const) component type designated by a ComponentTypeDesignator, and whether the
+ * designator gives read-only access.
+ */
+template<ComponentTypeDesignator C> struct designated_component {
+    using type = std::remove_const_t<C>;
+    static constexpr bool is_read_only = std::is_const_v<C>;
+};
+
+template<ComponentTypeDesignator C>
+    requires(!ComponentAccess<C>)
+struct designated_component<C> {
+    using type = std::remove_const_t<typename C::component_type>;
+    static constexpr bool is_read_only = std::is_const_v<typename C::component_type>;
+};
+
+template<ComponentTypeDesignator C>
+using designated_component_t = typename designated_component<C>::type;
 
 
 } // namespace Mg::ecs
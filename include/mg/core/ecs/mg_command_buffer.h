@@ -0,0 +1,262 @@
+//**************************************************************************************************
+// This file is part of Mg Engine. Copyright (c) 2026, Magnus Bergsten.
+// Mg Engine is made available under the terms of the 3-Clause BSD License.
+// See LICENSE.txt in the project's root directory.
+//**************************************************************************************************
+
+/** @file mg_command_buffer.h
+ * Deferred structural changes to an EntityCollection.
+ */
+
+#pragma once
+
+#include "mg/core/containers/mg_flat_map.h"
+#include "mg/core/ecs/mg_base_component.h"
+#include "mg/core/ecs/mg_entity.h"
+#include "mg/core/mg_linear_arena.h"
+#include "mg/utils/mg_macros.h"
+
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <span>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace Mg::ecs {
+
+/** An entity that will be created when the CommandBuffer that created it is applied. Only valid
+ * for use with that CommandBuffer, until it is applied or cleared.
+ */
+class PendingEntity {
+public:
+    PendingEntity() = default;
+
+private:
+    friend class CommandBuffer;
+    explicit PendingEntity(uint32_t index) noexcept : m_index{ index } {}
+
+    uint32_t m_index = std::numeric_limits<uint32_t>::max();
+};
+
+/** CommandBuffer records structural changes to an EntityCollection -- creating and deleting
+ * entities, adding and removing components -- to be applied later, at a point where nothing else
+ * accesses the EntityCollection. This allows systems to request structural changes while
+ * iterating over entities, or while running concurrently with other systems.
+ *
+ * Components to add are constructed immediately, into a LinearArena owned by the buffer, and
+ * moved into the EntityCollection when the buffer is applied.
+ *
+ * Commands are applied in order of their sort keys (see `set_sort_key`), and in recording order
+ * among commands with the same sort key. Commands on entities that no longer exist when the
+ * command is applied are skipped.
+ *
+ * Not thread-safe; use one CommandBuffer per thread, e.g. via ParallelCommandBuffer.
+ */
+class CommandBuffer {
+public:
+    explicit CommandBuffer(size_t arena_block_size = 16 * 1024);
+
+    /** Destroys the components of commands that have not been applied. */
+    ~CommandBuffer();
+
+    MG_MAKE_NON_COPYABLE(CommandBuffer);
+    MG_MAKE_NON_MOVABLE(CommandBuffer);
+
+    /** Set the sort key for subsequently recorded commands. The sort key is reset to 0 when the
+     * buffer is applied or cleared. To make the result of applying commands recorded by
+     * concurrently running jobs deterministic, each job should set its own sort key, one that
+     * does not depend on scheduling, e.g. derived from the entity that the job is processing.
+     */
+    void set_sort_key(uint64_t sort_key) noexcept { m_sort_key = sort_key; }
+
+    /** Set the sort key to one derived from the given entity. */
+    void set_sort_key(Entity entity) noexcept
+    {
+        m_sort_key = uint64_t{ entity.handle().index() } << 32 | entity.handle().counter();
+    }
+
+    uint64_t sort_key() const noexcept { return m_sort_key; }
+
+    /** Record creation of an entity. Components may be added to the pending entity before the
+     * buffer is applied.
+     */
+    [[nodiscard]] PendingEntity create_entity();
+
+    /** Record deletion of an entity and its components. */
+    void delete_entity(Entity entity);
+
+    /** Record adding a component, constructed with args, to an entity. The component is
+     * constructed immediately.
+     */
+    template<Component C, typename... Ts> void add_component(Entity entity, Ts&&... args)
+    {
+        record_add_component<C>(entity, k_no_pending_entity, std::forward<Ts>(args)...);
+    }
+
+    /** Record adding a component, constructed with args, to an entity created by this buffer. */
+    template<Component C, typename... Ts> void add_component(PendingEntity entity, Ts&&... args)
+    {
+        MG_ASSERT(entity.m_index < m_created_entities.size());
+        record_add_component<C>(Entity{}, entity.m_index, std::forward<Ts>(args)...);
+    }
+
+    /** Record removing a component from an entity. */
+    template<Component C> void remove_component(Entity entity)
+    {
+        m_commands.push_back({ .sort_key = m_sort_key,
+                               .entity = entity,
+                               .type = CommandType::remove_component,
+                               .component_type_id = C::component_type_id() });
+    }
+
+    /** Apply the recorded commands to the collection and clear the buffer.
+     * If a command throws, the remaining commands are discarded.
+     */
+    void apply(EntityCollection& collection);
+
+    /** Discard all recorded commands. */
+    void clear() noexcept;
+
+    /** Number of recorded commands. */
+    size_t size() const noexcept { return m_commands.size(); }
+
+    bool empty() const noexcept { return m_commands.empty(); }
+
+    /** Number of bytes used for storing components to add. */
+    size_t bytes_allocated() const noexcept { return m_arena.bytes_allocated(); }
+
+private:
+    friend class ParallelCommandBuffer;
+
+    static constexpr uint32_t k_no_pending_entity = std::numeric_limits<uint32_t>::max();
+
+    enum class CommandType : uint8_t {
+        create_entity,
+        delete_entity,
+        add_component,
+        remove_component
+    };
+
+    // Type-erased operations on a recorded component.
+    struct ComponentOps {
+        // Move the component into the collection, then destroy it.
+        void (*add)(EntityCollection& collection, Entity entity, void* component) = nullptr;
+        void (*destroy)(void* component) noexcept = nullptr;
+    };
+
+    struct Command {
+        uint64_t sort_key = 0;
+        Entity entity;
+
+        // Index into m_created_entities, if the command targets an entity created by this buffer.
+        uint32_t pending_entity = k_no_pending_entity;
+
+        CommandType type = CommandType::create_entity;
+        size_t component_type_id = 0;
+
+        // Component to add, and operations on it. Set to nullptr once the component has been
+        // consumed.
+        void* component = nullptr;
+        const ComponentOps* component_ops = nullptr;
+    };
+
+    template<Component C> static const ComponentOps& component_ops()
+    {
+        static constexpr ComponentOps ops = {
+            .add =
+                [](EntityCollection& collection, Entity entity, void* component) {
+                    C& c = *std::launder(static_cast<C*>(component));
+                    collection.place_component<C>(entity, std::move(c));
+                    c.~C();
+                },
+            .destroy =
+                [](void* component) noexcept { std::launder(static_cast<C*>(component))->~C(); },
+        };
+        return ops;
+    }
+
+    template<Component C, typename... Ts>
+    void record_add_component(Entity entity, uint32_t pending_entity, Ts&&... args)
+    {
+        // Record the command first, so that the component is never left without an owner.
+        Command& command = m_commands.emplace_back(Command{ .sort_key = m_sort_key,
+                                                            .entity = entity,
+                                                            .pending_entity = pending_entity,
+                                                            .type = CommandType::add_component });
+        try {
+            void* memory = m_arena.allocate(sizeof(C), alignof(C));
+            command.component = new (memory) C{ /*BaseComponent*/ {}, std::forward<Ts>(args)... };
+            command.component_ops = &component_ops<C>();
+        }
+        catch (...) {
+            m_commands.pop_back();
+            throw;
+        }
+    }
+
+    // Apply the commands of all buffers, merged by sort key. Ties are broken by position within
+    // the buffer, then by buffer order. Clears the buffers.
+    static void apply(std::span<CommandBuffer* const> buffers, EntityCollection& collection);
+
+    void execute(Command& command, EntityCollection& collection);
+
+    std::vector<Command> m_commands;
+
+    // Entities created by this buffer, indexed by PendingEntity. Created on first use when the
+    // buffer is applied.
+    std::vector<Entity> m_created_entities;
+
+    LinearArena m_arena;
+    uint64_t m_sort_key = 0;
+};
+
+/** A set of CommandBuffers, one per thread, so that any number of concurrently running jobs can
+ * record structural changes without synchronization. The buffers are applied together, at a sync
+ * point where no job is recording.
+ *
+ * Commands from different threads are merged by sort key, and commands with the same sort key by
+ * their position in their thread's buffer. Since jobs are scheduled onto threads arbitrarily, each
+ * job should set its own sort key (see `CommandBuffer::set_sort_key`) for the result not to
+ * depend on scheduling.
+ */
+class ParallelCommandBuffer {
+public:
+    ParallelCommandBuffer();
+    ~ParallelCommandBuffer();
+
+    MG_MAKE_NON_COPYABLE(ParallelCommandBuffer);
+    MG_MAKE_NON_MOVABLE(ParallelCommandBuffer);
+
+    /** Get the calling thread's CommandBuffer. Thread-safe. */
+    CommandBuffer& local();
+
+    /** Apply all threads' commands to the collection and clear the buffers. Must not be called
+     * while other threads use this ParallelCommandBuffer.
+     */
+    void apply(EntityCollection& collection);
+
+    /** Discard all recorded commands. Must not be called while other threads use this
+     * ParallelCommandBuffer.
+     */
+    void clear() noexcept;
+
+    /** Total number of recorded commands. Must not be called while other threads use this
+     * ParallelCommandBuffer.
+     */
+    size_t size() const noexcept;
+
+    bool empty() const noexcept { return size() == 0; }
+
+private:
+    // Identifies this instance in threads' cached look-ups of `local`.
+    uint64_t m_id = 0;
+
+    FlatMap<std::thread::id, std::unique_ptr<CommandBuffer>> m_buffers;
+    std::mutex m_mutex;
+};
+
+} // namespace Mg::ecs
@@ -23,7 +23,8 @@ namespace Mg::ecs {
 using ComponentMask = uint64_t;
 
 /** Creates ComponentMask from a set of component type designators, including the designators that
- * are Component types while ignoring those that are wrapped in Mg::ecs::Not<Component>.
+ * are Component types (or wrapped in Mg::ecs::Changed<> or Mg::ecs::Tracked<>) while ignoring those
+ * that are wrapped in Mg::ecs::Not<Component> or Mg::ecs::Maybe<Component>.
  */
 template<ComponentTypeDesignator C, ComponentTypeDesignator... Cs>
 constexpr ComponentMask create_mask()
@@ -33,8 +34,9 @@ constexpr ComponentMask create_mask()
         tail_mask = create_mask<Cs...>();
     }
 
-    if constexpr (Component<C>) {
-        return (ComponentMask{ 1u } << C::component_type_id()) | tail_mask;
+    if constexpr (ComponentAccess<C> || InstantiationOf<C, Changed> ||
+                  InstantiationOf<C, Tracked>) {
+        return (ComponentMask{ 1u } << designated_component_t<C>::component_type_id()) | tail_mask;
     }
     else {
         return tail_mask;
@@ -53,7 +55,7 @@ constexpr ComponentMask create_not_mask()
     }
 
     if constexpr (is_instantiation_of_v<C, Not>) {
-        return (ComponentMask{ 1u } << C::component_type::component_type_id()) | tail_mask;
+        return (ComponentMask{ 1u } << designated_component_t<C>::component_type_id()) | tail_mask;
     }
     else {
         return tail_mask;
@@ -14,42 +14,49 @@
 
 #pragma once
 
-// TODO looking back at this again a few years later, it strikes me how much pointer-chasing there
-// still is. Not sure it will bring the cache-friendliness promised of ECS. Notably iterating over
-// entities with different sets of components will cause random access in each component list for
-// each iteration.
-//
-// A simple case to fix is iterating with only one component type; in that case, we can iterate
-// directly over the component list.
-//
-// Otherwise solutions get more complex. One could define each component as being part of a group,
-// and allocate each group's components in an AoS. So an "SoAoS". That only helps when iterating
-// over (subsets) of that particular group, though.
-//
-// Also, I should probably use plf::colony instead of Mg::Slot_map for this. Might even remove the
-// latter as I cannot think of any situation where it is better than colony.
-
+#include "mg/core/ecs/mg_archetype.h"
 #include "mg/core/ecs/mg_base_component.h"
 #include "mg/core/ecs/mg_component_mask.h"
 
+#include "mg/core/containers/mg_flat_map.h"
 #include "mg/core/containers/mg_slot_map.h"
-#include "mg/core/ecs/mg_component_collection.h"
+#include "mg/utils/mg_macros.h"
 
 #include <array>
 #include <cstdint>
+#include <compare>
 #include <memory>
+#include <mutex>
+#include <new>
+#include <span>
+#include <tuple>
+#include <utility>
+#include <vector>
 
 /** Entity-Component-System. */
 namespace Mg::ecs {
 
+class CommandBuffer;
+
+namespace detail {
+template<ComponentTypeDesignator... Cs> class ChunkView;
+} // namespace detail
+
 /** In the Entity-Component-System pattern, an Entity is a handle to a set of associated components.
  */
 class Entity {
 public:
     Entity() = default;
 
+    /** Index of the entity in its EntityCollection. Unique among existing entities, but may be
+     * reused by an entity created after this one is deleted.
+     */
+    uint32_t index() const noexcept { return m_handle.index(); }
+
 private:
     friend class EntityCollection;
+    friend class CommandBuffer;
+    template<ComponentTypeDesignator... Cs> friend class detail::ChunkView;
 
     Slot_map_handle& handle() noexcept { return m_handle; }
     Entity(Slot_map_handle handle) noexcept : m_handle{ handle } {}
@@ -57,7 +64,232 @@ private:
     Slot_map_handle m_handle;
 };
 
-/** EntityCollection owns entities and their components. */
+/** Reference to a component designated by Tracked<C> when iterating over entities. Reading goes
+ * through `*` or `->`; writing requires `write()`, which marks the component as changed.
+ * @see EntityCollection::get_with
+ */
+template<Component C> class TrackedRef {
+public:
+    TrackedRef(C& component,
+               uint32_t& change_tick,
+               uint32_t& chunk_change_tick,
+               uint32_t current_change_tick) noexcept
+        : m_component{ &component }
+        , m_change_tick{ &change_tick }
+        , m_chunk_change_tick{ &chunk_change_tick }
+        , m_current_change_tick{ current_change_tick }
+    {}
+
+    const C& operator*() const noexcept { return *m_component; }
+    const C* operator->() const noexcept { return m_component; }
+
+    /** Get mutable access to the component, marking it as changed. */
+    C& write() const noexcept
+    {
+        *m_change_tick = m_current_change_tick;
+        *m_chunk_change_tick = m_current_change_tick;
+        return *m_component;
+    }
+
+    /** The change tick at which the component was last changed. */
+    uint32_t change_tick() const noexcept { return *m_change_tick; }
+
+private:
+    C* m_component;
+    uint32_t* m_change_tick;
+    uint32_t* m_chunk_change_tick;
+    uint32_t m_current_change_tick;
+};
+
+namespace detail {
+
+/** The components designated by Cs in one chunk of an Archetype.
+ * @see EntityCollection::get_with
+ */
+template<ComponentTypeDesignator... Cs> class ChunkView {
+public:
+    ChunkView() = default;
+
+    /** Construct ChunkView for the given chunk.
+     * @param change_tick Tick with which to mark components written through TrackedRef.
+     * @param changed_since Change tick for filtering components designated by Changed<>.
+     */
+    ChunkView(const Archetype& archetype,
+              size_t chunk_index,
+              uint32_t change_tick,
+              uint32_t changed_since)
+        : m_entities{ archetype.entities(chunk_index) }
+        , m_size{ archetype.chunk_size(chunk_index) }
+        , m_change_tick{ change_tick }
+        , m_changed_since{ changed_since }
+        , m_component_arrays{ component_array<Cs>(archetype, chunk_index)... }
+    {
+        if constexpr (k_is_change_tracked) {
+            m_change_ticks = { change_ticks<Cs>(archetype, chunk_index)... };
+            m_chunk_change_ticks = { chunk_change_tick<Cs>(archetype, chunk_index)... };
+        }
+    }
+
+    /** Number of entities in the chunk. */
+    uint32_t size() const noexcept { return m_size; }
+
+    /** Whether the chunk may contain entities whose components designated by Changed<> have all
+     * changed since `changed_since`.
+     */
+    bool has_changes() const noexcept
+    {
+        return [&]<size_t... Is>(std::index_sequence<Is...>) {
+            return ((!InstantiationOf<Cs, Changed> ||
+                     *m_chunk_change_ticks[Is] >= m_changed_since) &&
+                    ...);
+        }(std::index_sequence_for<Cs...>{});
+    }
+
+    /** Whether the entity in the given row is included, i.e. whether its components designated by
+     * Changed<> have all changed since `changed_since`.
+     */
+    bool is_included(uint32_t row) const noexcept
+    {
+        return [&]<size_t... Is>(std::index_sequence<Is...>) {
+            return ((!InstantiationOf<Cs, Changed> || m_change_ticks[Is][row] >= m_changed_since) &&
+                    ...);
+        }(std::index_sequence_for<Cs...>{});
+    }
+
+    /** Get tuple of (Entity, Components&...) for the entity in the given row. */
+    auto operator[](uint32_t row) const
+    {
+        return [&]<size_t... Is>(std::index_sequence<Is...>) {
+            return std::tuple_cat(std::tuple{ Entity{ m_entities[row] } },
+                                  get_tuple_with_reference_to_component<Cs>(Is, row)...);
+        }(std::index_sequence_for<Cs...>{});
+    }
+
+private:
+    static constexpr bool k_is_change_tracked =
+        ((InstantiationOf<Cs, Changed> || InstantiationOf<Cs, Tracked>) || ...);
+
+    template<InstantiationOf<Not> C>
+    std::tuple<> get_tuple_with_reference_to_component(size_t, uint32_t) const
+    {
+        return {};
+    }
+
+    template<InstantiationOf<Maybe> C>
+    std::tuple<typename C::component_type*>
+    get_tuple_with_reference_to_component(size_t i, uint32_t row) const
+    {
+        if (!m_component_arrays[i]) {
+            return nullptr;
+        }
+        return components<typename C::component_type>(i) + row;
+    }
+
+    template<InstantiationOf<Changed> C>
+    std::tuple<typename C::component_type&>
+    get_tuple_with_reference_to_component(size_t i, uint32_t row) const
+    {
+        return components<typename C::component_type>(i)[row];
+    }
+
+    template<InstantiationOf<Tracked> C>
+    std::tuple<TrackedRef<typename C::component_type>>
+    get_tuple_with_reference_to_component(size_t i, uint32_t row) const
+    {
+        using ComponentT = typename C::component_type;
+        return TrackedRef<ComponentT>{ components<ComponentT>(i)[row],
+                                       m_change_ticks[i][row],
+                                       *m_chunk_change_ticks[i],
+                                       m_change_tick };
+    }
+
+    template<ComponentAccess C>
+    std::tuple<C&> get_tuple_with_reference_to_component(size_t i, uint32_t row) const
+    {
+        return components<C>(i)[row];
+    }
+
+    template<ComponentAccess C> C* components(size_t i) const
+    {
+        return std::launder(reinterpret_cast<C*>(m_component_arrays[i]));
+    }
+
+    // Get the array of components designated by C; or nullptr, if C is a Not or a Maybe for a
+    // component type which the archetype does not have.
+    template<ComponentTypeDesignator C>
+    static std::byte* component_array(const Archetype& archetype, size_t chunk_index)
+    {
+        if constexpr (InstantiationOf<C, Not>) {
+            return nullptr;
+        }
+        else {
+            const auto component_type_id = designated_component_t<C>::component_type_id();
+            return archetype.has_component(component_type_id)
+                       ? archetype.component_array(chunk_index, component_type_id)
+                       : nullptr;
+        }
+    }
+
+    // Get the change ticks of the components designated by C, if C is a Changed or Tracked.
+    template<ComponentTypeDesignator C>
+    static uint32_t* change_ticks(const Archetype& archetype, size_t chunk_index)
+    {
+        if constexpr (InstantiationOf<C, Changed> || InstantiationOf<C, Tracked>) {
+            return archetype.change_ticks(chunk_index,
+                                          designated_component_t<C>::component_type_id());
+        }
+        else {
+            return nullptr;
+        }
+    }
+
+    template<ComponentTypeDesignator C>
+    static uint32_t* chunk_change_tick(const Archetype& archetype, size_t chunk_index)
+    {
+        if constexpr (InstantiationOf<C, Changed> || InstantiationOf<C, Tracked>) {
+            return &archetype.chunk_change_tick(chunk_index,
+                                                designated_component_t<C>::component_type_id());
+        }
+        else {
+            return nullptr;
+        }
+    }
+
+    Slot_map_handle* m_entities = nullptr;
+    uint32_t m_size = 0;
+    uint32_t m_change_tick = 0;
+    uint32_t m_changed_since = 0;
+    std::array<std::byte*, sizeof...(Cs)> m_component_arrays = {};
+    std::array<uint32_t*, sizeof...(Cs)> m_change_ticks = {};
+    std::array<uint32_t*, sizeof...(Cs)> m_chunk_change_ticks = {};
+};
+
+} // namespace detail
+
+/** EntityCollection owns entities and their components.
+ *
+ * Components are stored by archetype: entities with the same set of component types are stored
+ * together, with the components of each type in contiguous arrays (see Archetype). Iterating over
+ * the entities with a certain set of components visits only the matching archetypes, sweeping
+ * linearly through their component arrays.
+ *
+ * The archetypes matching each query (see `get_with`) are cached, and updated as new archetypes
+ * are created. Since the set of archetypes stabilizes quickly, repeated queries neither test
+ * individual entities nor the archetypes that do not match.
+ *
+ * Changes to components can be tracked using change ticks. The collection has a current change
+ * tick (see `change_tick`), which is advanced e.g. once per simulation step. Components are stamped
+ * with the current tick when they are added, and when they are written through the change-tracking
+ * API: `write_component`, or `TrackedRef::write` when iterating with the Tracked<> designator.
+ * Iterating with the Changed<> designator then visits only the entities whose components have
+ * changed since a given tick. Writes through plain references, e.g. from `get_component`, are not
+ * tracked.
+ *
+ * Note that adding or removing a component moves the entity's components to another archetype,
+ * and deleting an entity moves another entity's components into its place. Hence, references to
+ * components are invalidated by adding or removing components, and by creating or deleting
+ * entities.
+ */
 class EntityCollection {
 public:
     template<ComponentTypeDesignator... Cs> class iterator;
@@ -65,21 +297,23 @@ public:
     template<ComponentTypeDesignator... Cs> class UnpackingView;
 
     /** Construct a new EntityCollection.
-     * @param entity_capacity Max simultaneous entities. The required memory for entities and
-     * components is allocated immediately, so keep this value reasonably low.
+     * @param entity_capacity Number of entities for which to allocate entity meta-data up-front.
+     * The collection grows beyond this as needed. Component storage is allocated in chunks, as
+     * needed.
      *
      * Must call init() with the set of component types you want to use before using the
      * EntityCollection.
      */
-    explicit EntityCollection(uint32_t entity_capacity)
-        : m_entity_data{ entity_capacity }, m_component_lists{ entity_capacity }
-    {}
+    explicit EntityCollection(uint32_t entity_capacity);
+
+    MG_MAKE_NON_COPYABLE(EntityCollection);
+    MG_MAKE_NON_MOVABLE(EntityCollection);
 
     template<Component... Cs> void init()
     {
         MG_ASSERT(!m_initialized && "init() has already been called");
         (Cs::init_component_type_id(), ...);
-        (add_component_collection<Cs>(), ...);
+        ((m_component_type_infos[Cs::component_type_id()] = ComponentTypeInfo::make<Cs>()), ...);
         m_initialized = true;
     }
 
@@ -89,14 +323,43 @@ public:
     /** Creates a new entity with no components. */
     [[nodiscard]] Entity create_entity();
 
+    /** Creates entities with value-initialized components of the types in `mask`. The entities are
+     * placed directly in the archetype for `mask`, which is much cheaper than creating them one at
+     * a time and adding the components one by one.
+     * @param entities_out Receives the new entities; as many are created as it has elements.
+     */
+    void create_entities(ComponentMask mask, std::span<Entity> entities_out);
+
+    /** Creates entities with value-initialized components of types Cs. See the non-templated
+     * overload.
+     */
+    template<Component... Cs> void create_entities(std::span<Entity> entities_out)
+    {
+        if constexpr (sizeof...(Cs) > 0) {
+            create_entities(create_mask<Cs...>(), entities_out);
+        }
+        else {
+            create_entities(0, entities_out);
+        }
+    }
+
     /** Delete entity and its components. */
     void delete_entity(Entity entity);
 
+    /** Get whether the entity exists, i.e. has been created and not yet deleted. */
+    bool exists(Entity entity) const
+    {
+        return entity.m_handle && m_entity_data.is_handle_valid(entity.m_handle);
+    }
+
     /** Add component to entity, constructed with args. */
     template<Component C, typename... Ts> C& add_component(Entity entity, Ts&&... args);
 
     /** Remove component from entity. Requires that the component exists. */
-    template<Component C> void remove_component(Entity entity);
+    template<Component C> void remove_component(Entity entity)
+    {
+        remove_component(entity, C::component_type_id());
+    }
 
     /** Get whether the entity has a component of a given type. */
     template<Component C> bool has_component(Entity entity) const
@@ -104,13 +367,47 @@ public:
         return has_component(entity, C::component_type_id());
     }
 
-    /** Get reference to component. Requires that the component exists. */
+    /** Get reference to component. Requires that the component exists. Writes through the
+     * reference are not tracked; see `write_component`.
+     */
     template<Component C> C& get_component(Entity entity)
     {
         MG_ASSERT(has_component<C>(entity));
-        return get_component<C>(component_handle_ref(entity, C::component_type_id()));
+        const EntityData& entity_data = data(entity);
+        return m_archetypes[entity_data.archetype_index]->component<C>(entity_data.row);
     }
 
+    /** Get reference to component for writing, marking it as changed at the current change tick.
+     * Requires that the component exists.
+     */
+    template<Component C> C& write_component(Entity entity)
+    {
+        MG_ASSERT(has_component<C>(entity));
+        const EntityData& entity_data = data(entity);
+        Archetype& archetype = *m_archetypes[entity_data.archetype_index];
+        archetype.set_change_tick(entity_data.row, C::component_type_id(), m_change_tick);
+        return archetype.component<C>(entity_data.row);
+    }
+
+    /** Get the change tick at which the component was added or last written through the
+     * change-tracking API. Requires that the component exists.
+     */
+    template<Component C> uint32_t component_change_tick(Entity entity) const
+    {
+        MG_ASSERT(has_component<C>(entity));
+        const EntityData& entity_data = data(entity);
+        return m_archetypes[entity_data.archetype_index]->change_tick(entity_data.row,
+                                                                      C::component_type_id());
+    }
+
+    /** Current change tick, with which changed components are marked. Starts at 1. */
+    uint32_t change_tick() const noexcept { return m_change_tick; }
+
+    /** Advance the change tick. Must not be called while iterating over entities.
+     * @return The new change tick.
+     */
+    uint32_t advance_change_tick() noexcept { return ++m_change_tick; }
+
     /** Iterate over entities which have the requested set of components, e.g.:
      * @code
      * for (auto[entity, position, velocity]
@@ -137,13 +434,30 @@ public:
      *     }
      * @endcode
      *
+     * Const-qualified component types, e.g. `get_with<const Position>()`, give const references.
+     *
+     * `Mg::ecs::Changed` includes only entities whose component has changed at or after the
+     * `changed_since` tick, e.g. to process only entities that moved since a system last ran:
+     *
+     * @code
+     * for (auto[entity, position]
+     *     : entity_collection.get_with<Mg::ecs::Changed<const Position>>(last_run_tick)) { ... }
+     * @endcode
+     *
+     * `Mg::ecs::Tracked` gives a TrackedRef, through which writes mark the component as changed.
+     *
+     * Entities must not be created or deleted, nor components added or removed, while iterating.
+     * @see parallel_for_each in mg_parallel_for_each.h, for iterating in parallel.
+     *
      * @tparam Cs List of required components
+     * @param changed_since Change tick for components designated by `Mg::ecs::Changed`.
      * @return Iterable view over entities with the required components
      * whose iterator dereferences to a tuple (Entity, Cs*...)
      */
-    template<ComponentTypeDesignator... Cs> [[nodiscard]] UnpackingView<Cs...> get_with()
+    template<ComponentTypeDesignator... Cs>
+    [[nodiscard]] UnpackingView<Cs...> get_with(uint32_t changed_since = 0)
     {
-        return { *this };
+        return { *this, matching_archetypes<Cs...>(), changed_since };
     }
 
     ComponentMask component_mask(Entity entity) const { return data(entity).mask; }
@@ -151,56 +465,107 @@ public:
     /** Get the number of currently existing entities. */
     size_t num_entities() const noexcept { return m_entity_data.size(); }
 
-    // Array of handles to all components associated with an entity
-    using ComponentList = std::array<Slot_map_handle, k_max_component_types>;
+    /** Get the archetypes, i.e. the component storage for each distinct set of component types
+     * that entities in this collection have had.
+     */
+    std::span<const std::unique_ptr<Archetype>> archetypes() const noexcept
+    {
+        return m_archetypes;
+    }
+
+    /** Get the number of archetypes. */
+    size_t num_archetypes() const noexcept { return m_archetypes.size(); }
+
+    /** Get the indices, into `archetypes()`, of the archetypes whose entities have the components
+     * designated by Cs. This may include empty archetypes.
+     *
+     * The result is cached, so only the first call for a given query has to test the archetypes.
+     * Thread-safe with respect to other queries; the returned span is invalidated when a new
+     * archetype is created, i.e. when a component is added or removed.
+     */
+    template<ComponentTypeDesignator... Cs> std::span<const uint32_t> matching_archetypes()
+    {
+        if constexpr (sizeof...(Cs) > 0) {
+            return matching_archetypes(create_mask<Cs...>(), create_not_mask<Cs...>());
+        }
+        else {
+            return matching_archetypes(0, 0);
+        }
+    }
 
-    // Array of owning pointers to component collections.
-    using ComponentCollectionList =
-        std::array<std::unique_ptr<IComponentCollection>, k_max_component_types>;
+    /** Get the indices of the archetypes whose entities have all components in `mask` and none of
+     * those in `not_mask`. See the templated overload.
+     */
+    std::span<const uint32_t> matching_archetypes(ComponentMask mask, ComponentMask not_mask);
 
 private:
+    friend class CommandBuffer;
+
     // Meta-data associated with each entity
     struct EntityData {
-        // Bitmask representing what components the entity holds. It is
-        // technically redundant, but this compact representation allows very
-        // fast iteration when searching for all entities with a certain set of
-        // components.
+        // Bitmask representing what components the entity holds. Equal to the archetype's mask,
+        // but stored here to avoid an indirection.
         ComponentMask mask{};
 
-        // Handle to the ComponentList for this entity in m_component_lists
-        Slot_map_handle component_list_handle;
+        // Index of the entity's archetype in m_archetypes.
+        uint32_t archetype_index = 0;
+
+        // Row of the entity's components in the archetype.
+        uint32_t row = 0;
     };
 
     const EntityData& data(Entity entity) const { return m_entity_data[entity.handle()]; }
 
     EntityData& data(Entity entity) { return m_entity_data[entity.handle()]; }
 
-    template<Component C> void add_component_collection();
-
-    template<Component C> ComponentCollection<C>& component_collection();
-
     bool has_component(Entity entity, size_t component_type_id) const
     {
         return (component_mask(entity) & (ComponentMask{ 1u } << component_type_id)) != 0u;
     }
 
-    Slot_map_handle& component_handle_ref(Entity entity, size_t component_type_id);
+    void remove_component(Entity entity, size_t component_type_id);
 
-    template<Component C> C& get_component(Slot_map_handle component_handle)
-    {
-        return component_collection<C>().get_component(component_handle);
-    }
+    // Move the component into the entity, which must not already have one of the same type.
+    template<Component C> C& place_component(Entity entity, C&& component);
+
+    uint32_t find_or_create_archetype(ComponentMask mask);
 
-    ComponentMask& component_mask_ref(Entity entity) { return data(entity).mask; }
+    // Value-initialize the components of a newly pushed row. If a constructor throws, the row is
+    // removed again.
+    void construct_default_components(Archetype& archetype, uint32_t row);
+
+    // Get the archetype with the given component type added to or removed from the given one.
+    uint32_t archetype_transition(uint32_t archetype_index, size_t component_type_id);
+
+    // Move entity to another archetype. Components in both archetypes are relocated; those only in
+    // the entity's current archetype are destroyed; and those only in the new archetype are left
+    // uninitialized, to be constructed by the caller.
+    // Returns the entity's new row.
+    uint32_t move_entity(Entity entity, uint32_t archetype_index);
 
     Slot_map<EntityData> m_entity_data;
 
-    // m_component_lists holds arrays of component handles, each array
-    // corresponding to the components belonging to an entity.
-    Slot_map<ComponentList> m_component_lists;
+    std::array<ComponentTypeInfo, k_max_component_types> m_component_type_infos;
+
+    // Archetypes are never destroyed, so that their indices remain valid.
+    std::vector<std::unique_ptr<Archetype>> m_archetypes;
 
-    // ComponentCollections owns the actual component data
-    ComponentCollectionList m_component_collections;
+    FlatMap<ComponentMask, uint32_t> m_archetype_indices;
+
+    struct QueryKey {
+        ComponentMask mask = 0;
+        ComponentMask not_mask = 0;
+        auto operator<=>(const QueryKey&) const = default;
+    };
+
+    // Indices of the archetypes matching each query made so far. The vectors are individually
+    // allocated, so that they stay in place when other queries are added.
+    FlatMap<QueryKey, std::unique_ptr<std::vector<uint32_t>>> m_query_matches;
+
+    // Queries may be made concurrently, e.g. by systems running in a SystemGraph.
+    std::mutex m_query_matches_mutex;
+
+    uint32_t m_change_tick = 1;
 
     bool m_initialized = false;
 };
@@ -211,84 +576,77 @@ private:
 // See UnpackingView and EntityCollection::get_with
 template<ComponentTypeDesignator... Cs> class EntityCollection::iterator {
 public:
-    iterator(EntityCollection& collection, Slot_map<EntityData>::iterator it)
-        : m_collection{ collection }, m_it{ it }
+    iterator(EntityCollection& collection,
+             std::span<const uint32_t> archetype_indices,
+             size_t pos,
+             uint32_t changed_since)
+        : m_collection{ collection }
+        , m_archetype_indices{ archetype_indices }
+        , m_pos{ pos }
+        , m_changed_since{ changed_since }
     {
-        if constexpr (sizeof...(Cs) > 0) {
-            m_mask = create_mask<Cs...>();
-            m_not_mask = create_not_mask<Cs...>();
-        }
-        else {
-            m_mask = 0;
-            m_not_mask = 0;
-        }
         find_match();
     }
 
     // Increment until next matching entity is found (or end)
     iterator& operator++()
     {
-        ++m_it;
+        ++m_row;
         find_match();
         return *this;
     }
 
     // Dereference into a tuple of (Entity, Components&...)
-    auto operator*()
-    {
-        Entity entity = m_collection.m_entity_data.make_handle(m_it);
-        ComponentList& component_list = m_collection.m_component_lists[m_it->component_list_handle];
-
-        return std::tuple_cat(std::tuple{ entity },
-                              get_tuple_with_reference_to_component<Cs>(component_list)...);
-    }
-
-    friend bool operator!=(iterator l, iterator r) { return l.m_it != r.m_it; }
-
-private:
-    template<InstantiationOf<Not> C>
-    std::tuple<> get_tuple_with_reference_to_component(ComponentList&)
-    {
-        return {};
-    }
-
-    template<InstantiationOf<Maybe> C>
-    std::tuple<typename C::component_type*>
-    get_tuple_with_reference_to_component(ComponentList& component_list)
-    {
-        const auto id = C::component_type::component_type_id();
-        return component_list[id]
-                   ? &m_collection.get_component<typename C::component_type>(component_list[id])
-                   : nullptr;
-    }
+    auto operator*() const { return m_chunk[m_row]; }
 
-    template<Component C>
-    std::tuple<C&> get_tuple_with_reference_to_component(ComponentList& component_list)
+    friend bool operator!=(const iterator& l, const iterator& r)
     {
-        return m_collection.get_component<C>(component_list[C::component_type_id()]);
+        return l.m_pos != r.m_pos || l.m_chunk_index != r.m_chunk_index || l.m_row != r.m_row;
     }
 
-    // Check if the iterator points to an entity which has the sought set of components.
-    bool match() const
+private:
+    const Archetype& archetype() const
     {
-        return (m_it->mask & m_mask) == m_mask && (m_it->mask & m_not_mask) == 0u;
+        return *m_collection.m_archetypes[m_archetype_indices[m_pos]];
     }
 
+    // Advance to the first included entity at or after the current position, skipping empty
+    // archetypes and chunks without changes.
     void find_match()
     {
-        while (m_it != m_collection.m_entity_data.end() && !match()) {
-            ++m_it;
+        for (; m_pos < m_archetype_indices.size(); ++m_pos, m_chunk_index = 0) {
+            for (; m_chunk_index < archetype().num_chunks(); ++m_chunk_index, m_row = 0) {
+                if (m_row == 0) {
+                    m_chunk = {
+                        archetype(), m_chunk_index, m_collection.m_change_tick, m_changed_since
+                    };
+                    if (!m_chunk.has_changes()) {
+                        continue;
+                    }
+                }
+
+                for (; m_row < m_chunk.size(); ++m_row) {
+                    if (m_chunk.is_included(m_row)) {
+                        return;
+                    }
+                }
+            }
         }
     }
 
     EntityCollection& m_collection;
-    Slot_map<EntityData>::iterator m_it;
 
-    // The byte mask indicating which components must be included.
-    ComponentMask m_mask;
+    // Indices of the archetypes matching the query.
+    std::span<const uint32_t> m_archetype_indices;
+
+    // Current position.
+    size_t m_pos = 0;
+    size_t m_chunk_index = 0;
+    uint32_t m_row = 0;
+
+    uint32_t m_changed_since = 0;
 
-    // The byte mask indicating which components must be not included.
-    ComponentMask m_not_mask;
+    detail::ChunkView<Cs...> m_chunk;
 };
 
 
@@ -297,13 +655,24 @@ private:
  */
 template<ComponentTypeDesignator... Cs> class EntityCollection::UnpackingView {
 public:
-    UnpackingView(EntityCollection& collection) : m_owner{ collection } {}
+    UnpackingView(EntityCollection& collection,
+                  std::span<const uint32_t> archetype_indices,
+                  uint32_t changed_since)
+        : m_owner{ collection }
+        , m_archetype_indices{ archetype_indices }
+        , m_changed_since{ changed_since }
+    {}
 
-    iterator<Cs...> begin() { return { m_owner, m_owner.m_entity_data.begin() }; }
-    iterator<Cs...> end() { return { m_owner, m_owner.m_entity_data.end() }; }
+    iterator<Cs...> begin() { return { m_owner, m_archetype_indices, 0, m_changed_since }; }
+    iterator<Cs...> end()
+    {
+        return { m_owner, m_archetype_indices, m_archetype_indices.size(), m_changed_since };
+    }
 
 private:
     EntityCollection& m_owner;
+    std::span<const uint32_t> m_archetype_indices;
+    uint32_t m_changed_since = 0;
 };
 
 //--------------------------------------------------------------------------------------------------
@@ -314,51 +683,23 @@ private:
 template<Component C, typename... Ts>
 C& EntityCollection::add_component(Entity entity, Ts&&... args)
 {
-    // Make sure component does not already exist
-    MG_ASSERT(!has_component(entity, C::component_type_id()));
-
-    auto& components = component_collection<C>();
-    auto handle = components.emplace(std::forward<Ts>(args)...);
-
-    component_handle_ref(entity, C::component_type_id()) = handle;
-    component_mask_ref(entity) |= (ComponentMask{ 1 } << C::component_type_id());
-
-    return components.get_component(handle);
+    // Construct before moving the entity, so that it is left unchanged if construction throws.
+    return place_component<C>(entity, C{ /*BaseComponent*/ {}, std::forward<Ts>(args)... });
 }
 
-// Remove component from entity
-template<Component C> void EntityCollection::remove_component(Entity entity)
+template<Component C> C& EntityCollection::place_component(Entity entity, C&& component)
 {
-    MG_ASSERT(has_component<C>(entity) && "Removing non-existent component.");
-
-    auto& collection = component_collection<C>();
-    auto& handle = component_handle_ref(entity, C::component_type_id());
-    collection.erase(handle);
-
-    // Reset component handle (not strictly necessary but safer)
-    handle = {};
+    const auto component_type_id = C::component_type_id();
 
-    // Clear component flag.
-    component_mask_ref(entity) &= ~(ComponentMask{ 1 } << C::component_type_id());
-}
-
-template<Component C> void EntityCollection::add_component_collection()
-{
-    auto& p_collection = m_component_collections[C::component_type_id()];
-    MG_ASSERT(p_collection == nullptr);
-    p_collection = std::make_unique<ComponentCollection<C>>(m_entity_data.capacity());
-}
+    // Make sure component does not already exist
+    MG_ASSERT(!has_component(entity, component_type_id));
 
-// Retrieve component collection for component type C
-template<Component C> ComponentCollection<C>& EntityCollection::component_collection()
-{
-    auto& p_collection = m_component_collections[C::component_type_id()];
-    MG_ASSERT(p_collection != nullptr &&
-              "EntityCollection does not contain a ComponentCollection for this component type.");
+    const uint32_t archetype_index =
+        archetype_transition(data(entity).archetype_index, component_type_id);
+    const uint32_t row = move_entity(entity, archetype_index);
 
-    // Cast to actual type and return
-    auto& collection = *(p_collection.get());
-    return static_cast<ComponentCollection<C>&>(collection);
+    void* destination = m_archetypes[archetype_index]->component_ptr(row, component_type_id);
+    return *new (destination) C(std::move(component));
 }
 
 } // namespace Mg::ecs
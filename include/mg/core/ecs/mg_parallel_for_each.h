@@ -0,0 +1,110 @@
+//**************************************************************************************************
+// This file is part of Mg Engine. Copyright (c) 2026, Magnus Bergsten.
+// Mg Engine is made available under the terms of the 3-Clause BSD License.
+// See LICENSE.txt in the project's root directory.
+//**************************************************************************************************
+
+/** @file mg_parallel_for_each.h
+ * Parallel iteration over entities with a given set of components.
+ */
+
+#pragma once
+
+#include "mg/core/ecs/mg_entity.h"
+#include "mg/core/mg_job_system.h"
+
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+namespace Mg::ecs {
+
+namespace detail {
+
+template<ComponentTypeDesignator C, ComponentTypeDesignator... Cs>
+constexpr bool has_duplicate_component_types()
+{
+    constexpr bool head_is_duplicate =
+        (std::is_same_v<designated_component_t<C>, designated_component_t<Cs>> || ...);
+
+    if constexpr (sizeof...(Cs) > 0) {
+        return head_is_duplicate || has_duplicate_component_types<Cs...>();
+    }
+    else {
+        return head_is_duplicate;
+    }
+}
+
+template<typename F, typename Tuple> inline constexpr bool is_invocable_with_tuple_v = false;
+
+template<typename F, typename... Ts>
+inline constexpr bool is_invocable_with_tuple_v<F, std::tuple<Ts...>> =
+    std::is_invocable_v<F, Ts...>;
+
+} // namespace detail
+
+/** Invoke `function(entity, components...)` for each entity which has the components designated
+ * by Cs, in parallel, and wait for completion. The arguments are the same as when iterating over
+ * `collection.get_with<Cs...>()`, e.g.:
+ *
+ * @code
+ * parallel_for_each<const Velocity, Position>(collection, job_system,
+ *     [&](Entity entity, const Velocity& velocity, Position& position) { ... });
+ * @endcode
+ *
+ * The work is split into jobs of whole archetype chunks, so each job sweeps linearly through its
+ * own, cache-line aligned, component arrays.
+ *
+ * `function` is invoked concurrently, so it must be race-free. To help with that, only the
+ * components designated by Cs are passed to it, and:
+ * - components designated as const (e.g. `const Velocity`) are passed by const reference,
+ * - each component type may be designated only once,
+ * - `function` is invoked through a const reference, so that e.g. a mutable lambda cannot modify
+ *   its captures.
+ * Declare the same access for the system using `SystemAccess::queries<Cs...>()`.
+ *
+ * As with `get_with`, `changed_since` is the change tick for components designated by Changed<>.
+ * Chunks without such changes are skipped before any job is created.
+ *
+ * Entities must not be created or deleted, nor components added or removed, during the call.
+ */
+template<ComponentTypeDesignator... Cs>
+void parallel_for_each(EntityCollection& collection,
+                       JobSystem& job_system,
+                       const auto& function,
+                       uint32_t changed_since = 0)
+{
+    using ChunkView = detail::ChunkView<Cs...>;
+    using Arguments = decltype(std::declval<const ChunkView&>()[0]);
+
+    if constexpr (sizeof...(Cs) > 0) {
+        static_assert(!detail::has_duplicate_component_types<Cs...>(),
+                      "Each component type may be designated only once.");
+    }
+    static_assert(detail::is_invocable_with_tuple_v<decltype(function), Arguments>,
+                  "function must be invocable as function(Entity, components...), taking read-only "
+                  "(const) components by value or const reference.");
+
+    std::vector<ChunkView> chunks;
+    for (const uint32_t archetype_index : collection.matching_archetypes<Cs...>()) {
+        const Archetype& archetype = *collection.archetypes()[archetype_index];
+        for (size_t chunk_index = 0; chunk_index < archetype.num_chunks(); ++chunk_index) {
+            const ChunkView chunk{
+                archetype, chunk_index, collection.change_tick(), changed_since
+            };
+            if (chunk.has_changes()) {
+                chunks.push_back(chunk);
+            }
+        }
+    }
+
+    job_system.parallel_for(chunks, [&function](const ChunkView& chunk) {
+        for (uint32_t row = 0; row < chunk.size(); ++row) {
+            if (chunk.is_included(row)) {
+                std::apply(function, chunk[row]);
+            }
+        }
+    });
+}
+
+} // namespace Mg::ecs
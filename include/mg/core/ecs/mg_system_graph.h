@@ -0,0 +1,186 @@
+//**************************************************************************************************
+// This file is part of Mg Engine. Copyright (c) 2026, Magnus Bergsten.
+// Mg Engine is made available under the terms of the 3-Clause BSD License.
+// See LICENSE.txt in the project's root directory.
+//**************************************************************************************************
+
+/** @file mg_system_graph.h
+ * Scheduling of systems, which may run concurrently when they access different data.
+ */
+
+#pragma once
+
+#include "mg/core/containers/mg_small_vector.h"
+#include "mg/core/ecs/mg_base_component.h"
+#include "mg/core/ecs/mg_component_mask.h"
+#include "mg/core/mg_identifier.h"
+#include "mg/utils/mg_macros.h"
+
+#include <functional>
+#include <memory>
+#include <span>
+#include <vector>
+
+namespace Mg {
+class JobSystem;
+} // namespace Mg
+
+namespace Mg::ecs {
+
+/** Declares what a system reads and writes, so that SystemGraph can tell which systems may run
+ * concurrently. Component types are declared by type; other data (resources) by name.
+ */
+class SystemAccess {
+public:
+    /** Access that conflicts with every other system. Use for systems whose access is unknown. */
+    static SystemAccess exclusive()
+    {
+        SystemAccess result;
+        result.m_is_exclusive = true;
+        return result;
+    }
+
+    template<Component... Cs> SystemAccess& reads()
+    {
+        ((m_read_components |= ComponentMask{ 1u } << Cs::component_type_id()), ...);
+        return *this;
+    }
+
+    template<Component... Cs> SystemAccess& writes()
+    {
+        ((m_write_components |= ComponentMask{ 1u } << Cs::component_type_id()), ...);
+        return *this;
+    }
+
+    /** Declare the access of iterating over entities with the given component type designators,
+     * as in `EntityCollection::get_with` or `parallel_for_each`: const-qualified component types
+     * are read, the others written.
+     */
+    template<ComponentTypeDesignator... Cs> SystemAccess& queries()
+    {
+        (add_query_access<Cs>(), ...);
+        return *this;
+    }
+
+    SystemAccess& reads_resource(Identifier resource_id)
+    {
+        m_read_resources.push_back(resource_id);
+        return *this;
+    }
+
+    SystemAccess& writes_resource(Identifier resource_id)
+    {
+        m_write_resources.push_back(resource_id);
+        return *this;
+    }
+
+    /** The system must run on the thread calling `SystemGraph::run`, for example because it uses
+     * the OpenGL context or the window system.
+     */
+    SystemAccess& on_main_thread()
+    {
+        m_requires_main_thread = true;
+        return *this;
+    }
+
+    /** Whether two systems with these accesses must not run concurrently, i.e. whether either
+     * writes anything that the other reads or writes.
+     */
+    bool conflicts_with(const SystemAccess& other) const noexcept;
+
+    bool is_exclusive() const noexcept { return m_is_exclusive; }
+    bool requires_main_thread() const noexcept { return m_requires_main_thread; }
+
+private:
+    template<ComponentTypeDesignator C> void add_query_access()
+    {
+        // Not<C> only inspects which components the entities have, which does not race with
+        // writes to component data.
+        if constexpr (!InstantiationOf<C, Not>) {
+            const auto bit = ComponentMask{ 1u } << designated_component_t<C>::component_type_id();
+            if constexpr (designated_component<C>::is_read_only) {
+                m_read_components |= bit;
+            }
+            else {
+                m_write_components |= bit;
+            }
+        }
+    }
+
+    ComponentMask m_read_components = 0;
+    ComponentMask m_write_components = 0;
+    small_vector<Identifier, 2> m_read_resources;
+    small_vector<Identifier, 2> m_write_resources;
+    bool m_is_exclusive = false;
+    bool m_requires_main_thread = false;
+};
+
+/** Runs a set of systems -- functions operating on entities, components, or other data -- using a
+ * JobSystem. Each system declares what it accesses; systems whose accesses conflict run in the
+ * order in which they were added, while the others may run concurrently.
+ */
+class SystemGraph {
+public:
+    using SystemFunction = std::function<void()>;
+
+    SystemGraph();
+    ~SystemGraph();
+
+    MG_MAKE_NON_COPYABLE(SystemGraph);
+    MG_MAKE_NON_MOVABLE(SystemGraph);
+
+    /** Add system to the graph. Must not be called while the graph is running. */
+    void add_system(Identifier name, SystemAccess access, SystemFunction function);
+
+    /** Remove all systems. Must not be called while the graph is running. */
+    void clear();
+
+    /** Run all systems and wait for them to finish. Systems on the main thread (see
+     * `SystemAccess::on_main_thread`) run on the calling thread, the others as jobs in
+     * `job_system`. The calling thread also executes jobs while waiting.
+     *
+     * If a system throws, the systems that have not yet started are skipped, and the exception is
+     * rethrown once the running ones have finished.
+     */
+    void run(JobSystem& job_system);
+
+    size_t num_systems() const noexcept { return m_systems.size(); }
+
+    Identifier system_name(size_t system_index) const { return m_systems.at(system_index).name; }
+
+    /** Get the indices of the systems that must finish before the given system may start. Systems
+     * that are already implied by other dependencies are omitted.
+     */
+    std::span<const size_t> dependencies(size_t system_index) const
+    {
+        return m_systems.at(system_index).dependencies;
+    }
+
+private:
+    struct System {
+        Identifier name;
+        SystemAccess access;
+        SystemFunction function;
+        std::vector<size_t> dependencies;
+        std::vector<size_t> dependants;
+    };
+
+    struct RunState;
+
+    void run_system(size_t system_index) noexcept;
+
+    // Signal dependants that the system has finished, starting those that become ready.
+    void on_system_finished(size_t system_index) noexcept;
+
+    void start_system_job(size_t system_index) noexcept;
+
+    std::vector<System> m_systems;
+
+    // For each system, the set of systems that it (transitively) depends on.
+    std::vector<std::vector<bool>> m_ancestors;
+
+    // State used only during `run`.
+    std::unique_ptr<RunState> m_run_state;
+};
+
+} // namespace Mg::ecs
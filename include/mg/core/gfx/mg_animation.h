@@ -16,6 +16,10 @@
 #include <glm/gtc/quaternion.hpp>
 #include <glm/vec3.hpp>
 
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
 namespace Mg::gfx::mesh_data {
 
 struct PositionKey {
@@ -39,10 +43,58 @@ struct AnimationChannel {
     Array<ScaleKey> scale_keys;
 };
 
+/** Range of keys of one track -- positions, rotations, or scales -- of a compressed animation
+ * channel. Indexes both `CompressedAnimation::frames` and `CompressedAnimation::values`.
+ */
+struct CompressedAnimationTrack {
+    uint32_t first_key = 0;
+    uint32_t num_keys = 0;
+};
+
+/** Channel of a compressed animation. Positions are quantized to 16 bits per component within the
+ * range [position_min, position_min + position_extent], and scales likewise. Rotations are
+ * quaternions in "smallest three" encoding, see `compress_rotation`. A track without keys means
+ * the identity transformation, as for uncompressed channels.
+ */
+struct CompressedAnimationChannel {
+    CompressedAnimationTrack position_keys;
+    CompressedAnimationTrack rotation_keys;
+    CompressedAnimationTrack scale_keys;
+    glm::vec3 position_min = glm::vec3(0.0f);
+    glm::vec3 position_extent = glm::vec3(0.0f);
+    float scale_min = 0.0f;
+    float scale_extent = 0.0f;
+};
+
+/** Compressed representation of the channels of an animation clip, see `compress_animation_clip`.
+ * Keys are placed on a uniform grid of `sample_rate` frames per second, and each key consists of
+ * its frame number, in `frames`, and its quantized value, in `values`. Scale keys use only the
+ * first element of their value.
+ */
+struct CompressedAnimation {
+    float sample_rate = 0.0f;
+    Array<CompressedAnimationChannel> channels;
+    Array<uint16_t> frames;
+    Array<std::array<uint16_t, 3>> values;
+};
+
 struct AnimationClip {
     Identifier name;
+
+    /** Channels, indexed by JointId. Empty if the clip is compressed. */
     Array<AnimationChannel> channels;
+
     float duration_seconds = 0.0;
+
+    /** Channels in compressed format. Empty unless the clip is compressed. */
+    CompressedAnimation compressed;
+
+    bool is_compressed() const noexcept { return !compressed.channels.empty(); }
+
+    size_t num_channels() const noexcept
+    {
+        return is_compressed() ? compressed.channels.size() : channels.size();
+    }
 };
 
 } // namespace Mg::gfx::mesh_data
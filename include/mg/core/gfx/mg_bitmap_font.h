@@ -23,6 +23,7 @@
 
 namespace Mg {
 class FontResource;
+class LinearArena;
 struct UnicodeRange;
 } // namespace Mg
 
@@ -100,6 +101,13 @@ public:
     [[nodiscard]] PreparedText prepare_text(std::string_view text_utf8,
                                             const TypeSetting& typesetting) const;
 
+    /** As above, but the temporary data used while preparing the text is allocated from
+     * `scratch`, e.g. an arena that is reset every frame.
+     */
+    [[nodiscard]] PreparedText prepare_text(std::string_view text_utf8,
+                                            const TypeSetting& typesetting,
+                                            LinearArena& scratch) const;
+
     std::span<const UnicodeRange> contained_ranges() const;
 
     int font_size_pixels() const;
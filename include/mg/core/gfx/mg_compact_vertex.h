@@ -0,0 +1,69 @@
+//**************************************************************************************************
+// This file is part of Mg Engine. Copyright (c) 2026, Magnus Bergsten.
+// Mg Engine is made available under the terms of the 3-Clause BSD License.
+// See LICENSE.txt in the project's root directory.
+//**************************************************************************************************
+
+/** @file mg_compact_vertex.h
+ * Conversion between mesh_data::Vertex and the quantized mesh_data::CompactVertex.
+ */
+
+#pragma once
+
+#include "mg/core/gfx/mg_mesh_data.h"
+#include "mg/core/mg_bounding_volumes.h"
+
+#include <glm/vec3.hpp>
+
+#include <array>
+#include <cstdint>
+
+namespace Mg::gfx::mesh_data {
+
+/** Convert float to IEEE 754 half-precision float, rounding to nearest. Values too large to
+ * represent become infinity.
+ */
+uint16_t float_to_half(float value) noexcept;
+
+/** Convert IEEE 754 half-precision float to float. */
+float half_to_float(uint16_t value) noexcept;
+
+/** Quantize position to 16-bit unsigned normalized integers relative to the bounding box. Positions
+ * outside the box are clamped to it.
+ */
+std::array<uint16_t, 4> quantize_position(const glm::vec3& position,
+                                          const AxisAlignedBoundingBox& quantization_box) noexcept;
+
+/** Reverse the operation done by `quantize_position`. */
+glm::vec3 dequantize_position(const std::array<uint16_t, 4>& quantized_position,
+                              const AxisAlignedBoundingBox& quantization_box) noexcept;
+
+/** Orthonormal tangent frame. */
+struct TangentFrame {
+    glm::vec3 normal{ 0.0f, 0.0f, 1.0f };
+    glm::vec3 tangent{ 1.0f, 0.0f, 0.0f };
+    glm::vec3 bitangent{ 0.0f, 1.0f, 0.0f };
+};
+
+/** Encode a tangent frame as a QTangent: a quaternion for the rotation from tangent space, with
+ * the handedness of the bitangent in the sign of w. The tangent is orthogonalized against the
+ * normal; the bitangent is only used for handedness.
+ */
+std::array<int16_t, 4> encode_qtangent(const glm::vec3& normal,
+                                       const glm::vec3& tangent,
+                                       const glm::vec3& bitangent) noexcept;
+
+/** Decode a QTangent, see `encode_qtangent`. Same as done by the mesh renderer's vertex shader. */
+TangentFrame decode_qtangent(const std::array<int16_t, 4>& qtangent) noexcept;
+
+/** Convert vertex to compact format. `quantization_box` should enclose all vertices of the mesh,
+ * and must be provided along with the compact vertices when creating a mesh.
+ */
+CompactVertex compress_vertex(const Vertex& vertex,
+                              const AxisAlignedBoundingBox& quantization_box) noexcept;
+
+/** Convert compact vertex back to Vertex, with loss of precision. */
+Vertex decompress_vertex(const CompactVertex& vertex,
+                         const AxisAlignedBoundingBox& quantization_box) noexcept;
+
+} // namespace Mg::gfx::mesh_data
@@ -0,0 +1,71 @@
+//**************************************************************************************************
+// This file is part of Mg Engine. Copyright (c) 2026, Magnus Bergsten.
+// Mg Engine is made available under the terms of the 3-Clause BSD License.
+// See LICENSE.txt in the project's root directory.
+//**************************************************************************************************
+
+/** @file mg_compressed_animation.h
+ * Conversion between uncompressed animation clips and mesh_data::CompressedAnimation.
+ */
+
+#pragma once
+
+#include "mg/core/gfx/mg_animation.h"
+#include "mg/utils/mg_optional.h"
+
+#include <glm/gtc/quaternion.hpp>
+#include <glm/vec3.hpp>
+
+#include <array>
+#include <cstdint>
+
+namespace Mg::gfx::mesh_data {
+
+/** Encode a rotation quaternion in 48 bits using "smallest three" encoding: the component with
+ * the largest magnitude is dropped, after flipping the sign of the quaternion (which does not
+ * change the rotation) so that it is positive. The other three components, which lie within
+ * [-1/sqrt(2), 1/sqrt(2)], are stored as 15-bit integers, and the index of the dropped component in
+ * the top bits of the first two elements.
+ */
+std::array<uint16_t, 3> compress_rotation(const glm::quat& rotation) noexcept;
+
+/** Decode a rotation encoded by `compress_rotation`. */
+glm::quat decompress_rotation(const std::array<uint16_t, 3>& value) noexcept;
+
+/** Decode a position key value of the given channel. */
+glm::vec3 decompress_position(const std::array<uint16_t, 3>& value,
+                              const CompressedAnimationChannel& channel) noexcept;
+
+/** Decode a scale key value of the given channel. */
+float decompress_scale(const std::array<uint16_t, 3>& value,
+                       const CompressedAnimationChannel& channel) noexcept;
+
+struct AnimationCompressionSettings {
+    /** Frames per second at which the clip is resampled. Keys are placed only on these frames. */
+    float sample_rate = 30.0f;
+
+    /** Maximum error in positions, in mesh-space units. */
+    float position_tolerance = 0.0001f;
+
+    /** Maximum error in rotations, in radians. */
+    float rotation_tolerance = 0.0005f;
+
+    /** Maximum error in scales. */
+    float scale_tolerance = 0.0001f;
+};
+
+/** Compress an animation clip: resample each channel uniformly, quantize the values, and remove
+ * keys that can be reconstructed -- by interpolating between the remaining keys -- within the
+ * tolerances given in `settings`. Tracks that are constant keep a single key, or none at all if the
+ * constant is the identity transformation.
+ *
+ * The tolerances apply in addition to the error from quantization, which for positions and scales
+ * is proportional to the range of values in each channel.
+ *
+ * @return The compressed clip, or nullopt if the clip is too long to compress (more than 65535
+ * frames at the given sample rate).
+ */
+Opt<AnimationClip> compress_animation_clip(const AnimationClip& clip,
+                                           const AnimationCompressionSettings& settings = {});
+
+} // namespace Mg::gfx::mesh_data
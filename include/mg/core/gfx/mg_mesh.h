@@ -61,6 +61,11 @@ struct Mesh {
     /** Vertex data buffer. */
     SharedBuffer* vertex_buffer = nullptr;
 
+    /** Layout of the data in vertex_buffer. For `VertexFormat::Compact`, positions are quantized
+     * against `aabb`.
+     */
+    mesh_data::VertexFormat vertex_format = mesh_data::VertexFormat::Standard;
+
     /** Index buffer, triangle list of indexes into vertex_buffer. */
     SharedBuffer* index_buffer = nullptr;
 
@@ -20,8 +20,11 @@
 
 #include <glm/mat4x4.hpp>
 
+#include <array>
+#include <cstddef>
 #include <cstdint>
 #include <limits>
+#include <span>
 
 /** Definitions related to meshes. */
 namespace Mg::gfx::mesh_data {
@@ -81,6 +84,59 @@ inline constexpr std::array<VertexAttribute, 5> vertex_attributes = {
                      .int_value_meaning = IntValueMeaning::Normalize }
 };
 
+/** Compact alternative to Vertex, at less than half the size. Positions are quantized against a
+ * bounding box of the mesh, and the tangent frame is stored as a quaternion. The third texture
+ * coordinate component is not stored. See mg_compact_vertex.h for conversion functions.
+ */
+struct CompactVertex {
+    /** Position as 16-bit unsigned normalized integers, relative to the bounding box against which
+     * the mesh was quantized. The fourth element is padding.
+     */
+    std::array<uint16_t, 4> position = {};
+
+    /** Texture coordinates as half-precision floats. */
+    std::array<uint16_t, 2> tex_coord = {};
+
+    /** Tangent frame as a quaternion in 16-bit signed normalized integers (QTangent). The sign of
+     * the w component is the handedness of the bitangent.
+     */
+    std::array<int16_t, 4> qtangent = {};
+};
+
+/** Attribute array corresponding to CompactVertex. Describes the data layout of a compact
+ * vertex.
+ */
+inline constexpr std::array<VertexAttribute, 3> compact_vertex_attributes = {
+    VertexAttribute{ .identifier = "position",
+                     .binding_location = 0,
+                     .num_elements = 3,
+                     .size = sizeof(CompactVertex::position),
+                     .type = VertexAttributeType::u16,
+                     .int_value_meaning = IntValueMeaning::Normalize },
+
+    VertexAttribute{ .identifier = "tex_coord",
+                     .binding_location = 1,
+                     .num_elements = 2,
+                     .size = sizeof(CompactVertex::tex_coord),
+                     .type = VertexAttributeType::f16 },
+
+    VertexAttribute{ .identifier = "qtangent",
+                     .binding_location = 2,
+                     .num_elements = 4,
+                     .size = sizeof(CompactVertex::qtangent),
+                     .type = VertexAttributeType::i16,
+                     .int_value_meaning = IntValueMeaning::Normalize }
+};
+
+/** The layout of a mesh's vertex data. */
+enum class VertexFormat : uint8_t {
+    /** Vertices of type Vertex, described by `vertex_attributes`. */
+    Standard,
+
+    /** Vertices of type CompactVertex, described by `compact_vertex_attributes`. */
+    Compact
+};
+
 //--------------------------------------------------------------------------------------------------
 // Mesh structure definitions
 //--------------------------------------------------------------------------------------------------
@@ -105,7 +161,7 @@ struct Submesh {
 /** Non-owning view over the data required to define animations in a mesh. */
 struct AnimationDataView {
     /** Per-vertex influences of skeleton joints for animation. Should either be empty (for
-     * non-animated meshes), or the same size as `MeshDataView::vertices`.
+     * non-animated meshes), or the same size as `MeshDataView::num_vertices()`.
      */
     std::span<const Influences> influences;
     std::span<const Joint> joints;
@@ -116,10 +172,15 @@ struct AnimationDataView {
 
 /** Non-owning view over the data required to define a mesh. */
 struct MeshDataView {
-    /** The vertices making up the mesh. */
+    /** The vertices making up the mesh. Empty if the mesh uses compact vertices. */
     std::span<const Vertex> vertices{};
 
-    /** Indices into `vertices` buffer, defining triangle list. */
+    /** The vertices making up the mesh, in compact format. If not empty, this is used instead of
+     * `vertices`, and `aabb` must be the bounding box against which the positions were quantized.
+     */
+    std::span<const CompactVertex> compact_vertices{};
+
+    /** Indices into `vertices` (or `compact_vertices`) buffer, defining triangle list. */
     std::span<const Index> indices{};
 
     /** Submeshes as defined by a range of `indices`. */
@@ -133,6 +194,22 @@ struct MeshDataView {
 
     /** Optionally store bounding box; otherwise, it will be calculated when needed. */
     Opt<AxisAlignedBoundingBox> aabb = nullopt;
+
+    VertexFormat vertex_format() const noexcept
+    {
+        return compact_vertices.empty() ? VertexFormat::Standard : VertexFormat::Compact;
+    }
+
+    size_t num_vertices() const noexcept
+    {
+        return compact_vertices.empty() ? vertices.size() : compact_vertices.size();
+    }
+
+    /** The vertex data as laid out in memory, in whichever format the mesh uses. */
+    std::span<const std::byte> vertex_data() const noexcept
+    {
+        return compact_vertices.empty() ? std::as_bytes(vertices) : std::as_bytes(compact_vertices);
+    }
 };
 
 /** Strongly typed size type for vertex buffers, specified in number of bytes.
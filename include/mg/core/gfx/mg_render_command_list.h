@@ -50,6 +50,11 @@ struct RenderCommand {
     /** Material to use for this draw call. */
     const Material* material{};
 
+    /** If the mesh uses compact vertices (mesh_data::CompactVertex), this is the bounding box
+     * against which the vertex positions are quantized. Otherwise, nullptr.
+     */
+    const AxisAlignedBoundingBox* position_quantization_box{};
+
     /** If rendering a skinned mesh, this will point out which skinning matrices to upload to GPU.
      * If not, `num_skinning_matrices` will be 0.
      */
@@ -102,20 +107,27 @@ private:
 class SkinningMatrixPalette {
 public:
     /** Access to the skinning_matrices. Write the appropriate data to this before rendering.
+     * @note The returned span is invalidated when another palette is allocated, so allocate all
+     * palettes before writing to them (the palette object itself remains valid).
      * @see Mg::gfx::calculate_skinning_matrices
      */
-    std::span<glm::mat4> skinning_matrices() const noexcept { return m_skinning_matrices; }
+    std::span<glm::mat4> skinning_matrices() const noexcept
+    {
+        return std::span(*m_storage).subspan(m_start_index, m_num_matrices);
+    }
 
 private:
     friend class RenderCommandProducer;
 
-    explicit SkinningMatrixPalette(const std::span<glm::mat4> skinning_matrices,
-                                   const uint16_t start_index)
-        : m_skinning_matrices(skinning_matrices), m_start_index(start_index)
+    explicit SkinningMatrixPalette(std::vector<glm::mat4>& storage,
+                                   const uint16_t start_index,
+                                   const uint16_t num_matrices)
+        : m_storage(&storage), m_start_index(start_index), m_num_matrices(num_matrices)
     {}
 
-    std::span<glm::mat4> m_skinning_matrices;
-    const uint16_t m_start_index;
+    std::vector<glm::mat4>* m_storage;
+    uint16_t m_start_index;
+    uint16_t m_num_matrices;
 };
 
 /** Interface for producing RenderCommandList. */
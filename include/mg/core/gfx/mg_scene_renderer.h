@@ -25,7 +25,7 @@ public:
         // Drop render passes when shader resources have changed, so changes take immediate effect.
         m_shader_file_changed_tracker = resource_cache.make_file_change_tracker(
             "ShaderResource",
-            [](void* data, const FileChangedEvent&) {
+            [](void* data, std::span<const FileChangedEvent>) {
                 auto& self = *static_cast<SceneRenderer*>(data);
                 self.m_render_passes.clear();
             },
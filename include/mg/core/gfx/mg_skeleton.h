@@ -19,6 +19,14 @@
 #include <glm/mat4x4.hpp>
 #include <glm/vec3.hpp>
 
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace Mg {
+class JobSystem;
+} // namespace Mg
+
 namespace Mg::gfx::mesh_data {
 struct AnimationChannel;
 struct AnimationClip;
@@ -29,23 +37,48 @@ namespace Mg::gfx {
 struct SkeletonPose;
 
 /** A skeleton is a posable structure that is used to animate a mesh. It is defined as a tree of
- * Mg::gfx::mesh_data::Joint instances.
+ * Mg::gfx::mesh_data::Joint instances, where joint 0 is the root.
  */
 class Skeleton {
 public:
     Skeleton() = default;
 
-    explicit Skeleton(const Identifier id, const glm::mat4& root_transform, const size_t num_joints)
-        : m_id(id)
-        , m_joints(Array<mesh_data::Joint>::make(num_joints))
-        , m_root_transform(root_transform)
-    {}
+    explicit Skeleton(Identifier id,
+                      const glm::mat4& root_transform,
+                      std::span<const mesh_data::Joint> joints);
 
     Identifier id() const { return m_id; }
 
-    std::span<mesh_data::Joint> joints() { return m_joints; }
     std::span<const mesh_data::Joint> joints() const { return m_joints; }
 
+    /** Parent of each joint, indexed by JointId. The root, and joints that are not part of the
+     * tree, have no parent (joint_id_none).
+     */
+    std::span<const mesh_data::JointId> parents() const { return m_parents; }
+
+    /** The joints in the tree, ordered such that each joint comes after its parent, so that poses
+     * can be evaluated in a single pass. For joints as written by the mesh converter, this is
+     * simply ascending JointId order.
+     */
+    std::span<const mesh_data::JointId> evaluation_order() const { return m_evaluation_order; }
+
+    /** The joints in the tree, ordered by depth in the tree, where the root has depth 0. */
+    std::span<const mesh_data::JointId> joints_by_depth() const { return m_joints_by_depth; }
+
+    /** The greatest depth of any joint in the tree, where the root has depth 0. */
+    size_t max_depth() const { return m_depth_ends.empty() ? 0 : m_depth_ends.size() - 1; }
+
+    /** The joints in the tree down to the given depth: a prefix of `joints_by_depth()`. Excluding
+     * the deepest joints, e.g. fingers, is a way to reduce the cost of animating a skeleton.
+     */
+    std::span<const mesh_data::JointId> joints_up_to_depth(const size_t depth) const
+    {
+        if (depth >= m_depth_ends.size()) {
+            return m_joints_by_depth;
+        }
+        return std::span(m_joints_by_depth).first(m_depth_ends[depth]);
+    }
+
     Opt<mesh_data::JointId> find_joint(Identifier joint_name) const;
 
     const glm::mat4& root_transform() const { return m_root_transform; }
@@ -57,6 +90,12 @@ public:
 private:
     Identifier m_id;
     Array<mesh_data::Joint> m_joints;
+    Array<mesh_data::JointId> m_parents;
+    Array<mesh_data::JointId> m_evaluation_order;
+    Array<mesh_data::JointId> m_joints_by_depth;
+
+    // Number of joints with depth less than or equal to the index.
+    Array<size_t> m_depth_ends;
     glm::mat4 m_root_transform = glm::mat4(1.0f);
 };
 
@@ -73,6 +112,23 @@ struct SkeletonPose {
     Array<JointPose> joint_poses;
 };
 
+/** Playback state for sampling an animation clip repeatedly, e.g. once per frame. Remembers, for
+ * each channel, the keys that were used last time, so that when the sample time advances a little
+ * between samples, the next keys are found by stepping forward instead of searching.
+ *
+ * The cursor is only a hint: using it with a different clip, or with time moving backwards, gives
+ * the same result as sampling without a cursor.
+ */
+struct AnimationCursor {
+    struct ChannelKeys {
+        uint32_t position_key = 0;
+        uint32_t rotation_key = 0;
+        uint32_t scale_key = 0;
+    };
+
+    std::vector<ChannelKeys> channels;
+};
+
 /** Evaluate pose for a given skeleton and write the resulting skinning transformation matrices
  * (model space to world space) to skinning_matrices_out. This can fail if pose is impossible to
  * apply to the given skeleton, and if skinning_matrices_out is too small to fit matrices for all
@@ -92,6 +148,22 @@ bool calculate_skinning_matrices(const glm::mat4& transform,
                                  const SkeletonPose& pose,
                                  std::span<glm::mat4> skinning_matrices_out);
 
+/** Input and output of a skinning matrix calculation, see `calculate_skinning_matrices`. */
+struct SkinningMatricesJob {
+    glm::mat4 transform = glm::mat4(1.0f);
+    const Skeleton* skeleton = nullptr;
+    const SkeletonPose* pose = nullptr;
+    std::span<glm::mat4> skinning_matrices_out;
+};
+
+/** Calculate skinning matrices for many skeletons, in parallel using the job system, which is
+ * where the time goes in scenes with many animated meshes. The output spans may refer directly to
+ * palettes allocated with `RenderCommandProducer::allocate_skinning_matrix_palette`.
+ *
+ * @return Whether the evaluation was successful for all jobs.
+ */
+bool calculate_skinning_matrices(JobSystem& job_system, std::span<const SkinningMatricesJob> jobs);
+
 /** Evaluate pose for a given skeleton and write the resulting joint transformation matrices
  * (joint space to parent-joint space) to matrices_out. This can fail if pose is impossible to apply
  * to the given skeleton, and if matrices_out is too small to fit matrices for all joints.
@@ -107,14 +179,47 @@ bool calculate_pose_transformations(const Skeleton& skeleton,
                                     const SkeletonPose& pose,
                                     std::span<glm::mat4> matrices_out);
 
+/** Sample an animation channel at the given time. Keys are found by binary search. Before the
+ * first key and after the last key, the value of that key is used.
+ */
 void animate_joint(const mesh_data::AnimationChannel& animation_channel,
                    double time_seconds,
                    JointPose& joint_pose_out);
 
+/** Sample all channels of an animation clip, at the given time wrapped to the clip's duration,
+ * into joint_poses_out, which must have one element per channel. The clip may be compressed.
+ */
+void sample_animation_clip(const mesh_data::AnimationClip& clip,
+                           double time_seconds,
+                           std::span<JointPose> joint_poses_out);
+
+/** Like the above, but starts the search for keys from, and updates, the given cursor. As long
+ * as the sample time moves forward by a few keys at most between calls, as it does during
+ * playback, finding the keys takes constant time regardless of the length of the clip.
+ */
+void sample_animation_clip(const mesh_data::AnimationClip& clip,
+                           double time_seconds,
+                           std::span<JointPose> joint_poses_out,
+                           AnimationCursor& cursor);
+
+/** Like the above, but only samples the channels of the given joints, leaving the poses of other
+ * joints unchanged. See `Skeleton::joints_up_to_depth`.
+ */
+void sample_animation_clip(const mesh_data::AnimationClip& clip,
+                           double time_seconds,
+                           std::span<JointPose> joint_poses_out,
+                           AnimationCursor& cursor,
+                           std::span<const mesh_data::JointId> joints);
+
 void animate_skeleton(const mesh_data::AnimationClip& clip,
                       SkeletonPose& pose,
                       double time_seconds);
 
+void animate_skeleton(const mesh_data::AnimationClip& clip,
+                      SkeletonPose& pose,
+                      double time_seconds,
+                      AnimationCursor& cursor);
+
 void blend_joint_poses(const JointPose& first,
                        const JointPose& second,
                        JointPose& result,
@@ -23,7 +23,8 @@ enum class VertexAttributeType : uint32_t {
     i32 = 0x1404,
     u32 = 0x1405,
     f32 = 0x1406,
-    f64 = 0x140A
+    f64 = 0x140A,
+    f16 = 0x140B
 };
 
 /** Interpretation of the value of vertex attributes integral type. */
@@ -12,6 +12,7 @@
 #include "mg/core/gfx/mg_bitmap_font.h"
 #include "mg/core/gfx/mg_ui_renderer.h"
 #include "mg/core/gfx/render_passes/mg_irender_pass.h"
+#include "mg/core/mg_linear_arena.h"
 
 #include <memory>
 
@@ -42,10 +43,13 @@ public:
 
     void render(const RenderParams& /*params*/) override
     {
+        m_text_scratch.reset();
+
         for (const auto& text_render_command : m_render_list->text_render_commands) {
             auto prepared_text =
                 text_render_command.font->prepare_text(text_render_command.text,
-                                                       text_render_command.typesetting);
+                                                       text_render_command.typesetting,
+                                                       m_text_scratch);
             m_renderer.draw_text(*m_target, text_render_command.placement, prepared_text);
         }
     }
@@ -54,6 +58,9 @@ private:
     std::shared_ptr<IRenderTarget> m_target;
     std::shared_ptr<UIRenderList> m_render_list;
     UIRenderer m_renderer;
+
+    // Temporary data for preparing texts, reused every frame.
+    LinearArena m_text_scratch;
 };
 
 
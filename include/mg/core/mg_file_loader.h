@@ -12,19 +12,30 @@
 
 #include "mg/core/containers/mg_array.h"
 #include "mg/core/mg_identifier.h"
+#include "mg/utils/mg_directory_watcher.h"
 #include "mg/utils/mg_macros.h"
+#include "mg/utils/mg_optional.h"
 
 #include <cstddef>
 #include <cstdint>
 #include <ctime>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
 #include <span>
 #include <string>
 #include <string_view>
+#include <utility>
+#include <vector>
 
 // Forward declaration of libzip struct
 struct zip;
 using zip_t = struct zip;
 
+namespace Mg::io {
+class MappedFile;
+} // namespace Mg::io
+
 namespace Mg {
 
 
@@ -34,7 +45,52 @@ struct FileRecord {
     std::time_t time_stamp{};
 };
 
-/** Interface for loading files from some source (e.g. directory, zip-archive, ...). */
+/** Changes to the set of files available in an IFileLoader, see `IFileLoader::changed_files()`. */
+struct FileListDelta {
+    /** Files that were added or whose time stamp changed. */
+    std::vector<FileRecord> added_or_modified;
+
+    /** Files that are no longer available. */
+    std::vector<Identifier> removed;
+};
+
+/** Read-only view of a file's data that shares ownership of the underlying storage (e.g. a memory
+ * mapping). Copies are cheap and refer to the same storage, which is released when the last copy is
+ * destroyed. This allows resources to refer to file data in place instead of copying it.
+ */
+class SharedFileData {
+public:
+    SharedFileData() = default;
+
+    explicit SharedFileData(std::span<const std::byte> bytes,
+                            std::shared_ptr<const void> storage) noexcept
+        : m_bytes(bytes), m_storage(std::move(storage))
+    {}
+
+    /** Take ownership of data in an array. */
+    static SharedFileData from_array(Array<std::byte> data)
+    {
+        auto storage = std::make_shared<const Array<std::byte>>(std::move(data));
+        return SharedFileData{ *storage, storage };
+    }
+
+    std::span<const std::byte> bytes() const noexcept { return m_bytes; }
+
+    /** View of a sub-range of the data, sharing ownership of the same storage. */
+    SharedFileData subview(size_t offset, size_t size) const noexcept
+    {
+        return SharedFileData{ m_bytes.subspan(offset, size), m_storage };
+    }
+
+private:
+    std::span<const std::byte> m_bytes;
+    std::shared_ptr<const void> m_storage;
+};
+
+/** Interface for loading files from some source (e.g. directory, zip-archive, ...).
+ * Implementations must be safe to use from multiple threads concurrently, since ResourceCache may
+ * load resources on several loading threads at once.
+ */
 class IFileLoader {
 public:
     MG_INTERFACE_BOILERPLATE(IFileLoader);
@@ -42,6 +98,13 @@ public:
     // TODO: TOCTOU?
     virtual Array<FileRecord> available_files() = 0;
 
+    /** Optional capability: get the changes to the set of available files since the most recent
+     * call to `available_files()` or `changed_files()`, without scanning all files. Returns nullopt
+     * if this loader cannot tell what has changed, in which case `available_files()` should be
+     * used instead.
+     */
+    virtual Opt<FileListDelta> changed_files() { return nullopt; }
+
     virtual bool file_exists(Identifier file) = 0;
 
     /** Returns file size in bytes of the file. */
@@ -53,19 +116,35 @@ public:
     /** Load file. Throws if file is not available. */
     virtual void load_file(Identifier file, std::span<std::byte> target_buffer) = 0;
 
+    /** Optional capability: get a read-only view of the file's data without copying it into a
+     * buffer, e.g. by memory-mapping the file. Returns nullopt if this loader does not support it
+     * (for the given file), in which case `load_file` should be used instead.
+     */
+    virtual Opt<SharedFileData> map_file(Identifier /* file */) { return nullopt; }
+
     /** Returns a human-readable identifier for this file loader, e.g. path of directory or name of
      * zip archive. Mainly intended for logging.
      */
     virtual std::string_view name() const = 0;
 };
 
-/** Loads files directly from directory. */
+/** Loads files directly from directory.
+ * Where supported (see io::DirectoryWatcher), the directory is watched for changes after the first
+ * call to `available_files()`, so that `changed_files()` can report changes without rescanning the
+ * whole directory.
+ *
+ * Files are always copied, never memory-mapped: the directory holds files that are being edited,
+ * and a mapping would keep them from being saved (on Windows) or would break when they are
+ * rewritten in place (on POSIX).
+ */
 class BasicFileLoader final : public IFileLoader {
 public:
     explicit BasicFileLoader(std::string_view directory) : m_directory(directory) {}
 
     Array<FileRecord> available_files() override;
 
+    Opt<FileListDelta> changed_files() override;
+
     bool file_exists(Identifier file) override;
 
     uintmax_t file_size(Identifier file) override;
@@ -77,20 +156,35 @@ public:
     std::string_view name() const override { return m_directory; }
 
 private:
+    // Get path to file, throwing if it is outside of m_directory.
+    std::string path_to_file(Identifier file) const;
+
     std::string m_directory;
+
+    // Watches m_directory for changes. Nullptr if not yet started, unsupported, or if the watcher
+    // could not keep track of changes, in which case a full rescan is needed.
+    std::unique_ptr<io::DirectoryWatcher> m_watcher;
+    std::mutex m_watcher_mutex;
 };
 
-/** Loads files from a zip archive. */
+/** Loads files from a zip archive.
+ * The archive's central directory is indexed by `available_files()`, after which file metadata is
+ * served from the index without accessing the archive. Files may be loaded from multiple threads
+ * concurrently; each concurrent load uses a separate archive handle.
+ */
 class ZipFileLoader final : public IFileLoader {
 public:
     explicit ZipFileLoader(std::string_view archive) : m_archive_name(archive) {}
-    ~ZipFileLoader() override { close_zip_archive(); }
+    ~ZipFileLoader() override;
 
     MG_MAKE_NON_COPYABLE(ZipFileLoader);
     MG_MAKE_NON_MOVABLE(ZipFileLoader);
 
     Array<FileRecord> available_files() override;
 
+    /** Reports no changes if the archive's time stamp is unchanged since it was last indexed. */
+    Opt<FileListDelta> changed_files() override;
+
     bool file_exists(Identifier file) override;
 
     uintmax_t file_size(Identifier file) override;
@@ -102,11 +196,144 @@ public:
     std::string_view name() const override { return m_archive_name; }
 
 private:
-    void open_zip_archive();
-    void close_zip_archive() noexcept;
+    struct IndexEntry {
+        Identifier filename{ "" };
+
+        // Hash of the lower-cased filename. Files are looked up by case-insensitive name, as with
+        // libzip's ZIP_FL_NOCASE.
+        uint32_t lookup_hash = 0;
+
+        uint64_t zip_index = 0;
+        uint64_t size = 0;
+        std::time_t time_stamp = -1;
+        uint16_t compression_method = 0;
+    };
+
+    // Archive handle reserved for one thread, returned to the loader when the lease is destroyed.
+    class HandleLease {
+    public:
+        HandleLease(ZipFileLoader& loader, zip_t* handle, uint32_t generation) noexcept
+            : m_loader(&loader), m_handle(handle), m_generation(generation)
+        {}
+
+        HandleLease(HandleLease&& rhs) noexcept
+            : m_loader(rhs.m_loader)
+            , m_handle(std::exchange(rhs.m_handle, nullptr))
+            , m_generation(rhs.m_generation)
+        {}
+
+        HandleLease& operator=(HandleLease&&) = delete;
+
+        MG_MAKE_NON_COPYABLE(HandleLease);
+
+        ~HandleLease()
+        {
+            if (m_handle) {
+                m_loader->release_handle(m_handle, m_generation);
+            }
+        }
+
+        zip_t* handle() const noexcept { return m_handle; }
+
+    private:
+        ZipFileLoader* m_loader;
+        zip_t* m_handle;
+        uint32_t m_generation;
+    };
+
+    // A file's index entry, and a handle to the same version of the archive.
+    struct FileLease {
+        IndexEntry entry;
+        HandleLease lease;
+    };
+
+    // Open a new handle to the archive. Throws on failure.
+    zip_t* open_zip_archive() const;
+
+    // Look up file in index, and get an archive handle that is not in use by any other thread.
+    // Throws if the file does not exist.
+    FileLease lease_file(Identifier file);
+    void release_handle(zip_t* handle, uint32_t generation) noexcept;
+
+    // Look up file in index by case-insensitive name. Requires that the index has been built, and
+    // that m_index_mutex is locked.
+    const IndexEntry* find_in_index(Identifier file) const;
+
+    // Look up file in index, building the index if that has not yet been done.
+    Opt<IndexEntry> find_index_entry(Identifier file);
+
+    // As above, but throws if the file does not exist.
+    IndexEntry index_entry(Identifier file);
 
     std::string m_archive_name;
-    zip_t* m_archive_file = nullptr;
+
+    // Index of files in the archive, sorted by lookup_hash.
+    std::vector<IndexEntry> m_index;
+    bool m_has_index = false;
+    std::time_t m_indexed_archive_time_stamp = -1;
+    std::shared_mutex m_index_mutex;
+
+    // Archive handles not currently in use.
+    std::vector<zip_t*> m_free_handles;
+
+    // Incremented whenever the archive is re-indexed. Handles opened for an earlier version of the
+    // archive are closed instead of reused. Written while holding both m_index_mutex and
+    // m_handles_mutex, so that it can be read together with the index.
+    uint32_t m_handles_generation = 0;
+
+    // Locked after m_index_mutex, when both are needed.
+    std::mutex m_handles_mutex;
+};
+
+/** Loads files from an Mg pack file (see mg_pack_file_data.h), as created by the pack tool.
+ * The pack file is memory-mapped by `available_files()`; lookups are binary searches in the pack's
+ * sorted entry table, and uncompressed files are served by `map_file` without copying.
+ */
+class PackFileLoader final : public IFileLoader {
+public:
+    explicit PackFileLoader(std::string_view pack_file) : m_pack_file_name(pack_file) {}
+
+    Array<FileRecord> available_files() override;
+
+    /** Reports no changes if the pack file's time stamp is unchanged since it was last mapped. */
+    Opt<FileListDelta> changed_files() override;
+
+    bool file_exists(Identifier file) override;
+
+    uintmax_t file_size(Identifier file) override;
+
+    std::time_t file_time_stamp(Identifier file) override;
+
+    void load_file(Identifier file, std::span<std::byte> target_buffer) override;
+
+    /** Returns view of the file's data within the mapped pack file, if it is stored uncompressed.
+     */
+    Opt<SharedFileData> map_file(Identifier file) override;
+
+    std::string_view name() const override { return m_pack_file_name; }
+
+private:
+    struct Location {
+        std::shared_ptr<const io::MappedFile> pack;
+        size_t entry_index;
+    };
+
+    // Map the pack file and validate its header and entry table. Throws on failure.
+    std::shared_ptr<const io::MappedFile> open_pack_file() const;
+
+    // Look up file in the pack, mapping the pack if that has not yet been done.
+    Opt<Location> find_entry(Identifier file);
+
+    // As above, but throws if the file does not exist.
+    Location entry_location(Identifier file);
+
+    std::string m_pack_file_name;
+
+    // Currently mapped version of the pack file. Replaced when `available_files()` is called; the
+    // old mapping stays alive for as long as any SharedFileData refers to it.
+    std::shared_ptr<const io::MappedFile> m_pack;
+    std::time_t m_pack_time_stamp = -1;
+    std::shared_mutex m_pack_mutex;
 };
 
 } // namespace Mg
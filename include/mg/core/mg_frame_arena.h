@@ -0,0 +1,97 @@
+//**************************************************************************************************
+// This file is part of Mg Engine. Copyright (c) 2026, Magnus Bergsten.
+// Mg Engine is made available under the terms of the 3-Clause BSD License.
+// See LICENSE.txt in the project's root directory.
+//**************************************************************************************************
+
+/** @file mg_frame_arena.h
+ * Per-thread, double-buffered arenas for per-frame transient data.
+ */
+
+#pragma once
+
+#include "mg/core/containers/mg_flat_map.h"
+#include "mg/core/mg_linear_arena.h"
+#include "mg/utils/mg_macros.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace Mg {
+
+/** Memory usage of a FrameArena during a frame, summed over all threads. */
+struct FrameArenaStats {
+    /** Number of bytes allocated during the frame. */
+    size_t bytes_allocated = 0;
+
+    /** Largest number of bytes allocated during any frame so far. */
+    size_t high_water_mark = 0;
+
+    /** Total size of all arenas' blocks. */
+    size_t capacity = 0;
+
+    /** Number of blocks allocated from the heap during the frame. Zero in a steady state. */
+    size_t num_block_allocations = 0;
+};
+
+/** FrameArena provides each thread with a LinearArena for transient data that only needs to live
+ * until the end of the next frame, e.g. data produced in one frame and consumed in the next.
+ * Allocating from it is as cheap as bumping a pointer, and once the arenas have grown to hold a
+ * typical frame's data, a frame does not allocate from the heap at all.
+ *
+ * Each thread has two arenas, used in alternating frames; `next_frame` resets the arenas that
+ * were used the frame before the current one, and switches to those.
+ */
+class FrameArena {
+public:
+    /** Construct a new FrameArena. No memory is allocated until the first allocation.
+     * @param block_size Block size of each thread's LinearArenas.
+     */
+    explicit FrameArena(size_t block_size = LinearArena::k_default_block_size);
+    ~FrameArena();
+
+    MG_MAKE_NON_COPYABLE(FrameArena);
+    MG_MAKE_NON_MOVABLE(FrameArena);
+
+    /** Get the calling thread's arena for the current frame. Allocations from it remain valid
+     * until `next_frame` has been called twice. Thread-safe.
+     */
+    LinearArena& local();
+
+    /** Finish the current frame and start the next one, invalidating the allocations made during
+     * the previous frame. Must not be called while other threads use this FrameArena.
+     */
+    void next_frame();
+
+    /** Memory usage during the most recently finished frame. */
+    const FrameArenaStats& last_frame_stats() const noexcept { return m_last_frame_stats; }
+
+    /** Number of finished frames. */
+    uint64_t frame_count() const noexcept { return m_frame_count; }
+
+private:
+    struct ThreadArenas {
+        explicit ThreadArenas(size_t block_size) : arenas{ LinearArena{ block_size },
+                                                           LinearArena{ block_size } }
+        {}
+
+        std::array<LinearArena, 2> arenas;
+    };
+
+    // Identifies this instance in threads' cached look-ups of `local`.
+    uint64_t m_id = 0;
+
+    size_t m_block_size = 0;
+    uint64_t m_frame_count = 0;
+
+    FlatMap<std::thread::id, std::unique_ptr<ThreadArenas>> m_thread_arenas;
+    std::mutex m_mutex;
+
+    FrameArenaStats m_last_frame_stats;
+};
+
+} // namespace Mg
@@ -0,0 +1,293 @@
+//**************************************************************************************************
+// This file is part of Mg Engine. Copyright (c) 2026, Magnus Bergsten.
+// Mg Engine is made available under the terms of the 3-Clause BSD License.
+// See LICENSE.txt in the project's root directory.
+//**************************************************************************************************
+
+/** @file mg_job_system.h
+ * Work-stealing job system.
+ */
+
+#pragma once
+
+#include "mg/utils/mg_impl_ptr.h"
+#include "mg/utils/mg_macros.h"
+
+#include <algorithm>
+#include <atomic>
+#include <concepts>
+#include <cstddef>
+#include <cstring>
+#include <future>
+#include <memory>
+#include <new>
+#include <ranges>
+#include <span>
+#include <type_traits>
+#include <utility>
+
+namespace Mg {
+
+class JobSystem;
+
+/** Counts unfinished jobs. Pass to `JobSystem::add_job` and wait for the jobs using
+ * `JobSystem::wait`. A job may add further (child) jobs using the same counter; since the child
+ * is counted before the parent finishes, waiting for the counter waits for the children as well.
+ */
+class JobCounter {
+public:
+    JobCounter() = default;
+
+    MG_MAKE_NON_COPYABLE(JobCounter);
+    MG_MAKE_NON_MOVABLE(JobCounter);
+
+    /** Whether all jobs added with this counter have finished. */
+    bool is_done() const noexcept { return m_num_unfinished.load(std::memory_order_acquire) == 0; }
+
+private:
+    friend class JobSystem;
+    std::atomic_size_t m_num_unfinished = 0;
+};
+
+namespace detail {
+
+/** A job as stored by the JobSystem. Small callables are stored inline, larger ones on the heap.
+ */
+struct alignas(64) Job {
+    static constexpr size_t k_inline_storage_size = 96;
+
+    using InvokeFunction = void (*)(Job&) noexcept;
+
+    // Invokes and then destroys the callable.
+    InvokeFunction invoke = nullptr;
+
+    JobCounter* counter = nullptr;
+
+    // Pooled jobs are marked as in use from allocation until executed.
+    std::atomic_bool is_in_use = false;
+    bool is_heap_allocated = false;
+
+    alignas(std::max_align_t) std::byte storage[k_inline_storage_size];
+};
+
+static_assert(sizeof(Job) == 128);
+
+} // namespace detail
+
+/** Runs jobs on a set of worker threads. Each worker has its own lock-free job queue; idle workers
+ * steal jobs from the others. Threads waiting for jobs to finish (see `wait`) execute pending jobs
+ * while waiting.
+ *
+ * The thread that constructs the JobSystem also gets a job queue. Jobs added from other
+ * (non-worker) threads go through a shared, locked queue.
+ *
+ * Jobs must not throw exceptions, except those added with the `add_job` overload returning a
+ * std::future, where the exception is stored in the future.
+ */
+class JobSystem {
+public:
+    /** Construct a new JobSystem
+     * @param num_worker_threads How many worker threads to create. May be zero, in which case all
+     * jobs are executed by threads waiting for them.
+     */
+    explicit JobSystem(size_t num_worker_threads);
+
+    /** All jobs, including jobs added by running jobs, are finished before destruction. */
+    ~JobSystem();
+
+    MG_MAKE_NON_COPYABLE(JobSystem);
+    MG_MAKE_NON_MOVABLE(JobSystem);
+
+    /** Get the number of worker threads in this JobSystem. */
+    size_t num_worker_threads() const noexcept;
+
+    /** Add function (object) as job. `counter` is incremented now and decremented when the job has
+     * finished.
+     * @remark: To pass arguments into the function, write a lambda as the job and capture the
+     * arguments. Make sure to by-value-capture arguments with short lifetimes!
+     */
+    void add_job(std::invocable auto job, JobCounter& counter)
+    {
+        enqueue_job(std::move(job), &counter);
+    }
+
+    /** Add function (object) as job.
+     * @return std::future for the return value of the function.
+     */
+    [[nodiscard]] auto add_job(std::invocable auto job)
+        -> std::future<std::invoke_result_t<decltype(job)>>;
+
+    /** Add function (object) as job, without a way to wait for its completion. */
+    void add_job_fire_and_forget(std::invocable auto job) { enqueue_job(std::move(job), nullptr); }
+
+    /** Wait until all jobs added with `counter` have finished. Executes pending jobs while waiting.
+     */
+    void wait(const JobCounter& counter);
+
+    /** Count `num` units of work in `counter` that are not jobs, for example work that will be
+     * added as jobs later. Each unit must be finished with `release`.
+     */
+    void retain(JobCounter& counter, size_t num = 1) noexcept;
+
+    /** Finish a unit of work counted with `retain`, waking threads waiting for `counter` if it is
+     * done.
+     */
+    void release(JobCounter& counter) noexcept;
+
+    /** Invoke `function(begin, end)` on sub-ranges covering [0, num_elems), in parallel, and wait
+     * for completion. The range is split into halves on demand, when other threads are available
+     * to take work, down to `min_elems_per_job`. If `min_elems_per_job` is 0, it is chosen based
+     * on the number of elements and threads.
+     */
+    void parallel_for_ranges(size_t num_elems,
+                             size_t min_elems_per_job,
+                             const std::invocable<size_t, size_t> auto& function);
+
+    /** Invoke function on all elements in range, in parallel, and wait for completion. */
+    void parallel_for(std::ranges::contiguous_range auto& range, const auto& function)
+    {
+        parallel_for(range, 0, function);
+    }
+
+    /** Invoke function on all elements in range, in parallel, and wait for completion. Each job
+     * handles at least `min_elems_per_job` elements (except possibly the last).
+     */
+    void parallel_for(std::ranges::contiguous_range auto& range,
+                      size_t min_elems_per_job,
+                      const auto& function);
+
+private:
+    // Get a job from the calling thread's pool, or nullptr if none is available.
+    detail::Job* try_allocate_pooled_job() noexcept;
+
+    // Add allocated job with callable in place to the calling thread's queue.
+    void push_job(detail::Job& job, JobCounter* counter);
+
+    // Whether the calling thread's queue has jobs which other threads could take.
+    bool has_queued_jobs() const noexcept;
+
+    size_t auto_elems_per_job(size_t num_elems) const noexcept;
+
+    template<typename F> void enqueue_job(F&& function, JobCounter* counter);
+
+    template<typename F>
+    void split_and_run(size_t begin,
+                       size_t end,
+                       size_t min_elems_per_job,
+                       const F& function,
+                       JobCounter& counter);
+
+    struct Impl;
+    ImplPtr<Impl> m_impl;
+};
+
+//--------------------------------------------------------------------------------------------------
+// JobSystem implementation
+//--------------------------------------------------------------------------------------------------
+
+template<typename F> void JobSystem::enqueue_job(F&& function, JobCounter* counter)
+{
+    using FunctionT = std::decay_t<F>;
+    using detail::Job;
+
+    Job* job = try_allocate_pooled_job();
+    if (!job) {
+        job = new Job;
+        job->is_heap_allocated = true;
+    }
+
+    constexpr bool fits_inline = sizeof(FunctionT) <= Job::k_inline_storage_size &&
+                                 alignof(FunctionT) <= alignof(std::max_align_t);
+
+    if constexpr (fits_inline) {
+        new (job->storage) FunctionT(std::forward<F>(function));
+        job->invoke = [](Job& j) noexcept {
+            FunctionT& stored = *std::launder(reinterpret_cast<FunctionT*>(j.storage));
+            stored();
+            stored.~FunctionT();
+        };
+    }
+    else {
+        auto* stored = new FunctionT(std::forward<F>(function));
+        std::memcpy(job->storage, &stored, sizeof(stored));
+        job->invoke = [](Job& j) noexcept {
+            FunctionT* ptr = nullptr;
+            std::memcpy(&ptr, j.storage, sizeof(ptr));
+            std::unique_ptr<FunctionT> owner{ ptr };
+            (*owner)();
+        };
+    }
+
+    push_job(*job, counter);
+}
+
+auto JobSystem::add_job(std::invocable auto job) -> std::future<std::invoke_result_t<decltype(job)>>
+{
+    using JobReturnT = std::invoke_result_t<decltype(job)>;
+
+    auto packaged_task = std::packaged_task<JobReturnT()>(std::move(job));
+    std::future<JobReturnT> ret_val = packaged_task.get_future();
+    enqueue_job([task = std::move(packaged_task)]() mutable { task(); }, nullptr);
+    return ret_val;
+}
+
+template<typename F>
+void JobSystem::split_and_run(const size_t begin,
+                              const size_t end,
+                              const size_t min_elems_per_job,
+                              const F& function,
+                              JobCounter& counter)
+{
+    // Lazy binary splitting: process the range in chunks of min_elems_per_job, handing off the
+    // upper half of the remainder whenever this thread has no queued work left for others to
+    // steal. This way, the number of jobs adapts to how busy the other threads are.
+    size_t first = begin;
+    size_t last = end;
+
+    while (first < last) {
+        if (last - first > 2 * min_elems_per_job && !has_queued_jobs()) {
+            const size_t middle = first + (last - first) / 2;
+            add_job([this, middle, last, min_elems_per_job, &function, &counter] {
+                split_and_run(middle, last, min_elems_per_job, function, counter);
+            },
+                    counter);
+            last = middle;
+            continue;
+        }
+
+        const size_t chunk_end = std::min(last, first + min_elems_per_job);
+        function(first, chunk_end);
+        first = chunk_end;
+    }
+}
+
+void JobSystem::parallel_for_ranges(const size_t num_elems,
+                                    size_t min_elems_per_job,
+                                    const std::invocable<size_t, size_t> auto& function)
+{
+    if (num_elems == 0) {
+        return;
+    }
+
+    if (min_elems_per_job == 0) {
+        min_elems_per_job = auto_elems_per_job(num_elems);
+    }
+
+    JobCounter counter;
+    split_and_run(0, num_elems, min_elems_per_job, function, counter);
+    wait(counter);
+}
+
+void JobSystem::parallel_for(std::ranges::contiguous_range auto& range,
+                             const size_t min_elems_per_job,
+                             const auto& function)
+{
+    const auto span = std::span(range);
+    parallel_for_ranges(span.size(), min_elems_per_job, [&span, &function](size_t b, size_t e) {
+        for (auto&& v : span.subspan(b, e - b)) {
+            function(v);
+        }
+    });
+}
+
+} // namespace Mg
@@ -0,0 +1,139 @@
+//**************************************************************************************************
+// This file is part of Mg Engine. Copyright (c) 2026, Magnus Bergsten.
+// Mg Engine is made available under the terms of the 3-Clause BSD License.
+// See LICENSE.txt in the project's root directory.
+//**************************************************************************************************
+
+/** @file mg_linear_arena.h
+ * Linear (bump) allocator for short-lived data.
+ */
+
+#pragma once
+
+#include "mg/utils/mg_macros.h"
+#include "mg/utils/mg_math_utils.h"
+
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace Mg {
+
+/** LinearArena hands out memory by bumping an offset into large blocks. Individual allocations
+ * cannot be freed; instead, `reset` makes all of the arena's memory available again at once. The
+ * blocks are kept across resets, so that an arena which is reset regularly (e.g. once per frame)
+ * stops allocating once it has grown to its working size.
+ *
+ * The arena never calls destructors: objects created in it must either be trivially destructible
+ * or be destroyed explicitly before the arena is reset.
+ *
+ * Not thread-safe.
+ */
+class LinearArena {
+public:
+    static constexpr size_t k_default_block_size = 64 * 1024;
+
+    /** Construct a new LinearArena. No memory is allocated until the first allocation.
+     * @param block_size Size of each block. Allocations larger than this get a block of their own.
+     */
+    explicit LinearArena(size_t block_size = k_default_block_size) : m_block_size{ block_size } {}
+
+    MG_MAKE_NON_COPYABLE(LinearArena);
+    MG_MAKE_DEFAULT_MOVABLE(LinearArena);
+
+    ~LinearArena() = default;
+
+    /** Allocate `size` bytes with the given alignment, which must be a power of two. */
+    [[nodiscard]] void* allocate(size_t size, size_t alignment);
+
+    /** Allocate and construct an object of type T. */
+    template<typename T, typename... Args> [[nodiscard]] T* create(Args&&... args)
+    {
+        void* memory = allocate(sizeof(T), alignof(T));
+        return new (memory) T(std::forward<Args>(args)...);
+    }
+
+    /** Make all memory available again, invalidating all allocations. Keeps the blocks. */
+    void reset() noexcept;
+
+    /** Release all blocks, invalidating all allocations. */
+    void release() noexcept;
+
+    /** Number of bytes allocated since the last reset, including alignment padding. */
+    size_t bytes_allocated() const noexcept { return m_bytes_allocated; }
+
+    /** Largest `bytes_allocated()` reached since construction or the last release. */
+    size_t high_water_mark() const noexcept { return max(m_high_water_mark, m_bytes_allocated); }
+
+    /** Number of blocks allocated from the heap since the last reset. Zero once the arena has
+     * grown to its working size.
+     */
+    size_t num_block_allocations() const noexcept { return m_num_block_allocations; }
+
+    /** Total size of the blocks owned by the arena. */
+    size_t capacity() const noexcept;
+
+private:
+    struct Block {
+        std::unique_ptr<std::byte[]> data;
+        size_t size = 0;
+    };
+
+    std::vector<Block> m_blocks;
+
+    // Block currently being allocated from, and the offset of its first free byte.
+    size_t m_current_block = 0;
+    size_t m_offset = 0;
+
+    size_t m_bytes_allocated = 0;
+    size_t m_high_water_mark = 0;
+    size_t m_num_block_allocations = 0;
+    size_t m_block_size = 0;
+};
+
+/** Standard-library-compatible allocator that allocates from a LinearArena, for containers of
+ * short-lived data, e.g. `ArenaVector` or `Slot_map<T, ArenaAllocator<T>>`. Deallocation is a
+ * no-op: memory is only reclaimed when the arena is reset, so a container that grows repeatedly
+ * leaves its old buffers unused in the arena. Reserve up-front where possible.
+ *
+ * The arena must outlive the containers using it, and must not be reset while they are in use.
+ */
+template<typename T> class ArenaAllocator {
+public:
+    using value_type = T;
+
+    explicit ArenaAllocator(LinearArena& arena) noexcept : m_arena{ &arena } {}
+
+    template<typename U>
+    ArenaAllocator(const ArenaAllocator<U>& rhs) noexcept // NOLINT(google-explicit-constructor)
+        : m_arena{ &rhs.arena() }
+    {}
+
+    [[nodiscard]] T* allocate(size_t n)
+    {
+        if (n > std::numeric_limits<size_t>::max() / sizeof(T)) {
+            throw std::bad_array_new_length();
+        }
+        return static_cast<T*>(m_arena->allocate(n * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T* /* p */, size_t /* n */) noexcept {}
+
+    LinearArena& arena() const noexcept { return *m_arena; }
+
+    template<typename U> friend bool operator==(const ArenaAllocator& l, const ArenaAllocator<U>& r)
+    {
+        return &l.arena() == &r.arena();
+    }
+
+private:
+    LinearArena* m_arena;
+};
+
+/** std::vector allocating from a LinearArena. */
+template<typename T> using ArenaVector = std::vector<T, ArenaAllocator<T>>;
+
+} // namespace Mg
@@ -0,0 +1,64 @@
+//**************************************************************************************************
+// This file is part of Mg Engine. Copyright (c) 2026, Magnus Bergsten.
+// Mg Engine is made available under the terms of the 3-Clause BSD License.
+// See LICENSE.txt in the project's root directory.
+//**************************************************************************************************
+
+/** @file mg_pack_file_data.h
+ * Data definitions for the Mg pack file format, an archive format for resource files.
+ * @see Mg::PackFileLoader
+ */
+
+#pragma once
+
+#include "mg/utils/mg_fourcc.h"
+
+#include <cstdint>
+
+/** Data structure definitions and constants for the Mg pack file format.
+ *
+ * Layout: a Header, followed by `num_entries` Entry records sorted by `name_hash`, followed by a
+ * buffer of file names, followed by the files' data. Each file's data begins at an offset aligned
+ * to `data_alignment` (or `large_data_alignment` for large files, so that they can be mapped
+ * page-by-page), so that resource types can parse data in place.
+ *
+ * All values are little-endian.
+ */
+namespace Mg::PackFileData {
+
+inline constexpr uint32_t fourcc = make_fourcc("MGPK");
+inline constexpr uint32_t version = 1; // Current version of the file format.
+
+inline constexpr uint64_t data_alignment = 16;
+inline constexpr uint64_t large_data_alignment = 4096;
+inline constexpr uint64_t large_data_threshold = 64 * 1024;
+
+enum class Compression : uint32_t {
+    none = 0,
+    lz4 = 1, // LZ4 block format, see mg_lz4.h
+};
+
+struct Header {
+    uint32_t four_cc;
+    uint32_t version;
+    uint64_t num_entries;
+    uint64_t names_offset; // Offset to buffer of file names (not zero-terminated).
+    uint64_t names_size;
+};
+
+struct Entry {
+    // Hash of the file name, as given by hash_fnv1a (i.e. same as Mg::Identifier::hash()). Names
+    // are stored as well, to disambiguate hash collisions.
+    uint32_t name_hash;
+    uint32_t name_length;
+    uint64_t name_offset; // Relative to Header::names_offset.
+
+    uint64_t data_offset;  // Relative to start of file.
+    uint64_t stored_size;  // Size of data in the pack file.
+    uint64_t size;         // Size of the file after decompression.
+    int64_t time_stamp;    // Last-modified time of the original file, as time_t.
+    Compression compression;
+    uint32_t reserved;
+};
+
+} // namespace Mg::PackFileData
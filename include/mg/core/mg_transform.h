@@ -20,6 +20,11 @@
 
 #include "mg/core/mg_rotation.h"
 
+#include <array>
+#include <cstddef>
+#include <span>
+#include <vector>
+
 namespace Mg {
 
 class Transform {
@@ -40,6 +45,24 @@ public:
         return glm::translate(position) * rotation.to_matrix() * glm::scale(scale);
     }
 
+    /** Decompose a matrix into position, scale, and rotation. Assumes that the matrix has no
+     * shearing, projection, or negative scale.
+     */
+    static Transform from_matrix(const glm::mat4& matrix) noexcept;
+
+    /** Interpolate between two transforms. Unlike interpolating matrices, this preserves scale.
+     * Rotations are interpolated along the shortest path, using normalized linear interpolation,
+     * which for the small differences between consecutive simulation steps is indistinguishable
+     * from spherical linear interpolation.
+     */
+    static Transform mix(const Transform& from, const Transform& to, float x) noexcept;
+
+    friend bool operator==(const Transform& l, const Transform& r) noexcept
+    {
+        return l.position == r.position && l.scale == r.scale &&
+               l.rotation.to_quaternion() == r.rotation.to_quaternion();
+    }
+
     /** Sets the rotation so the forward vector faces target. */
     void look_at(glm::vec3 target, glm::vec3 up = world_vector::up) const
     {
@@ -47,4 +70,53 @@ public:
     }
 };
 
+/** Batch of pairs of transforms to interpolate between, stored as structure-of-arrays in blocks
+ * of `k_block_size` elements, so that `interpolate` can process a whole block with SIMD
+ * instructions. Produces the same results as `Transform::mix(from, to, x).matrix()`, up to
+ * rounding.
+ *
+ * Keep the batch around and `clear` it between uses, so that it does not reallocate.
+ */
+class TransformInterpolationBatch {
+public:
+    static constexpr size_t k_block_size = 8;
+
+    /** Add a pair of transforms to interpolate between. */
+    void push_back(const Transform& from, const Transform& to);
+
+    /** Interpolate each pair of transforms by x and write the resulting matrices, in the order in
+     * which the pairs were added, to `matrices_out`, which must have room for `size()` matrices.
+     */
+    void interpolate(float x, std::span<glm::mat4> matrices_out) const noexcept;
+
+    void clear() noexcept
+    {
+        m_blocks.clear();
+        m_size = 0;
+    }
+
+    void reserve(size_t size) { m_blocks.reserve((size + k_block_size - 1) / k_block_size); }
+
+    size_t size() const noexcept { return m_size; }
+
+    bool empty() const noexcept { return m_size == 0; }
+
+private:
+    using Lanes = std::array<float, k_block_size>;
+
+    // Channels of k_block_size transform pairs: x, y, z of positions and scales, and x, y, z, w of
+    // rotation quaternions.
+    struct Block {
+        std::array<Lanes, 3> from_position;
+        std::array<Lanes, 3> to_position;
+        std::array<Lanes, 4> from_rotation;
+        std::array<Lanes, 4> to_rotation;
+        std::array<Lanes, 3> from_scale;
+        std::array<Lanes, 3> to_scale;
+    };
+
+    std::vector<Block> m_blocks;
+    size_t m_size = 0;
+};
+
 } // namespace Mg
@@ -79,6 +79,11 @@ public:
 
     float mass() const;
 
+    /** Whether the body is being simulated. The simulation deactivates (puts to sleep) bodies that
+     * have come to rest, until they are disturbed, e.g. by a collision or an applied force.
+     */
+    bool is_active() const;
+
     /** Get the linear velocity (in metres/second) for this DynamicBody. */
     glm::vec3 velocity() const;
 
@@ -35,17 +35,11 @@ public:
     ResT& get_resource() override { return m_resource.value(); }
     const ResT& get_resource() const override { return m_resource.value(); }
 
-    void unload() override
-    {
-        MG_ASSERT(ref_count == 0);
-        dependencies.clear();
-        m_resource.reset();
-    }
-
     bool is_loaded() const override { return m_resource.has_value(); }
 
 protected:
     ResT& create_resource() override { return m_resource.emplace(resource_id()); }
+    void destroy_resource() override { m_resource.reset(); }
 
 private:
     Opt<ResT> m_resource;
@@ -18,6 +18,9 @@
 #include "mg/utils/mg_macros.h"
 
 #include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
 #include <ctime>
 #include <shared_mutex>
 #include <vector>
@@ -52,14 +55,32 @@ public:
     virtual BaseResource& get_resource() = 0;
     virtual const BaseResource& get_resource() const = 0;
 
-    /** Load the resource. */
+    /** Load the resource. If loading fails, the resource is left unloaded.
+     * Precondition: caller holds a unique lock on `mutex` and the resource is not loaded.
+     */
     void load_resource();
 
+    /** Load the resource unless it is already loaded. Locks `mutex` as needed, so it is safe to
+     * call concurrently from multiple threads; if another thread is loading the resource, this
+     * blocks until that load is complete.
+     */
+    void ensure_loaded();
+
     /** Whether resource is loaded. */
     virtual bool is_loaded() const = 0;
 
-    /** Unload stored resource. */
-    virtual void unload() = 0;
+    /** Unload stored resource.
+     * Precondition: caller holds a unique lock on `mutex` and ref_count is zero.
+     */
+    void unload();
+
+    /** Update access time and least-recently-used order in the owning cache. */
+    void mark_accessed();
+
+    /** Approximate memory used by the loaded resource, see `BaseResource::resident_size_bytes`.
+     * Zero if not loaded.
+     */
+    size_t resident_size_bytes() const noexcept { return m_resident_size_bytes; }
 
     Identifier resource_id() const noexcept { return m_resource_id; }
 
@@ -76,6 +97,14 @@ public:
         return m_resource_type_id;
     }
 
+    /** Whether the resource has been loaded at least once (i.e. whether `resource_type_id()` may be
+     * called). Safe to call without holding `mutex`.
+     */
+    bool has_been_loaded() const noexcept
+    {
+        return m_has_been_loaded.load(std::memory_order_acquire);
+    }
+
     std::time_t time_stamp() const noexcept { return m_time_stamp; }
 
     ResourceCache& owning_cache() const noexcept { return *m_p_owning_cache; }
@@ -90,15 +119,48 @@ public:
     /** A list of resource files upon which this resource depends. This is used to trigger
      * re-loading of this resource if those files are changed. Dependencies are automatically
      * tracked when a dependency is loaded in a resource type's `load_resource()` function via
-     * `ResourceLoadingInput::load_dependency()`.
+     * `ResourceLoadingInput::load_dependency()` or `ResourceLoadingInput::request_dependency()`.
      */
     std::vector<Dependency> dependencies;
 
+    /** Time of most recent load or access. Written under the owning cache's LRU lock. */
     std::time_t last_access{};
 
     mutable std::shared_timed_mutex mutex;
     std::atomic_uint32_t ref_count{};
 
+    /** Usage counters, see `ResourceCache::statistics()`. Updated using relaxed atomic operations,
+     * so that collecting them is cheap enough to always be enabled.
+     */
+    struct Counters {
+        std::atomic_uint64_t num_hits{};
+        std::atomic_uint64_t num_misses{};
+        std::atomic_uint64_t num_loads{};
+        std::atomic_uint64_t bytes_read{};
+        std::atomic_int64_t io_time_ns{};
+        std::atomic_int64_t load_time_ns{};
+        std::atomic_int64_t lock_wait_time_ns{};
+    };
+    Counters counters;
+
+    /** Acquire the given lock (std::unique_lock or std::shared_lock on `mutex`), adding any time
+     * spent waiting for it to `counters.lock_wait_time_ns`. The clock is only read if the lock is
+     * contended.
+     */
+    template<typename LockT> void lock_counting_wait(LockT& lock)
+    {
+        if (lock.try_lock()) {
+            return;
+        }
+
+        const auto start = std::chrono::steady_clock::now();
+        lock.lock();
+        const auto wait_time = std::chrono::steady_clock::now() - start;
+        counters.lock_wait_time_ns.fetch_add(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(wait_time).count(),
+            std::memory_order_relaxed);
+    }
+
 protected:
     IFileLoader* m_p_loader = nullptr;
     ResourceCache* m_p_owning_cache = nullptr;
@@ -106,10 +168,22 @@ protected:
     Identifier m_resource_type_id = "<unset>";
     std::time_t m_time_stamp{};
 
-    // Has the resource ever been loaded? (Only required for sanity checking.)
-    bool m_has_been_loaded = false;
+    // Has the resource ever been loaded? Set (once) after m_resource_type_id, so that statistics
+    // can read the type without locking.
+    std::atomic_bool m_has_been_loaded = false;
+
+    size_t m_resident_size_bytes = 0;
 
     virtual BaseResource& create_resource() = 0;
+    virtual void destroy_resource() = 0;
+
+private:
+    friend class ResourceCache;
+
+    // Intrusive links in the owning cache's least-recently-used list of loaded resources.
+    // Guarded by the owning cache's LRU mutex.
+    ResourceEntryBase* m_lru_prev = nullptr;
+    ResourceEntryBase* m_lru_next = nullptr;
 };
 
 } // namespace Mg
@@ -12,6 +12,7 @@
 
 #include "mg/core/mg_identifier.h"
 #include "mg/utils/mg_macros.h"
+#include "mg/utils/mg_optional.h"
 
 #include <string>
 #include <string_view>
@@ -61,6 +62,11 @@ public:
      */
     virtual Identifier type_id() const = 0;
 
+    /** Approximate amount of memory used by this resource, in bytes. Used by ResourceCache to keep
+     * within its memory budget. If nullopt, the size of the resource file is used as estimate.
+     */
+    virtual Opt<size_t> resident_size_bytes() const noexcept { return nullopt; }
+
     /** Resource identifier (filename, if loaded from file). */
     Identifier resource_id() const noexcept { return m_id; }
 
@@ -16,6 +16,9 @@
 #include "mg/core/resource_cache/mg_resource_handle.h"
 #include "mg/utils/mg_macros.h"
 
+#include <mutex>
+#include <shared_mutex>
+
 namespace Mg {
 
 /** Reference-counting access to a resource within a ResourceCache.
@@ -33,17 +36,28 @@ namespace Mg {
  *
  * As long as at least one ResourceAccessGuard to a given resource exist, then that resource will
  * not be unloaded from the ResourceCache.
+ *
+ * If the resource is not loaded, then constructing a ResourceAccessGuard loads it on the calling
+ * thread (or waits for a load already in progress, see `ResourceCache::request_load`).
  * @see Mg::ResourceCache
  */
 template<typename ResT> class ResourceAccessGuard {
 public:
     [[nodiscard]] explicit ResourceAccessGuard(BaseResourceHandle handle)
-        : m_entry(handle.m_p_entry), m_lock(handle.m_p_entry->mutex)
+        : m_entry(handle.m_p_entry), m_lock(handle.m_p_entry->mutex, std::defer_lock)
     {
-        if (!m_entry->is_loaded()) {
-            m_entry->load_resource();
+        // Loading requires a unique lock, so load first and then acquire the shared lock. The
+        // resource may be unloaded by another thread in between, in which case we try again.
+        for (;;) {
+            m_entry->ensure_loaded();
+            m_entry->lock_counting_wait(m_lock);
+            if (m_entry->is_loaded()) {
+                break;
+            }
+            m_lock.unlock();
         }
-        m_entry->last_access = std::time(nullptr);
+
+        m_entry->mark_accessed();
         ++m_entry->ref_count;
 
         MG_ASSERT(
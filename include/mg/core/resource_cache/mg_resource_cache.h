@@ -15,18 +15,27 @@
 #include "mg/core/mg_identifier.h"
 #include "mg/core/resource_cache/internal/mg_resource_entry.h"
 #include "mg/core/resource_cache/mg_resource_access_guard.h"
+#include "mg/core/resource_cache/mg_resource_cache_statistics.h"
 #include "mg/core/resource_cache/mg_resource_handle.h"
+#include "mg/core/resource_cache/mg_resource_load_request.h"
 #include "mg/core/resources/mg_file_changed_event.h"
 #include "mg/utils/mg_macros.h"
 
 #include <algorithm>
+#include <atomic>
+#include <future>
+#include <limits>
 #include <memory>
 #include <mutex>
 #include <shared_mutex>
+#include <span>
+#include <unordered_map>
 #include <vector>
 
 namespace Mg {
 
+class JobSystem;
+
 /** ResourceCache is an efficient and flexible way of loading and using resources.
  * It works with both file-system directories and zip archives via file loaders (see IFileLoader).
  *
@@ -43,7 +52,18 @@ namespace Mg {
  * The cache maintains an list of files available to its resource loaders. This allows the cache to
  * know whether to load from directory or from archive, without a file system look-up. However, it
  * also means that `refresh()` should be called if either directory or archive contents have
- * changed. One may, for example, call `refresh()` upon window-receiving-focus events.
+ * changed. One may, for example, call `refresh()` upon window-receiving-focus events. Refreshing
+ * is cheap when file loaders can report what has changed (see `IFileLoader::changed_files()`),
+ * since then only the changed files are examined.
+ *
+ * The cache keeps track of approximately how much memory its loaded resources use (see
+ * `BaseResource::resident_size_bytes`). If a memory budget is set using `set_memory_budget()`, then
+ * unused resources are unloaded automatically, in least-recently-used order, whenever the total
+ * exceeds the budget.
+ *
+ * Resources may be loaded asynchronously using `request_load()`, which loads the resource on one
+ * of the cache's loading threads. Resource types that load dependencies via
+ * `ResourceLoadingInput::request_dependency()` have those dependencies loaded in parallel, too.
  */
 class ResourceCache {
 public:
@@ -85,12 +105,16 @@ public:
         refresh();
     }
 
-    ~ResourceCache() = default;
+    // Out-of-line, waits for pending asynchronous loads.
+    ~ResourceCache();
 
     MG_MAKE_NON_COPYABLE(ResourceCache);
     MG_MAKE_NON_MOVABLE(ResourceCache); // Prevents pointer invalidation
 
-    /** Update file list, detects if files have changed (added, removed, changed timestamp). */
+    /** Update file list, detects if files have changed (added, removed, changed timestamp).
+     * Loaded resources whose files, or whose dependencies' files, have changed are unloaded (to be
+     * reloaded on next access) and trackers of their resource types are notified.
+     */
     void refresh();
 
     /** Get handle to a resource with the given path.
@@ -122,12 +146,24 @@ public:
         return handle;
     }
 
+    /** Start loading the resource with the given path on a loading thread, without blocking.
+     * Throws ResourceNotFound immediately if there is no such file; errors in loading the resource
+     * data are instead reported when calling `get()` on the returned request.
+     * @param file Filename (path) to resource file.
+     */
+    template<typename ResT> ResourceLoadRequest<ResT> request_load(Identifier file)
+    {
+        ResourceHandle<ResT> handle = resource_handle<ResT>(file, false);
+        return ResourceLoadRequest<ResT>(handle, enqueue_load(*handle.m_p_entry));
+    }
+
     /** Access the resource with the given file path.
      * @param file Filename (path) to resource file.
      */
     template<typename ResT> ResourceAccessGuard<ResT> access_resource(Identifier file)
     {
-        return ResourceAccessGuard(resource_handle<ResT>(file));
+        // The access guard loads the resource, if needed.
+        return ResourceAccessGuard(resource_handle<ResT>(file, false));
     }
 
     /** Returns whether a file with the given path exists in the file list.
@@ -165,12 +201,35 @@ public:
      */
     bool unload_unused(bool unload_all_unused = false) const;
 
+    /** Set the maximum amount of memory, in bytes, that loaded resources may use before unused
+     * resources are unloaded automatically. Resources in use are never unloaded, so the budget may
+     * still be exceeded. Unloads unused resources immediately if the budget is already exceeded.
+     * The default is no limit.
+     */
+    void set_memory_budget(size_t num_bytes);
+
+    /** Get the memory budget, see `set_memory_budget()`. */
+    size_t memory_budget() const noexcept { return m_memory_budget; }
+
+    /** Get the approximate amount of memory, in bytes, used by currently loaded resources. */
+    size_t resident_size_bytes() const noexcept { return m_resident_size_bytes; }
+
+    /** Get a snapshot of usage statistics for the resources in this cache, e.g. to find which
+     * resources dominate loading time or memory usage. May be called while other threads access
+     * resources, in which case the snapshot may be slightly out of date.
+     */
+    ResourceCacheStatistics statistics() const;
+
     std::span<const std::unique_ptr<IFileLoader>> file_loaders() const noexcept
     {
         // No need to lock, since m_file_loaders never changes after construction.
         return m_file_loaders;
     }
 
+    /** Create a tracker which is notified when resources of the given type have been reloaded
+     * due to file changes, see `refresh()`. Notifications stop when the returned tracker is
+     * destroyed.
+     */
     [[nodiscard]] std::shared_ptr<FileChangedTracker>
     make_file_change_tracker(Identifier resource_type,
                              FileChangedTracker::CallbackT callback,
@@ -181,6 +240,19 @@ public:
         return result;
     }
 
+    /** As above, but the callback receives all events for the resource type from a refresh at
+     * once.
+     */
+    [[nodiscard]] std::shared_ptr<FileChangedTracker>
+    make_file_change_tracker(Identifier resource_type,
+                             FileChangedTracker::BatchCallbackT batch_callback,
+                             void* user_data = nullptr)
+    {
+        auto result = std::make_shared<FileChangedTracker>(batch_callback, user_data);
+        m_file_changed_trackers_by_resource_type[resource_type].push_back(result);
+        return result;
+    }
+
 private:
     struct FileInfo {
         Identifier filename;
@@ -191,8 +263,56 @@ private:
         std::unique_ptr<ResourceEntryBase> entry;
     };
 
-    // Rebuilds resource-file-list data structures.
-    void rebuild_file_list();
+    // Bookkeeping of resident size and least-recently-used order, invoked by ResourceEntryBase.
+    friend class ResourceEntryBase;
+    void on_resource_loaded(ResourceEntryBase& entry);
+    void on_resource_unloaded(ResourceEntryBase& entry);
+    void on_resource_accessed(ResourceEntryBase& entry);
+
+    // Insert/remove entry in LRU list. Caller must hold m_lru_mutex.
+    void lru_push_front(ResourceEntryBase& entry) noexcept;
+    void lru_unlink(ResourceEntryBase& entry) noexcept;
+
+    // Unload up to `max_num_to_unload` unused resources, in least-recently-used order, stopping
+    // early once resident size is no greater than `target_resident_size`, if given. Never unloads
+    // `keep`. Returns number of unloaded resources.
+    size_t unload_least_recently_used(size_t max_num_to_unload,
+                                      Opt<size_t> target_resident_size,
+                                      const ResourceEntryBase* keep) const;
+
+    // Load the entry's resource on a loading thread, unless it is already loaded.
+    // Returns future which is ready when the loading attempt has finished.
+    std::shared_future<void> enqueue_load(ResourceEntryBase& entry);
+
+    // Update the file list with changes from all file loaders, rescanning only those loaders that
+    // cannot report changes (see IFileLoader::changed_files). Returns names of files whose time
+    // stamp or loader changed. Caller must hold unique lock on m_file_list_mutex.
+    std::vector<Identifier> update_file_list();
+
+    struct ReloadInfo;
+
+    // Unload loaded resources whose files have changed, and, transitively, the resources that
+    // depend on them. Returns the unloaded resources along with their dependency relations.
+    std::vector<ReloadInfo> unload_changed_resources(std::span<const Identifier> changed_files);
+
+    // Load the given resources on the loading threads, dependencies before dependants.
+    void reload_resources(std::span<ReloadInfo> resources);
+
+    // Notify file-change trackers of reloaded resources, one batch per resource type.
+    void notify_file_changed_trackers(std::span<const ReloadInfo> resources);
+
+    // Get the loaded resources that depend on the given file, see m_dependants.
+    std::vector<ResourceEntryBase*> dependants_of(Identifier file) const;
+
+    // Get the difference between the file list and a full list of the loader's files.
+    FileListDelta make_file_list_delta(const IFileLoader& loader,
+                                       std::span<const FileRecord> records) const;
+
+    // Apply a loader's changes to the file list, appending names of changed files to
+    // `changed_files`.
+    void apply_file_list_delta(IFileLoader& loader,
+                               const FileListDelta& delta,
+                               std::vector<Identifier>& changed_files);
 
     // Get pointer to FileInfo record for the given filename, or nullptr if no such file exists.
     Opt<const FileInfo&> file_info(Identifier file) const;
@@ -264,6 +384,33 @@ private:
     // through the file list; re-loading the resource, in turn, invokes
     // `ResourceCache::resource_handle` as it requests a dependency.
     std::mutex m_set_resource_entry_mutex;
+
+    // Intrusive doubly-linked list of loaded resources, most recently used first. Links are stored
+    // in the ResourceEntryBase objects, so that an access only has to relink one node.
+    // Lock order: a ResourceEntryBase::mutex may be held while locking m_lru_mutex, but not vice
+    // versa (except via try_lock).
+    mutable std::mutex m_lru_mutex;
+    ResourceEntryBase* m_lru_head = nullptr;
+    ResourceEntryBase* m_lru_tail = nullptr;
+
+    // Reverse dependency index: for each file, the loaded resources which depended on it when they
+    // were loaded (see ResourceEntryBase::dependencies). Used to find the resources affected by a
+    // file change without examining every resource. Updated when resources are loaded or
+    // unloaded. Lock order: may be locked while holding a ResourceEntryBase::mutex.
+    std::unordered_map<Identifier, std::vector<ResourceEntryBase*>> m_dependants;
+    mutable std::mutex m_dependants_mutex;
+
+    // Sum of resident_size_bytes() of loaded resources. Modified under m_lru_mutex.
+    std::atomic_size_t m_resident_size_bytes = 0;
+    std::atomic_size_t m_memory_budget = std::numeric_limits<size_t>::max();
+
+    // Threads for asynchronous loading, created on first use by `enqueue_load`.
+    // Custom deleter, since JobSystem is incomplete here and the constructors are inline.
+    struct JobSystemDeleter {
+        void operator()(JobSystem* job_system) const noexcept;
+    };
+    std::once_flag m_loading_job_system_init_flag;
+    std::unique_ptr<JobSystem, JobSystemDeleter> m_loading_job_system;
 };
 
 } // namespace Mg
@@ -0,0 +1,100 @@
+//**************************************************************************************************
+// This file is part of Mg Engine. Copyright (c) 2026, Magnus Bergsten.
+// Mg Engine is made available under the terms of the 3-Clause BSD License.
+// See LICENSE.txt in the project's root directory.
+//**************************************************************************************************
+
+/** @file mg_resource_cache_statistics.h
+ * Snapshot of ResourceCache usage statistics.
+ * @see Mg::ResourceCache::statistics
+ */
+
+#pragma once
+
+#include "mg/core/mg_identifier.h"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Mg {
+
+/** Counters describing how a resource (or a group of resources) has been used. Counts accumulate
+ * over the lifetime of the ResourceCache.
+ */
+struct ResourceCounters {
+    /** Accesses where the resource was already loaded. */
+    uint64_t num_hits = 0;
+
+    /** Accesses where the resource had to be loaded (or where a load in progress was awaited). */
+    uint64_t num_misses = 0;
+
+    /** Number of times the resource was successfully loaded. */
+    uint64_t num_loads = 0;
+
+    /** Total size of file data read or mapped when loading. */
+    uint64_t bytes_read = 0;
+
+    /** Time spent reading (or mapping) file data when loading. */
+    std::chrono::nanoseconds io_time{};
+
+    /** Time spent in the resource type's `load_resource_impl`. Includes time spent loading
+     * dependencies on the same thread.
+     */
+    std::chrono::nanoseconds load_time{};
+
+    /** Time spent waiting for other threads to release the resource's lock. */
+    std::chrono::nanoseconds lock_wait_time{};
+
+    /** Approximate memory currently used by the resource, see `BaseResource::resident_size_bytes`.
+     */
+    size_t resident_size_bytes = 0;
+
+    ResourceCounters& operator+=(const ResourceCounters& rhs) noexcept;
+};
+
+/** Statistics for a single resource. */
+struct ResourceStatistics {
+    Identifier resource_id;
+
+    /** Type of the resource, or "<unset>" if it has never been loaded. */
+    Identifier resource_type_id = "<unset>";
+
+    bool is_loaded = false;
+
+    ResourceCounters counters;
+};
+
+/** Statistics summed over all resources of a type. */
+struct ResourceTypeStatistics {
+    Identifier resource_type_id;
+    size_t num_resources = 0;
+    size_t num_loaded = 0;
+    ResourceCounters counters;
+};
+
+/** Snapshot of the statistics of a ResourceCache, see `ResourceCache::statistics()`.
+ * Only resources that have been requested at least once are included.
+ */
+struct ResourceCacheStatistics {
+    /** Per-resource statistics, sorted by resource name. */
+    std::vector<ResourceStatistics> resources;
+
+    /** Per-type statistics, sorted by type name. */
+    std::vector<ResourceTypeStatistics> resource_types;
+
+    /** Sum over all resources. */
+    ResourceCounters total;
+};
+
+/** Format per-resource statistics as CSV, with a header row. Times are given in microseconds. */
+std::string to_csv(const ResourceCacheStatistics& statistics);
+
+/** Format statistics as a JSON object with the members "total", "resource_types", and "resources".
+ * Times are given in microseconds.
+ */
+std::string to_json(const ResourceCacheStatistics& statistics);
+
+} // namespace Mg
@@ -35,6 +35,7 @@ public:
 
 protected:
     template<typename ResT> friend class ResourceAccessGuard;
+    friend class ResourceCache;
 
     Identifier m_id = "";
     ResourceEntryBase* m_p_entry = nullptr;
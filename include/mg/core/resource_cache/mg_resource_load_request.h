@@ -0,0 +1,76 @@
+//**************************************************************************************************
+// This file is part of Mg Engine. Copyright (c) 2026, Magnus Bergsten.
+// Mg Engine is made available under the terms of the 3-Clause BSD License.
+// See LICENSE.txt in the project's root directory.
+//**************************************************************************************************
+
+/** @file mg_resource_load_request.h
+ * Pollable state of an asynchronous resource load.
+ * @see Mg::ResourceCache::request_load
+ */
+
+#pragma once
+
+#include "mg/core/resource_cache/mg_resource_access_guard.h"
+#include "mg/core/resource_cache/mg_resource_handle.h"
+
+#include <chrono>
+#include <future>
+
+namespace Mg {
+
+/** Result of `ResourceCache::request_load`. Refers to a resource that is being loaded on one of
+ * the cache's loading threads.
+ *
+ * Usage example, loading a set of resources without stalling the calling thread:
+ *
+ *     std::vector<ResourceLoadRequest<MeshResource>> requests;
+ *     for (Identifier file : files) {
+ *         requests.push_back(cache.request_load<MeshResource>(file));
+ *     }
+ *
+ *     // ... later, e.g. once per frame:
+ *     if (std::ranges::all_of(requests, [](auto& r) { return r.is_ready(); })) {
+ *         for (auto& r : requests) {
+ *             m_meshes.push_back(r.get());
+ *         }
+ *     }
+ */
+template<typename ResT> class ResourceLoadRequest {
+public:
+    ResourceLoadRequest() = default;
+
+    explicit ResourceLoadRequest(ResourceHandle<ResT> handle, std::shared_future<void> done)
+        : m_handle(handle), m_done(std::move(done))
+    {}
+
+    /** Whether the loading attempt has finished (successfully or not). Does not block. */
+    bool is_ready() const
+    {
+        return m_done.valid() && m_done.wait_for(std::chrono::seconds(0)) ==
+                                     std::future_status::ready;
+    }
+
+    /** Block until the loading attempt has finished. */
+    void wait() const { m_done.wait(); }
+
+    /** Get the handle to the resource, ensuring that it is loaded. If the load has not yet
+     * finished, this blocks until it is; if it has not yet started, it is done on the calling
+     * thread instead of waiting for a loading thread to become available.
+     * Throws the same exceptions as `ResourceCache::resource_handle` if loading failed.
+     */
+    ResourceHandle<ResT> get() const
+    {
+        ResourceAccessGuard<ResT> access(m_handle);
+        return m_handle;
+    }
+
+    /** Get the handle to the resource, without waiting for it to load. */
+    ResourceHandle<ResT> handle() const noexcept { return m_handle; }
+
+private:
+    ResourceHandle<ResT> m_handle;
+    std::shared_future<void> m_done;
+};
+
+} // namespace Mg
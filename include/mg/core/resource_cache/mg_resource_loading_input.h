@@ -25,12 +25,47 @@ public:
         : m_data(std::move(data)), m_owning_cache(&owning_cache), m_resource_entry(&resource_entry)
     {}
 
-    std::span<const std::byte> resource_data() const noexcept { return m_data; }
-    Array<std::byte> take_resource_data() noexcept { return std::move(m_data); }
+    ResourceLoadingInput(SharedFileData data,
+                         ResourceCache& owning_cache,
+                         ResourceEntryBase& resource_entry) noexcept
+        : m_shared_data(std::move(data))
+        , m_owning_cache(&owning_cache)
+        , m_resource_entry(&resource_entry)
+    {}
+
+    std::span<const std::byte> resource_data() const noexcept
+    {
+        return m_shared_data ? m_shared_data->bytes() : std::span<const std::byte>(m_data);
+    }
+
+    /** Take the resource data as an owned, mutable array. If the data is not already in an array
+     * (e.g. if it is memory-mapped), this copies it; prefer `share_resource_data` if the resource
+     * does not need to modify the data.
+     */
+    Array<std::byte> take_resource_data()
+    {
+        if (m_shared_data) {
+            return Array<std::byte>::make_copy(m_shared_data->bytes());
+        }
+        return std::move(m_data);
+    }
+
+    /** Get shared, read-only view of the resource data without copying. Resource types that can
+     * use the file data in place should hold on to the returned object for as long as they refer
+     * to the data.
+     */
+    SharedFileData share_resource_data()
+    {
+        if (!m_shared_data) {
+            m_shared_data = SharedFileData::from_array(std::move(m_data));
+        }
+        return *m_shared_data;
+    }
 
     std::string_view resource_data_as_text() const noexcept
     {
-        return { reinterpret_cast<const char*>(m_data.data()), m_data.size() }; // NOLINT
+        const auto data = resource_data();
+        return { reinterpret_cast<const char*>(data.data()), data.size() }; // NOLINT
     }
 
     /** Load a resource and mark this resource as dependent on the newly loaded resource. */
@@ -47,8 +82,28 @@ public:
         return handle;
     }
 
+    /** Like `load_dependency`, but loads the dependency asynchronously on one of the cache's
+     * loading threads. Use this to load multiple dependencies in parallel: request all of them
+     * first, then call `get()` on each request.
+     */
+    template<typename ResT>
+    ResourceLoadRequest<ResT> request_dependency(Identifier dependency_file_id) const
+    {
+        const auto file_time_stamp = m_owning_cache->file_time_stamp(dependency_file_id);
+        auto request = m_owning_cache->request_load<ResT>(dependency_file_id);
+
+        // Write dependency after look-up.
+        // Order is important, as look-ups might throw.
+        m_resource_entry->dependencies.push_back({ dependency_file_id, file_time_stamp });
+
+        return request;
+    }
+
 private:
+    // Resource data is in either of these.
     Array<std::byte> m_data;
+    Opt<SharedFileData> m_shared_data;
+
     ResourceCache* m_owning_cache;
     ResourceEntryBase* m_resource_entry;
 };
@@ -13,6 +13,7 @@
 #include "mg/core/resource_cache/mg_resource_handle.h"
 
 #include <ctime>
+#include <span>
 
 namespace Mg {
 
@@ -23,18 +24,40 @@ struct FileChangedEvent {
     std::time_t time_stamp;
 };
 
+/** Receives FileChangedEvents for a resource type, see `ResourceCache::make_file_change_tracker`.
+ * Events are delivered after the changed resources have been reloaded, either one at a time
+ * (CallbackT) or all events for the resource type from a single refresh at once (BatchCallbackT).
+ */
 class FileChangedTracker {
 public:
     using CallbackT = void (*)(void* user_data, const FileChangedEvent&);
+    using BatchCallbackT = void (*)(void* user_data, std::span<const FileChangedEvent>);
 
     explicit FileChangedTracker(CallbackT callback, void* user_data)
         : m_callback{ callback }, m_user_data{ user_data }
     {}
 
-    void notify_update(const FileChangedEvent& event) { m_callback(m_user_data, event); }
+    explicit FileChangedTracker(BatchCallbackT batch_callback, void* user_data)
+        : m_batch_callback{ batch_callback }, m_user_data{ user_data }
+    {}
+
+    void notify_update(const FileChangedEvent& event) { notify_updates({ &event, 1 }); }
+
+    void notify_updates(std::span<const FileChangedEvent> events)
+    {
+        if (m_batch_callback) {
+            m_batch_callback(m_user_data, events);
+            return;
+        }
+
+        for (const FileChangedEvent& event : events) {
+            m_callback(m_user_data, event);
+        }
+    }
 
 private:
-    CallbackT m_callback;
+    CallbackT m_callback = nullptr;
+    BatchCallbackT m_batch_callback = nullptr;
     void* m_user_data = nullptr;
 };
 
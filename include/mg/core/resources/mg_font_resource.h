@@ -10,7 +10,7 @@
 
 #pragma once
 
-#include "mg/core/containers/mg_array.h"
+#include "mg/core/mg_file_loader.h"
 #include "mg/core/resource_cache/mg_base_resource.h"
 
 namespace Mg {
@@ -24,13 +24,13 @@ public:
     Identifier type_id() const override { return "FontResource"; }
 
     /** Access raw font data. */
-    std::span<const std::byte> data() const noexcept { return m_font_data; }
+    std::span<const std::byte> data() const noexcept { return m_font_data.bytes(); }
 
 protected:
     LoadResourceResult load_resource_impl(ResourceLoadingInput& input) override;
 
 private:
-    Array<std::byte> m_font_data;
+    SharedFileData m_font_data;
 };
 
 } // namespace Mg
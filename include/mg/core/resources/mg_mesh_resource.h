@@ -19,6 +19,7 @@
 
 namespace Mg::gfx::mesh_data {
 struct Vertex;
+struct CompactVertex;
 struct JointData;
 struct Submesh;
 struct Joint;
@@ -42,7 +43,14 @@ public:
 
     gfx::mesh_data::MeshDataView data_view() const noexcept;
 
+    /** Vertices of the mesh. Empty if the mesh uses compact vertices. */
     std::span<const gfx::mesh_data::Vertex> vertices() const noexcept;
+
+    /** Vertices of the mesh in compact format, with positions quantized against
+     * `axis_aligned_bounding_box()`. Empty unless the mesh file was written with compact vertices.
+     */
+    std::span<const gfx::mesh_data::CompactVertex> compact_vertices() const noexcept;
+
     std::span<const gfx::mesh_data::Index> indices() const noexcept;
     std::span<const gfx::mesh_data::Submesh> submeshes() const noexcept;
     std::span<const gfx::mesh_data::Influences> influences() const noexcept;
@@ -66,6 +74,8 @@ public:
 
     bool should_reload_on_file_change() const noexcept override { return true; }
 
+    Opt<size_t> resident_size_bytes() const noexcept override;
+
     Identifier type_id() const noexcept override { return "MeshResource"; }
 
 protected:
@@ -74,6 +84,10 @@ protected:
 private:
     // Calculate bounds of this mesh, i.e. centre and radius.
     void calculate_bounds() noexcept;
+
+    // Validate mesh data. Checking that indices are within bounds may be skipped for data that is
+    // known to be valid, since it requires examining every index.
+    bool validate_impl(bool check_index_bounds) const;
     std::unique_ptr<Data> m_data;
 };
 
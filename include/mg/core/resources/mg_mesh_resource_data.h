@@ -14,24 +14,45 @@
 #include "mg/core/gfx/mg_joint.h"
 #include "mg/core/gfx/mg_mesh_data.h"
 #include "mg/core/mg_file_data_range.h"
+#include "mg/utils/mg_macros.h"
 
 #include <glm/gtc/quaternion.hpp>
 #include <glm/mat4x4.hpp>
 #include <glm/vec3.hpp>
 
+#include <array>
+#include <cstddef>
 #include <cstdint>
-
-/** Data structure definitions and constants for the Mg mesh file format. */
+#include <cstring>
+#include <span>
+
+/** Data structure definitions and constants for the Mg mesh file format.
+ *
+ * Since version 3, each data range begins at an offset aligned to `data_alignment`, so that vertex,
+ * index, and influence data can be used directly from the (loaded or memory-mapped) file.
+ *
+ * Since version 4, vertices may instead be stored in compact format (`Header::compact_vertices`),
+ * with positions quantized against the bounding box given by `Header::abb_min` and `abb_max`. Only
+ * one of `Header::vertices` and `Header::compact_vertices` is non-empty.
+ *
+ * Since version 5, animation clips may instead be stored in compressed format
+ * (`Header::compressed_animations`, see `gfx::mesh_data::CompressedAnimation`). Each compressed
+ * clip records its index among all clips, so that the order of clips is the same in either format.
+ */
 namespace Mg::MeshResourceData {
 
 inline constexpr uint32_t fourcc = 0x444D474Du; // MGMD
-inline constexpr uint32_t version = 2;          // Current version of the file format.
+inline constexpr uint32_t version = 5;          // Current version of the file format.
+
+inline constexpr uint32_t data_alignment = 16;
 
 using gfx::mesh_data::joint_id_none;
 using gfx::mesh_data::max_num_children_per_joint;
 using gfx::mesh_data::max_vertices_per_mesh;
 using gfx::mesh_data::num_influences_per_vertex;
 
+using gfx::mesh_data::CompactVertex;
+using gfx::mesh_data::CompressedAnimationChannel;
 using gfx::mesh_data::Index;
 using gfx::mesh_data::Influences;
 using gfx::mesh_data::JointChildren;
@@ -54,14 +75,57 @@ struct Header {
     glm::vec3 abb_max;
     glm::mat4 skeleton_root_transform;
     FileDataRange vertices;
+    FileDataRange compact_vertices;
     FileDataRange indices;
     FileDataRange submeshes;
     FileDataRange joints;
     FileDataRange influences;
     FileDataRange animations;
+    FileDataRange compressed_animations;
     FileDataRange strings;
+
+    // Checksum of all data following the header, see `calculate_checksum`. The converter validates
+    // the mesh when writing the file, so a matching checksum means the data need not be validated
+    // again when loading. Debug builds verify the checksum; release builds check index bounds
+    // instead, which is cheaper.
+    uint64_t data_checksum;
 };
 
+/** Checksum used for `Header::data_checksum`. Fletcher-style sums over 64-bit words in four
+ * independent lanes, so that it can be computed at close to memory bandwidth.
+ */
+MG_USES_UNSIGNED_OVERFLOW inline uint64_t
+calculate_checksum(std::span<const std::byte> data) noexcept
+{
+    constexpr size_t num_lanes = 4;
+    constexpr size_t block_size = num_lanes * sizeof(uint64_t);
+
+    std::array<uint64_t, num_lanes> sums = {};
+    std::array<uint64_t, num_lanes> sums_of_sums = {};
+
+    size_t offset = 0;
+    for (; offset + block_size <= data.size(); offset += block_size) {
+        for (size_t lane = 0; lane < num_lanes; ++lane) {
+            uint64_t word = 0;
+            std::memcpy(&word, &data[offset + lane * sizeof(uint64_t)], sizeof(uint64_t));
+            sums[lane] += word;
+            sums_of_sums[lane] += sums[lane];
+        }
+    }
+
+    for (; offset < data.size(); ++offset) {
+        sums[0] += static_cast<uint64_t>(data[offset]);
+        sums_of_sums[0] += sums[0];
+    }
+
+    uint64_t result = data.size();
+    for (size_t lane = 0; lane < num_lanes; ++lane) {
+        result = (result ^ sums[lane]) * 0x100000001b3u;
+        result = (result ^ sums_of_sums[lane]) * 0x100000001b3u;
+    }
+    return result;
+}
+
 /** At the end of each mesh file there is a buffer of zero-terminated strings. This struct points
  * out a string within said buffer.
  */
@@ -95,4 +159,17 @@ struct AnimationChannel {
     FileDataRange scale_keys;
 };
 
+struct CompressedAnimationClip {
+    StringRange name;
+    FileDataRange channels; // CompressedAnimationChannel
+    FileDataRange frames;   // uint16_t
+    FileDataRange values;   // std::array<uint16_t, 3>
+    float duration = 0.0f;
+    float sample_rate = 0.0f;
+
+    // Position of this clip among all of the mesh's clips, compressed or not, so that clips keep
+    // the order of the source file.
+    uint32_t index = 0;
+};
+
 } // namespace Mg::MeshResourceData
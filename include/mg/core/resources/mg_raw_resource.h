@@ -32,6 +32,8 @@ public:
     /** Access byte stream. */
     std::span<const std::byte> bytes() const noexcept { return m_buffer; }
 
+    Opt<size_t> resident_size_bytes() const noexcept override { return m_buffer.size(); }
+
     Identifier type_id() const override { return "RawResource"_id; }
 
 protected:
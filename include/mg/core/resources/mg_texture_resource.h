@@ -10,8 +10,8 @@
 
 #pragma once
 
-#include "mg/core/containers/mg_array.h"
 #include "mg/core/gfx/mg_texture_related_types.h"
+#include "mg/core/mg_file_loader.h"
 #include "mg/core/resource_cache/mg_base_resource.h"
 
 #include <span>
@@ -59,13 +59,19 @@ public:
 
     bool is_cube_map() const noexcept { return m_format.num_images == 6; }
 
+    Opt<size_t> resident_size_bytes() const noexcept override
+    {
+        return m_pixel_data.bytes().size();
+    }
+
 protected:
     /** Constructs a texture from file. Only DDS files are supported. */
     LoadResourceResult load_resource_impl(ResourceLoadingInput& input) override;
 
 private:
     Format m_format;
-    Array<std::byte> m_pixel_data;
+    // Refers to the pixel data in the file data, without copying.
+    SharedFileData m_pixel_data;
 };
 
 } // namespace Mg
@@ -16,8 +16,11 @@
 #include "mg/components/mg_mesh_component.h"
 #include "mg/components/mg_static_body_component.h"
 #include "mg/components/mg_transform_component.h"
+#include "mg/components/mg_update_animation_lods.h"
 #include "mg/components/mg_update_dynamic_body_transforms.h"
+#include "mg/core/ecs/mg_command_buffer.h"
 #include "mg/core/ecs/mg_entity.h"
+#include "mg/core/ecs/mg_system_graph.h"
 #include "mg/core/gfx/mg_debug_renderer.h"
 #include "mg/core/gfx/mg_material_pool.h"
 #include "mg/core/gfx/mg_mesh_pool.h"
@@ -27,18 +30,30 @@
 #include "mg/core/mg_application_context.h"
 #include "mg/core/mg_config.h"
 #include "mg/core/mg_file_loader.h"
+#include "mg/core/mg_frame_arena.h"
+#include "mg/core/mg_job_system.h"
 #include "mg/core/mg_window.h"
 #include "mg/core/physics/mg_dynamic_body_handle.h"
 #include "mg/core/physics/mg_physics_world.h"
 #include "mg/core/resources/mg_mesh_resource.h"
 
+#include <algorithm>
+#include <span>
+#include <thread>
+#include <utility>
+#include <vector>
+
 namespace Mg {
 
 struct GameParams {
     std::string window_title;
     std::string_view config_file_path;
     std::vector<std::unique_ptr<IFileLoader>> file_loaders;
-    uint32_t max_num_entities = 1024;
+
+    /** Number of entities to allocate memory for up-front. More entities may be created; this only
+     * avoids re-allocation while the number of entities is below this value.
+     */
+    uint32_t entity_capacity = 1024;
 };
 
 struct LoadModelParams {
@@ -52,8 +67,39 @@ struct TransformParams {
     glm::vec3 scale{ 1.0f };
 };
 
+/** What kind of physics body, if any, the instances of a Prefab get. */
+enum class PrefabBodyType { none, static_body, dynamic_body };
+
+/** An object's mesh, materials, and physics shape, resolved once for spawning many instances with
+ * `Game::spawn_n`. Create with `Game::make_static_prefab` or `Game::make_dynamic_prefab`.
+ */
+struct Prefab {
+    Identifier object_id;
+    Identifier mesh_file;
+    const gfx::Mesh* mesh = nullptr;
+    small_vector<gfx::MaterialBinding, 4> material_bindings;
+
+    PrefabBodyType body_type = PrefabBodyType::none;
+
+    // Collision shape shared by all static bodies.
+    physics::Shape* static_shape = nullptr;
+
+    // Dynamic bodies' convex hull shapes include the instance's scale, so they are created on
+    // demand and shared between instances with the same scale.
+    Opt<physics::DynamicBodyParameters> dynamic_body_params;
+    glm::vec3 centre_of_mass{ 0.0f };
+    small_vector<std::pair<glm::vec3, physics::Shape*>, 1> dynamic_shapes;
+};
+
 class Game : public IApplication {
 public:
+    /** Names of data other than components accessed by the engine's systems, for use in
+     * `ecs::SystemAccess` when adding systems with `add_simulation_system` or `add_render_system`.
+     */
+    static constexpr Identifier k_physics_world_resource = "PhysicsWorld";
+    static constexpr Identifier k_window_resource = "Window";
+    static constexpr Identifier k_debug_render_queue_resource = "DebugRenderQueue";
+
     template<ecs::Component... AdditionalComponentTs>
     explicit Game(GameParams params)
         : m_config{ params.config_file_path }
@@ -62,7 +108,7 @@ public:
         , m_mesh_pool{ std::make_shared<gfx::MeshPool>(m_resource_cache) }
         , m_texture_pool{ std::make_shared<gfx::TexturePool>(m_resource_cache) }
         , m_material_pool{ std::make_shared<gfx::MaterialPool>(m_resource_cache, m_texture_pool) }
-        , m_entities{ params.max_num_entities }
+        , m_entities{ params.entity_capacity }
     {
         m_entities.init<TransformComponent,
                         StaticBodyComponent,
@@ -78,83 +124,71 @@ public:
 
     void simulation_step(ApplicationTimeInfo time_info) final
     {
-        const auto timer_config = update_timer_config();
-        const auto time_step =
-            narrow_cast<float>(1.0 / double(timer_config.simulation_steps_per_second));
-
-        gfx::get_debug_render_queue().clear();
-
-        m_window.poll_input_events();
-
-        update_dynamic_body_transforms(m_entities);
-
-        on_simulation_step(time_info);
-
-        m_physics_world->update(time_step);
+        m_time_info = time_info;
+        m_entities.advance_change_tick();
+        build_system_graphs();
+        m_simulation_graph.run(m_job_system);
+        m_entity_commands.apply(m_entities);
     }
 
     void render(double lerp_factor, ApplicationTimeInfo time_info) final
     {
-        advance_animations(m_entities, float(time_info.time_since_init));
+        m_frame_arena.next_frame();
+        m_time_info = time_info;
+        m_lerp_factor = lerp_factor;
+        build_system_graphs();
+        m_render_graph.run(m_job_system);
+        m_entity_commands.apply(m_entities);
+    }
 
-        on_render(lerp_factor, time_info);
+    /** Add a system to run in each simulation step, after `on_simulation_step` and before the
+     * physics update. Systems run concurrently with each other and with the engine's systems,
+     * unless their accesses conflict, in which case they run in the order they were added.
+     */
+    void add_simulation_system(Identifier name,
+                               ecs::SystemAccess access,
+                               ecs::SystemGraph::SystemFunction function)
+    {
+        m_simulation_systems.push_back({ name, std::move(access), std::move(function) });
+        m_should_rebuild_system_graphs = true;
+    }
 
-        renderer().render({
-            .camera = active_camera(),
-            .time_since_init = float(time_info.time_since_init),
-        });
-        window().swap_buffers();
+    /** Add a system to run in each render step, after `on_render` and before the scene is
+     * rendered. See `add_simulation_system`.
+     */
+    void add_render_system(Identifier name,
+                           ecs::SystemAccess access,
+                           ecs::SystemGraph::SystemFunction function)
+    {
+        m_render_systems.push_back({ name, std::move(access), std::move(function) });
+        m_should_rebuild_system_graphs = true;
     }
 
+    /** Time info of the current simulation or render step. */
+    const ApplicationTimeInfo& time_info() const { return m_time_info; }
+
+    /** Interpolation factor of the current render step. */
+    double lerp_factor() const { return m_lerp_factor; }
+
     void load_model(const LoadModelParams& params, ecs::Entity entity)
     {
-        auto& mesh = m_entities.add_component<MeshComponent>(entity);
-        mesh.mesh = m_mesh_pool->get_or_load(params.mesh_file);
-
-        if (mesh.mesh->animation_data) {
+        const Prefab prefab = make_prefab(params.mesh_file, params);
+        if (prefab.mesh->animation_data) {
             auto& animation = m_entities.add_component<AnimationComponent>(entity);
-            animation.pose = mesh.mesh->animation_data->skeleton.get_bind_pose();
-        }
-
-        mesh.material_bindings.resize(params.material_bindings.size());
-        for (auto&& [binding_id, filename] : params.material_bindings) {
-            mesh.material_bindings.push_back(
-                { .material_binding_id = binding_id,
-                  .material = m_material_pool->get_or_load(filename) });
+            animation.pose = prefab.mesh->animation_data->skeleton.get_bind_pose();
         }
 
-        for (auto&& submesh : mesh.mesh->submeshes) {
-            auto has_material = [&](const gfx::MaterialBinding& binding) {
-                return binding.material_binding_id == submesh.material_binding_id;
-            };
-            if (std::ranges::find_if(mesh.material_bindings, has_material) ==
-                mesh.material_bindings.end()) {
-                log.warning("Submesh '{}' with material_binding_id '{}' has no material assigned.",
-                            submesh.name.str_view(),
-                            submesh.material_binding_id.str_view());
-            }
-        }
+        // Added last, since adding components invalidates references to the entity's components.
+        auto& mesh = m_entities.add_component<MeshComponent>(entity);
+        mesh.mesh = prefab.mesh;
+        mesh.material_bindings = prefab.material_bindings;
     }
 
     ecs::Entity add_static_object(const LoadModelParams& params,
                                   const TransformParams& transform_params)
     {
-        const auto entity = m_entities.create_entity();
-        load_model(params, entity);
-
-        const ResourceAccessGuard access =
-            m_resource_cache->access_resource<MeshResource>(params.mesh_file);
-
-        physics::Shape* shape = m_physics_world->create_mesh_shape(access->data_view());
-
-        glm::mat4 M = glm::translate(transform_params.position) *
-                      transform_params.rotation.to_matrix() * glm::scale(transform_params.scale);
-
-        auto static_body = m_physics_world->create_static_body(params.mesh_file, *shape, M);
-        m_entities.add_component<StaticBodyComponent>(entity, static_body);
-        m_entities.add_component<TransformComponent>(entity, M, M);
-
-        return entity;
+        Prefab prefab = make_static_prefab(params);
+        return spawn_n(prefab, { &transform_params, 1 }).front();
     }
 
     ecs::Entity add_dynamic_object(Identifier object_id,
@@ -162,41 +196,121 @@ public:
                                    const TransformParams& transform_params,
                                    Opt<physics::DynamicBodyParameters> physics_params)
     {
-        const auto entity = m_entities.create_entity();
-        load_model(model_params, entity);
+        Prefab prefab = make_dynamic_prefab(object_id, model_params, physics_params);
+        return spawn_n(prefab, { &transform_params, 1 }).front();
+    }
+
+    /** Make a prefab for spawning static objects, like those created by `add_static_object`. */
+    Prefab make_static_prefab(const LoadModelParams& params)
+    {
+        Prefab prefab = make_prefab(params.mesh_file, params);
+        prefab.body_type = PrefabBodyType::static_body;
+
+        const ResourceAccessGuard access =
+            m_resource_cache->access_resource<MeshResource>(params.mesh_file);
+        prefab.static_shape = m_physics_world->create_mesh_shape(access->data_view());
 
-        auto& mesh = m_entities.get_component<MeshComponent>(entity);
-        auto& transform = m_entities.add_component<TransformComponent>(entity);
+        return prefab;
+    }
 
-        const glm::mat4 M = glm::translate(transform_params.position) *
-                            transform_params.rotation.to_matrix();
+    /** Make a prefab for spawning dynamic objects, like those created by `add_dynamic_object`. */
+    Prefab make_dynamic_prefab(Identifier object_id,
+                               const LoadModelParams& model_params,
+                               Opt<physics::DynamicBodyParameters> physics_params)
+    {
+        Prefab prefab = make_prefab(object_id, model_params);
 
         if (physics_params.has_value()) {
+            prefab.body_type = PrefabBodyType::dynamic_body;
+            prefab.dynamic_body_params = physics_params;
+
             const ResourceAccessGuard access =
                 m_resource_cache->access_resource<MeshResource>(model_params.mesh_file);
+            prefab.centre_of_mass = access->bounding_sphere().centre;
+        }
 
-            const glm::vec3 centre = access->bounding_sphere().centre;
-
-            physics::Shape* shape = m_physics_world->create_convex_hull(access->vertices(),
-                                                                        centre,
-                                                                        transform_params.scale);
+        return prefab;
+    }
 
-            m_entities.add_component<DynamicBodyComponent>(
-                entity,
-                m_physics_world->create_dynamic_body(object_id, *shape, physics_params.value(), M));
+    /** Create an instance of the prefab for each of the transforms. The entities are created in
+     * one batch, with all of their components, and share the prefab's mesh, materials, and
+     * physics shapes.
+     * @return The new entities, in the same order as the transforms.
+     */
+    std::vector<ecs::Entity> spawn_n(Prefab& prefab, std::span<const TransformParams> transforms)
+    {
+        MG_ASSERT(prefab.mesh);
+        const bool is_animated = prefab.mesh->animation_data != nullptr;
 
-            // Add visualization translation relative to centre of mass.
-            // Note unusual order: for once we translate before the scale, since the translation is
-            // in model space, not world space.
-            mesh.mesh_transform = glm::scale(transform_params.scale) * glm::translate(-centre);
+        ecs::ComponentMask mask = ecs::create_mask<TransformComponent, MeshComponent>();
+        if (is_animated) {
+            mask |= ecs::create_mask<AnimationComponent>();
+        }
+        if (prefab.body_type == PrefabBodyType::static_body) {
+            mask |= ecs::create_mask<StaticBodyComponent>();
         }
-        else {
-            transform.transform = M;
-            transform.previous_transform = M;
-            mesh.mesh_transform = glm::scale(transform_params.scale);
+        if (prefab.body_type == PrefabBodyType::dynamic_body) {
+            mask |= ecs::create_mask<DynamicBodyComponent>();
         }
 
-        return entity;
+        std::vector<ecs::Entity> entities(transforms.size());
+        m_entities.create_entities(mask, entities);
+
+        for (size_t i = 0; i < entities.size(); ++i) {
+            const TransformParams& params = transforms[i];
+            const ecs::Entity entity = entities[i];
+
+            auto& mesh = m_entities.get_component<MeshComponent>(entity);
+            mesh.mesh = prefab.mesh;
+            mesh.material_bindings = prefab.material_bindings;
+
+            if (is_animated) {
+                m_entities.get_component<AnimationComponent>(entity).pose =
+                    prefab.mesh->animation_data->skeleton.get_bind_pose();
+            }
+
+            const Transform scaled_transform{ params.position, params.scale, params.rotation };
+            auto& transform = m_entities.get_component<TransformComponent>(entity);
+
+            switch (prefab.body_type) {
+            case PrefabBodyType::none:
+                transform.transform = scaled_transform;
+                transform.previous_transform = scaled_transform;
+                break;
+
+            case PrefabBodyType::static_body:
+                m_entities.get_component<StaticBodyComponent>(entity).physics_body =
+                    m_physics_world->create_static_body(prefab.object_id,
+                                                        *prefab.static_shape,
+                                                        scaled_transform.matrix());
+                transform.transform = scaled_transform;
+                transform.previous_transform = scaled_transform;
+                break;
+
+            case PrefabBodyType::dynamic_body: {
+                // The physics body's transform has no scale; it is applied by the mesh transform.
+                const Transform unscaled_transform{ params.position,
+                                                    glm::vec3(1.0f),
+                                                    params.rotation };
+                m_entities.get_component<DynamicBodyComponent>(entity).physics_body =
+                    m_physics_world->create_dynamic_body(prefab.object_id,
+                                                         dynamic_shape(prefab, params.scale),
+                                                         prefab.dynamic_body_params.value(),
+                                                         unscaled_transform.matrix());
+                transform.transform = unscaled_transform;
+                transform.previous_transform = unscaled_transform;
+
+                // Add visualization translation relative to centre of mass.
+                // Note unusual order: for once we translate before the scale, since the
+                // translation is in model space, not world space.
+                mesh.mesh_transform =
+                    glm::scale(params.scale) * glm::translate(-prefab.centre_of_mass);
+                break;
+            }
+            }
+        }
+
+        return entities;
     }
 
     Window& window() { return m_window; }
@@ -215,9 +329,31 @@ public:
     ecs::EntityCollection& entities() { return m_entities; }
     const ecs::EntityCollection& entities() const { return m_entities; }
 
+    /** Command buffers for structural changes to `entities()` -- creating and deleting entities,
+     * adding and removing components -- from systems that run concurrently with others. Record
+     * into `entity_commands().local()`, with a sort key set as described for
+     * `ecs::ParallelCommandBuffer`; the commands are applied once all systems of the current
+     * simulation or render step have finished.
+     */
+    ecs::ParallelCommandBuffer& entity_commands() { return m_entity_commands; }
+
+    /** Per-thread arenas for transient data that only needs to live until the end of the next
+     * render step, e.g. `ArenaVector`s built by render systems. A new frame starts at the beginning
+     * of each render step; `frame_arena().last_frame_stats()` reports the previous frame's memory
+     * usage, including the high-water mark.
+     */
+    FrameArena& frame_arena() { return m_frame_arena; }
+
     gfx::SceneLights& scene_lights() { return *m_scene_lights; }
     const gfx::SceneLights& scene_lights() const { return *m_scene_lights; }
 
+    JobSystem& job_system() { return m_job_system; }
+
+    /** Levels of detail for animations, selected each frame by the size of the animated meshes
+     * as seen from `active_camera()`. See `update_animation_lods`.
+     */
+    AnimationLodSettings& animation_lod_settings() { return m_animation_lod_settings; }
+
     virtual const gfx::ICamera& active_camera() const = 0;
     virtual gfx::SceneRenderer& renderer() = 0;
 
@@ -225,6 +361,58 @@ public:
     virtual void on_render(double lerp_factor, const ApplicationTimeInfo& time_info) = 0;
 
 private:
+    struct SystemInfo {
+        Identifier name;
+        ecs::SystemAccess access;
+        ecs::SystemGraph::SystemFunction function;
+    };
+
+    // Resolve the mesh and materials of a model.
+    Prefab make_prefab(Identifier object_id, const LoadModelParams& params)
+    {
+        Prefab prefab;
+        prefab.object_id = object_id;
+        prefab.mesh_file = params.mesh_file;
+        prefab.mesh = m_mesh_pool->get_or_load(params.mesh_file);
+
+        for (auto&& [binding_id, filename] : params.material_bindings) {
+            prefab.material_bindings.push_back(
+                { .material_binding_id = binding_id,
+                  .material = m_material_pool->get_or_load(filename) });
+        }
+
+        for (auto&& submesh : prefab.mesh->submeshes) {
+            auto has_material = [&](const gfx::MaterialBinding& binding) {
+                return binding.material_binding_id == submesh.material_binding_id;
+            };
+            if (std::ranges::find_if(prefab.material_bindings, has_material) ==
+                prefab.material_bindings.end()) {
+                log.warning("Submesh '{}' with material_binding_id '{}' has no material assigned.",
+                            submesh.name.str_view(),
+                            submesh.material_binding_id.str_view());
+            }
+        }
+
+        return prefab;
+    }
+
+    // Get the prefab's convex hull shape for the given scale, creating it if necessary.
+    physics::Shape& dynamic_shape(Prefab& prefab, const glm::vec3& scale)
+    {
+        for (const auto& [shape_scale, shape] : prefab.dynamic_shapes) {
+            if (shape_scale == scale) {
+                return *shape;
+            }
+        }
+
+        const ResourceAccessGuard access =
+            m_resource_cache->access_resource<MeshResource>(prefab.mesh_file);
+        physics::Shape* shape =
+            m_physics_world->create_convex_hull(access->vertices(), prefab.centre_of_mass, scale);
+        prefab.dynamic_shapes.emplace_back(scale, shape);
+        return *shape;
+    }
+
     void on_window_focus_change(const bool is_focused)
     {
         if (is_focused) {
@@ -232,6 +420,95 @@ private:
         }
     }
 
+    // The user-overridable `on_simulation_step` and `on_render` may access anything, so they run
+    // exclusively on the main thread.
+    void build_system_graphs()
+    {
+        if (!m_should_rebuild_system_graphs) {
+            return;
+        }
+        m_should_rebuild_system_graphs = false;
+
+        using ecs::SystemAccess;
+
+        m_simulation_graph.clear();
+
+        m_simulation_graph.add_system("clear_debug_render_queue",
+                                      SystemAccess{}.writes_resource(k_debug_render_queue_resource),
+                                      [] { gfx::get_debug_render_queue().clear(); });
+
+        m_simulation_graph.add_system("poll_input_events",
+                                      SystemAccess{}
+                                          .writes_resource(k_window_resource)
+                                          .on_main_thread(),
+                                      [this] { m_window.poll_input_events(); });
+
+        m_simulation_graph.add_system(
+            "update_dynamic_body_transforms",
+            SystemAccess{}
+                .queries<const DynamicBodyComponent, ecs::Tracked<TransformComponent>>()
+                .reads_resource(k_physics_world_resource),
+            [this] { update_dynamic_body_transforms(m_entities, m_job_system); });
+
+        m_simulation_graph.add_system("on_simulation_step",
+                                      SystemAccess::exclusive().on_main_thread(),
+                                      [this] { on_simulation_step(m_time_info); });
+
+        for (const SystemInfo& system : m_simulation_systems) {
+            m_simulation_graph.add_system(system.name, system.access, system.function);
+        }
+
+        m_simulation_graph.add_system(
+            "physics_update",
+            SystemAccess{}.writes_resource(k_physics_world_resource),
+            [this] {
+                const auto timer_config = update_timer_config();
+                const auto time_step =
+                    narrow_cast<float>(1.0 / double(timer_config.simulation_steps_per_second));
+                m_physics_world->update(time_step);
+            });
+
+        m_render_graph.clear();
+
+        m_render_graph.add_system("update_animation_lods",
+                                  SystemAccess{}
+                                      .queries<const TransformComponent,
+                                               const MeshComponent,
+                                               AnimationComponent>(),
+                                  [this] {
+                                      update_animation_lods(m_entities,
+                                                            m_job_system,
+                                                            active_camera(),
+                                                            m_animation_lod_settings);
+                                  });
+
+        m_render_graph.add_system("advance_animations",
+                                  SystemAccess{}.queries<const MeshComponent, AnimationComponent>(),
+                                  [this] {
+                                      advance_animations(m_entities,
+                                                         m_job_system,
+                                                         float(m_time_info.time_since_init));
+                                  });
+
+        m_render_graph.add_system("on_render",
+                                  SystemAccess::exclusive().on_main_thread(),
+                                  [this] { on_render(m_lerp_factor, m_time_info); });
+
+        for (const SystemInfo& system : m_render_systems) {
+            m_render_graph.add_system(system.name, system.access, system.function);
+        }
+
+        m_render_graph.add_system("render_scene",
+                                  SystemAccess::exclusive().on_main_thread(),
+                                  [this] {
+                                      renderer().render({
+                                          .camera = active_camera(),
+                                          .time_since_init = float(m_time_info.time_since_init),
+                                      });
+                                      window().swap_buffers();
+                                  });
+    }
+
     Config m_config;
     Window m_window;
 
@@ -246,6 +523,21 @@ private:
     std::shared_ptr<gfx::SceneLights> m_scene_lights = std::make_shared<gfx::SceneLights>();
 
     ecs::EntityCollection m_entities;
+    ecs::ParallelCommandBuffer m_entity_commands;
+    FrameArena m_frame_arena;
+    AnimationLodSettings m_animation_lod_settings;
+
+    // The main thread also runs jobs while waiting for them.
+    JobSystem m_job_system{ std::max(std::thread::hardware_concurrency(), 2u) - 1u };
+
+    std::vector<SystemInfo> m_simulation_systems;
+    std::vector<SystemInfo> m_render_systems;
+    ecs::SystemGraph m_simulation_graph;
+    ecs::SystemGraph m_render_graph;
+    bool m_should_rebuild_system_graphs = true;
+
+    ApplicationTimeInfo m_time_info{};
+    double m_lerp_factor = 0.0;
 };
 
 } // namespace Mg
@@ -0,0 +1,55 @@
+//**************************************************************************************************
+// This file is part of Mg Engine. Copyright (c) 2026, Magnus Bergsten.
+// Mg Engine is made available under the terms of the 3-Clause BSD License.
+// See LICENSE.txt in the project's root directory.
+//**************************************************************************************************
+
+/** @file mg_directory_watcher.h
+ * Notifications of changes to files in a directory tree.
+ */
+
+#pragma once
+
+#include "mg/utils/mg_impl_ptr.h"
+#include "mg/utils/mg_macros.h"
+#include "mg/utils/mg_optional.h"
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace Mg::io {
+
+/** Watches a directory, including subdirectories, for changes to the files therein.
+ * Currently only supported on Linux (using inotify).
+ */
+class DirectoryWatcher {
+public:
+    /** Start watching the directory at the given UTF-8 path. Returns nullptr along with error
+     * reason if watching is not supported or fails.
+     */
+    static std::pair<std::unique_ptr<DirectoryWatcher>, std::string>
+    open(std::string_view directory);
+
+    MG_MAKE_NON_COPYABLE(DirectoryWatcher);
+    MG_MAKE_NON_MOVABLE(DirectoryWatcher);
+
+    /** Get the files that were created, modified, or removed since the watch began or since the
+     * previous call. Paths are relative to the watched directory, in generic format. Does not
+     * block.
+     * @return List of paths, or nullopt if the changes could not be determined (for example, if
+     * subdirectories were added or removed, or too many changes occurred). In that case, the
+     * caller should rescan the directory, and open a new DirectoryWatcher to continue watching.
+     */
+    Opt<std::vector<std::string>> poll_changed_files();
+
+private:
+    DirectoryWatcher();
+
+    struct Impl;
+    ImplPtr<Impl> m_impl;
+};
+
+} // namespace Mg::io
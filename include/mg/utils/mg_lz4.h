@@ -0,0 +1,43 @@
+//**************************************************************************************************
+// This file is part of Mg Engine. Copyright (c) 2026, Magnus Bergsten.
+// Mg Engine is made available under the terms of the 3-Clause BSD License.
+// See LICENSE.txt in the project's root directory.
+//**************************************************************************************************
+
+/** @file mg_lz4.h
+ * Compression and decompression of data in the LZ4 block format.
+ * This is a small, dependency-free implementation favouring fast decompression. The compressor is a
+ * simple greedy one, so it compresses less than the reference implementation, but its output is
+ * valid LZ4 block data.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <span>
+
+namespace Mg {
+
+/** Maximum size of compressed data for input of the given size. */
+constexpr size_t lz4_compress_bound(size_t input_size) noexcept
+{
+    return input_size + input_size / 255 + 16;
+}
+
+/** Compress data into LZ4 block format.
+ * @param source Data to compress.
+ * @param destination Output buffer. Will always suffice if at least
+ * `lz4_compress_bound(source.size())` bytes.
+ * @return Size of the compressed data, or 0 if it did not fit in destination.
+ */
+size_t lz4_compress(std::span<const std::byte> source, std::span<std::byte> destination) noexcept;
+
+/** Decompress LZ4 block data.
+ * @param source Compressed data.
+ * @param destination Output buffer, which must be exactly the size of the decompressed data.
+ * @return Whether decompression succeeded. Fails if the data is malformed or does not decompress
+ * to exactly the size of destination.
+ */
+bool lz4_decompress(std::span<const std::byte> source, std::span<std::byte> destination) noexcept;
+
+} // namespace Mg
@@ -0,0 +1,56 @@
+//**************************************************************************************************
+// This file is part of Mg Engine. Copyright (c) 2026, Magnus Bergsten.
+// Mg Engine is made available under the terms of the 3-Clause BSD License.
+// See LICENSE.txt in the project's root directory.
+//**************************************************************************************************
+
+/** @file mg_mapped_file.h
+ * Read-only memory-mapped files.
+ */
+
+#pragma once
+
+#include "mg/utils/mg_macros.h"
+#include "mg/utils/mg_optional.h"
+
+#include <cstddef>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+
+namespace Mg::io {
+
+/** Read-only memory mapping of a whole file. The mapping is released on destruction. */
+class MappedFile {
+public:
+    /** Map the file at the given UTF-8 path. Returns nullopt along with error reason if mapping
+     * fails.
+     */
+    static std::pair<Opt<MappedFile>, std::string> open(std::string_view filepath);
+
+    ~MappedFile();
+
+    MappedFile(MappedFile&& rhs) noexcept
+        : m_data(std::exchange(rhs.m_data, nullptr)), m_size(std::exchange(rhs.m_size, 0))
+    {}
+
+    MappedFile& operator=(MappedFile&& rhs) noexcept
+    {
+        std::swap(m_data, rhs.m_data);
+        std::swap(m_size, rhs.m_size);
+        return *this;
+    }
+
+    MG_MAKE_NON_COPYABLE(MappedFile);
+
+    std::span<const std::byte> bytes() const noexcept { return { m_data, m_size }; }
+
+private:
+    MappedFile(const std::byte* data, size_t size) noexcept : m_data(data), m_size(size) {}
+
+    const std::byte* m_data = nullptr;
+    size_t m_size = 0;
+};
+
+} // namespace Mg::io
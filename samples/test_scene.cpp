@@ -53,7 +53,7 @@ TestScene::TestScene()
           .window_title = window_title,
           .config_file_path = config_file,
           .file_loaders = make_file_loaders(),
-          .max_num_entities = 1024,
+          .entity_capacity = 1024,
       } }
 {
     MG_GFX_DEBUG_GROUP_BY_FUNCTION
@@ -116,6 +116,24 @@ TestScene::TestScene()
 
     create_entities();
     generate_lights();
+
+    // Runs after on_render, concurrently with other systems not touching these components.
+    add_render_system("enqueue_meshes_for_rendering",
+                      Mg::ecs::SystemAccess{}
+                          .queries<const Mg::TransformComponent,
+                                   const Mg::MeshComponent,
+                                   Mg::ecs::Maybe<const Mg::AnimationComponent>>()
+                          .writes_resource("MeshRenderCommands"),
+                      [this] {
+                          m_renderer_data->mesh_render_command_producer->clear();
+                          Mg::enqueue_meshes_for_rendering(entities(),
+                                                           job_system(),
+                                                           *m_renderer_data
+                                                                ->mesh_render_command_producer,
+                                                           float(lerp_factor()),
+                                                           m_transform_batch,
+                                                           frame_arena().local());
+                      });
 }
 
 TestScene::~TestScene()
@@ -209,12 +227,6 @@ void TestScene::on_render(const double lerp_factor, const Mg::ApplicationTimeInf
     camera.position.z += character_controller->current_height_smooth(float(lerp_factor)) * 0.90f;
     camera.exposure = -5.0f;
 
-    // Draw meshes and billboards.
-    m_renderer_data->mesh_render_command_producer->clear();
-    Mg::enqueue_meshes_for_rendering(entities(),
-                                     *m_renderer_data->mesh_render_command_producer,
-                                     float(lerp_factor));
-
     // Draw UI
     {
         m_renderer_data->ui_render_list->text_render_commands.clear();
@@ -293,7 +305,8 @@ void TestScene::render_skeleton_debug_geometry()
 
     for (auto [entity, transform, mesh, animation] :
          entities().get_with<Mg::TransformComponent, Mg::MeshComponent, Mg::AnimationComponent>()) {
-        Mg::gfx::get_debug_render_queue().draw_bones(transform.transform * mesh.mesh_transform,
+        Mg::gfx::get_debug_render_queue().draw_bones(transform.transform.matrix() *
+                                                         mesh.mesh_transform,
                                                      mesh.mesh->animation_data->skeleton,
                                                      animation.pose);
     }
@@ -61,5 +61,8 @@ private:
         std::make_shared<Mg::gfx::SimpleSceneRendererData>();
     std::unique_ptr<Mg::gfx::SceneRenderer> m_renderer;
 
+    // Reused by enqueue_meshes_for_rendering every frame.
+    Mg::TransformInterpolationBatch m_transform_batch;
+
     bool m_should_exit = false;
 };
@@ -0,0 +1,151 @@
+//**************************************************************************************************
+// This file is part of Mg Engine. Copyright (c) 2026, Magnus Bergsten.
+// Mg Engine is made available under the terms of the 3-Clause BSD License.
+// See LICENSE.txt in the project's root directory.
+//**************************************************************************************************
+
+#include "mg/core/ecs/mg_archetype.h"
+
+#include "mg/utils/mg_math_utils.h"
+
+#include <memory>
+
+namespace Mg::ecs {
+
+namespace {
+
+size_t align_up(size_t offset, size_t alignment)
+{
+    return (offset + alignment - 1) / alignment * alignment;
+}
+
+} // namespace
+
+Archetype::Archetype(ComponentMask mask, std::span<const ComponentTypeInfo> component_type_infos)
+    : m_mask{ mask }
+{
+    m_transitions.fill(k_no_archetype);
+
+    size_t row_size = sizeof(Slot_map_handle);
+
+    for (size_t id = 0; id < k_max_component_types; ++id) {
+        if (has_component(id)) {
+            const ComponentTypeInfo& info = component_type_infos[id];
+            MG_ASSERT(info.relocate && "Component type was not registered with EntityCollection.");
+            m_column_indices[id] = uint8_t(m_columns.size());
+            m_columns.push_back({ .type_info = info, .component_type_id = id, .offset = 0 });
+            row_size += info.size + sizeof(uint32_t);
+            m_chunk_alignment = max(m_chunk_alignment, info.alignment);
+        }
+    }
+
+    // Chunk change ticks, then entity handles, then the component arrays, then the arrays of
+    // change ticks.
+    m_entities_offset = align_up(sizeof(uint32_t) * m_columns.size(), alignof(Slot_map_handle));
+
+    // Lay out the columns for a given number of rows per chunk; returns the chunk size.
+    const auto layout = [&](uint32_t capacity) {
+        size_t offset = m_entities_offset + sizeof(Slot_map_handle) * capacity;
+        for (Column& column : m_columns) {
+            offset = align_up(offset, column.type_info.alignment);
+            column.offset = offset;
+            offset += column.type_info.size * capacity;
+        }
+        for (Column& column : m_columns) {
+            offset = align_up(offset, alignof(uint32_t));
+            column.change_ticks_offset = offset;
+            offset += sizeof(uint32_t) * capacity;
+        }
+        return offset;
+    };
+
+    // As many rows as fit in a chunk, accounting for alignment padding between columns.
+    m_chunk_capacity = uint32_t(max<size_t>(1, k_chunk_size / row_size));
+    m_chunk_size_bytes = layout(m_chunk_capacity);
+    while (m_chunk_size_bytes > k_chunk_size && m_chunk_capacity > 1) {
+        m_chunk_size_bytes = layout(--m_chunk_capacity);
+    }
+}
+
+Archetype::~Archetype()
+{
+    clear();
+}
+
+uint32_t Archetype::push_back_uninitialized(Slot_map_handle entity, const uint32_t change_tick)
+{
+    MG_ASSERT(m_size < std::numeric_limits<uint32_t>::max());
+
+    const size_t chunk_index = m_size / m_chunk_capacity;
+
+    if (chunk_index == m_chunks.size()) {
+        auto* memory = static_cast<std::byte*>(
+            ::operator new(m_chunk_size_bytes, std::align_val_t{ m_chunk_alignment }));
+        m_chunks.emplace_back(memory, ChunkDeleter{ m_chunk_alignment });
+    }
+
+    // Reset the chunk change ticks when a chunk starts being used, including a spare chunk.
+    if (m_size % m_chunk_capacity == 0) {
+        std::uninitialized_fill_n(chunk_change_ticks(chunk_index), m_columns.size(), 0u);
+    }
+
+    const uint32_t row = m_size++;
+    new (&entities(chunk_index)[row % m_chunk_capacity]) Slot_map_handle(entity);
+
+    for (const Column& column : m_columns) {
+        set_change_tick(row, column.component_type_id, change_tick);
+    }
+
+    return row;
+}
+
+Slot_map_handle Archetype::erase(const uint32_t row,
+                                 const ComponentMask relocated_components) noexcept
+{
+    MG_ASSERT_DEBUG(row < m_size);
+    const uint32_t last_row = m_size - 1;
+
+    for (const Column& column : m_columns) {
+        std::byte* component = component_ptr(row, column.component_type_id);
+
+        if ((relocated_components & (ComponentMask{ 1u } << column.component_type_id)) == 0) {
+            column.type_info.destroy(component);
+        }
+        if (row != last_row) {
+            column.type_info.relocate(component, component_ptr(last_row, column.component_type_id));
+            set_change_tick(row,
+                            column.component_type_id,
+                            change_tick(last_row, column.component_type_id));
+        }
+    }
+
+    Slot_map_handle& entity = entities(row / m_chunk_capacity)[row % m_chunk_capacity];
+    entity = entities(last_row / m_chunk_capacity)[last_row % m_chunk_capacity];
+    --m_size;
+
+    // Keep one spare chunk, to avoid repeatedly allocating and freeing a chunk when an entity
+    // moves back and forth across a chunk boundary.
+    if (m_chunks.size() > num_chunks() + 1) {
+        m_chunks.pop_back();
+    }
+
+    return row != last_row ? entity : Slot_map_handle{};
+}
+
+void Archetype::clear() noexcept
+{
+    for (size_t chunk_index = 0; chunk_index < num_chunks(); ++chunk_index) {
+        const uint32_t num_rows = chunk_size(chunk_index);
+        for (const Column& column : m_columns) {
+            std::byte* components = component_array(chunk_index, column.component_type_id);
+            for (uint32_t i = 0; i < num_rows; ++i) {
+                column.type_info.destroy(components + i * column.type_info.size);
+            }
+        }
+    }
+
+    m_size = 0;
+    m_chunks.clear();
+}
+
+} // namespace Mg::ecs
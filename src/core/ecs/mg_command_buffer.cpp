@@ -0,0 +1,204 @@
+//**************************************************************************************************
+// This file is part of Mg Engine. Copyright (c) 2026, Magnus Bergsten.
+// Mg Engine is made available under the terms of the 3-Clause BSD License.
+// See LICENSE.txt in the project's root directory.
+//**************************************************************************************************
+
+#include "mg/core/ecs/mg_command_buffer.h"
+
+#include "mg/core/containers/mg_small_vector.h"
+
+#include <algorithm>
+#include <atomic>
+#include <compare>
+
+namespace Mg::ecs {
+
+namespace {
+
+std::atomic_uint64_t g_next_parallel_command_buffer_id = 1;
+
+// The calling thread's most recently used CommandBuffer from a ParallelCommandBuffer, to avoid
+// locking in `ParallelCommandBuffer::local`.
+struct LocalCommandBuffer {
+    uint64_t owner_id = 0;
+    CommandBuffer* buffer = nullptr;
+};
+
+thread_local LocalCommandBuffer t_local_command_buffer;
+
+} // namespace
+
+CommandBuffer::CommandBuffer(size_t arena_block_size) : m_arena{ arena_block_size } {}
+
+CommandBuffer::~CommandBuffer()
+{
+    clear();
+}
+
+PendingEntity CommandBuffer::create_entity()
+{
+    const auto index = static_cast<uint32_t>(m_created_entities.size());
+    m_created_entities.emplace_back();
+    m_commands.push_back({ .sort_key = m_sort_key,
+                           .entity = {},
+                           .pending_entity = index,
+                           .type = CommandType::create_entity });
+    return PendingEntity{ index };
+}
+
+void CommandBuffer::delete_entity(Entity entity)
+{
+    m_commands.push_back(
+        { .sort_key = m_sort_key, .entity = entity, .type = CommandType::delete_entity });
+}
+
+void CommandBuffer::apply(EntityCollection& collection)
+{
+    CommandBuffer* buffers[] = { this };
+    apply(buffers, collection);
+}
+
+void CommandBuffer::clear() noexcept
+{
+    for (const Command& command : m_commands) {
+        if (command.component) {
+            command.component_ops->destroy(command.component);
+        }
+    }
+
+    m_commands.clear();
+    m_created_entities.clear();
+    m_arena.reset();
+    m_sort_key = 0;
+}
+
+void CommandBuffer::apply(std::span<CommandBuffer* const> buffers, EntityCollection& collection)
+{
+    // Ties in sort key are broken by position in the recording buffer, which does not depend on
+    // the buffer's thread, and only then by buffer.
+    struct CommandRef {
+        uint64_t sort_key;
+        uint32_t command_index;
+        uint32_t buffer_index;
+        auto operator<=>(const CommandRef&) const = default;
+    };
+
+    std::vector<CommandRef> order;
+    for (uint32_t buffer_index = 0; buffer_index < buffers.size(); ++buffer_index) {
+        const auto& commands = buffers[buffer_index]->m_commands;
+        for (uint32_t command_index = 0; command_index < commands.size(); ++command_index) {
+            order.push_back({ commands[command_index].sort_key, command_index, buffer_index });
+        }
+    }
+
+    // Commands are usually recorded in sort key order, in which case they need no sorting.
+    if (!std::ranges::is_sorted(order)) {
+        std::ranges::sort(order);
+    }
+
+    try {
+        for (const CommandRef& ref : order) {
+            CommandBuffer& buffer = *buffers[ref.buffer_index];
+            buffer.execute(buffer.m_commands[ref.command_index], collection);
+        }
+    }
+    catch (...) {
+        for (CommandBuffer* buffer : buffers) {
+            buffer->clear();
+        }
+        throw;
+    }
+
+    for (CommandBuffer* buffer : buffers) {
+        buffer->clear();
+    }
+}
+
+void CommandBuffer::execute(Command& command, EntityCollection& collection)
+{
+    Entity entity = command.entity;
+
+    if (command.pending_entity != k_no_pending_entity) {
+        Entity& created_entity = m_created_entities[command.pending_entity];
+        if (!created_entity.handle()) {
+            created_entity = collection.create_entity();
+        }
+        entity = created_entity;
+    }
+
+    // The entity may have been deleted by an earlier command, or before the buffer was applied.
+    if (!collection.exists(entity)) {
+        return;
+    }
+
+    switch (command.type) {
+    case CommandType::create_entity:
+        break;
+
+    case CommandType::delete_entity:
+        collection.delete_entity(entity);
+        break;
+
+    case CommandType::add_component:
+        command.component_ops->add(collection, entity, command.component);
+        command.component = nullptr;
+        break;
+
+    case CommandType::remove_component:
+        collection.remove_component(entity, command.component_type_id);
+        break;
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+
+ParallelCommandBuffer::ParallelCommandBuffer()
+    : m_id{ g_next_parallel_command_buffer_id.fetch_add(1, std::memory_order_relaxed) }
+{}
+
+ParallelCommandBuffer::~ParallelCommandBuffer() = default;
+
+CommandBuffer& ParallelCommandBuffer::local()
+{
+    LocalCommandBuffer& cached = t_local_command_buffer;
+    if (cached.owner_id == m_id) {
+        return *cached.buffer;
+    }
+
+    std::lock_guard lock{ m_mutex };
+    auto& buffer = m_buffers[std::this_thread::get_id()];
+    if (!buffer) {
+        buffer = std::make_unique<CommandBuffer>();
+    }
+
+    cached = { m_id, buffer.get() };
+    return *buffer;
+}
+
+void ParallelCommandBuffer::apply(EntityCollection& collection)
+{
+    small_vector<CommandBuffer*, 16> buffers;
+    for (auto& [thread_id, buffer] : m_buffers) {
+        buffers.push_back(buffer.get());
+    }
+    CommandBuffer::apply(buffers, collection);
+}
+
+void ParallelCommandBuffer::clear() noexcept
+{
+    for (auto& [thread_id, buffer] : m_buffers) {
+        buffer->clear();
+    }
+}
+
+size_t ParallelCommandBuffer::size() const noexcept
+{
+    size_t result = 0;
+    for (const auto& [thread_id, buffer] : m_buffers) {
+        result += buffer->size();
+    }
+    return result;
+}
+
+} // namespace Mg::ecs
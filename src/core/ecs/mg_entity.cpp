@@ -6,51 +6,201 @@
 
 #include "mg/core/ecs/mg_entity.h"
 
-#include "mg/utils/mg_gsl.h"
+#include <bit>
+#include <vector>
 
 namespace Mg::ecs {
 
+namespace {
+// Archetype of entities without components.
+constexpr uint32_t k_empty_archetype_index = 0;
+} // namespace
+
+EntityCollection::EntityCollection(uint32_t entity_capacity) : m_entity_data{ entity_capacity }
+{
+    [[maybe_unused]] const auto index = find_or_create_archetype(0);
+    MG_ASSERT(index == k_empty_archetype_index);
+}
+
 // Reset EntityCollection, destroying all entities and components
 void EntityCollection::reset() noexcept
 {
-    for (auto& ptr : m_component_collections) {
-        if (ptr != nullptr) {
-            ptr->clear();
-        }
+    for (auto& archetype : m_archetypes) {
+        archetype->clear();
     }
     m_entity_data.clear();
-    m_component_lists.clear();
 }
 
 Entity EntityCollection::create_entity()
 {
     Entity entity = m_entity_data.emplace();
-    data(entity).component_list_handle = m_component_lists.emplace();
+    EntityData& entity_data = data(entity);
+    entity_data.archetype_index = k_empty_archetype_index;
+    entity_data.row = m_archetypes[k_empty_archetype_index]->push_back_uninitialized(
+        entity.handle(), m_change_tick);
     return entity;
 }
 
-void EntityCollection::delete_entity(Entity entity)
+void EntityCollection::create_entities(const ComponentMask mask,
+                                       const std::span<Entity> entities_out)
 {
-    // Delete all components belonging to this Entity
-    for (uint32_t i = 0; i < k_max_component_types; ++i) {
-        // Remove component if it exists
-        if (has_component(entity, i)) {
-            const auto& handle = component_handle_ref(entity, i);
-            at(m_component_collections, i)->erase(handle);
+    const uint32_t archetype_index = find_or_create_archetype(mask);
+    Archetype& archetype = *m_archetypes[archetype_index];
+
+    std::vector<Slot_map_handle> handles(entities_out.size());
+    m_entity_data.emplace_n(handles);
+
+    size_t num_created = 0;
+    try {
+        for (; num_created < handles.size(); ++num_created) {
+            const Slot_map_handle handle = handles[num_created];
+            const uint32_t row = archetype.push_back_uninitialized(handle, m_change_tick);
+            construct_default_components(archetype, row);
+
+            EntityData& entity_data = m_entity_data[handle];
+            entity_data.mask = mask;
+            entity_data.archetype_index = archetype_index;
+            entity_data.row = row;
+            entities_out[num_created] = handle;
+        }
+    }
+    catch (...) {
+        for (size_t i = 0; i < num_created; ++i) {
+            delete_entity(entities_out[i]);
         }
+        m_entity_data.erase_n(std::span{ handles }.subspan(num_created));
+        throw;
     }
+}
 
-    // Delete components
-    m_component_lists.erase(data(entity).component_list_handle);
+void EntityCollection::delete_entity(Entity entity)
+{
+    const EntityData& entity_data = data(entity);
+
+    // Destroy components; another entity's components may be moved into the vacated row.
+    const Slot_map_handle moved_entity =
+        m_archetypes[entity_data.archetype_index]->erase(entity_data.row);
+    if (moved_entity) {
+        m_entity_data[moved_entity].row = entity_data.row;
+    }
 
     m_entity_data.erase(entity.handle());
 }
 
-Slot_map_handle& EntityCollection::component_handle_ref(Entity entity, size_t component_type_id)
+void EntityCollection::remove_component(Entity entity, size_t component_type_id)
 {
-    const auto& list_handle = data(entity).component_list_handle;
-    auto& handle_array = m_component_lists[list_handle];
-    return handle_array.at(component_type_id);
+    MG_ASSERT(has_component(entity, component_type_id) && "Removing non-existent component.");
+    move_entity(entity, archetype_transition(data(entity).archetype_index, component_type_id));
+}
+
+uint32_t EntityCollection::find_or_create_archetype(ComponentMask mask)
+{
+    if (auto it = m_archetype_indices.find(mask); it != m_archetype_indices.end()) {
+        return it->second;
+    }
+
+    const auto index = static_cast<uint32_t>(m_archetypes.size());
+    m_archetypes.push_back(std::make_unique<Archetype>(mask, m_component_type_infos));
+    m_archetype_indices[mask] = index;
+
+    // Keep the cached query results up to date.
+    std::lock_guard lock{ m_query_matches_mutex };
+    for (auto& [key, matches] : m_query_matches) {
+        if (m_archetypes.back()->matches(key.mask, key.not_mask)) {
+            matches->push_back(index);
+        }
+    }
+
+    return index;
+}
+
+std::span<const uint32_t> EntityCollection::matching_archetypes(ComponentMask mask,
+                                                                ComponentMask not_mask)
+{
+    std::lock_guard lock{ m_query_matches_mutex };
+
+    auto& matches = m_query_matches[QueryKey{ mask, not_mask }];
+    if (!matches) {
+        matches = std::make_unique<std::vector<uint32_t>>();
+        for (uint32_t i = 0; i < m_archetypes.size(); ++i) {
+            if (m_archetypes[i]->matches(mask, not_mask)) {
+                matches->push_back(i);
+            }
+        }
+    }
+
+    return *matches;
+}
+
+uint32_t EntityCollection::archetype_transition(uint32_t archetype_index, size_t component_type_id)
+{
+    Archetype& archetype = *m_archetypes[archetype_index];
+    uint32_t& result = archetype.transition(component_type_id);
+    if (result == Archetype::k_no_archetype) {
+        result = find_or_create_archetype(archetype.mask() ^
+                                          (ComponentMask{ 1u } << component_type_id));
+    }
+    return result;
+}
+
+void EntityCollection::construct_default_components(Archetype& archetype, const uint32_t row)
+{
+    ComponentMask constructed = 0;
+    try {
+        for (ComponentMask remaining = archetype.mask(); remaining != 0;
+             remaining &= remaining - 1) {
+            const auto component_type_id = static_cast<size_t>(std::countr_zero(remaining));
+            const ComponentTypeInfo& type_info = m_component_type_infos[component_type_id];
+            MG_ASSERT(type_info.default_construct && "Component is not default-constructible.");
+            type_info.default_construct(archetype.component_ptr(row, component_type_id));
+            constructed |= ComponentMask{ 1u } << component_type_id;
+        }
+    }
+    catch (...) {
+        for (ComponentMask remaining = constructed; remaining != 0; remaining &= remaining - 1) {
+            const auto component_type_id = static_cast<size_t>(std::countr_zero(remaining));
+            m_component_type_infos[component_type_id].destroy(
+                archetype.component_ptr(row, component_type_id));
+        }
+
+        // The row is the last one, so erasing it moves nothing; and its components are already
+        // destroyed.
+        archetype.erase(row, archetype.mask());
+        throw;
+    }
+}
+
+uint32_t EntityCollection::move_entity(Entity entity, uint32_t archetype_index)
+{
+    EntityData& entity_data = data(entity);
+    Archetype& source = *m_archetypes[entity_data.archetype_index];
+    Archetype& destination = *m_archetypes[archetype_index];
+    MG_ASSERT_DEBUG(&source != &destination);
+
+    // Components that are new to the entity count as changed.
+    const uint32_t destination_row =
+        destination.push_back_uninitialized(entity.handle(), m_change_tick);
+
+    const ComponentMask shared_components = source.mask() & destination.mask();
+    for (ComponentMask remaining = shared_components; remaining != 0; remaining &= remaining - 1) {
+        const auto component_type_id = static_cast<size_t>(std::countr_zero(remaining));
+        m_component_type_infos[component_type_id].relocate(
+            destination.component_ptr(destination_row, component_type_id),
+            source.component_ptr(entity_data.row, component_type_id));
+        destination.set_change_tick(destination_row,
+                                    component_type_id,
+                                    source.change_tick(entity_data.row, component_type_id));
+    }
+
+    const Slot_map_handle moved_entity = source.erase(entity_data.row, shared_components);
+    if (moved_entity) {
+        m_entity_data[moved_entity].row = entity_data.row;
+    }
+
+    entity_data.mask = destination.mask();
+    entity_data.archetype_index = archetype_index;
+    entity_data.row = destination_row;
+    return destination_row;
 }
 
 } // namespace Mg::ecs
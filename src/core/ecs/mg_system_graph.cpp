@@ -0,0 +1,218 @@
+//**************************************************************************************************
+// This file is part of Mg Engine. Copyright (c) 2026, Magnus Bergsten.
+// Mg Engine is made available under the terms of the 3-Clause BSD License.
+// See LICENSE.txt in the project's root directory.
+//**************************************************************************************************
+
+#include "mg/core/ecs/mg_system_graph.h"
+
+#include "mg/core/mg_job_system.h"
+#include "mg/utils/mg_assert.h"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <utility>
+
+namespace Mg::ecs {
+
+namespace {
+
+bool intersects(std::span<const Identifier> lhs, std::span<const Identifier> rhs)
+{
+    return std::ranges::any_of(lhs, [&](Identifier id) { return std::ranges::count(rhs, id) > 0; });
+}
+
+} // namespace
+
+bool SystemAccess::conflicts_with(const SystemAccess& other) const noexcept
+{
+    if (m_is_exclusive || other.m_is_exclusive) {
+        return true;
+    }
+
+    const bool components_conflict =
+        (m_write_components & (other.m_read_components | other.m_write_components)) != 0 ||
+        (other.m_write_components & m_read_components) != 0;
+
+    return components_conflict || intersects(m_write_resources, other.m_read_resources) ||
+           intersects(m_write_resources, other.m_write_resources) ||
+           intersects(other.m_write_resources, m_read_resources);
+}
+
+struct SystemGraph::RunState {
+    explicit RunState(size_t num_systems)
+        : num_pending_dependencies(new std::atomic_size_t[num_systems])
+        , main_thread_gates(new JobCounter[num_systems])
+    {}
+
+    JobSystem* job_system = nullptr;
+
+    // Counts the jobs of systems not running on the main thread.
+    JobCounter system_jobs;
+
+    // For systems not running on the main thread: number of unfinished dependencies. The system is
+    // started when it reaches zero.
+    std::unique_ptr<std::atomic_size_t[]> num_pending_dependencies;
+
+    // For systems running on the main thread: retained once per unfinished dependency, so that the
+    // main thread can wait for them while executing other jobs.
+    std::unique_ptr<JobCounter[]> main_thread_gates;
+
+    std::atomic_bool has_failed = false;
+    std::exception_ptr exception;
+    std::mutex exception_mutex;
+};
+
+SystemGraph::SystemGraph() = default;
+SystemGraph::~SystemGraph() = default;
+
+void SystemGraph::add_system(Identifier name, SystemAccess access, SystemFunction function)
+{
+    MG_ASSERT(!m_run_state || !m_run_state->job_system);
+
+    const size_t index = m_systems.size();
+    std::vector<bool> ancestors(index + 1, false);
+    std::vector<size_t> dependencies;
+
+    // Depend on the latest conflicting systems, skipping those already implied by another
+    // dependency. Systems are added in order, so ancestors of earlier systems are complete.
+    for (size_t i = index; i-- > 0;) {
+        if (ancestors[i] || !access.conflicts_with(m_systems[i].access)) {
+            continue;
+        }
+
+        dependencies.push_back(i);
+        ancestors[i] = true;
+        for (size_t j = 0; j < i; ++j) {
+            if (m_ancestors[i][j]) {
+                ancestors[j] = true;
+            }
+        }
+    }
+
+    for (size_t i = 0; i < m_ancestors.size(); ++i) {
+        m_ancestors[i].push_back(false);
+    }
+    m_ancestors.push_back(std::move(ancestors));
+
+    std::ranges::reverse(dependencies);
+    for (const size_t dependency : dependencies) {
+        m_systems[dependency].dependants.push_back(index);
+    }
+
+    m_systems.push_back({ .name = name,
+                          .access = std::move(access),
+                          .function = std::move(function),
+                          .dependencies = std::move(dependencies),
+                          .dependants = {} });
+
+    // Reallocated for the new number of systems on next run.
+    m_run_state.reset();
+}
+
+void SystemGraph::clear()
+{
+    MG_ASSERT(!m_run_state || !m_run_state->job_system);
+    m_systems.clear();
+    m_ancestors.clear();
+    m_run_state.reset();
+}
+
+void SystemGraph::run(JobSystem& job_system)
+{
+    if (m_systems.empty()) {
+        return;
+    }
+
+    if (!m_run_state) {
+        m_run_state = std::make_unique<RunState>(m_systems.size());
+    }
+
+    RunState& state = *m_run_state;
+    MG_ASSERT(!state.job_system && "SystemGraph::run is not reentrant.");
+    state.job_system = &job_system;
+    state.has_failed = false;
+    state.exception = nullptr;
+
+    for (size_t i = 0; i < m_systems.size(); ++i) {
+        const size_t num_dependencies = m_systems[i].dependencies.size();
+        if (m_systems[i].access.requires_main_thread()) {
+            job_system.retain(state.main_thread_gates[i], num_dependencies);
+        }
+        else {
+            state.num_pending_dependencies[i].store(num_dependencies, std::memory_order_relaxed);
+        }
+    }
+
+    for (size_t i = 0; i < m_systems.size(); ++i) {
+        if (!m_systems[i].access.requires_main_thread() && m_systems[i].dependencies.empty()) {
+            start_system_job(i);
+        }
+    }
+
+    // Main-thread systems in order; this is a valid order since dependencies are always on earlier
+    // systems.
+    for (size_t i = 0; i < m_systems.size(); ++i) {
+        if (m_systems[i].access.requires_main_thread()) {
+            job_system.wait(state.main_thread_gates[i]);
+            run_system(i);
+            on_system_finished(i);
+        }
+    }
+
+    job_system.wait(state.system_jobs);
+    state.job_system = nullptr;
+
+    if (state.exception) {
+        std::rethrow_exception(std::exchange(state.exception, nullptr));
+    }
+}
+
+void SystemGraph::run_system(const size_t system_index) noexcept
+{
+    RunState& state = *m_run_state;
+    if (state.has_failed.load(std::memory_order_relaxed)) {
+        return;
+    }
+
+    try {
+        m_systems[system_index].function();
+    }
+    catch (...) {
+        std::lock_guard lock{ state.exception_mutex };
+        if (!state.exception) {
+            state.exception = std::current_exception();
+        }
+        state.has_failed = true;
+    }
+}
+
+void SystemGraph::on_system_finished(const size_t system_index) noexcept
+{
+    RunState& state = *m_run_state;
+
+    for (const size_t dependant : m_systems[system_index].dependants) {
+        if (m_systems[dependant].access.requires_main_thread()) {
+            state.job_system->release(state.main_thread_gates[dependant]);
+        }
+        else if (state.num_pending_dependencies[dependant].fetch_sub(1, std::memory_order_acq_rel) ==
+                 1) {
+            start_system_job(dependant);
+        }
+    }
+}
+
+void SystemGraph::start_system_job(const size_t system_index) noexcept
+{
+    RunState& state = *m_run_state;
+    state.job_system->add_job(
+        [this, system_index] {
+            run_system(system_index);
+            on_system_finished(system_index);
+        },
+        state.system_jobs);
+}
+
+} // namespace Mg::ecs
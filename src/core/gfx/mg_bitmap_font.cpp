@@ -8,6 +8,7 @@
 
 #include "mg/core/containers/mg_array.h"
 #include "mg/core/containers/mg_small_vector.h"
+#include "mg/core/mg_linear_arena.h"
 #include "mg/core/mg_log.h"
 #include "mg/core/mg_runtime_error.h"
 #include "mg/core/mg_unicode.h"
@@ -313,23 +314,24 @@ BitmapFont::~BitmapFont() = default;
 namespace {
 
 struct BreakLinesResult {
-    Array<stbtt_aligned_quad> char_quads;
     float width;
     float height;
     size_t num_lines;
 };
 
 // Break text into multiple lines at '\n'-codepoints and wherever the line would exceed
-// `max_width_pixels`.
-BreakLinesResult break_lines(const std::u32string_view& text_codepoints,
+// `max_width_pixels`. Writes the quads, moved into their lines, to `result_quads`.
+BreakLinesResult break_lines(std::span<const char32_t> text_codepoints,
                              std::span<const stbtt_aligned_quad> single_line_quads,
+                             std::span<stbtt_aligned_quad> result_quads,
                              const Opt<int32_t> max_width_pixels,
                              const float line_height,
                              const float line_spacing_factor)
 {
     MG_ASSERT(text_codepoints.size() == single_line_quads.size());
+    MG_ASSERT(result_quads.size() == single_line_quads.size());
 
-    auto result_quads = Array<stbtt_aligned_quad>::make_copy(single_line_quads);
+    std::ranges::copy(single_line_quads, result_quads.begin());
     float width = 0.0f;
     size_t num_lines = 1;
 
@@ -405,37 +407,39 @@ BreakLinesResult break_lines(const std::u32string_view& text_codepoints,
     }
 
     const float height = line_height + y_offset;
-    return { std::move(result_quads), width, height, num_lines };
+    return { width, height, num_lines };
 };
 
 // Convert to UTF32 and filter out unprintable characters.
-std::u32string convert_and_filter(std::string_view text)
+ArenaVector<char32_t> convert_and_filter(std::string_view text, LinearArena& scratch)
 {
-    // Convert to codepoints.
-    bool utf8_error = false;
-    std::u32string codepoints = utf8_to_utf32(text, &utf8_error);
-    if (utf8_error) {
-        auto msg = std::format("FontHandler::prepare_text: invalid UTF-8 in string '{}'.", text);
-        log.warning(msg);
-    }
+    ArenaVector<char32_t> codepoints{ ArenaAllocator<char32_t>{ scratch } };
+    codepoints.reserve(text.size());
 
     // Filter out ASCII control characters, except for tabs, which we will turn into four spaces,
     // and line feeds, which are later handled by break_lines.
     auto is_ascii_ctrl_code = [](const char32_t c) { return (c != 10 && c < 32) || c == 127; };
-    const bool should_be_filtered =
-        std::find_if(codepoints.begin(), codepoints.end(), is_ascii_ctrl_code) != codepoints.end();
-
-    if (should_be_filtered) {
-        std::u32string filtered_text;
-        for (const char32_t c : codepoints) {
-            if (!is_ascii_ctrl_code(c)) {
-                filtered_text += c;
-            }
-            else if (c == '\t') {
-                filtered_text += U"    ";
-            }
+
+    bool utf8_error = false;
+    size_t i = 0;
+    while (i < text.size()) {
+        const auto [codepoint, num_bytes, valid] = get_unicode_codepoint_at(text, i);
+        i += num_bytes;
+
+        if (!valid) {
+            utf8_error = true;
+        }
+        else if (!is_ascii_ctrl_code(codepoint)) {
+            codepoints.push_back(codepoint);
+        }
+        else if (codepoint == '\t') {
+            codepoints.insert(codepoints.end(), 4, U' ');
         }
-        codepoints = filtered_text;
+    }
+
+    if (utf8_error) {
+        auto msg = std::format("FontHandler::prepare_text: invalid UTF-8 in string '{}'.", text);
+        log.warning(msg);
     }
 
     return codepoints;
@@ -445,16 +449,29 @@ std::u32string convert_and_filter(std::string_view text)
 
 PreparedText BitmapFont::prepare_text(std::string_view text_utf8,
                                       const TypeSetting& typesetting) const
+{
+    // Room for each character's code points (four, for tabs), two quads, and six vertices, so that
+    // all temporary data fits in a single block.
+    constexpr size_t bytes_per_char = 4 * sizeof(char32_t) + 2 * sizeof(stbtt_aligned_quad) +
+                                      6 * 4 * sizeof(float);
+    LinearArena scratch{ 1024 + text_utf8.size() * bytes_per_char };
+    return prepare_text(text_utf8, typesetting, scratch);
+}
+
+PreparedText BitmapFont::prepare_text(std::string_view text_utf8,
+                                      const TypeSetting& typesetting,
+                                      LinearArena& scratch) const
 {
     // Convert text to sequence of code points (while filtering out unprintable characters).
-    const std::u32string text_codepoints = convert_and_filter(text_utf8);
+    const ArenaVector<char32_t> text_codepoints = convert_and_filter(text_utf8, scratch);
     const auto line_height = static_cast<float>(font_size_pixels());
 
     // Get texture for font.
     MG_ASSERT(m_impl->texture.handle != TextureHandle::null_handle());
 
     // Get quads for each codepoint in the string.
-    auto char_quads = Array<stbtt_aligned_quad>::make_for_overwrite(text_codepoints.size());
+    ArenaVector<stbtt_aligned_quad> char_quads(text_codepoints.size(),
+                                               ArenaAllocator<stbtt_aligned_quad>{ scratch });
     {
         float x = 0.0f;
         float y = line_height;
@@ -488,12 +505,14 @@ PreparedText BitmapFont::prepare_text(std::string_view text_utf8,
     }
 
     // Break quads into multiple lines.
-    BreakLinesResult break_lines_result = break_lines(text_codepoints,
-                                                      char_quads,
-                                                      typesetting.max_width_pixels,
-                                                      line_height,
-                                                      typesetting.line_spacing_factor);
-    char_quads = std::move(break_lines_result.char_quads);
+    ArenaVector<stbtt_aligned_quad> line_quads(char_quads.size(),
+                                               ArenaAllocator<stbtt_aligned_quad>{ scratch });
+    const BreakLinesResult break_lines_result = break_lines(text_codepoints,
+                                                            char_quads,
+                                                            line_quads,
+                                                            typesetting.max_width_pixels,
+                                                            line_height,
+                                                            typesetting.line_spacing_factor);
     const float width = break_lines_result.width;
     const float height = break_lines_result.height;
 
@@ -506,10 +525,11 @@ PreparedText BitmapFont::prepare_text(std::string_view text_utf8,
     static_assert(sizeof(Vertex) == 2u * sizeof(glm::vec2)); // Assert no padding.
 
     static constexpr size_t verts_per_char = 6u;
-    auto vertices = Array<Vertex>::make_for_overwrite(text_codepoints.size() * verts_per_char);
+    ArenaVector<Vertex> vertices(text_codepoints.size() * verts_per_char,
+                                 ArenaAllocator<Vertex>{ scratch });
 
-    for (size_t i = 0; i < char_quads.size(); ++i) {
-        const stbtt_aligned_quad& q = char_quads[i];
+    for (size_t i = 0; i < line_quads.size(); ++i) {
+        const stbtt_aligned_quad& q = line_quads[i];
         const size_t offset = i * verts_per_char;
 
         // Normalize vertex positions into [0.0, 1.0] to simplify transformations (width and height
@@ -0,0 +1,205 @@
+//**************************************************************************************************
+// This file is part of Mg Engine. Copyright (c) 2026, Magnus Bergsten.
+// Mg Engine is made available under the terms of the 3-Clause BSD License.
+// See LICENSE.txt in the project's root directory.
+//**************************************************************************************************
+
+#include "mg/core/gfx/mg_compact_vertex.h"
+
+#include "mg/utils/mg_vector_normalized.h"
+
+#include <glm/geometric.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <glm/mat3x3.hpp>
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <limits>
+
+namespace Mg::gfx::mesh_data {
+
+namespace {
+
+// Unlike `normalize<int16_t>`, this rounds to nearest, which matters for the precision of the
+// tangent frame.
+int16_t to_snorm16(float value) noexcept
+{
+    constexpr float max = std::numeric_limits<int16_t>::max();
+    return static_cast<int16_t>(std::lround(std::clamp(value, -1.0f, 1.0f) * max));
+}
+
+} // namespace
+
+uint16_t float_to_half(const float value) noexcept
+{
+    uint32_t bits = std::bit_cast<uint32_t>(value);
+    const uint32_t sign = (bits >> 16) & 0x8000u;
+    bits &= 0x7FFFFFFFu;
+
+    // Infinity or NaN. NaN stays NaN.
+    if (bits >= 0x7F800000u) {
+        return static_cast<uint16_t>(sign | 0x7C00u | (bits > 0x7F800000u ? 0x0200u : 0u));
+    }
+
+    // Rounds to larger than the largest half (65504).
+    if (bits >= 0x477FF000u) {
+        return static_cast<uint16_t>(sign | 0x7C00u);
+    }
+
+    // Smaller than the smallest normal half: result is subnormal or zero. Adding 0.5 moves the
+    // value's significant bits into the position of a half subnormal's mantissa, with the rounding
+    // done by the floating-point addition.
+    if (bits < 0x38800000u) {
+        const float shifted = std::bit_cast<float>(bits) + 0.5f;
+        return static_cast<uint16_t>(sign | (std::bit_cast<uint32_t>(shifted) - 0x3F000000u));
+    }
+
+    // Normal number: rebias exponent and round mantissa to 10 bits, to nearest even.
+    const uint32_t mantissa_is_odd = (bits >> 13) & 1u;
+    bits -= (127u - 15u) << 23;
+    bits += 0xFFFu + mantissa_is_odd;
+    return static_cast<uint16_t>(sign | (bits >> 13));
+}
+
+float half_to_float(const uint16_t value) noexcept
+{
+    const uint32_t sign = uint32_t{ value & 0x8000u } << 16;
+    const uint32_t exponent = (value >> 10) & 0x1Fu;
+    const uint32_t mantissa = value & 0x3FFu;
+
+    if (exponent == 0) {
+        const float magnitude = static_cast<float>(mantissa) * 0x1p-24f;
+        return sign != 0 ? -magnitude : magnitude;
+    }
+
+    if (exponent == 0x1F) {
+        return std::bit_cast<float>(sign | 0x7F800000u | (mantissa << 13));
+    }
+
+    return std::bit_cast<float>(sign | ((exponent + 127u - 15u) << 23) | (mantissa << 13));
+}
+
+std::array<uint16_t, 4> quantize_position(const glm::vec3& position,
+                                          const AxisAlignedBoundingBox& quantization_box) noexcept
+{
+    constexpr float max = std::numeric_limits<uint16_t>::max();
+    const glm::vec3 extent = quantization_box.max_corner - quantization_box.min_corner;
+
+    std::array<uint16_t, 4> result = {};
+    for (glm::length_t i = 0; i < 3; ++i) {
+        const float t = extent[i] > 0.0f
+                            ? (position[i] - quantization_box.min_corner[i]) / extent[i]
+                            : 0.0f;
+        result[size_t(i)] = static_cast<uint16_t>(std::lround(std::clamp(t, 0.0f, 1.0f) * max));
+    }
+
+    return result;
+}
+
+glm::vec3 dequantize_position(const std::array<uint16_t, 4>& quantized_position,
+                              const AxisAlignedBoundingBox& quantization_box) noexcept
+{
+    const glm::vec3 extent = quantization_box.max_corner - quantization_box.min_corner;
+    const glm::vec3 t{ denormalize(quantized_position[0]),
+                       denormalize(quantized_position[1]),
+                       denormalize(quantized_position[2]) };
+    return quantization_box.min_corner + t * extent;
+}
+
+std::array<int16_t, 4> encode_qtangent(const glm::vec3& normal,
+                                       const glm::vec3& tangent,
+                                       const glm::vec3& bitangent) noexcept
+{
+    constexpr float epsilon = 1e-6f;
+
+    // Build an orthonormal, right-handed basis, tolerating degenerate input.
+    const glm::vec3 n = glm::length(normal) > epsilon ? glm::normalize(normal)
+                                                      : glm::vec3(0.0f, 0.0f, 1.0f);
+
+    glm::vec3 t = tangent - n * glm::dot(n, tangent);
+    if (glm::length(t) <= epsilon) {
+        const glm::vec3 axis = std::abs(n.x) < 0.9f ? glm::vec3(1.0f, 0.0f, 0.0f)
+                                                    : glm::vec3(0.0f, 1.0f, 0.0f);
+        t = axis - n * glm::dot(n, axis);
+    }
+    t = glm::normalize(t);
+
+    const glm::vec3 b = glm::cross(n, t);
+    const bool is_reflected = glm::dot(b, bitangent) < 0.0f;
+
+    glm::quat q = glm::normalize(glm::quat_cast(glm::mat3(t, b, n)));
+
+    // q and -q represent the same rotation, so the sign of w is free to encode handedness. To make
+    // that sign survive quantization, w must not be zero.
+    if (q.w < 0.0f) {
+        q = -q;
+    }
+
+    constexpr float bias = 1.0f / std::numeric_limits<int16_t>::max();
+    if (q.w < bias) {
+        const float factor = std::sqrt(1.0f - bias * bias);
+        q.x *= factor;
+        q.y *= factor;
+        q.z *= factor;
+        q.w = bias;
+    }
+
+    if (is_reflected) {
+        q = -q;
+    }
+
+    return { to_snorm16(q.x), to_snorm16(q.y), to_snorm16(q.z), to_snorm16(q.w) };
+}
+
+TangentFrame decode_qtangent(const std::array<int16_t, 4>& qtangent) noexcept
+{
+    const glm::vec4 q = glm::normalize(glm::vec4{ denormalize(qtangent[0]),
+                                                  denormalize(qtangent[1]),
+                                                  denormalize(qtangent[2]),
+                                                  denormalize(qtangent[3]) });
+    const float handedness = qtangent[3] < 0 ? -1.0f : 1.0f;
+
+    TangentFrame result;
+    result.tangent = { 1.0f - 2.0f * (q.y * q.y + q.z * q.z),
+                       2.0f * (q.x * q.y + q.w * q.z),
+                       2.0f * (q.x * q.z - q.w * q.y) };
+    result.bitangent = glm::vec3{ 2.0f * (q.x * q.y - q.w * q.z),
+                                  1.0f - 2.0f * (q.x * q.x + q.z * q.z),
+                                  2.0f * (q.y * q.z + q.w * q.x) } *
+                       handedness;
+    result.normal = { 2.0f * (q.x * q.z + q.w * q.y),
+                      2.0f * (q.y * q.z - q.w * q.x),
+                      1.0f - 2.0f * (q.x * q.x + q.y * q.y) };
+    return result;
+}
+
+CompactVertex compress_vertex(const Vertex& vertex,
+                              const AxisAlignedBoundingBox& quantization_box) noexcept
+{
+    CompactVertex result;
+    result.position = quantize_position(vertex.position, quantization_box);
+    result.tex_coord = { float_to_half(vertex.tex_coord.x), float_to_half(vertex.tex_coord.y) };
+    result.qtangent = encode_qtangent(vertex.normal.get(),
+                                      vertex.tangent.get(),
+                                      vertex.bitangent.get());
+    return result;
+}
+
+Vertex decompress_vertex(const CompactVertex& vertex,
+                         const AxisAlignedBoundingBox& quantization_box) noexcept
+{
+    const TangentFrame tangent_frame = decode_qtangent(vertex.qtangent);
+
+    Vertex result;
+    result.position = dequantize_position(vertex.position, quantization_box);
+    result.tex_coord = { half_to_float(vertex.tex_coord[0]),
+                         half_to_float(vertex.tex_coord[1]),
+                         0.0f };
+    result.normal = tangent_frame.normal;
+    result.tangent = tangent_frame.tangent;
+    result.bitangent = tangent_frame.bitangent;
+    return result;
+}
+
+} // namespace Mg::gfx::mesh_data
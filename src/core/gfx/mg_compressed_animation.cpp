@@ -0,0 +1,329 @@
+//**************************************************************************************************
+// This file is part of Mg Engine. Copyright (c) 2026, Magnus Bergsten.
+// Mg Engine is made available under the terms of the 3-Clause BSD License.
+// See LICENSE.txt in the project's root directory.
+//**************************************************************************************************
+
+#include "mg/core/gfx/mg_compressed_animation.h"
+
+#include "mg/core/gfx/mg_skeleton.h"
+#include "mg/utils/mg_assert.h"
+#include "mg/utils/mg_gsl.h"
+
+#include <glm/geometric.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <span>
+#include <vector>
+
+namespace Mg::gfx::mesh_data {
+
+namespace {
+
+// Largest magnitude of any but the largest component of a unit quaternion.
+constexpr float k_rotation_component_range = 0.70710678f;
+constexpr uint16_t k_rotation_component_mask = 0x7FFFu;
+
+constexpr float k_max_quantized = std::numeric_limits<uint16_t>::max();
+
+uint16_t quantize(const float value, const float min, const float extent) noexcept
+{
+    const float t = extent > 0.0f ? (value - min) / extent : 0.0f;
+    return static_cast<uint16_t>(std::lround(std::clamp(t, 0.0f, 1.0f) * k_max_quantized));
+}
+
+float dequantize(const uint16_t value, const float min, const float extent) noexcept
+{
+    return min + (float(value) / k_max_quantized) * extent;
+}
+
+// Angle of the rotation from l to r. Computed from the distance between the quaternions, since the
+// arc cosine of their dot product is imprecise for small angles.
+float angle_between(const glm::quat& l, glm::quat r) noexcept
+{
+    if (glm::dot(l, r) < 0.0f) {
+        r = -r;
+    }
+    return 4.0f * std::asin(std::min(glm::length(l - r) * 0.5f, 1.0f));
+}
+
+// Select the frames to keep as keys for a track, given its samples and the samples' values after
+// encoding and decoding. Interpolating, using `mix`, between the decoded values of the kept frames
+// reproduces every sample to within the tolerance, as measured by `distance`.
+template<typename T, typename Distance, typename Mix>
+std::vector<size_t> select_keys(const std::span<const T> samples,
+                                const std::span<const T> decoded,
+                                const T& identity,
+                                const float tolerance,
+                                Distance&& distance,
+                                Mix&& mix)
+{
+    MG_ASSERT(!samples.empty() && samples.size() == decoded.size());
+
+    const auto all_within_tolerance_of = [&](const T& value) {
+        return std::ranges::all_of(samples, [&](const T& sample) {
+            return distance(sample, value) <= tolerance;
+        });
+    };
+
+    if (all_within_tolerance_of(identity)) {
+        return {};
+    }
+    if (all_within_tolerance_of(decoded[0])) {
+        return { 0 };
+    }
+
+    const auto is_redundant_between = [&](const size_t a, const size_t b) {
+        for (size_t i = a + 1; i < b; ++i) {
+            const float x = float(i - a) / float(b - a);
+            if (distance(samples[i], mix(decoded[a], decoded[b], x)) > tolerance) {
+                return false;
+            }
+        }
+        return true;
+    };
+
+    // Greedily make each segment between keys as long as possible. Checking a segment costs time
+    // linear in its length, so instead of extending the segment one frame at a time, which would
+    // cost quadratic time, its length is doubled until it is no longer redundant, and the end is
+    // then found by binary search. This costs O(n log n) for a track of n frames. Since redundancy
+    // does not strictly decrease with segment length, segments may end somewhat earlier than they
+    // would when extended frame by frame.
+    std::vector<size_t> keys = { 0 };
+    const size_t last = samples.size() - 1;
+    size_t a = 0;
+    while (a < last) {
+        // A segment with no frames in between is always redundant.
+        size_t good = a + 1;
+        size_t bad = last + 1;
+
+        for (size_t length = 2; good < last; length *= 2) {
+            const size_t b = std::min(a + length, last);
+            if (!is_redundant_between(a, b)) {
+                bad = b;
+                break;
+            }
+            good = b;
+        }
+
+        while (bad - good > 1) {
+            const size_t mid = good + (bad - good) / 2;
+            if (is_redundant_between(a, mid)) {
+                good = mid;
+            }
+            else {
+                bad = mid;
+            }
+        }
+
+        keys.push_back(good);
+        a = good;
+    }
+
+    return keys;
+}
+
+} // namespace
+
+std::array<uint16_t, 3> compress_rotation(const glm::quat& rotation) noexcept
+{
+    const glm::quat q = glm::normalize(rotation);
+
+    glm::length_t largest = 0;
+    for (glm::length_t i = 1; i < 4; ++i) {
+        if (std::abs(q[i]) > std::abs(q[largest])) {
+            largest = i;
+        }
+    }
+
+    const float sign = q[largest] < 0.0f ? -1.0f : 1.0f;
+
+    std::array<uint16_t, 3> result = {};
+    size_t out = 0;
+    for (glm::length_t i = 0; i < 4; ++i) {
+        if (i == largest) {
+            continue;
+        }
+        const float t = (sign * q[i] / k_rotation_component_range) * 0.5f + 0.5f;
+        result[out++] = static_cast<uint16_t>(
+            std::lround(std::clamp(t, 0.0f, 1.0f) * k_rotation_component_mask));
+    }
+
+    result[0] |= static_cast<uint16_t>((largest & 1) << 15);
+    result[1] |= static_cast<uint16_t>((largest >> 1) << 15);
+    return result;
+}
+
+glm::quat decompress_rotation(const std::array<uint16_t, 3>& value) noexcept
+{
+    const auto largest = static_cast<glm::length_t>((value[0] >> 15) | ((value[1] >> 15) << 1));
+
+    glm::quat result(1.0f, 0.0f, 0.0f, 0.0f);
+    float sum_of_squares = 0.0f;
+    size_t in = 0;
+    for (glm::length_t i = 0; i < 4; ++i) {
+        if (i == largest) {
+            continue;
+        }
+        const float t = float(value[in++] & k_rotation_component_mask) /
+                        float(k_rotation_component_mask);
+        result[i] = (t * 2.0f - 1.0f) * k_rotation_component_range;
+        sum_of_squares += result[i] * result[i];
+    }
+
+    result[largest] = std::sqrt(std::max(1.0f - sum_of_squares, 0.0f));
+    return result;
+}
+
+glm::vec3 decompress_position(const std::array<uint16_t, 3>& value,
+                              const CompressedAnimationChannel& channel) noexcept
+{
+    return { dequantize(value[0], channel.position_min.x, channel.position_extent.x),
+             dequantize(value[1], channel.position_min.y, channel.position_extent.y),
+             dequantize(value[2], channel.position_min.z, channel.position_extent.z) };
+}
+
+float decompress_scale(const std::array<uint16_t, 3>& value,
+                       const CompressedAnimationChannel& channel) noexcept
+{
+    return dequantize(value[0], channel.scale_min, channel.scale_extent);
+}
+
+Opt<AnimationClip> compress_animation_clip(const AnimationClip& clip,
+                                           const AnimationCompressionSettings& settings)
+{
+    MG_ASSERT(!clip.is_compressed());
+    MG_ASSERT(settings.sample_rate > 0.0f);
+
+    // Adjust the sample rate so that the clip's duration is a whole number of frames.
+    const double duration = std::max(double(clip.duration_seconds), 0.0);
+    const double num_intervals =
+        duration > 0.0 ? std::max(std::ceil(duration * settings.sample_rate), 1.0) : 0.0;
+    if (num_intervals > std::numeric_limits<uint16_t>::max()) {
+        return nullopt;
+    }
+
+    const auto num_frames = static_cast<size_t>(num_intervals) + 1;
+    const float sample_rate = duration > 0.0 ? float(num_intervals / duration)
+                                             : settings.sample_rate;
+
+    std::vector<CompressedAnimationChannel> channels(clip.channels.size());
+    std::vector<uint16_t> frames;
+    std::vector<std::array<uint16_t, 3>> values;
+
+    std::vector<JointPose> poses(num_frames);
+    std::vector<glm::vec3> positions(num_frames);
+    std::vector<glm::vec3> decoded_positions(num_frames);
+    std::vector<glm::quat> rotations(num_frames);
+    std::vector<glm::quat> decoded_rotations(num_frames);
+    std::vector<float> scales(num_frames);
+    std::vector<float> decoded_scales(num_frames);
+    std::vector<std::array<uint16_t, 3>> encoded(num_frames);
+
+    const auto add_track = [&](CompressedAnimationTrack& track, std::span<const size_t> keys) {
+        track.first_key = narrow<uint32_t>(frames.size());
+        track.num_keys = narrow<uint32_t>(keys.size());
+        for (const size_t key : keys) {
+            frames.push_back(narrow<uint16_t>(key));
+            values.push_back(encoded[key]);
+        }
+    };
+
+    for (size_t channel_index = 0; channel_index < clip.channels.size(); ++channel_index) {
+        CompressedAnimationChannel& channel = channels[channel_index];
+
+        for (size_t frame = 0; frame < num_frames; ++frame) {
+            const double time = std::min(double(frame) / sample_rate, duration);
+            animate_joint(clip.channels[channel_index], time, poses[frame]);
+            positions[frame] = poses[frame].translation;
+            rotations[frame] = poses[frame].rotation.to_quaternion();
+            scales[frame] = poses[frame].scale;
+        }
+
+        // Positions.
+        {
+            glm::vec3 min = positions[0];
+            glm::vec3 max = positions[0];
+            for (const glm::vec3& position : positions) {
+                min = glm::min(min, position);
+                max = glm::max(max, position);
+            }
+            channel.position_min = min;
+            channel.position_extent = max - min;
+
+            for (size_t frame = 0; frame < num_frames; ++frame) {
+                const glm::vec3& position = positions[frame];
+                encoded[frame] = { quantize(position.x, min.x, channel.position_extent.x),
+                                   quantize(position.y, min.y, channel.position_extent.y),
+                                   quantize(position.z, min.z, channel.position_extent.z) };
+                decoded_positions[frame] = decompress_position(encoded[frame], channel);
+            }
+
+            const float quantization_error = 0.5f * glm::length(channel.position_extent) /
+                                             k_max_quantized;
+            const std::vector<size_t> keys = select_keys<glm::vec3>(
+                positions,
+                decoded_positions,
+                glm::vec3(0.0f),
+                settings.position_tolerance + quantization_error,
+                [](const glm::vec3& l, const glm::vec3& r) { return glm::distance(l, r); },
+                [](const glm::vec3& l, const glm::vec3& r, float x) { return glm::mix(l, r, x); });
+            add_track(channel.position_keys, keys);
+        }
+
+        // Rotations.
+        {
+            for (size_t frame = 0; frame < num_frames; ++frame) {
+                encoded[frame] = compress_rotation(rotations[frame]);
+                decoded_rotations[frame] = decompress_rotation(encoded[frame]);
+            }
+
+            // Interpolate as the sampler does, see `Rotation::mix`.
+            const std::vector<size_t> keys = select_keys<glm::quat>(
+                rotations,
+                decoded_rotations,
+                glm::quat(1.0f, 0.0f, 0.0f, 0.0f),
+                settings.rotation_tolerance,
+                angle_between,
+                [](const glm::quat& l, const glm::quat& r, float x) {
+                    return glm::slerp(l, r, x);
+                });
+            add_track(channel.rotation_keys, keys);
+        }
+
+        // Scales.
+        {
+            const auto [min, max] = std::ranges::minmax(scales);
+            channel.scale_min = min;
+            channel.scale_extent = max - min;
+
+            for (size_t frame = 0; frame < num_frames; ++frame) {
+                encoded[frame] = { quantize(scales[frame], min, channel.scale_extent), 0, 0 };
+                decoded_scales[frame] = decompress_scale(encoded[frame], channel);
+            }
+
+            const float quantization_error = 0.5f * channel.scale_extent / k_max_quantized;
+            const std::vector<size_t> keys = select_keys<float>(
+                scales,
+                decoded_scales,
+                1.0f,
+                settings.scale_tolerance + quantization_error,
+                [](float l, float r) { return std::abs(l - r); },
+                [](float l, float r, float x) { return l + (r - l) * x; });
+            add_track(channel.scale_keys, keys);
+        }
+    }
+
+    AnimationClip result;
+    result.name = clip.name;
+    result.duration_seconds = clip.duration_seconds;
+    result.compressed.sample_rate = sample_rate;
+    result.compressed.channels = Array<CompressedAnimationChannel>::make_copy(channels);
+    result.compressed.frames = Array<uint16_t>::make_copy(frames);
+    result.compressed.values = Array<std::array<uint16_t, 3>>::make_copy(values);
+    return result;
+}
+
+} // namespace Mg::gfx::mesh_data
@@ -7,8 +7,10 @@
 #include "mg/core/gfx/mg_debug_renderer.h"
 
 #include "mg/core/containers/mg_flat_map.h"
+#include "mg/core/mg_linear_arena.h"
 #include "mg/core/mg_rotation.h"
 #include "mg/core/gfx/mg_blend_modes.h"
+#include "mg/core/gfx/mg_compact_vertex.h"
 #include "mg/core/gfx/mg_joint.h"
 #include "mg/core/gfx/mg_mesh_data.h"
 #include "mg/core/gfx/mg_pipeline.h"
@@ -24,10 +26,15 @@
 #include <glm/gtc/constants.hpp>
 #include <glm/mat4x4.hpp>
 
+#include <algorithm>
 #include <array>
 #include <cmath>
 #include <cstdint>
+#include <memory>
 #include <mutex>
+#include <span>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
 namespace Mg::gfx {
@@ -556,6 +563,21 @@ void DebugRenderer::draw_normals(const IRenderTarget& render_target,
                                  const glm::mat4& M,
                                  const mesh_data::MeshDataView& mesh_data)
 {
+    if (mesh_data.vertex_format() == mesh_data::VertexFormat::Compact) {
+        const AxisAlignedBoundingBox quantization_box = mesh_data.aabb.value();
+        std::vector<mesh_data::Vertex> vertices;
+        vertices.reserve(mesh_data.compact_vertices.size());
+        for (const mesh_data::CompactVertex& vertex : mesh_data.compact_vertices) {
+            vertices.push_back(mesh_data::decompress_vertex(vertex, quantization_box));
+        }
+
+        mesh_data::MeshDataView decompressed = mesh_data;
+        decompressed.vertices = vertices;
+        decompressed.compact_vertices = {};
+        draw_normals(render_target, view_proj, M, decompressed);
+        return;
+    }
+
     for (const auto& vertex : mesh_data.vertices) {
         draw_line(render_target,
                   view_proj * M,
@@ -579,11 +601,61 @@ void DebugRenderer::draw_normals(const IRenderTarget& render_target,
 // DebugRenderQueue implementation
 //--------------------------------------------------------------------------------------------------
 
-using Job = std::function<
-    void(const IRenderTarget& render_target, DebugRenderer& renderer, const glm::mat4& view_proj)>;
+// A queued draw: a closure, allocated in the queue's arena, with its parameters.
+struct Job {
+    void* closure = nullptr;
+    void (*invoke)(void* closure,
+                   const IRenderTarget& render_target,
+                   DebugRenderer& renderer,
+                   const glm::mat4& view_proj) = nullptr;
+    void (*destroy)(void* closure) noexcept = nullptr;
+};
 
 struct DebugRenderQueue::Impl {
+    Impl() = default;
+    ~Impl() { clear(); }
+
+    MG_MAKE_NON_COPYABLE(Impl);
+    MG_MAKE_NON_MOVABLE(Impl);
+
+    // Enqueue a draw. Requires that the mutex is locked.
+    template<typename F> void push(F&& function)
+    {
+        using Closure = std::decay_t<F>;
+        // Grow before creating the closure, so that push_back cannot throw and leave the closure
+        // without an owner.
+        if (jobs.size() == jobs.capacity()) {
+            jobs.reserve(std::max<size_t>(16, 2 * jobs.capacity()));
+        }
+        Closure* closure = arena.create<Closure>(std::forward<F>(function));
+        jobs.push_back({ .closure = closure,
+                         .invoke =
+                             [](void* c,
+                                const IRenderTarget& render_target,
+                                DebugRenderer& renderer,
+                                const glm::mat4& view_proj) {
+                                 (*static_cast<Closure*>(c))(render_target, renderer, view_proj);
+                             },
+                         .destroy =
+                             [](void* c) noexcept { static_cast<Closure*>(c)->~Closure(); } });
+    }
+
+    // Destroy all jobs and reset the arena. Requires that the mutex is locked.
+    void clear() noexcept
+    {
+        for (const Job& job : jobs) {
+            job.destroy(job.closure);
+        }
+        jobs.clear();
+        arena.reset();
+    }
+
     std::mutex mutex;
+
+    // The jobs' closures and data are allocated in the arena, which is reset when the queue is
+    // cleared. Both the arena and the job list keep their memory, so once they have grown to hold
+    // a typical frame's debug draws, queueing does not allocate.
+    LinearArena arena;
     std::vector<Job> jobs;
 };
 
@@ -593,9 +665,9 @@ void DebugRenderQueue::draw_box(DebugRenderer::BoxDrawParams params, glm::mat4 t
 {
     std::lock_guard g{ m_impl->mutex };
 
-    m_impl->jobs.emplace_back([params, transform](const IRenderTarget& render_target,
-                                                  DebugRenderer& renderer,
-                                                  const glm::mat4& view_proj) {
+    m_impl->push([params, transform](const IRenderTarget& render_target,
+                                     DebugRenderer& renderer,
+                                     const glm::mat4& view_proj) {
         renderer.draw_box(render_target, view_proj * transform, params);
     });
 }
@@ -605,9 +677,9 @@ void DebugRenderQueue::draw_ellipsoid(DebugRenderer::EllipsoidDrawParams params,
 {
     std::lock_guard g{ m_impl->mutex };
 
-    m_impl->jobs.emplace_back([params, transform](const IRenderTarget& render_target,
-                                                  DebugRenderer& renderer,
-                                                  const glm::mat4& view_proj) {
+    m_impl->push([params, transform](const IRenderTarget& render_target,
+                                     DebugRenderer& renderer,
+                                     const glm::mat4& view_proj) {
         renderer.draw_ellipsoid(render_target, view_proj * transform, params);
     });
 }
@@ -618,8 +690,12 @@ void DebugRenderQueue::draw_line(std::span<const glm::vec3> points,
 {
     std::lock_guard g{ m_impl->mutex };
 
-    m_impl->jobs.emplace_back( //
-        [points = Array<glm::vec3>::make_copy(points),
+    auto* points_copy = static_cast<glm::vec3*>(
+        m_impl->arena.allocate(points.size_bytes(), alignof(glm::vec3)));
+    std::uninitialized_copy(points.begin(), points.end(), points_copy);
+
+    m_impl->push( //
+        [points = std::span<const glm::vec3>{ points_copy, points.size() },
          colour,
          width] //
         (const IRenderTarget& render_target, DebugRenderer& renderer, const glm::mat4& view_proj) {
@@ -633,9 +709,9 @@ void DebugRenderQueue::draw_bones(const glm::mat4& M,
 {
     std::lock_guard g{ m_impl->mutex };
 
-    m_impl->jobs.emplace_back([M, skeleton, pose](const IRenderTarget& render_target,
-                                                  DebugRenderer& renderer,
-                                                  const glm::mat4& view_proj) {
+    m_impl->push([M, skeleton, pose](const IRenderTarget& render_target,
+                                     DebugRenderer& renderer,
+                                     const glm::mat4& view_proj) {
         renderer.draw_bones(render_target, view_proj, M, skeleton, pose);
     });
 }
@@ -645,10 +721,9 @@ void DebugRenderQueue::draw_view_frustum(const glm::mat4& view_projection_frustu
 {
     std::lock_guard g{ m_impl->mutex };
 
-    m_impl->jobs.emplace_back([view_projection_frustum,
-                               max_distance](const IRenderTarget& render_target,
-                                             DebugRenderer& renderer,
-                                             const glm::mat4& view_proj) {
+    m_impl->push([view_projection_frustum, max_distance](const IRenderTarget& render_target,
+                                                         DebugRenderer& renderer,
+                                                         const glm::mat4& view_proj) {
         renderer.draw_view_frustum(render_target, view_proj, view_projection_frustum, max_distance);
     });
 }
@@ -659,15 +734,15 @@ void DebugRenderQueue::dispatch(const IRenderTarget& render_target,
 {
     std::lock_guard g{ m_impl->mutex };
 
-    for (Job& job : m_impl->jobs) {
-        job(render_target, renderer, view_proj_matrix);
+    for (const Job& job : m_impl->jobs) {
+        job.invoke(job.closure, render_target, renderer, view_proj_matrix);
     }
 }
 
 void DebugRenderQueue::clear()
 {
     std::lock_guard g{ m_impl->mutex };
-    m_impl->jobs.clear();
+    m_impl->clear();
 }
 
 } // namespace Mg::gfx
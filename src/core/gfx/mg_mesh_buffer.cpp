@@ -40,7 +40,7 @@ public:
     {
         MG_GFX_DEBUG_GROUP("MeshBuffer::Impl::create");
 
-        if (mesh_data.vertices.size_bytes() + m_vertex_buffer_offset > m_vertex_buffer_size) {
+        if (mesh_data.vertex_data().size() + m_vertex_buffer_offset > m_vertex_buffer_size) {
             return { nullptr, MeshBuffer::ReturnCode::Vertex_buffer_full };
         }
 
@@ -58,7 +58,7 @@ public:
         MakeMeshParams params = mesh_params_from_mesh_data(*m_pool_impl, mesh_data);
         const auto mesh_handle = make_mesh(*m_pool_impl, name, params);
 
-        m_vertex_buffer_offset += mesh_data.vertices.size_bytes();
+        m_vertex_buffer_offset += mesh_data.vertex_data().size();
         m_index_buffer_offset += mesh_data.indices.size_bytes();
 
         if (mesh_data.animation_data) {
@@ -20,6 +20,8 @@
 
 #include "mg_opengl_loader_glad.h"
 
+#include <glm/geometric.hpp>
+
 #include <plf_colony.h>
 
 #include <cstddef>
@@ -108,7 +110,7 @@ inline MakeMeshParams mesh_params_from_mesh_data(MeshPoolImpl& impl,
 
     MakeMeshParams params = {};
 
-    params.vertex_buffer = make_vertex_buffer(impl, mesh_data.vertices.size_bytes());
+    params.vertex_buffer = make_vertex_buffer(impl, mesh_data.vertex_data().size());
     params.index_buffer = make_index_buffer(impl, mesh_data.indices.size_bytes());
     params.influences_buffer =
         has_animation_data
@@ -118,6 +120,19 @@ inline MakeMeshParams mesh_params_from_mesh_data(MeshPoolImpl& impl,
     params.index_buffer_data_offset = 0;
     params.influences_buffer_data_offset = 0;
     params.mesh_data = mesh_data;
+
+    if (mesh_data.vertex_format() == mesh_data::VertexFormat::Compact) {
+        // The bounding box is required to interpret compact vertices, see `create`.
+        params.aabb = mesh_data.aabb.value();
+
+        // Without decoding the vertices, the best estimate is the sphere enclosing the box.
+        const glm::vec3 half_extent = (params.aabb.max_corner - params.aabb.min_corner) / 2.0f;
+        params.bounding_sphere = mesh_data.bounding_sphere.value_or(
+            BoundingSphere{ .centre = params.aabb.min_corner + half_extent,
+                            .radius = glm::length(half_extent) });
+        return params;
+    }
+
     params.bounding_sphere =
         mesh_data.bounding_sphere
             .or_else([&] { return calculate_mesh_bounding_sphere(mesh_data.vertices); })
@@ -206,8 +221,7 @@ inline AnimationData* make_animation_data(MeshPoolImpl& impl,
     std::ranges::copy(data.animation_clips, result.clips.begin());
     result.influences_buffer = influences_buffer;
     ++influences_buffer->num_users;
-    result.skeleton = Skeleton{ name, data.skeleton_root_transform, data.joints.size() };
-    std::ranges::copy(data.joints, result.skeleton.joints().begin());
+    result.skeleton = Skeleton{ name, data.skeleton_root_transform, data.joints };
     return &result;
 }
 
@@ -221,6 +235,7 @@ make_mesh_at(MeshPoolImpl& impl, Mesh& mesh, Identifier name, const MakeMeshPara
     mesh.name = name;
     mesh.bounding_sphere = params.bounding_sphere;
     mesh.aabb = params.aabb;
+    mesh.vertex_format = params.mesh_data.vertex_format();
 
     mesh.submeshes.resize(params.mesh_data.submeshes.size());
     std::ranges::copy(params.mesh_data.submeshes, mesh.submeshes.begin());
@@ -235,7 +250,7 @@ make_mesh_at(MeshPoolImpl& impl, Mesh& mesh, Identifier name, const MakeMeshPara
         mesh.vertex_buffer = params.vertex_buffer;
         ++mesh.vertex_buffer->num_users;
 
-        const auto vertex_data = std::as_bytes(params.mesh_data.vertices);
+        const auto vertex_data = params.mesh_data.vertex_data();
         const auto vertex_buffer_id = mesh.vertex_buffer->handle.as_gl_id();
 
         glBindBuffer(GL_ARRAY_BUFFER, vertex_buffer_id);
@@ -244,7 +259,12 @@ make_mesh_at(MeshPoolImpl& impl, Mesh& mesh, Identifier name, const MakeMeshPara
                         as<GLsizeiptr>(vertex_data.size()),
                         vertex_data.data());
 
-        setup_vertex_attributes(mesh_data::vertex_attributes);
+        if (mesh.vertex_format == mesh_data::VertexFormat::Compact) {
+            setup_vertex_attributes(mesh_data::compact_vertex_attributes);
+        }
+        else {
+            setup_vertex_attributes(mesh_data::vertex_attributes);
+        }
     }
 
     { // Upload index data to GPU
@@ -313,7 +333,7 @@ create(MeshPoolImpl& impl, const mesh_data::MeshDataView& mesh_data, Identifier
     MG_GFX_DEBUG_GROUP("MeshPoolImpl::create");
 
     // Check precondition
-    const bool has_vertices = !mesh_data.vertices.empty();
+    const bool has_vertices = mesh_data.num_vertices() > 0;
     const bool has_indices = !mesh_data.indices.empty();
 
     if (!has_vertices || !has_indices) {
@@ -321,6 +341,19 @@ create(MeshPoolImpl& impl, const mesh_data::MeshDataView& mesh_data, Identifier
         throw RuntimeError{ "MeshPool: cannot create mesh '{}': {}.", name.str_view(), problem };
     }
 
+    if (!mesh_data.vertices.empty() && !mesh_data.compact_vertices.empty()) {
+        throw RuntimeError{ "MeshPool: cannot create mesh '{}': both vertices and compact "
+                            "vertices were provided.",
+                            name.str_view() };
+    }
+
+    if (mesh_data.vertex_format() == mesh_data::VertexFormat::Compact &&
+        !mesh_data.aabb.has_value()) {
+        throw RuntimeError{ "MeshPool: cannot create mesh '{}': compact vertices require the "
+                            "bounding box against which they were quantized.",
+                            name.str_view() };
+    }
+
     const MakeMeshParams params = mesh_params_from_mesh_data(impl, mesh_data);
     return make_mesh(impl, name, params);
 }
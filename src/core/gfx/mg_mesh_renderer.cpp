@@ -16,6 +16,7 @@
 #include "mg/core/gfx/mg_light.h"
 #include "mg/core/gfx/mg_material.h"
 #include "mg/core/gfx/mg_matrix_uniform_handler.h"
+#include "mg/core/gfx/mg_mesh_data.h"
 #include "mg/core/gfx/mg_pipeline_pool.h"
 #include "mg/core/gfx/mg_render_command_list.h"
 #include "mg/core/gfx/mg_render_target.h"
@@ -44,6 +45,12 @@ constexpr uint32_t k_sampler_light_index_index = 9; // Index of sampler for ligh
 /** Location of '_matrix_index' vertex attribute in shader code. */
 constexpr uint32_t k_matrix_index_vertex_attrib_location = 8;
 
+/** Locations of '_position_offset' and '_position_scale' vertex attributes in shader code, used to
+ * dequantize the positions of compact vertices.
+ */
+constexpr uint32_t k_position_offset_vertex_attrib_location = 9;
+constexpr uint32_t k_position_scale_vertex_attrib_location = 10;
+
 /** Size of M and MVP matrix arrays uploaded to GPU. */
 constexpr uint32_t k_matrix_ubo_array_size = 128;
 
@@ -127,6 +134,7 @@ FrameBlock make_frame_block(const ICamera& camera,
 
 enum class MeshPipelinePoolKind { Static, Animated };
 PipelinePool make_mesh_pipeline_pool(const MeshPipelinePoolKind kind,
+                                     const mesh_data::VertexFormat vertex_format,
                                      const LightGridConfig& light_grid_config)
 {
     internal::MeshRendererFrameworkShaderParams params = {
@@ -134,6 +142,9 @@ PipelinePool make_mesh_pipeline_pool(const MeshPipelinePoolKind kind,
         .skinning_matrix_array_size =
             kind == MeshPipelinePoolKind::Animated ? k_skinning_matrix_ubo_array_size : 0,
         .matrix_index_vertex_attrib_binding_location = k_matrix_index_vertex_attrib_location,
+        .compact_vertices = vertex_format == mesh_data::VertexFormat::Compact,
+        .position_offset_vertex_attrib_binding_location = k_position_offset_vertex_attrib_location,
+        .position_scale_vertex_attrib_binding_location = k_position_scale_vertex_attrib_location,
         .light_grid_config = light_grid_config
     };
 
@@ -143,7 +154,7 @@ PipelinePool make_mesh_pipeline_pool(const MeshPipelinePoolKind kind,
         internal::mesh_renderer_fragment_shader_framework_code(params);
 
     PipelinePoolConfig config{};
-    config.name = "MeshRenderer";
+    config.name = params.compact_vertices ? "CompactMeshRenderer" : "MeshRenderer";
     config.preamble_shader_code = { VertexShaderCode{ framework_vertex_code },
                                     {},
                                     FragmentShaderCode{ framework_fragment_code } };
@@ -198,16 +209,30 @@ PipelinePool make_mesh_pipeline_pool(const MeshPipelinePoolKind kind,
 /** MeshRenderer's state. */
 struct MeshRenderer::Impl {
     Impl(const LightGridConfig& light_grid_config)
-        : static_mesh_pipeline_pool(
-              make_mesh_pipeline_pool(MeshPipelinePoolKind::Static, light_grid_config))
-        , animated_mesh_pipeline_pool(
-              make_mesh_pipeline_pool(MeshPipelinePoolKind::Animated, light_grid_config))
+        : static_mesh_pipeline_pool(make_mesh_pipeline_pool(MeshPipelinePoolKind::Static,
+                                                            mesh_data::VertexFormat::Standard,
+                                                            light_grid_config))
+        , animated_mesh_pipeline_pool(make_mesh_pipeline_pool(MeshPipelinePoolKind::Animated,
+                                                              mesh_data::VertexFormat::Standard,
+                                                              light_grid_config))
+        , compact_static_mesh_pipeline_pool(
+              make_mesh_pipeline_pool(MeshPipelinePoolKind::Static,
+                                      mesh_data::VertexFormat::Compact,
+                                      light_grid_config))
+        , compact_animated_mesh_pipeline_pool(
+              make_mesh_pipeline_pool(MeshPipelinePoolKind::Animated,
+                                      mesh_data::VertexFormat::Compact,
+                                      light_grid_config))
         , light_buffers(light_grid_config)
     {}
 
     PipelinePool static_mesh_pipeline_pool;
     PipelinePool animated_mesh_pipeline_pool;
 
+    // Pipelines for meshes with compact vertices (mesh_data::CompactVertex).
+    PipelinePool compact_static_mesh_pipeline_pool;
+    PipelinePool compact_animated_mesh_pipeline_pool;
+
     MatrixUniformHandler matrix_uniform_handler{ k_matrix_ubo_array_size, 2 };
     MatrixUniformHandler skinning_matrix_uniform_handler{ k_skinning_matrix_ubo_array_size, 1 };
 
@@ -270,6 +295,27 @@ void set_matrix_index(uint32_t index) noexcept
     glVertexAttribI1ui(k_matrix_index_vertex_attrib_location, index);
 }
 
+// Set the bounding box against which the next render command's vertex positions are quantized.
+void set_position_quantization_box(const AxisAlignedBoundingBox& box) noexcept
+{
+    const glm::vec3 scale = box.max_corner - box.min_corner;
+    glVertexAttrib3f(k_position_offset_vertex_attrib_location,
+                     box.min_corner.x,
+                     box.min_corner.y,
+                     box.min_corner.z);
+    glVertexAttrib3f(k_position_scale_vertex_attrib_location, scale.x, scale.y, scale.z);
+}
+
+PipelinePool& pipeline_pool_for(MeshRenderer::Impl& data, const RenderCommand& command)
+{
+    const bool is_skinned_mesh = command.num_skinning_matrices > 0;
+    if (command.position_quantization_box != nullptr) {
+        return is_skinned_mesh ? data.compact_animated_mesh_pipeline_pool
+                               : data.compact_static_mesh_pipeline_pool;
+    }
+    return is_skinned_mesh ? data.animated_mesh_pipeline_pool : data.static_mesh_pipeline_pool;
+}
+
 // Upload the next batch of transformation matrices.
 size_t upload_next_matrix_batch(MeshRenderer::Impl& data,
                                 const RenderCommandList& command_list,
@@ -310,7 +356,8 @@ void MeshRenderer::render(const ICamera& cam,
 
     const auto render_commands = command_list.render_commands();
     const Material* previous_material = nullptr;
-    bool previous_was_skinned_mesh = false;
+    const PipelinePool* previous_pipeline_pool = nullptr;
+    const AxisAlignedBoundingBox* previous_position_quantization_box = nullptr;
 
     // Number of iterations until we have consumed the transformation matrices so far uploaded to
     // the CPU.
@@ -325,30 +372,36 @@ void MeshRenderer::render(const ICamera& cam,
 
         const RenderCommand& command = render_commands[i];
         const bool is_skinned_mesh = command.num_skinning_matrices > 0;
-        auto* pipeline_pool = is_skinned_mesh ? &m_impl->animated_mesh_pipeline_pool
-                                              : &m_impl->static_mesh_pipeline_pool;
+        PipelinePool& pipeline_pool = pipeline_pool_for(*m_impl, command);
 
         MG_ASSERT_DEBUG(command.material != nullptr);
 
         const bool should_switch_pipeline = //
             !previous_pipeline_settings.has_value() ||
             command.vertex_array != previous_pipeline_settings->vertex_array ||
-            command.material != previous_material || previous_was_skinned_mesh != is_skinned_mesh;
+            command.material != previous_material || previous_pipeline_pool != &pipeline_pool;
 
         if (should_switch_pipeline) {
             auto pipeline_settings = make_pipeline_settings(render_target, command.vertex_array);
-            pipeline_pool->bind_material_pipeline(*command.material,
-                                                  pipeline_settings,
-                                                  binding_context);
+            pipeline_pool.bind_material_pipeline(*command.material,
+                                                 pipeline_settings,
+                                                 binding_context);
 
             previous_pipeline_settings = pipeline_settings;
             previous_material = command.material;
-            previous_was_skinned_mesh = is_skinned_mesh;
+            previous_pipeline_pool = &pipeline_pool;
         }
 
         // Set up mesh transform matrix index.
         set_matrix_index(i % k_matrix_ubo_array_size);
 
+        // Set up dequantization of compact vertex positions, if the mesh changed.
+        if (command.position_quantization_box != nullptr &&
+            command.position_quantization_box != previous_position_quantization_box) {
+            set_position_quantization_box(*command.position_quantization_box);
+            previous_position_quantization_box = command.position_quantization_box;
+        }
+
         // If render command is a skinned mesh, also upload skinning matrices.
         if (is_skinned_mesh) {
             m_impl->skinning_matrix_uniform_handler.set_matrix_array(
@@ -369,6 +422,8 @@ void MeshRenderer::drop_shaders()
     MG_GFX_DEBUG_GROUP("Mesh_renderer::drop_shaders")
     m_impl->static_mesh_pipeline_pool.drop_pipelines();
     m_impl->animated_mesh_pipeline_pool.drop_pipelines();
+    m_impl->compact_static_mesh_pipeline_pool.drop_pipelines();
+    m_impl->compact_animated_mesh_pipeline_pool.drop_pipelines();
 }
 
 } // namespace Mg::gfx
@@ -86,6 +86,8 @@ void RenderCommandProducer::add_mesh(const Mesh& mesh,
             command.begin = submesh.index_range.begin;
             command.amount = submesh.index_range.amount;
             command.material = material;
+            command.position_quantization_box =
+                mesh.vertex_format == mesh_data::VertexFormat::Compact ? &mesh.aabb : nullptr;
         }
     }
 }
@@ -102,8 +104,7 @@ void RenderCommandProducer::add_skinned_mesh(const Mesh& mesh,
     for (size_t i = num_commands_before; i < m_impl->render_commands_unsorted.size(); ++i) {
         RenderCommand& command = m_impl->render_commands_unsorted[i];
         command.skinning_matrices_begin = as<uint16_t>(skinning_matrix_palette.m_start_index);
-        command.num_skinning_matrices =
-            as<uint16_t>(skinning_matrix_palette.m_skinning_matrices.size());
+        command.num_skinning_matrices = skinning_matrix_palette.m_num_matrices;
     }
 }
 
@@ -126,9 +127,9 @@ RenderCommandProducer::allocate_skinning_matrix_palette(const Skeleton& skeleton
     const size_t skinning_matrices_begin = m_impl->commands.m_skinning_matrices.size();
     m_impl->commands.m_skinning_matrices.resize(skinning_matrices_begin + num_joints);
 
-    return SkinningMatrixPalette{ std::span(m_impl->commands.m_skinning_matrices)
-                                      .subspan(skinning_matrices_begin, num_joints),
-                                  as<uint16_t>(skinning_matrices_begin) };
+    return SkinningMatrixPalette{ m_impl->commands.m_skinning_matrices,
+                                  as<uint16_t>(skinning_matrices_begin),
+                                  num_joints };
 }
 
 void RenderCommandProducer::clear() noexcept
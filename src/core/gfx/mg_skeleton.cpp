@@ -6,12 +6,24 @@
 
 #include "mg/core/gfx/mg_skeleton.h"
 
+#include "mg/core/mg_job_system.h"
 #include "mg/core/mg_log.h"
 #include "mg/core/gfx/mg_animation.h"
+#include "mg/core/gfx/mg_compressed_animation.h"
+#include "mg/utils/mg_gsl.h"
+#include "mg/utils/mg_math_utils.h"
 
 #include <glm/mat3x3.hpp>
 #include <glm/mat4x4.hpp>
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
 namespace Mg::gfx {
 
 namespace {
@@ -50,56 +62,287 @@ JointPose affine_matrix_to_pose(const glm::mat4x4 m)
     return pose;
 }
 
-void calculate_pose_transformations_impl(const glm::mat4& parent_to_model,
-                                         const mesh_data::JointId current,
-                                         const std::span<const mesh_data::Joint> joints,
-                                         const std::span<const JointPose> joint_poses,
-                                         const std::span<glm::mat4> matrices_out)
+double key_time(const mesh_data::PositionKey& key)
 {
-    if (current == mesh_data::joint_id_none) {
-        return;
+    return key.time;
+}
+double key_time(const mesh_data::RotationKey& key)
+{
+    return key.time;
+}
+double key_time(const mesh_data::ScaleKey& key)
+{
+    return key.time;
+}
+
+// Keys of compressed animations are frame numbers.
+double key_time(const uint16_t frame)
+{
+    return double(frame);
+}
+
+// Index of the last key at or before time, or 0 if there is none. Starts at the hint -- the result
+// of a previous search -- if it is valid and not after time, stepping forward a few keys before
+// falling back to binary search over the remaining keys.
+template<typename Key>
+size_t find_key(const std::span<const Key> keys, const double time, const size_t hint)
+{
+    MG_ASSERT_DEBUG(!keys.empty());
+    constexpr size_t max_linear_steps = 4;
+
+    size_t search_begin = 0;
+
+    if (hint < keys.size() && key_time(keys[hint]) <= time) {
+        size_t index = hint;
+        for (size_t step = 0; step < max_linear_steps; ++step) {
+            if (index + 1 == keys.size() || key_time(keys[index + 1]) > time) {
+                return index;
+            }
+            ++index;
+        }
+        search_begin = index;
     }
 
-    MG_ASSERT_DEBUG(current <= joints.size());
-    MG_ASSERT_DEBUG(current <= matrices_out.size());
-    MG_ASSERT_DEBUG(current <= joint_poses.size());
+    const auto it = std::upper_bound(keys.begin() + narrow_cast<ptrdiff_t>(search_begin),
+                                     keys.end(),
+                                     time,
+                                     [](const double t, const Key& key) {
+                                         return t < key_time(key);
+                                     });
+    return it == keys.begin() ? 0 : narrow_cast<size_t>(it - keys.begin()) - 1;
+}
 
-    const glm::mat4 joint_to_parent = pose_to_matrix(joint_poses[current]);
-    matrices_out[current] = parent_to_model * joint_to_parent;
+struct KeyPair {
+    size_t index_a;
+    size_t index_b;
+    float factor;
+};
 
-    for (const mesh_data::JointId& child : joints[current].children) {
-        calculate_pose_transformations_impl(matrices_out[current],
-                                            child,
-                                            joints,
-                                            joint_poses,
-                                            matrices_out);
+// Find the keys surrounding time, using and updating the cursor, and return their indices along
+// with the interpolation factor between them.
+template<typename Key>
+KeyPair find_keys(const std::span<const Key> keys, const double time, uint32_t& cursor)
+{
+    const size_t index_a = find_key(keys, time, cursor);
+    const size_t index_b = min(index_a + 1, keys.size() - 1);
+    cursor = narrow_cast<uint32_t>(index_a);
+
+    const double time_a = key_time(keys[index_a]);
+    const double time_b = key_time(keys[index_b]);
+
+    // Clamp, so that times before the first key and after the last key get those keys' values.
+    const float factor =
+        time_a >= time_b
+            ? 0.0f
+            : clamp(narrow_cast<float>((time - time_a) / (time_b - time_a)), 0.0f, 1.0f);
+
+    return { index_a, index_b, factor };
+}
+
+void sample_channel(const mesh_data::AnimationChannel& animation_channel,
+                    const double time_seconds,
+                    AnimationCursor::ChannelKeys& cursor,
+                    JointPose& joint_pose_out)
+{
+    if (!animation_channel.position_keys.empty()) {
+        const std::span<const mesh_data::PositionKey> keys = animation_channel.position_keys;
+        const auto [a, b, factor] = find_keys(keys, time_seconds, cursor.position_key);
+        joint_pose_out.translation = glm::mix(keys[a].value, keys[b].value, factor);
+    }
+    else {
+        joint_pose_out.translation = glm::vec3(0.0f);
+    }
+
+    if (!animation_channel.rotation_keys.empty()) {
+        const std::span<const mesh_data::RotationKey> keys = animation_channel.rotation_keys;
+        const auto [a, b, factor] = find_keys(keys, time_seconds, cursor.rotation_key);
+        joint_pose_out.rotation =
+            Rotation::mix(Rotation(keys[a].value), Rotation(keys[b].value), factor);
+    }
+    else {
+        joint_pose_out.rotation = Rotation();
+    }
+
+    if (!animation_channel.scale_keys.empty()) {
+        const std::span<const mesh_data::ScaleKey> keys = animation_channel.scale_keys;
+        const auto [a, b, factor] = find_keys(keys, time_seconds, cursor.scale_key);
+        joint_pose_out.scale = glm::mix(keys[a].value, keys[b].value, factor);
+    }
+    else {
+        joint_pose_out.scale = 1.0f;
     }
 }
 
-void get_bind_pose_impl(const glm::mat4& inverse_parent_transformation,
-                        const mesh_data::JointId current,
-                        const std::span<const mesh_data::Joint> joints,
-                        const std::span<JointPose> joint_poses)
+// Like `sample_channel`, but for compressed animations, where time is given in frames.
+void sample_compressed_channel(const mesh_data::CompressedAnimation& animation,
+                               const mesh_data::CompressedAnimationChannel& channel,
+                               const double frame_time,
+                               AnimationCursor::ChannelKeys& cursor,
+                               JointPose& joint_pose_out)
 {
-    if (current == mesh_data::joint_id_none) {
-        return;
+    using Value = std::array<uint16_t, 3>;
+
+    const auto track_frames = [&](const mesh_data::CompressedAnimationTrack& track) {
+        return std::span<const uint16_t>(animation.frames).subspan(track.first_key,
+                                                                   track.num_keys);
+    };
+    const auto track_values = [&](const mesh_data::CompressedAnimationTrack& track) {
+        return std::span<const Value>(animation.values).subspan(track.first_key, track.num_keys);
+    };
+
+    if (channel.position_keys.num_keys > 0) {
+        const auto values = track_values(channel.position_keys);
+        const auto [a, b, factor] =
+            find_keys(track_frames(channel.position_keys), frame_time, cursor.position_key);
+        joint_pose_out.translation = glm::mix(mesh_data::decompress_position(values[a], channel),
+                                              mesh_data::decompress_position(values[b], channel),
+                                              factor);
+    }
+    else {
+        joint_pose_out.translation = glm::vec3(0.0f);
+    }
+
+    if (channel.rotation_keys.num_keys > 0) {
+        const auto values = track_values(channel.rotation_keys);
+        const auto [a, b, factor] =
+            find_keys(track_frames(channel.rotation_keys), frame_time, cursor.rotation_key);
+        joint_pose_out.rotation =
+            Rotation::mix(Rotation(mesh_data::decompress_rotation(values[a])),
+                          Rotation(mesh_data::decompress_rotation(values[b])),
+                          factor);
+    }
+    else {
+        joint_pose_out.rotation = Rotation();
+    }
+
+    if (channel.scale_keys.num_keys > 0) {
+        const auto values = track_values(channel.scale_keys);
+        const auto [a, b, factor] =
+            find_keys(track_frames(channel.scale_keys), frame_time, cursor.scale_key);
+        joint_pose_out.scale = glm::mix(mesh_data::decompress_scale(values[a], channel),
+                                        mesh_data::decompress_scale(values[b], channel),
+                                        factor);
+    }
+    else {
+        joint_pose_out.scale = 1.0f;
     }
+}
 
-    MG_ASSERT_DEBUG(current <= joints.size());
-    MG_ASSERT_DEBUG(current <= joint_poses.size());
+double wrap_time(const mesh_data::AnimationClip& clip, const double time_seconds)
+{
+    if (clip.duration_seconds <= 0.0f) {
+        return 0.0;
+    }
 
-    const glm::mat4& model_to_parent_joint = inverse_parent_transformation;
-    const glm::mat4 joint_to_model = glm::inverse(joints[current].inverse_bind_matrix);
-    const glm::mat4 joint_to_parent_joint = model_to_parent_joint * joint_to_model;
-    joint_poses[current] = affine_matrix_to_pose(joint_to_parent_joint);
+    const double time = std::fmod(time_seconds, double(clip.duration_seconds));
+    return time < 0.0 ? time + clip.duration_seconds : time;
+}
 
-    for (const mesh_data::JointId& child : joints[current].children) {
-        get_bind_pose_impl(joints[current].inverse_bind_matrix, child, joints, joint_poses);
+void sample_joint(const mesh_data::AnimationClip& clip,
+                  const double time,
+                  const size_t joint,
+                  AnimationCursor::ChannelKeys& cursor,
+                  JointPose& joint_pose_out)
+{
+    if (clip.is_compressed()) {
+        const mesh_data::CompressedAnimation& animation = clip.compressed;
+        sample_compressed_channel(animation,
+                                  animation.channels[joint],
+                                  time * animation.sample_rate,
+                                  cursor,
+                                  joint_pose_out);
+    }
+    else {
+        sample_channel(clip.channels[joint], time, cursor, joint_pose_out);
+    }
+}
+
+// Sample all channels of the clip, using and updating the cursor, if given.
+void sample_clip(const mesh_data::AnimationClip& clip,
+                 const double time_seconds,
+                 const std::span<JointPose> joint_poses_out,
+                 AnimationCursor* cursor)
+{
+    MG_ASSERT(clip.num_channels() == joint_poses_out.size());
+    const double time = wrap_time(clip, time_seconds);
+
+    if (cursor) {
+        cursor->channels.resize(joint_poses_out.size());
+    }
+
+    for (size_t i = 0; i < joint_poses_out.size(); ++i) {
+        AnimationCursor::ChannelKeys local_cursor;
+        AnimationCursor::ChannelKeys& channel_cursor = cursor ? cursor->channels[i]
+                                                              : local_cursor;
+        sample_joint(clip, time, i, channel_cursor, joint_poses_out[i]);
     }
 }
 
 } // namespace
 
+Skeleton::Skeleton(const Identifier id,
+                   const glm::mat4& root_transform,
+                   const std::span<const mesh_data::Joint> joints)
+    : m_id(id)
+    , m_joints(Array<mesh_data::Joint>::make_copy(joints))
+    , m_parents(Array<mesh_data::JointId>::make(joints.size(), mesh_data::joint_id_none))
+    , m_root_transform(root_transform)
+{
+    if (joints.empty()) {
+        return;
+    }
+
+    // Depth-first, pre-order traversal from the root, which is the order in which the mesh
+    // converter assigns JointIds. Children that are out of range or already visited -- which valid
+    // data does not have -- are ignored, so that the order is finite.
+    std::vector<mesh_data::JointId> order;
+    std::vector<bool> visited(joints.size(), false);
+    std::vector<mesh_data::JointId> stack = { 0 };
+    visited[0] = true;
+
+    while (!stack.empty()) {
+        const mesh_data::JointId current = stack.back();
+        stack.pop_back();
+        order.push_back(current);
+
+        const mesh_data::JointChildren& children = joints[current].children;
+        for (auto it = children.rbegin(); it != children.rend(); ++it) {
+            const mesh_data::JointId child = *it;
+            if (child == mesh_data::joint_id_none || child >= joints.size() || visited[child]) {
+                continue;
+            }
+            visited[child] = true;
+            m_parents[child] = current;
+            stack.push_back(child);
+        }
+    }
+
+    m_evaluation_order = Array<mesh_data::JointId>::make_copy(order);
+
+    // Since parents come before children in `order`, each parent's depth is known before its
+    // children's.
+    std::vector<size_t> depths(joints.size(), 0);
+    size_t max_depth = 0;
+    for (const mesh_data::JointId current : order) {
+        const mesh_data::JointId parent = m_parents[current];
+        depths[current] = parent == mesh_data::joint_id_none ? 0 : depths[parent] + 1;
+        max_depth = max(max_depth, depths[current]);
+    }
+
+    m_depth_ends = Array<size_t>::make(max_depth + 1, 0);
+    for (const mesh_data::JointId current : order) {
+        ++m_depth_ends[depths[current]];
+    }
+    for (size_t depth = 1; depth <= max_depth; ++depth) {
+        m_depth_ends[depth] += m_depth_ends[depth - 1];
+    }
+
+    std::ranges::stable_sort(order, [&](const mesh_data::JointId l, const mesh_data::JointId r) {
+        return depths[l] < depths[r];
+    });
+    m_joints_by_depth = Array<mesh_data::JointId>::make_copy(order);
+}
+
 Opt<mesh_data::JointId> Skeleton::find_joint(Identifier joint_name) const
 {
     mesh_data::JointId id = 0;
@@ -125,8 +368,17 @@ SkeletonPose Skeleton::get_bind_pose() const
 {
     SkeletonPose result;
     result.skeleton_id = id();
-    result.joint_poses = Array<JointPose>::make_for_overwrite(m_joints.size());
-    get_bind_pose_impl(glm::mat4(1.0f), 0, joints(), result.joint_poses);
+    result.joint_poses = Array<JointPose>::make(m_joints.size());
+
+    for (const mesh_data::JointId current : m_evaluation_order) {
+        const mesh_data::JointId parent = m_parents[current];
+        const glm::mat4 model_to_parent_joint = parent == mesh_data::joint_id_none
+                                                    ? glm::mat4(1.0f)
+                                                    : m_joints[parent].inverse_bind_matrix;
+        const glm::mat4 joint_to_model = glm::inverse(m_joints[current].inverse_bind_matrix);
+        result.joint_poses[current] = affine_matrix_to_pose(model_to_parent_joint * joint_to_model);
+    }
+
     return result;
 }
 
@@ -194,77 +446,103 @@ bool calculate_pose_transformations(const Skeleton& skeleton,
         return false;
     }
 
-    calculate_pose_transformations_impl(skeleton.root_transform(),
-                                        0,
-                                        skeleton.joints(),
-                                        pose.joint_poses,
-                                        matrices_out);
+    // Parents come before their children in the evaluation order, so the parent's matrix is always
+    // ready when it is needed.
+    const std::span<const mesh_data::JointId> parents = skeleton.parents();
+    for (const mesh_data::JointId current : skeleton.evaluation_order()) {
+        MG_ASSERT_DEBUG(current < pose.joint_poses.size());
+        const mesh_data::JointId parent = parents[current];
+        const glm::mat4& parent_to_model = parent == mesh_data::joint_id_none
+                                               ? skeleton.root_transform()
+                                               : matrices_out[parent];
+        matrices_out[current] = parent_to_model * pose_to_matrix(pose.joint_poses[current]);
+    }
+
     return true;
 }
 
-void animate_joint(const mesh_data::AnimationChannel& animation_channel,
-                   double time_seconds,
-                   JointPose& joint_pose_out)
-
+bool calculate_skinning_matrices(JobSystem& job_system,
+                                 const std::span<const SkinningMatricesJob> jobs)
 {
-    auto get_keys = [time_seconds](const auto& keys) {
-        const bool last_key_index = keys.size() - 1;
+    if (jobs.empty()) {
+        return true;
+    }
+
+    // Make each job large enough to be worth the overhead of scheduling it.
+    constexpr size_t min_joints_per_job = 256;
+    size_t num_joints = 0;
+    for (const SkinningMatricesJob& job : jobs) {
+        num_joints += job.skeleton->joints().size();
+    }
+    const size_t average_joints = max<size_t>(num_joints / jobs.size(), 1);
+    const size_t min_elems_per_job = max<size_t>(min_joints_per_job / average_joints, 1);
 
-        for (size_t i = 0; i < keys.size(); ++i) {
-            if (keys[i].time >= time_seconds) {
-                const size_t index_a = (i == 0 ? last_key_index : i - 1);
-                const size_t index_b = i;
+    std::atomic_bool success = true;
 
-                return std::make_pair(keys[index_a], keys[index_b]);
+    job_system.parallel_for_ranges(jobs.size(), min_elems_per_job, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            const SkinningMatricesJob& job = jobs[i];
+            if (!calculate_skinning_matrices(
+                    job.transform, *job.skeleton, *job.pose, job.skinning_matrices_out)) {
+                success.store(false, std::memory_order_relaxed);
             }
         }
+    });
 
-        return std::make_pair(keys[0], keys[0]);
-    };
+    return success.load(std::memory_order_relaxed);
+}
 
-    auto interpolation_factor = [time_seconds](const auto& key_a, const auto& key_b) {
-        return key_a.time == key_b.time
-                   ? 0.0f
-                   : narrow_cast<float>((time_seconds - key_a.time) / (key_b.time - key_a.time));
-    };
+void animate_joint(const mesh_data::AnimationChannel& animation_channel,
+                   const double time_seconds,
+                   JointPose& joint_pose_out)
+{
+    AnimationCursor::ChannelKeys cursor;
+    sample_channel(animation_channel, time_seconds, cursor, joint_pose_out);
+}
 
-    if (!animation_channel.position_keys.empty()) {
-        const auto [key_a, key_b] = get_keys(animation_channel.position_keys);
-        joint_pose_out.translation =
-            glm::mix(key_a.value, key_b.value, interpolation_factor(key_a, key_b));
-    }
-    else {
-        joint_pose_out.translation = glm::vec3(0.0f);
-    }
+void sample_animation_clip(const mesh_data::AnimationClip& clip,
+                           const double time_seconds,
+                           const std::span<JointPose> joint_poses_out)
+{
+    sample_clip(clip, time_seconds, joint_poses_out, nullptr);
+}
 
-    if (!animation_channel.rotation_keys.empty()) {
-        const auto [key_a, key_b] = get_keys(animation_channel.rotation_keys);
-        joint_pose_out.rotation = Rotation::mix(Rotation(key_a.value),
-                                                Rotation(key_b.value),
-                                                interpolation_factor(key_a, key_b));
-    }
-    else {
-        joint_pose_out.rotation = Rotation();
-    }
+void sample_animation_clip(const mesh_data::AnimationClip& clip,
+                           const double time_seconds,
+                           const std::span<JointPose> joint_poses_out,
+                           AnimationCursor& cursor)
+{
+    sample_clip(clip, time_seconds, joint_poses_out, &cursor);
+}
 
-    if (!animation_channel.scale_keys.empty()) {
-        const auto [key_a, key_b] = get_keys(animation_channel.scale_keys);
-        joint_pose_out.scale =
-            glm::mix(key_a.value, key_b.value, interpolation_factor(key_a, key_b));
-    }
-    else {
-        joint_pose_out.scale = 1.0f;
+void sample_animation_clip(const mesh_data::AnimationClip& clip,
+                           const double time_seconds,
+                           const std::span<JointPose> joint_poses_out,
+                           AnimationCursor& cursor,
+                           const std::span<const mesh_data::JointId> joints)
+{
+    MG_ASSERT(clip.num_channels() == joint_poses_out.size());
+    const double time = wrap_time(clip, time_seconds);
+
+    cursor.channels.resize(joint_poses_out.size());
+
+    for (const mesh_data::JointId joint : joints) {
+        MG_ASSERT_DEBUG(joint < joint_poses_out.size());
+        sample_joint(clip, time, joint, cursor.channels[joint], joint_poses_out[joint]);
     }
 }
 
 void animate_skeleton(const mesh_data::AnimationClip& clip, SkeletonPose& pose, double time_seconds)
 {
-    MG_ASSERT(clip.channels.size() == pose.joint_poses.size());
-    time_seconds = std::fmod(time_seconds, clip.duration_seconds);
+    sample_animation_clip(clip, time_seconds, pose.joint_poses);
+}
 
-    for (size_t i = 0; i < pose.joint_poses.size(); ++i) {
-        animate_joint(clip.channels[i], time_seconds, pose.joint_poses[i]);
-    }
+void animate_skeleton(const mesh_data::AnimationClip& clip,
+                      SkeletonPose& pose,
+                      double time_seconds,
+                      AnimationCursor& cursor)
+{
+    sample_animation_clip(clip, time_seconds, pose.joint_poses, cursor);
 }
 
 void blend_joint_poses(const JointPose& first,
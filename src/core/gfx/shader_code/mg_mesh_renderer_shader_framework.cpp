@@ -38,11 +38,52 @@ layout(std140) uniform FrameBlock {
 )";
 
 constexpr const auto vertex_framework_code = R"(
+#if COMPACT_VERTICES_ENABLED
+
+layout(location = POSITION_BINDING_LOCATION) in vec3 _vert_quantized_position;
+layout(location = TEX_COORD_BINDING_LOCATION) in vec2 _vert_half_tex_coord;
+layout(location = QTANGENT_BINDING_LOCATION) in vec4 _vert_qtangent;
+
+// Per-mesh bounding box against which positions are quantized.
+layout(location = POSITION_OFFSET_BINDING_LOCATION) in vec3 _position_offset;
+layout(location = POSITION_SCALE_BINDING_LOCATION) in vec3 _position_scale;
+
+// Decoded at the start of main(), so that the rest of the code is the same for both formats.
+vec3 vert_position;
+vec3 vert_tex_coord;
+vec3 vert_normal;
+vec3 vert_tangent;
+vec3 vert_bitangent;
+
+void _decode_compact_vertex()
+{
+    vert_position = _position_offset + _vert_quantized_position * _position_scale;
+    vert_tex_coord = vec3(_vert_half_tex_coord, 0.0);
+
+    // Tangent frame is the rotation matrix of the quaternion; sign of w is bitangent handedness.
+    vec4 q = normalize(_vert_qtangent);
+    vert_tangent = vec3(1.0 - 2.0 * (q.y * q.y + q.z * q.z),
+                        2.0 * (q.x * q.y + q.w * q.z),
+                        2.0 * (q.x * q.z - q.w * q.y));
+    vert_bitangent = vec3(2.0 * (q.x * q.y - q.w * q.z),
+                          1.0 - 2.0 * (q.x * q.x + q.z * q.z),
+                          2.0 * (q.y * q.z + q.w * q.x));
+    vert_normal = vec3(2.0 * (q.x * q.z + q.w * q.y),
+                       2.0 * (q.y * q.z - q.w * q.x),
+                       1.0 - 2.0 * (q.x * q.x + q.y * q.y));
+    vert_bitangent *= (_vert_qtangent.w < 0.0) ? -1.0 : 1.0;
+}
+
+#else
+
 layout(location = POSITION_BINDING_LOCATION) in vec3 vert_position;
 layout(location = TEX_COORD_BINDING_LOCATION) in vec3 vert_tex_coord;
 layout(location = NORMAL_BINDING_LOCATION) in vec3 vert_normal;
 layout(location = TANGENT_BINDING_LOCATION) in vec3 vert_tangent;
 layout(location = BITANGENT_BINDING_LOCATION) in vec3 vert_bitangent;
+
+#endif // COMPACT_VERTICES_ENABLED
+
 layout(location = JOINT_INFLUENCES_BINDING_LOCATION) in vec4 vert_joint_influences;
 layout(location = JOINT_WEIGHTS_BINDING_LOCATION) in vec4 vert_joint_weights;
 
@@ -93,6 +134,10 @@ void vertex_preprocess(inout VertexParams v_out);
 // Basic model vertex shader
 void main()
 {
+#if COMPACT_VERTICES_ENABLED
+    _decode_compact_vertex();
+#endif
+
 #if VERTEX_PREPROCESS_ENABLED
 
     VertexParams v_o;
@@ -374,13 +419,27 @@ mesh_renderer_vertex_shader_framework_code(const MeshRendererFrameworkShaderPara
     if (params.skinning_matrix_array_size > 0) {
         add_define(result, "SKELETAL_ANIMATION_ENABLED", 1);
     }
+    if (params.compact_vertices) {
+        add_define(result, "COMPACT_VERTICES_ENABLED", 1);
+    }
 
     // Add #defines for vertex attribute binding locations.
     {
         std::vector<VertexAttributeBinding> bindings;
-        std::ranges::transform(mesh_data::vertex_attributes,
-                               std::back_inserter(bindings),
-                               from_vertex_attribute);
+        if (params.compact_vertices) {
+            std::ranges::transform(mesh_data::compact_vertex_attributes,
+                                   std::back_inserter(bindings),
+                                   from_vertex_attribute);
+            bindings.push_back(
+                { "POSITION_OFFSET", params.position_offset_vertex_attrib_binding_location });
+            bindings.push_back(
+                { "POSITION_SCALE", params.position_scale_vertex_attrib_binding_location });
+        }
+        else {
+            std::ranges::transform(mesh_data::vertex_attributes,
+                                   std::back_inserter(bindings),
+                                   from_vertex_attribute);
+        }
         std::ranges::transform(mesh_data::influences_attributes,
                                std::back_inserter(bindings),
                                from_vertex_attribute);
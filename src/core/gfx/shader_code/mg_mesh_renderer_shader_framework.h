@@ -28,6 +28,16 @@ struct MeshRendererFrameworkShaderParams {
     /** Binding location of '_matrix_index' vertex attribute in shader code. */
     uint32_t matrix_index_vertex_attrib_binding_location = {};
 
+    // Whether the shader is for meshes with compact vertices (mesh_data::CompactVertex) rather
+    // than mesh_data::Vertex.
+    bool compact_vertices = false;
+
+    /** Binding locations of '_position_offset' and '_position_scale' vertex attributes in shader
+     * code, used to dequantize compact vertex positions.
+     */
+    uint32_t position_offset_vertex_attrib_binding_location = {};
+    uint32_t position_scale_vertex_attrib_binding_location = {};
+
     // Configuration relating to the light grid.
     LightGridConfig light_grid_config;
 };
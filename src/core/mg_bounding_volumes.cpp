@@ -33,7 +33,7 @@ AxisAlignedBoundingBox calculate_mesh_bounding_box(const std::span<const Vertex>
     }
 
     glm::vec3 abb_min(std::numeric_limits<float>::max());
-    glm::vec3 abb_max(std::numeric_limits<float>::min());
+    glm::vec3 abb_max(std::numeric_limits<float>::lowest());
 
     for (const auto& v : vertices) {
         abb_min.x = min(v.position.x, abb_min.x);
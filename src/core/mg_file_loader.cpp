@@ -31,15 +31,23 @@
 
 #include "mg/core/containers/mg_small_vector.h"
 #include "mg/core/mg_log.h"
+#include "mg/core/mg_pack_file_data.h"
 #include "mg/core/mg_runtime_error.h"
 #include "mg/utils/mg_file_io.h"
 #include "mg/utils/mg_file_time_helper.h"
+#include "mg/utils/mg_hash_fnv1a.h"
+#include "mg/utils/mg_lz4.h"
+#include "mg/utils/mg_mapped_file.h"
 #include "mg/utils/mg_string_utils.h"
 #include "mg/utils/mg_u8string_casts.h"
 
 #include <zip.h>
 
+#include <algorithm>
+#include <cstring>
 #include <filesystem>
+#include <format>
+#include <functional>
 
 namespace Mg {
 
@@ -51,6 +59,16 @@ namespace fs = std::filesystem;
 
 Array<FileRecord> BasicFileLoader::available_files()
 {
+    // Start watching before scanning, so that changes made during the scan are not missed.
+    {
+        std::lock_guard lock{ m_watcher_mutex };
+        auto [watcher, error_msg] = io::DirectoryWatcher::open(m_directory);
+        if (!watcher) {
+            log.verbose("Not watching '{}' for changes: {}", m_directory, error_msg);
+        }
+        m_watcher = std::move(watcher);
+    }
+
     small_vector<FileRecord, 48> index;
 
     fs::path root_dir{ m_directory };
@@ -78,6 +96,43 @@ Array<FileRecord> BasicFileLoader::available_files()
     return Array<FileRecord>::make_copy(index);
 }
 
+Opt<FileListDelta> BasicFileLoader::changed_files()
+{
+    std::lock_guard lock{ m_watcher_mutex };
+    if (!m_watcher) {
+        return nullopt;
+    }
+
+    Opt<std::vector<std::string>> changed_paths = m_watcher->poll_changed_files();
+    if (!changed_paths) {
+        // The watcher lost track; a new one is started by the rescan in available_files().
+        m_watcher.reset();
+        return nullopt;
+    }
+
+    FileListDelta delta;
+    for (const std::string& changed_path : *changed_paths) {
+        const auto file = Identifier::from_runtime_string(changed_path);
+        const auto path = fs::path(cast_as_u8_unchecked(m_directory)) /
+                          fs::path(cast_as_u8_unchecked(changed_path));
+
+        // The file may be removed at any point, in which case reading the time stamp throws.
+        std::error_code error;
+        try {
+            if (fs::exists(path, error) && !fs::is_directory(path, error)) {
+                delta.added_or_modified.push_back({ file, last_write_time_t(path) });
+                continue;
+            }
+        }
+        catch (const RuntimeError&) {
+        }
+
+        delta.removed.push_back(file);
+    }
+
+    return delta;
+}
+
 bool BasicFileLoader::file_exists(Identifier file)
 {
     const auto fname = file.str_view();
@@ -106,10 +161,8 @@ std::time_t BasicFileLoader::file_time_stamp(Identifier file)
     return last_write_time_t(file_path);
 }
 
-void BasicFileLoader::load_file(Identifier file, std::span<std::byte> target_buffer)
+std::string BasicFileLoader::path_to_file(Identifier file) const
 {
-    MG_ASSERT(target_buffer.size() >= file_size(file));
-
     const auto fname = file.str_view();
     const auto path = fs::path(m_directory) / fs::path(fname);
 
@@ -122,7 +175,14 @@ void BasicFileLoader::load_file(Identifier file, std::span<std::byte> target_buf
         };
     }
 
-    const auto u8path = cast_u8_to_char(path.generic_u8string());
+    return cast_u8_to_char(path.generic_u8string());
+}
+
+void BasicFileLoader::load_file(Identifier file, std::span<std::byte> target_buffer)
+{
+    MG_ASSERT(target_buffer.size() >= file_size(file));
+
+    const auto u8path = path_to_file(file);
     auto [istream, error_msg] = io::make_input_filestream(u8path, io::Mode::binary);
     if (!istream) {
         throw RuntimeError{ "Could not read file '{}': {}", u8path, error_msg };
@@ -141,23 +201,29 @@ void BasicFileLoader::load_file(Identifier file, std::span<std::byte> target_buf
 // Zip archive loading
 //--------------------------------------------------------------------------------------------------
 
-/** (Re-) open the zip archive for this reader. */
-void ZipFileLoader::open_zip_archive()
+namespace {
+
+// RAII wrapper, automatically closes zipfile on scope exit
+auto make_zip_handle(zip_file_t* p) noexcept
 {
-    if (m_archive_file != nullptr) {
-        const auto* error = zip_get_error(m_archive_file);
-        if (error->sys_err == 0 && error->zip_err == 0) {
-            return;
-        }
+    return std::unique_ptr<zip_file_t, decltype(&zip_fclose)>{ p, &zip_fclose };
+}
 
-        // If something is wrong, try to close and re-open archive
-        close_zip_archive();
+} // namespace
+
+ZipFileLoader::~ZipFileLoader()
+{
+    for (zip_t* handle : m_free_handles) {
+        zip_close(handle);
     }
+}
 
+zip_t* ZipFileLoader::open_zip_archive() const
+{
     int zip_error = 0;
-    m_archive_file = zip_open(m_archive_name.data(), ZIP_RDONLY, &zip_error);
+    zip_t* archive = zip_open(m_archive_name.data(), ZIP_RDONLY, &zip_error);
 
-    if (m_archive_file == nullptr) {
+    if (archive == nullptr) {
         zip_error_t error{};
         zip_error_init_with_code(&error, zip_error);
         std::string error_message = zip_error_strerror(&error);
@@ -165,163 +231,482 @@ void ZipFileLoader::open_zip_archive()
 
         throw RuntimeError{ "Failed to open archive '{}': {}", m_archive_name, error_message };
     }
+
+    return archive;
 }
 
-void ZipFileLoader::close_zip_archive() noexcept
+ZipFileLoader::FileLease ZipFileLoader::lease_file(Identifier file)
 {
-    if (m_archive_file != nullptr) {
-        zip_close(m_archive_file);
-        m_archive_file = nullptr;
+    std::shared_lock index_lock{ m_index_mutex };
+    if (!m_has_index) {
+        index_lock.unlock();
+        available_files();
+        return lease_file(file);
+    }
+
+    const IndexEntry* entry = find_in_index(file);
+    if (!entry) {
+        throw RuntimeError{
+            "ZipFileLoader: could not find file '{}' in archive '{}'", file.c_str(), m_archive_name
+        };
+    }
+
+    // The generation is read under the same index lock as the entry, so both refer to the same
+    // version of the archive.
+    {
+        std::lock_guard handles_lock{ m_handles_mutex };
+        if (!m_free_handles.empty()) {
+            zip_t* handle = m_free_handles.back();
+            m_free_handles.pop_back();
+            return { *entry, HandleLease{ *this, handle, m_handles_generation } };
+        }
     }
+
+    // All handles are in use by other threads: open a new one. This is done outside of the handle
+    // lock, since it reads from disk, but still under the index lock, so that the archive is not
+    // re-indexed before the handle is opened.
+    const uint32_t generation = m_handles_generation;
+    return { *entry, HandleLease{ *this, open_zip_archive(), generation } };
 }
 
-Array<FileRecord> ZipFileLoader::available_files()
+void ZipFileLoader::release_handle(zip_t* handle, const uint32_t generation) noexcept
 {
-    open_zip_archive();
-    const auto num_files = zip_get_num_entries(m_archive_file, 0);
+    {
+        std::lock_guard lock{ m_handles_mutex };
+        const auto* error = zip_get_error(handle);
+        const bool is_ok = error->sys_err == 0 && error->zip_err == 0;
+
+        if (is_ok && generation == m_handles_generation) {
+            m_free_handles.push_back(handle);
+            return;
+        }
+    }
 
-    auto index = Array<FileRecord>::make_for_overwrite(as<size_t>(num_files));
+    // Archive has changed since the handle was opened, or the handle is in an error state.
+    zip_close(handle);
+}
+
+Array<FileRecord> ZipFileLoader::available_files()
+{
+    // Get time stamp before opening, so that a concurrent modification is detected next time.
+    const std::time_t archive_time_stamp = last_write_time_t(
+        fs::path(cast_as_u8_unchecked(m_archive_name)));
 
-    for (uint32_t i = 0; i < num_files; ++i) {
-        const char* filename = zip_get_name(m_archive_file, i, 0);
+    // The archive may have changed on disk, so read the central directory from a fresh handle.
+    zip_t* archive = open_zip_archive();
+    const auto num_entries = zip_get_num_entries(archive, 0);
 
-        std::time_t last_write_time = -1;
+    std::vector<IndexEntry> index;
+    index.reserve(as<size_t>(std::max<zip_int64_t>(num_entries, 0)));
 
+    for (uint64_t i = 0; i < as<uint64_t>(num_entries); ++i) {
         struct zip_stat stat = {};
-        zip_stat(m_archive_file, filename, 0, &stat);
+        if (zip_stat_index(archive, i, 0, &stat) == -1 || (stat.valid & ZIP_STAT_NAME) == 0) {
+            log.warning("Failed to read entry {} in archive '{}'.", i, m_archive_name);
+            continue;
+        }
+
+        // Skip directory entries.
+        const std::string_view filename = stat.name;
+        if (filename.empty() || filename.back() == '/') {
+            continue;
+        }
+
+        IndexEntry& entry = index.emplace_back();
+        entry.filename = Identifier::from_runtime_string(filename);
+        entry.lookup_hash = hash_fnv1a(to_lower(filename));
+        entry.zip_index = i;
+
+        if ((stat.valid & ZIP_STAT_SIZE) != 0) {
+            entry.size = stat.size;
+        }
+        else {
+            log.warning("Failed to get size of file '{}' in archive '{}'.",
+                        filename,
+                        m_archive_name);
+        }
 
         if ((stat.valid & ZIP_STAT_MTIME) != 0) {
-            last_write_time = stat.mtime;
+            entry.time_stamp = stat.mtime;
         }
         else {
             constexpr auto msg = "Failed to get time stamp of file '{}' in archive '{}'.";
             log.warning(msg, filename, m_archive_name);
         }
 
-        index[i] = FileRecord{ Identifier::from_runtime_string(filename), last_write_time };
+        if ((stat.valid & ZIP_STAT_COMP_METHOD) != 0) {
+            entry.compression_method = stat.comp_method;
+        }
     }
 
-    return index;
-}
+    std::ranges::sort(index, std::less{}, &IndexEntry::lookup_hash);
 
-bool ZipFileLoader::file_exists(Identifier file)
-{
-    open_zip_archive();
-    struct zip_stat sb {};
-    const int result = zip_stat(m_archive_file, file.c_str(), 0, &sb);
+    auto result = Array<FileRecord>::make_for_overwrite(index.size());
+    for (size_t i = 0; i < index.size(); ++i) {
+        result[i] = FileRecord{ index[i].filename, index[i].time_stamp };
+    }
+
+    // Replace the index, invalidate handles to the old version of the archive, and keep the new
+    // one.
+    std::vector<zip_t*> stale_handles;
+    {
+        std::unique_lock index_lock{ m_index_mutex };
+        m_index = std::move(index);
+        m_has_index = true;
+        m_indexed_archive_time_stamp = archive_time_stamp;
+
+        std::lock_guard handles_lock{ m_handles_mutex };
+        ++m_handles_generation;
+        stale_handles = std::exchange(m_free_handles, { archive });
+    }
+    for (zip_t* handle : stale_handles) {
+        zip_close(handle);
+    }
 
-    return (result != -1);
+    return result;
 }
 
-struct zip_stat zip_stat_helper(zip_t* archive, Identifier file_path)
+Opt<FileListDelta> ZipFileLoader::changed_files()
 {
-    struct zip_stat sb {};
+    std::shared_lock lock{ m_index_mutex };
+    const auto time_stamp = last_write_time_t(fs::path(cast_as_u8_unchecked(m_archive_name)));
+    if (!m_has_index || time_stamp != m_indexed_archive_time_stamp) {
+        return nullopt;
+    }
+    return FileListDelta{};
+}
 
-    if (zip_stat(archive, file_path.c_str(), 0, &sb) != -1) {
-        return sb;
+const ZipFileLoader::IndexEntry* ZipFileLoader::find_in_index(Identifier file) const
+{
+    const std::string lookup_name = to_lower(file.str_view());
+    const auto [first, last] = std::ranges::equal_range(
+        m_index, hash_fnv1a(lookup_name), std::less{}, &IndexEntry::lookup_hash);
+
+    // Compare names to disambiguate hash collisions.
+    for (auto it = first; it != last; ++it) {
+        if (to_lower(it->filename.str_view()) == lookup_name) {
+            return &*it;
+        }
     }
 
-    throw RuntimeError{ "ZipFileLoader::file_size(): Could not find file '{}'", file_path.c_str() };
+    return nullptr;
 }
 
-uintmax_t ZipFileLoader::file_size(Identifier file)
+Opt<ZipFileLoader::IndexEntry> ZipFileLoader::find_index_entry(Identifier file)
 {
-    MG_ASSERT(file_exists(file));
-    open_zip_archive();
+    {
+        std::shared_lock lock{ m_index_mutex };
+        if (m_has_index) {
+            const IndexEntry* entry = find_in_index(file);
+            if (entry) {
+                return *entry;
+            }
+            return nullopt;
+        }
+    }
 
-    const auto sb = zip_stat_helper(m_archive_file, file);
+    // Index has not been built yet: build it and try again.
+    available_files();
+    return find_index_entry(file);
+}
 
-    if ((sb.valid & ZIP_STAT_SIZE) == 0) {
+ZipFileLoader::IndexEntry ZipFileLoader::index_entry(Identifier file)
+{
+    return find_index_entry(file).or_else([&] {
         throw RuntimeError{
-            "ZipFileLoader::file_size(): "
-            "Could not read size of file '{}' in zip archive '{}'",
-            file.c_str(),
-            m_archive_name
+            "ZipFileLoader: could not find file '{}' in archive '{}'", file.c_str(), m_archive_name
         };
-    }
+    }).value();
+}
+
+bool ZipFileLoader::file_exists(Identifier file)
+{
+    return find_index_entry(file).has_value();
+}
 
-    return sb.size;
+uintmax_t ZipFileLoader::file_size(Identifier file)
+{
+    return index_entry(file).size;
 }
 
 std::time_t ZipFileLoader::file_time_stamp(Identifier file)
 {
-    MG_ASSERT(file_exists(file));
-    open_zip_archive();
+    return index_entry(file).time_stamp;
+}
 
-    const auto sb = zip_stat_helper(m_archive_file, file);
-    if ((sb.valid & ZIP_STAT_MTIME) == 0) {
-        throw RuntimeError{
-            "ZipFileLoader::file_time_stamp(): "
-            "Could not read time stamp of file '{}' in zip archive '{}'",
-            file.c_str(),
-            m_archive_name
-        };
+void ZipFileLoader::load_file(Identifier file, std::span<std::byte> target_buffer)
+{
+    // Each thread decompresses using its own archive handle, libzip handles are not thread-safe.
+    const FileLease file_lease = lease_file(file);
+    const IndexEntry& entry = file_lease.entry;
+    zip_t* const handle = file_lease.lease.handle();
+    MG_ASSERT(entry.size <= target_buffer.size());
+
+    if (entry.size == 0) {
+        return; // Ignore empty files.
     }
 
-    return sb.mtime;
+    const auto error_throw = [&](std::string_view reason) {
+        throw RuntimeError{ "Could not read file '{}' (compression method {}) from archive '{}': {}",
+                            file.c_str(),
+                            entry.compression_method,
+                            m_archive_name,
+                            reason };
+    };
+
+    // Open file within archive
+    auto zip_file = make_zip_handle(zip_fopen_index(handle, entry.zip_index, 0));
+
+    // Check for errors
+    if (zip_file == nullptr) {
+        error_throw(zip_strerror(handle));
+    }
+
+    // Read data from file
+    const auto bytes_read = zip_fread(zip_file.get(), target_buffer.data(), entry.size);
+
+    if (bytes_read == -1) {
+        error_throw(zip_file_strerror(zip_file.get()));
+    }
+
+    MG_ASSERT(size_t(bytes_read) <= target_buffer.size());
 }
 
-// RAII wrapper, automatically closes zipfile on scope exit
-static auto make_zip_handle(zip_file_t* p) noexcept
+
+//--------------------------------------------------------------------------------------------------
+// Pack file loading
+//--------------------------------------------------------------------------------------------------
+
+namespace {
+
+template<typename T> T read_pack_struct(std::span<const std::byte> pack, size_t offset)
 {
-    return std::unique_ptr<zip_file_t, decltype(&zip_fclose)>{ p, &zip_fclose };
+    T result{};
+    std::memcpy(&result, &pack[offset], sizeof(T));
+    return result;
 }
 
-void ZipFileLoader::load_file(Identifier file, std::span<std::byte> target_buffer)
+PackFileData::Header read_pack_header(std::span<const std::byte> pack)
 {
-    MG_ASSERT(file_size(file) <= target_buffer.size());
+    return read_pack_struct<PackFileData::Header>(pack, 0);
+}
 
-    if (target_buffer.empty()) {
-        return; // Ignore empty files.
-    }
+PackFileData::Entry read_pack_entry(std::span<const std::byte> pack, size_t entry_index)
+{
+    const size_t offset = sizeof(PackFileData::Header) + entry_index * sizeof(PackFileData::Entry);
+    return read_pack_struct<PackFileData::Entry>(pack, offset);
+}
 
-    // Make sure archive is open for reading
-    open_zip_archive();
+std::string_view pack_entry_name(std::span<const std::byte> pack, const PackFileData::Entry& entry)
+{
+    const auto header = read_pack_header(pack);
+    const auto* names = reinterpret_cast<const char*>(&pack[header.names_offset]); // NOLINT
+    return { names + entry.name_offset, entry.name_length };                       // NOLINT
+}
 
-    const auto index = zip_name_locate(m_archive_file, file.c_str(), ZIP_FL_NOCASE);
+} // namespace
 
-    const auto error_throw = [&](const std::string& reason) {
-        throw RuntimeError{
-            "Could not read file '{}' from archive '{}': {}", file.c_str(), m_archive_name, reason
-        };
+std::shared_ptr<const io::MappedFile> PackFileLoader::open_pack_file() const
+{
+    using namespace PackFileData;
+
+    auto [mapped_file, error_msg] = io::MappedFile::open(m_pack_file_name);
+    if (!mapped_file) {
+        throw RuntimeError{ "Failed to open pack file '{}': {}", m_pack_file_name, error_msg };
+    }
+
+    const auto error_throw = [&](std::string_view reason) {
+        throw RuntimeError{ "Invalid pack file '{}': {}", m_pack_file_name, reason };
     };
 
-    if (index == -1) {
-        error_throw("could not find file in archive");
+    // Validate everything that lookups rely on up front, so that they need no bounds checks.
+    const auto pack = mapped_file->bytes();
+    if (pack.size() < sizeof(Header)) {
+        error_throw("file too small");
     }
 
-    auto uindex = as<uint64_t>(index);
+    const auto header = read_pack_header(pack);
+    if (header.four_cc != PackFileData::fourcc) {
+        error_throw("not a pack file");
+    }
+    if (header.version != PackFileData::version) {
+        error_throw(std::format("unsupported version {}", header.version));
+    }
 
-    // Get file size
-    struct zip_stat file_info = {};
-    zip_stat_index(m_archive_file, uindex, 0, &file_info);
+    const uint64_t entries_end = sizeof(Header) + header.num_entries * sizeof(Entry);
+    if (header.num_entries > pack.size() / sizeof(Entry) || entries_end > header.names_offset ||
+        header.names_offset > pack.size() || header.names_size > pack.size() - header.names_offset) {
+        error_throw("corrupt entry table");
+    }
 
-    // Check for errors
-    if ((file_info.valid & ZIP_STAT_SIZE) == 0) {
-        error_throw("could not read file size");
+    uint32_t prev_hash = 0;
+    for (size_t i = 0; i < header.num_entries; ++i) {
+        const Entry entry = read_pack_entry(pack, i);
+        const bool is_valid = entry.name_hash >= prev_hash &&
+                              entry.name_offset <= header.names_size &&
+                              entry.name_length <= header.names_size - entry.name_offset &&
+                              entry.data_offset <= pack.size() &&
+                              entry.stored_size <= pack.size() - entry.data_offset &&
+                              (entry.compression == Compression::none ||
+                               entry.compression == Compression::lz4) &&
+                              (entry.compression != Compression::none ||
+                               entry.stored_size == entry.size);
+        if (!is_valid) {
+            error_throw(std::format("corrupt entry {}", i));
+        }
+        prev_hash = entry.name_hash;
     }
 
-    // Open file within archive
-    auto zip_file = make_zip_handle(zip_fopen_index(m_archive_file, uindex, 0));
+    return std::make_shared<const io::MappedFile>(std::move(*mapped_file));
+}
 
-    // Check for errors
-    if (zip_file == nullptr) {
-        zip_error_t error{};
-        zip_error_init(&error);
-        std::string msg = zip_error_strerror(&error);
-        zip_error_fini(&error);
+Array<FileRecord> PackFileLoader::available_files()
+{
+    // Get time stamp before mapping, so that a concurrent modification is detected next time.
+    const std::time_t pack_time_stamp = last_write_time_t(
+        fs::path(cast_as_u8_unchecked(m_pack_file_name)));
+
+    // The pack may have changed on disk, so map it anew.
+    auto pack = open_pack_file();
+    const auto bytes = pack->bytes();
+    const auto num_entries = read_pack_header(bytes).num_entries;
+
+    auto result = Array<FileRecord>::make_for_overwrite(as<size_t>(num_entries));
+    for (size_t i = 0; i < num_entries; ++i) {
+        const auto entry = read_pack_entry(bytes, i);
+        result[i] = FileRecord{ Identifier::from_runtime_string(pack_entry_name(bytes, entry)),
+                                std::time_t(entry.time_stamp) };
+    }
 
-        error_throw(msg);
+    {
+        std::unique_lock lock{ m_pack_mutex };
+        m_pack = std::move(pack);
+        m_pack_time_stamp = pack_time_stamp;
     }
 
-    // Read data from file
-    const auto bytes_read = zip_fread(zip_file.get(), target_buffer.data(), file_info.size);
+    return result;
+}
 
-    if (bytes_read == -1) {
-        error_throw("could not read data");
+Opt<FileListDelta> PackFileLoader::changed_files()
+{
+    std::shared_lock lock{ m_pack_mutex };
+    const auto time_stamp = last_write_time_t(fs::path(cast_as_u8_unchecked(m_pack_file_name)));
+    if (!m_pack || time_stamp != m_pack_time_stamp) {
+        return nullopt;
     }
+    return FileListDelta{};
+}
 
-    MG_ASSERT(size_t(bytes_read) <= target_buffer.size());
+Opt<PackFileLoader::Location> PackFileLoader::find_entry(Identifier file)
+{
+    std::shared_ptr<const io::MappedFile> pack;
+    {
+        std::shared_lock lock{ m_pack_mutex };
+        pack = m_pack;
+    }
+
+    if (!pack) {
+        // Pack has not been mapped yet: map it and try again.
+        available_files();
+        return find_entry(file);
+    }
+
+    const auto bytes = pack->bytes();
+    const size_t num_entries = as<size_t>(read_pack_header(bytes).num_entries);
+
+    // Binary search for first entry with matching hash.
+    size_t first = 0;
+    size_t count = num_entries;
+    while (count > 0) {
+        const size_t step = count / 2;
+        if (read_pack_entry(bytes, first + step).name_hash < file.hash()) {
+            first += step + 1;
+            count -= step + 1;
+        }
+        else {
+            count = step;
+        }
+    }
+
+    // Compare names to disambiguate hash collisions.
+    for (size_t i = first; i < num_entries; ++i) {
+        const auto entry = read_pack_entry(bytes, i);
+        if (entry.name_hash != file.hash()) {
+            break;
+        }
+        if (pack_entry_name(bytes, entry) == file.str_view()) {
+            return Location{ std::move(pack), i };
+        }
+    }
+
+    return nullopt;
+}
+
+PackFileLoader::Location PackFileLoader::entry_location(Identifier file)
+{
+    return find_entry(file).or_else([&] {
+        throw RuntimeError{
+            "PackFileLoader: could not find file '{}' in pack '{}'", file.c_str(), m_pack_file_name
+        };
+    }).value();
+}
+
+bool PackFileLoader::file_exists(Identifier file)
+{
+    return find_entry(file).has_value();
+}
+
+uintmax_t PackFileLoader::file_size(Identifier file)
+{
+    const auto location = entry_location(file);
+    return read_pack_entry(location.pack->bytes(), location.entry_index).size;
+}
+
+std::time_t PackFileLoader::file_time_stamp(Identifier file)
+{
+    const auto location = entry_location(file);
+    return std::time_t(read_pack_entry(location.pack->bytes(), location.entry_index).time_stamp);
+}
+
+void PackFileLoader::load_file(Identifier file, std::span<std::byte> target_buffer)
+{
+    const auto location = entry_location(file);
+    const auto bytes = location.pack->bytes();
+    const auto entry = read_pack_entry(bytes, location.entry_index);
+    MG_ASSERT(entry.size <= target_buffer.size());
+
+    const auto stored_data = bytes.subspan(as<size_t>(entry.data_offset),
+                                           as<size_t>(entry.stored_size));
+
+    switch (entry.compression) {
+    case PackFileData::Compression::none:
+        if (!stored_data.empty()) {
+            std::memcpy(target_buffer.data(), stored_data.data(), stored_data.size());
+        }
+        break;
+
+    case PackFileData::Compression::lz4:
+        if (!lz4_decompress(stored_data, target_buffer.subspan(0, as<size_t>(entry.size)))) {
+            throw RuntimeError{ "Could not decompress file '{}' from pack '{}'.",
+                                file.c_str(),
+                                m_pack_file_name };
+        }
+        break;
+    }
+}
+
+Opt<SharedFileData> PackFileLoader::map_file(Identifier file)
+{
+    const auto location = entry_location(file);
+    const auto bytes = location.pack->bytes();
+    const auto entry = read_pack_entry(bytes, location.entry_index);
+
+    if (entry.compression != PackFileData::Compression::none) {
+        return nullopt;
+    }
+
+    const auto data = bytes.subspan(as<size_t>(entry.data_offset), as<size_t>(entry.size));
+    return SharedFileData{ data, location.pack };
 }
 
 } // namespace Mg
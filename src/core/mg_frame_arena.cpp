@@ -0,0 +1,76 @@
+//**************************************************************************************************
+// This file is part of Mg Engine. Copyright (c) 2026, Magnus Bergsten.
+// Mg Engine is made available under the terms of the 3-Clause BSD License.
+// See LICENSE.txt in the project's root directory.
+//**************************************************************************************************
+
+#include "mg/core/mg_frame_arena.h"
+
+#include "mg/utils/mg_math_utils.h"
+
+#include <atomic>
+
+namespace Mg {
+
+namespace {
+
+std::atomic_uint64_t g_next_frame_arena_id = 1;
+
+// The calling thread's arenas in the most recently used FrameArena, to avoid locking in
+// `FrameArena::local`.
+struct LocalFrameArenas {
+    uint64_t owner_id = 0;
+    std::array<LinearArena, 2>* arenas = nullptr;
+};
+
+thread_local LocalFrameArenas t_local_frame_arenas;
+
+} // namespace
+
+FrameArena::FrameArena(const size_t block_size)
+    : m_id{ g_next_frame_arena_id.fetch_add(1, std::memory_order_relaxed) }
+    , m_block_size{ block_size }
+{}
+
+FrameArena::~FrameArena() = default;
+
+LinearArena& FrameArena::local()
+{
+    const size_t current = m_frame_count % 2;
+
+    LocalFrameArenas& cached = t_local_frame_arenas;
+    if (cached.owner_id == m_id) {
+        return (*cached.arenas)[current];
+    }
+
+    std::lock_guard lock{ m_mutex };
+    auto& thread_arenas = m_thread_arenas[std::this_thread::get_id()];
+    if (!thread_arenas) {
+        thread_arenas = std::make_unique<ThreadArenas>(m_block_size);
+    }
+
+    cached = { m_id, &thread_arenas->arenas };
+    return thread_arenas->arenas[current];
+}
+
+void FrameArena::next_frame()
+{
+    const size_t finished = m_frame_count % 2;
+    const size_t next = 1 - finished;
+
+    FrameArenaStats stats;
+    for (auto& [thread_id, thread_arenas] : m_thread_arenas) {
+        const LinearArena& arena = thread_arenas->arenas[finished];
+        stats.bytes_allocated += arena.bytes_allocated();
+        stats.num_block_allocations += arena.num_block_allocations();
+        stats.capacity += arena.capacity() + thread_arenas->arenas[next].capacity();
+
+        thread_arenas->arenas[next].reset();
+    }
+
+    stats.high_water_mark = max(m_last_frame_stats.high_water_mark, stats.bytes_allocated);
+    m_last_frame_stats = stats;
+    ++m_frame_count;
+}
+
+} // namespace Mg
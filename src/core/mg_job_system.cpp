@@ -0,0 +1,450 @@
+//**************************************************************************************************
+// This file is part of Mg Engine. Copyright (c) 2026, Magnus Bergsten.
+// Mg Engine is made available under the terms of the 3-Clause BSD License.
+// See LICENSE.txt in the project's root directory.
+//**************************************************************************************************
+
+#include "mg/core/mg_job_system.h"
+
+#include "mg/utils/mg_assert.h"
+
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Mg {
+
+using detail::Job;
+
+namespace {
+
+// Number of pooled jobs per queue. Jobs beyond this are heap-allocated.
+constexpr size_t k_job_pool_size = 1024;
+
+// Capacity of each work-stealing deque; must be a power of two. If full, jobs are run immediately.
+constexpr size_t k_deque_capacity = 4096;
+
+// How many times an idle thread looks for jobs before going to sleep.
+constexpr size_t k_num_spins_before_sleep = 64;
+
+constexpr size_t k_external_thread = SIZE_MAX;
+
+/** Fixed-capacity work-stealing deque of jobs, after Chase & Lev, "Dynamic Circular Work-Stealing
+ * Deque" (2005), with the memory orderings from Lê et al., "Correct and Efficient Work-Stealing for
+ * Weak Memory Models" (2013). The owning thread pushes and pops at the bottom; other threads steal
+ * from the top.
+ */
+class WorkStealingDeque {
+public:
+    WorkStealingDeque() : m_buffer(new std::atomic<Job*>[k_deque_capacity]) {}
+
+    // Owner only. Returns false if the deque is full.
+    bool push(Job* job) noexcept
+    {
+        const int64_t bottom = m_bottom.load(std::memory_order_relaxed);
+        const int64_t top = m_top.load(std::memory_order_acquire);
+        if (bottom - top >= int64_t(k_deque_capacity)) {
+            return false;
+        }
+
+        slot(bottom).store(job, std::memory_order_relaxed);
+        m_bottom.store(bottom + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Owner only.
+    Job* pop() noexcept
+    {
+        const int64_t bottom = m_bottom.load(std::memory_order_relaxed) - 1;
+        m_bottom.store(bottom, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t top = m_top.load(std::memory_order_relaxed);
+
+        if (top > bottom) {
+            m_bottom.store(bottom + 1, std::memory_order_relaxed);
+            return nullptr;
+        }
+
+        Job* job = slot(bottom).load(std::memory_order_relaxed);
+        if (top == bottom) {
+            // Last job: race against stealers.
+            if (!m_top.compare_exchange_strong(top,
+                                               top + 1,
+                                               std::memory_order_seq_cst,
+                                               std::memory_order_relaxed)) {
+                job = nullptr;
+            }
+            m_bottom.store(bottom + 1, std::memory_order_relaxed);
+        }
+        return job;
+    }
+
+    // Any thread.
+    Job* steal() noexcept
+    {
+        int64_t top = m_top.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        const int64_t bottom = m_bottom.load(std::memory_order_acquire);
+
+        if (top >= bottom) {
+            return nullptr;
+        }
+
+        Job* job = slot(top).load(std::memory_order_relaxed);
+        if (!m_top.compare_exchange_strong(top,
+                                           top + 1,
+                                           std::memory_order_seq_cst,
+                                           std::memory_order_relaxed)) {
+            return nullptr;
+        }
+        return job;
+    }
+
+    bool is_empty() const noexcept
+    {
+        return m_bottom.load(std::memory_order_relaxed) <= m_top.load(std::memory_order_relaxed);
+    }
+
+private:
+    std::atomic<Job*>& slot(int64_t index) noexcept
+    {
+        return m_buffer[size_t(index) & (k_deque_capacity - 1)];
+    }
+
+    alignas(64) std::atomic<int64_t> m_top = 0;
+    alignas(64) std::atomic<int64_t> m_bottom = 0;
+    std::unique_ptr<std::atomic<Job*>[]> m_buffer;
+};
+
+// Identifies the JobSystem and queue of the calling worker thread.
+struct WorkerThreadContext {
+    const void* job_system = nullptr;
+    size_t queue_index = 0;
+};
+
+thread_local WorkerThreadContext t_worker_context;
+
+} // namespace
+
+struct JobSystem::Impl {
+    // Job queue and job pool of a thread. Queue 0 belongs to the thread that created the
+    // JobSystem, queue i + 1 to worker thread i.
+    struct alignas(64) ThreadQueue {
+        WorkStealingDeque deque;
+
+        // Only the owning thread allocates from the pool; any thread may release a job back to it.
+        std::unique_ptr<Job[]> job_pool{ new Job[k_job_pool_size] };
+        size_t next_pool_index = 0;
+    };
+
+    explicit Impl(size_t num_worker_threads) : queues(num_worker_threads + 1) {}
+
+    size_t current_queue_index() const noexcept
+    {
+        if (t_worker_context.job_system == this) {
+            return t_worker_context.queue_index;
+        }
+        if (std::this_thread::get_id() == owner_thread_id) {
+            return 0;
+        }
+        return k_external_thread;
+    }
+
+    Job* find_job(size_t queue_index) noexcept;
+    bool try_run_one_job(size_t queue_index) noexcept;
+    void execute(Job& job) noexcept;
+    void decrement(JobCounter& counter) noexcept;
+
+    // Block until there may be new jobs (or the condition may have changed), after a short spin.
+    template<typename StopCondition>
+    void idle(size_t queue_index, const StopCondition& should_stop) noexcept;
+
+    // Wake one sleeping thread, if any, after a job was added.
+    void notify_job_added() noexcept;
+
+    // Wake all sleeping threads.
+    void notify_all() noexcept;
+
+    void worker_loop(size_t queue_index) noexcept;
+
+    std::vector<ThreadQueue> queues;
+    std::vector<std::thread> threads;
+    std::thread::id owner_thread_id = std::this_thread::get_id();
+
+    // Jobs added from threads without a queue of their own.
+    std::deque<Job*> external_jobs;
+    std::atomic_size_t num_external_jobs = 0;
+    std::mutex external_jobs_mutex;
+
+    // Incremented to wake sleeping threads, which wait on it using std::atomic::wait.
+    alignas(64) std::atomic_uint64_t wake_epoch = 0;
+    alignas(64) std::atomic_size_t num_sleeping_threads = 0;
+
+    std::atomic_bool is_exiting = false;
+};
+
+Job* JobSystem::Impl::find_job(const size_t queue_index) noexcept
+{
+    const bool has_own_queue = queue_index != k_external_thread;
+
+    if (has_own_queue) {
+        if (Job* job = queues[queue_index].deque.pop()) {
+            return job;
+        }
+    }
+
+    // Start stealing at different queues, to spread contention.
+    thread_local size_t steal_offset = 0;
+    const size_t num_queues = queues.size();
+    ++steal_offset;
+
+    for (size_t i = 0; i < num_queues; ++i) {
+        const size_t victim = (steal_offset + i) % num_queues;
+        if (has_own_queue && victim == queue_index) {
+            continue;
+        }
+        if (Job* job = queues[victim].deque.steal()) {
+            return job;
+        }
+    }
+
+    if (num_external_jobs.load(std::memory_order_acquire) > 0) {
+        std::lock_guard lock{ external_jobs_mutex };
+        if (!external_jobs.empty()) {
+            Job* job = external_jobs.front();
+            external_jobs.pop_front();
+            num_external_jobs.fetch_sub(1, std::memory_order_relaxed);
+            return job;
+        }
+    }
+
+    return nullptr;
+}
+
+bool JobSystem::Impl::try_run_one_job(const size_t queue_index) noexcept
+{
+    Job* job = find_job(queue_index);
+    if (!job) {
+        return false;
+    }
+    execute(*job);
+    return true;
+}
+
+void JobSystem::Impl::execute(Job& job) noexcept
+{
+    JobCounter* counter = job.counter;
+    job.invoke(job);
+
+    if (job.is_heap_allocated) {
+        delete &job;
+    }
+    else {
+        job.is_in_use.store(false, std::memory_order_release);
+    }
+
+    if (counter) {
+        decrement(*counter);
+    }
+}
+
+void JobSystem::Impl::decrement(JobCounter& counter) noexcept
+{
+    // The counter may be destroyed as soon as it reaches zero, so it must not be touched after
+    // decrementing. Waiting threads sleep on wake_epoch instead.
+    if (counter.m_num_unfinished.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        notify_all();
+    }
+}
+
+template<typename StopCondition>
+void JobSystem::Impl::idle(const size_t queue_index, const StopCondition& should_stop) noexcept
+{
+    for (size_t i = 0; i < k_num_spins_before_sleep; ++i) {
+        if (should_stop() || try_run_one_job(queue_index)) {
+            return;
+        }
+        std::this_thread::yield();
+    }
+
+    // Register as sleeping before the final check. Together with the fence in push_job, this
+    // guarantees that either this thread sees the new job or the pusher sees this thread sleeping
+    // and increments wake_epoch, so that the wait below does not block.
+    const uint64_t epoch = wake_epoch.load();
+    num_sleeping_threads.fetch_add(1);
+
+    if (Job* job = find_job(queue_index)) {
+        num_sleeping_threads.fetch_sub(1);
+        execute(*job);
+        return;
+    }
+
+    if (!should_stop()) {
+        wake_epoch.wait(epoch);
+    }
+
+    num_sleeping_threads.fetch_sub(1);
+}
+
+void JobSystem::Impl::notify_job_added() noexcept
+{
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (num_sleeping_threads.load() > 0) {
+        wake_epoch.fetch_add(1);
+        wake_epoch.notify_one();
+    }
+}
+
+void JobSystem::Impl::notify_all() noexcept
+{
+    wake_epoch.fetch_add(1);
+    if (num_sleeping_threads.load() > 0) {
+        wake_epoch.notify_all();
+    }
+}
+
+void JobSystem::Impl::worker_loop(const size_t queue_index) noexcept
+{
+    t_worker_context = { this, queue_index };
+
+    for (;;) {
+        if (try_run_one_job(queue_index)) {
+            continue;
+        }
+
+        // Jobs only add jobs to their own thread's queue, so once no jobs are found after the
+        // JobSystem started exiting, this thread is done.
+        if (is_exiting.load()) {
+            return;
+        }
+
+        idle(queue_index, [this] { return is_exiting.load(); });
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+
+JobSystem::JobSystem(const size_t num_worker_threads) : m_impl(num_worker_threads)
+{
+    m_impl->threads.reserve(num_worker_threads);
+    for (size_t i = 0; i < num_worker_threads; ++i) {
+        m_impl->threads.emplace_back([this, i] { m_impl->worker_loop(i + 1); });
+    }
+}
+
+JobSystem::~JobSystem()
+{
+    const size_t queue_index = m_impl->current_queue_index();
+    while (m_impl->try_run_one_job(queue_index)) {
+    }
+
+    m_impl->is_exiting.store(true);
+    m_impl->notify_all();
+
+    for (std::thread& thread : m_impl->threads) {
+        thread.join();
+    }
+
+    // Worker threads finish the jobs in their own queues, but jobs may have been added to the
+    // other queues while they were exiting.
+    while (m_impl->try_run_one_job(queue_index)) {
+    }
+
+    for ([[maybe_unused]] Impl::ThreadQueue& queue : m_impl->queues) {
+        MG_ASSERT_DEBUG(queue.deque.is_empty());
+    }
+}
+
+size_t JobSystem::num_worker_threads() const noexcept
+{
+    return m_impl->threads.size();
+}
+
+void JobSystem::wait(const JobCounter& counter)
+{
+    const size_t queue_index = m_impl->current_queue_index();
+
+    while (!counter.is_done()) {
+        if (!m_impl->try_run_one_job(queue_index)) {
+            m_impl->idle(queue_index, [&counter] { return counter.is_done(); });
+        }
+    }
+}
+
+void JobSystem::retain(JobCounter& counter, const size_t num) noexcept
+{
+    counter.m_num_unfinished.fetch_add(num, std::memory_order_relaxed);
+}
+
+void JobSystem::release(JobCounter& counter) noexcept
+{
+    MG_ASSERT_DEBUG(!counter.is_done());
+    m_impl->decrement(counter);
+}
+
+Job* JobSystem::try_allocate_pooled_job() noexcept
+{
+    const size_t queue_index = m_impl->current_queue_index();
+    if (queue_index == k_external_thread) {
+        return nullptr;
+    }
+
+    Impl::ThreadQueue& queue = m_impl->queues[queue_index];
+
+    // Jobs are usually finished in roughly the order they were allocated, so the next slot is
+    // likely to be free.
+    for (size_t i = 0; i < k_job_pool_size; ++i) {
+        Job& job = queue.job_pool[queue.next_pool_index];
+        queue.next_pool_index = (queue.next_pool_index + 1) % k_job_pool_size;
+
+        if (!job.is_in_use.load(std::memory_order_acquire)) {
+            job.is_in_use.store(true, std::memory_order_relaxed);
+            return &job;
+        }
+    }
+
+    return nullptr;
+}
+
+void JobSystem::push_job(Job& job, JobCounter* counter)
+{
+    job.counter = counter;
+    if (counter) {
+        counter->m_num_unfinished.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    const size_t queue_index = m_impl->current_queue_index();
+
+    if (queue_index == k_external_thread) {
+        std::lock_guard lock{ m_impl->external_jobs_mutex };
+        m_impl->external_jobs.push_back(&job);
+        m_impl->num_external_jobs.fetch_add(1, std::memory_order_release);
+    }
+    else if (!m_impl->queues[queue_index].deque.push(&job)) {
+        m_impl->execute(job);
+        return;
+    }
+
+    m_impl->notify_job_added();
+}
+
+bool JobSystem::has_queued_jobs() const noexcept
+{
+    const size_t queue_index = m_impl->current_queue_index();
+    if (queue_index == k_external_thread) {
+        return m_impl->num_external_jobs.load(std::memory_order_relaxed) > 0;
+    }
+    return !m_impl->queues[queue_index].deque.is_empty();
+}
+
+size_t JobSystem::auto_elems_per_job(const size_t num_elems) const noexcept
+{
+    // Small enough for the work to be balanced across threads; since jobs are only split off when
+    // threads are available (see split_and_run), small chunks cost little when all are busy.
+    const size_t num_threads = num_worker_threads() + 1;
+    return std::max(size_t(1), num_elems / (8 * num_threads));
+}
+
+} // namespace Mg
@@ -0,0 +1,64 @@
+//**************************************************************************************************
+// This file is part of Mg Engine. Copyright (c) 2026, Magnus Bergsten.
+// Mg Engine is made available under the terms of the 3-Clause BSD License.
+// See LICENSE.txt in the project's root directory.
+//**************************************************************************************************
+
+#include "mg/core/mg_linear_arena.h"
+
+#include "mg/utils/mg_assert.h"
+#include "mg/utils/mg_math_utils.h"
+
+#include <cstdint>
+
+namespace Mg {
+
+void* LinearArena::allocate(const size_t size, const size_t alignment)
+{
+    MG_ASSERT_DEBUG(alignment > 0 && (alignment & (alignment - 1)) == 0);
+
+    // Blocks that are too full for the allocation are skipped until the next reset.
+    for (; m_current_block < m_blocks.size(); ++m_current_block, m_offset = 0) {
+        Block& block = m_blocks[m_current_block];
+        const auto base = reinterpret_cast<uintptr_t>(block.data.get());
+        const size_t aligned_offset = ((base + m_offset + alignment - 1) & ~(alignment - 1)) - base;
+
+        if (aligned_offset + size <= block.size) {
+            m_bytes_allocated += aligned_offset + size - m_offset;
+            m_offset = aligned_offset + size;
+            return block.data.get() + aligned_offset;
+        }
+    }
+
+    const size_t block_size = max(m_block_size, size + alignment);
+    m_blocks.push_back({ std::make_unique_for_overwrite<std::byte[]>(block_size), block_size });
+    ++m_num_block_allocations;
+    return allocate(size, alignment);
+}
+
+void LinearArena::reset() noexcept
+{
+    m_high_water_mark = high_water_mark();
+    m_num_block_allocations = 0;
+    m_current_block = 0;
+    m_offset = 0;
+    m_bytes_allocated = 0;
+}
+
+void LinearArena::release() noexcept
+{
+    m_blocks.clear();
+    reset();
+    m_high_water_mark = 0;
+}
+
+size_t LinearArena::capacity() const noexcept
+{
+    size_t result = 0;
+    for (const Block& block : m_blocks) {
+        result += block.size;
+    }
+    return result;
+}
+
+} // namespace Mg
@@ -0,0 +1,177 @@
+//**************************************************************************************************
+// This file is part of Mg Engine. Copyright (c) 2026, Magnus Bergsten.
+// Mg Engine is made available under the terms of the 3-Clause BSD License.
+// See LICENSE.txt in the project's root directory.
+//**************************************************************************************************
+
+#include "mg/core/mg_transform.h"
+
+#include "mg/utils/mg_assert.h"
+
+#include <glm/gtc/quaternion.hpp>
+#include <glm/mat3x3.hpp>
+
+#include <algorithm>
+
+namespace Mg {
+
+namespace {
+
+glm::quat shortest_path_nlerp(const glm::quat& from, glm::quat to, const float x) noexcept
+{
+    if (glm::dot(from, to) < 0.0f) {
+        to = -to;
+    }
+    return glm::normalize(from + (to - from) * x);
+}
+
+// Interpolation in this form is exact when a == b, so that transforms that did not change are not
+// perturbed.
+float lerp(const float a, const float b, const float x) noexcept
+{
+    return a + (b - a) * x;
+}
+
+} // namespace
+
+Transform Transform::from_matrix(const glm::mat4& matrix) noexcept
+{
+    const glm::vec3 scale{ glm::length(glm::vec3(matrix[0])),
+                           glm::length(glm::vec3(matrix[1])),
+                           glm::length(glm::vec3(matrix[2])) };
+
+    const glm::mat3 rotation_matrix{ glm::vec3(matrix[0]) / scale.x,
+                                     glm::vec3(matrix[1]) / scale.y,
+                                     glm::vec3(matrix[2]) / scale.z };
+
+    return Transform{ glm::vec3(matrix[3]),
+                      scale,
+                      Rotation{ glm::normalize(glm::quat_cast(rotation_matrix)) } };
+}
+
+Transform Transform::mix(const Transform& from, const Transform& to, const float x) noexcept
+{
+    return Transform{ from.position + (to.position - from.position) * x,
+                      from.scale + (to.scale - from.scale) * x,
+                      Rotation{ shortest_path_nlerp(
+                          from.rotation.to_quaternion(), to.rotation.to_quaternion(), x) } };
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void TransformInterpolationBatch::push_back(const Transform& from, const Transform& to)
+{
+    const size_t lane = m_size % k_block_size;
+    if (lane == 0) {
+        // Unused lanes get identity rotations, so that interpolating them is well-defined.
+        Block& block = m_blocks.emplace_back();
+        block.from_rotation[3].fill(1.0f);
+        block.to_rotation[3].fill(1.0f);
+    }
+
+    Block& block = m_blocks.back();
+    const glm::quat from_rotation = from.rotation.to_quaternion();
+    const glm::quat to_rotation = to.rotation.to_quaternion();
+
+    for (glm::length_t i = 0; i < 3; ++i) {
+        block.from_position[i][lane] = from.position[i];
+        block.to_position[i][lane] = to.position[i];
+        block.from_scale[i][lane] = from.scale[i];
+        block.to_scale[i][lane] = to.scale[i];
+    }
+    for (glm::length_t i = 0; i < 4; ++i) {
+        block.from_rotation[i][lane] = from_rotation[i];
+        block.to_rotation[i][lane] = to_rotation[i];
+    }
+
+    ++m_size;
+}
+
+void TransformInterpolationBatch::interpolate(const float x,
+                                              std::span<glm::mat4> matrices_out) const noexcept
+{
+    MG_ASSERT(matrices_out.size() >= m_size);
+
+    for (size_t block_index = 0; block_index < m_blocks.size(); ++block_index) {
+        const Block& block = m_blocks[block_index];
+
+        // Matrix elements, in column-major order, for each lane. The loops over lanes below are
+        // free of branches and dependencies between lanes, so that they can be vectorized.
+        std::array<Lanes, 16> m;
+
+        for (size_t l = 0; l < k_block_size; ++l) {
+            const float fx = block.from_rotation[0][l];
+            const float fy = block.from_rotation[1][l];
+            const float fz = block.from_rotation[2][l];
+            const float fw = block.from_rotation[3][l];
+            float tx = block.to_rotation[0][l];
+            float ty = block.to_rotation[1][l];
+            float tz = block.to_rotation[2][l];
+            float tw = block.to_rotation[3][l];
+
+            // Interpolate along the shortest path.
+            const float dot = fx * tx + fy * ty + fz * tz + fw * tw;
+            const float sign = dot < 0.0f ? -1.0f : 1.0f;
+            tx *= sign;
+            ty *= sign;
+            tz *= sign;
+            tw *= sign;
+
+            const float qx = lerp(fx, tx, x);
+            const float qy = lerp(fy, ty, x);
+            const float qz = lerp(fz, tz, x);
+            const float qw = lerp(fw, tw, x);
+
+            // Instead of normalizing the quaternion, which would need a square root, the rotation
+            // matrix is scaled by the inverse of its squared norm.
+            const float s = 2.0f / (qx * qx + qy * qy + qz * qz + qw * qw);
+
+            const float sx = lerp(block.from_scale[0][l], block.to_scale[0][l], x);
+            const float sy = lerp(block.from_scale[1][l], block.to_scale[1][l], x);
+            const float sz = lerp(block.from_scale[2][l], block.to_scale[2][l], x);
+
+            const float xx = qx * qx;
+            const float yy = qy * qy;
+            const float zz = qz * qz;
+            const float xy = qx * qy;
+            const float xz = qx * qz;
+            const float yz = qy * qz;
+            const float wx = qw * qx;
+            const float wy = qw * qy;
+            const float wz = qw * qz;
+
+            m[0][l] = (1.0f - s * (yy + zz)) * sx;
+            m[1][l] = s * (xy + wz) * sx;
+            m[2][l] = s * (xz - wy) * sx;
+            m[3][l] = 0.0f;
+
+            m[4][l] = s * (xy - wz) * sy;
+            m[5][l] = (1.0f - s * (xx + zz)) * sy;
+            m[6][l] = s * (yz + wx) * sy;
+            m[7][l] = 0.0f;
+
+            m[8][l] = s * (xz + wy) * sz;
+            m[9][l] = s * (yz - wx) * sz;
+            m[10][l] = (1.0f - s * (xx + yy)) * sz;
+            m[11][l] = 0.0f;
+
+            m[12][l] = lerp(block.from_position[0][l], block.to_position[0][l], x);
+            m[13][l] = lerp(block.from_position[1][l], block.to_position[1][l], x);
+            m[14][l] = lerp(block.from_position[2][l], block.to_position[2][l], x);
+            m[15][l] = 1.0f;
+        }
+
+        const size_t first = block_index * k_block_size;
+        const size_t num_lanes = std::min(k_block_size, m_size - first);
+        for (size_t l = 0; l < num_lanes; ++l) {
+            glm::mat4& out = matrices_out[first + l];
+            for (glm::length_t column = 0; column < 4; ++column) {
+                for (glm::length_t row = 0; row < 4; ++row) {
+                    out[column][row] = m[size_t(column * 4 + row)][l];
+                }
+            }
+        }
+    }
+}
+
+} // namespace Mg
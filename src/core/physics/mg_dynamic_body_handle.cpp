@@ -15,6 +15,11 @@ float DynamicBodyHandle::mass() const
     return data().body.getMass();
 }
 
+bool DynamicBodyHandle::is_active() const
+{
+    return data().body.isActive();
+}
+
 mat4 DynamicBodyHandle::interpolated_transform() const
 {
     // transform is updated in Mg::physics::World::update()
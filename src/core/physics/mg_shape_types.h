@@ -12,6 +12,7 @@
 #include "mg_shape_base.h"
 
 #include "mg/core/containers/mg_array.h"
+#include "mg/core/gfx/mg_compact_vertex.h"
 #include "mg/core/gfx/mg_mesh_data.h"
 #include "mg/core/physics/mg_shape.h"
 #include "mg/utils/mg_assert.h"
@@ -125,7 +126,7 @@ private:
 class MeshShape : public ShapeBase {
 public:
     explicit MeshShape(const gfx::mesh_data::MeshDataView& mesh_data)
-        : m_vertices{ copy_vertex_positions(mesh_data.vertices) }
+        : m_vertices{ copy_vertex_positions(mesh_data) }
         , m_indices{ Array<uint32_t>::make_copy(mesh_data.indices) }
         , m_bt_shape{ prepare_shape() }
     {}
@@ -155,11 +156,21 @@ private:
         return btBvhTriangleMeshShape{ &m_bt_triangle_mesh, true, true };
     }
 
-    static Array<glm::vec3> copy_vertex_positions(std::span<const gfx::mesh_data::Vertex> vertices)
+    static Array<glm::vec3> copy_vertex_positions(const gfx::mesh_data::MeshDataView& mesh_data)
     {
-        auto result = Array<glm::vec3>::make_for_overwrite(vertices.size());
+        auto result = Array<glm::vec3>::make_for_overwrite(mesh_data.num_vertices());
+
+        if (mesh_data.vertex_format() == gfx::mesh_data::VertexFormat::Compact) {
+            const AxisAlignedBoundingBox quantization_box = mesh_data.aabb.value();
+            for (size_t i = 0; i < result.size(); ++i) {
+                result[i] = gfx::mesh_data::dequantize_position(
+                    mesh_data.compact_vertices[i].position, quantization_box);
+            }
+            return result;
+        }
+
         for (size_t i = 0; i < result.size(); ++i) {
-            result[i] = vertices[i].position;
+            result[i] = mesh_data.vertices[i].position;
         }
         return result;
     }
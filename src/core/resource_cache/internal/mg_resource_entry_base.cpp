@@ -10,9 +10,13 @@
 #include "mg/core/mg_log.h"
 #include "mg/core/resource_cache/mg_base_resource.h"
 #include "mg/core/resource_cache/mg_resource_exceptions.h"
+#include "mg/core/resource_cache/mg_resource_cache.h"
 #include "mg/core/resource_cache/mg_resource_loading_input.h"
+#include "mg/utils/mg_gsl.h"
 
+#include <chrono>
 #include <format>
+#include <mutex>
 
 namespace Mg {
 
@@ -23,33 +27,107 @@ void ResourceEntryBase::load_resource()
     MG_ASSERT(m_p_owning_cache != nullptr);
     MG_ASSERT(m_p_loader != nullptr);
 
-    last_access = std::time(nullptr);
+    using Clock = std::chrono::steady_clock;
+    const auto elapsed_ns = [](Clock::time_point since) {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - since).count();
+    };
 
-    // Load raw data.
-    const auto file_size = loader().file_size(resource_id());
-    auto file_data = Array<std::byte>::make_for_overwrite(file_size);
-    loader().load_file(resource_id(), file_data);
+    const auto io_start = Clock::now();
 
-    // Structure providing interface needed for resources to load data.
-    ResourceLoadingInput input{ std::move(file_data), owning_cache(), *this };
+    // Load raw data. Map the file instead of copying it, if the loader supports that.
+    Opt<SharedFileData> mapped_data = loader().map_file(resource_id());
+    const auto file_size = mapped_data ? mapped_data->bytes().size()
+                                       : loader().file_size(resource_id());
+
+    const auto make_input = [&] {
+        // Structure providing interface needed for resources to load data.
+        if (mapped_data) {
+            return ResourceLoadingInput{ std::move(*mapped_data), owning_cache(), *this };
+        }
+
+        auto file_data = Array<std::byte>::make_for_overwrite(file_size);
+        loader().load_file(resource_id(), file_data);
+        return ResourceLoadingInput{ std::move(file_data), owning_cache(), *this };
+    };
+    ResourceLoadingInput input = make_input();
+
+    counters.io_time_ns.fetch_add(elapsed_ns(io_start), std::memory_order_relaxed);
+    counters.bytes_read.fetch_add(file_size, std::memory_order_relaxed);
 
     // Init contained resource.
     BaseResource& resource = create_resource();
-    m_resource_type_id = resource.type_id();
-    m_has_been_loaded = true;
+    if (!m_has_been_loaded) {
+        m_resource_type_id = resource.type_id();
+        m_has_been_loaded.store(true, std::memory_order_release);
+    }
     m_time_stamp = loader().file_time_stamp(resource_id());
-    LoadResourceResult result = resource.load_resource(input);
+
+    const auto load_start = Clock::now();
+    const auto add_load_time = finally(
+        [&] { counters.load_time_ns.fetch_add(elapsed_ns(load_start), std::memory_order_relaxed); });
+
+    LoadResourceResult result = LoadResourceResult::success();
+    try {
+        result = resource.load_resource(input);
+    }
+    catch (...) {
+        // Do not leave a half-initialized resource behind; next access will retry loading.
+        unload();
+        throw;
+    }
 
     switch (result.result_code) {
     case LoadResourceResultCode::DataError:
         log.error("Loading resource '{}': DataError: {}",
                   resource_id().str_view(),
                   result.error_reason);
+        unload();
         throw ResourceDataError{};
 
     case LoadResourceResultCode::Success:
         break;
     }
+
+    m_resident_size_bytes = resource.resident_size_bytes().value_or(narrow<size_t>(file_size));
+    counters.num_loads.fetch_add(1, std::memory_order_relaxed);
+    owning_cache().on_resource_loaded(*this);
+}
+
+void ResourceEntryBase::unload()
+{
+    MG_ASSERT(ref_count == 0);
+
+    owning_cache().on_resource_unloaded(*this);
+    dependencies.clear();
+    destroy_resource();
+    m_resident_size_bytes = 0;
+}
+
+void ResourceEntryBase::mark_accessed()
+{
+    owning_cache().on_resource_accessed(*this);
+}
+
+void ResourceEntryBase::ensure_loaded()
+{
+    {
+        std::shared_lock lock{ mutex, std::defer_lock };
+        lock_counting_wait(lock);
+        if (is_loaded()) {
+            counters.num_hits.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+    }
+
+    counters.num_misses.fetch_add(1, std::memory_order_relaxed);
+
+    std::unique_lock lock{ mutex, std::defer_lock };
+    lock_counting_wait(lock);
+
+    // Check again after locking, in case another thread loaded the resource ahead of us.
+    if (!is_loaded()) {
+        load_resource();
+    }
 }
 
 } // namespace Mg
@@ -6,12 +6,17 @@
 
 #include "mg/core/resource_cache/mg_resource_cache.h"
 
+#include "mg/core/mg_job_system.h"
 #include "mg/core/mg_log.h"
 #include "mg/core/resource_cache/mg_base_resource.h"
 #include "mg/core/resource_cache/mg_resource_exceptions.h"
 #include "mg/utils/mg_stl_helpers.h"
 
+#include <algorithm>
 #include <format>
+#include <iterator>
+#include <limits>
+#include <thread>
 
 namespace Mg {
 
@@ -35,18 +40,104 @@ std::string format_time(std::time_t time)
 // ResourceCache implementation
 //--------------------------------------------------------------------------------------------------
 
+ResourceCache::~ResourceCache()
+{
+    // Pending loads may enqueue further loads (dependencies), so finish them while the rest of the
+    // cache is still fully alive. Destroying the job system finishes all its jobs.
+    m_loading_job_system.reset();
+}
+
+void ResourceCache::JobSystemDeleter::operator()(JobSystem* job_system) const noexcept
+{
+    delete job_system;
+}
+
+std::shared_future<void> ResourceCache::enqueue_load(ResourceEntryBase& entry)
+{
+    // Avoid the round-trip through the job system if the resource is already loaded. Do not block
+    // if the entry is locked, though: it may be in the middle of being loaded.
+    {
+        std::shared_lock entry_lock{ entry.mutex, std::try_to_lock };
+        if (entry_lock.owns_lock() && entry.is_loaded()) {
+            std::promise<void> already_loaded;
+            already_loaded.set_value();
+            return already_loaded.get_future().share();
+        }
+    }
+
+    std::call_once(m_loading_job_system_init_flag, [this] {
+        // Leave one hardware thread for the thread that requests the loads.
+        const size_t num_threads = std::max(std::thread::hardware_concurrency(), 2u) - 1u;
+        log_verbose("<N/A>", std::format("Starting {} resource-loading threads.", num_threads));
+        m_loading_job_system.reset(new JobSystem(num_threads));
+    });
+
+    // Any exception is stored in the future; ResourceLoadRequest::get() reports it by retrying the
+    // load, since a failed load leaves the entry unloaded.
+    return m_loading_job_system->add_job([&entry] { entry.ensure_loaded(); }).share();
+}
+
+struct ResourceCache::ReloadInfo {
+    ResourceEntryBase* entry;
+    Identifier resource_type_id;
+    std::time_t new_time_stamp;
+
+    // Indices (in the list of ReloadInfos) of the resources that this one depends on.
+    std::vector<size_t> dependencies;
+};
+
 // Update file list, detects if files have changed (added, removed, changed timestamp).
 void ResourceCache::refresh()
 {
     // Refresh list of available files.
+    std::vector<Identifier> changed_files;
     {
         std::unique_lock lock{ m_file_list_mutex };
-        rebuild_file_list();
+        changed_files = update_file_list();
+    }
+
+    // Nothing to do if no files have changed, which is the common case.
+    if (!changed_files.empty()) {
+        std::vector<ReloadInfo> reloaded = unload_changed_resources(changed_files);
+        reload_resources(reloaded);
+        notify_file_changed_trackers(reloaded);
+    }
+
+    // Clear out unused file changed trackers
+    for (auto&& [resource_type, trackers] : m_file_changed_trackers_by_resource_type) {
+        std::erase_if(trackers, [](std::weak_ptr<FileChangedTracker>& p) { return p.expired(); });
+    }
+}
+
+std::vector<ResourceCache::ReloadInfo>
+ResourceCache::unload_changed_resources(std::span<const Identifier> changed_files)
+{
+    struct ChangedFile {
+        Identifier filename;
+        std::time_t time_stamp;
+        IFileLoader* loader;
+        ResourceEntryBase* entry;
+    };
+
+    // Copy what is needed from the file list, so that entries need not be locked while holding
+    // m_file_list_mutex (loading resources locks them in the opposite order).
+    std::vector<ChangedFile> changed;
+    {
+        std::shared_lock lock{ m_file_list_mutex };
+        for (const Identifier file : changed_files) {
+            if (Opt<FileInfo&> fi = file_info(file); fi) {
+                changed.push_back({ fi->filename, fi->time_stamp, fi->loader, fi->entry.get() });
+            }
+        }
     }
 
-    auto has_file_changed = [](const ResourceCache::FileInfo& file,
-                               std::time_t old_time_stamp) -> bool {
-        const bool has_changed = file.time_stamp > old_time_stamp;
+    const auto find_changed = [&](Identifier file) -> const ChangedFile* {
+        const auto it = std::ranges::find(changed, file, &ChangedFile::filename);
+        return it != changed.end() ? &*it : nullptr;
+    };
+
+    const auto has_file_changed = [](const ChangedFile& file, std::time_t old_time_stamp) {
+        const bool has_changed = file.time_stamp != old_time_stamp;
 
         if (has_changed) {
             log.message("Detected that {} has changed (old time-stamp: {}, new time-stamp: {}).",
@@ -58,75 +149,186 @@ void ResourceCache::refresh()
         return has_changed;
     };
 
-    // Has any of the given ResourceEntry's dependencies' files changed since they were loaded?
-    auto dependencies_were_updated = [&](const ResourceEntryBase& entry) -> bool {
-        auto dependency_was_updated = [&](const ResourceEntryBase::Dependency& dependency) {
-            return has_file_changed(file_info(dependency.dependency_id).value(),
-                                    dependency.time_stamp);
-        };
+    // Caller must hold a lock on entry.mutex.
+    const auto is_reloadable = [](const ResourceEntryBase& entry) {
+        return entry.is_loaded() && entry.get_resource().should_reload_on_file_change();
+    };
+
+    std::vector<ReloadInfo> result;
+    std::unordered_map<Identifier, size_t> result_indices;
 
-        return find_if(entry.dependencies, dependency_was_updated) != entry.dependencies.end();
+    // Files whose dependants should be examined. If `file_has_changed` is false, the file's
+    // resource is being reloaded, so all of its dependants need to be reloaded, too.
+    struct Pending {
+        Identifier file;
+        bool file_has_changed;
     };
+    std::vector<Pending> pending;
 
-    // Should the resource corresponding to the given file be re-loaded (i.e. has its file or those
-    // of any of its dependencies changed)?
-    const auto should_reload = [&](const FileInfo& fi) -> bool {
-        if (fi.entry == nullptr) {
-            return false;
+    // Caller must hold a lock on entry.mutex.
+    const auto add_to_result = [&](ResourceEntryBase& entry, std::time_t new_time_stamp) {
+        result_indices.emplace(entry.resource_id(), result.size());
+        result.push_back(ReloadInfo{ &entry, entry.resource_type_id(), new_time_stamp, {} });
+        pending.push_back({ entry.resource_id(), false });
+    };
+
+    // First, the resources whose own files have changed.
+    for (const ChangedFile& file : changed) {
+        pending.push_back({ file.filename, true });
+        if (file.entry == nullptr) {
+            continue;
         }
 
-        std::shared_lock entry_lock{ fi.entry->mutex };
+        std::unique_lock entry_lock{ file.entry->mutex };
 
-        if (!fi.entry->is_loaded() || !fi.entry->get_resource().should_reload_on_file_change()) {
-            return false;
+        // The file may now be provided by another file loader.
+        const bool has_changed = &file.entry->loader() != file.loader ||
+                                 has_file_changed(file, file.entry->time_stamp());
+        file.entry->m_p_loader = file.loader;
+
+        if (has_changed && is_reloadable(*file.entry) &&
+            !result_indices.contains(file.filename)) {
+            add_to_result(*file.entry, file.time_stamp);
         }
+    }
+
+    // Then, transitively, the resources depending on changed files or on reloaded resources.
+    // Only the affected part of the dependency graph is visited, thanks to the reverse index.
+    for (size_t i = 0; i < pending.size(); ++i) {
+        const Pending current = pending[i];
+
+        for (ResourceEntryBase* dependant : dependants_of(current.file)) {
+            if (result_indices.contains(dependant->resource_id())) {
+                continue;
+            }
 
-        // First, check whether resource file has been updated.
-        if (has_file_changed(fi, fi.entry->time_stamp())) {
-            return true;
+            std::shared_lock entry_lock{ dependant->mutex };
+            if (!is_reloadable(*dependant)) {
+                continue;
+            }
+
+            if (current.file_has_changed) {
+                // Skip dependants that already loaded the current version of the file.
+                const auto it = std::ranges::find(dependant->dependencies,
+                                                  current.file,
+                                                  &ResourceEntryBase::Dependency::dependency_id);
+                const ChangedFile* file = find_changed(current.file);
+                const bool has_changed = it != dependant->dependencies.end() &&
+                                         (file == nullptr ||
+                                          has_file_changed(*file, it->time_stamp));
+                if (!has_changed) {
+                    continue;
+                }
+            }
+
+            // The dependant's own file is unchanged (or it would have been added above).
+            add_to_result(*dependant, dependant->time_stamp());
         }
+    }
 
-        // Then, check whether dependencies have been updated.
-        return dependencies_were_updated(*fi.entry);
-    };
+    // Record dependency relations within the set before unloading, since that clears them.
+    for (ReloadInfo& info : result) {
+        std::unique_lock entry_lock{ info.entry->mutex };
 
-    struct ReloadInfo {
-        ResourceEntryBase& entry;
-        Identifier resource_type_id;
-        std::time_t new_time_stamp;
-    };
-    std::vector<ReloadInfo> entries_to_reload;
+        for (const ResourceEntryBase::Dependency& dependency : info.entry->dependencies) {
+            if (auto it = result_indices.find(dependency.dependency_id);
+                it != result_indices.end()) {
+                info.dependencies.push_back(it->second);
+            }
+        }
 
-    // Scope for lock.
-    {
-        std::shared_lock lock{ m_file_list_mutex };
+        if (info.entry->is_loaded()) {
+            info.entry->unload();
+        }
+    }
+
+    return result;
+}
+
+void ResourceCache::reload_resources(std::span<ReloadInfo> resources)
+{
+    // Load in waves, where each wave contains the resources whose dependencies have all been
+    // reloaded (Kahn's algorithm). Resources within a wave are loaded in parallel.
+    std::vector<size_t> num_pending_dependencies(resources.size(), 0);
+    std::vector<std::vector<size_t>> dependants(resources.size());
+    std::vector<size_t> wave;
+
+    for (size_t i = 0; i < resources.size(); ++i) {
+        for (const size_t dependency : resources[i].dependencies) {
+            ++num_pending_dependencies[i];
+            dependants[dependency].push_back(i);
+        }
+        if (num_pending_dependencies[i] == 0) {
+            wave.push_back(i);
+        }
+    }
+
+    size_t num_reloaded = 0;
+    std::vector<std::shared_future<void>> loads;
+
+    while (!wave.empty()) {
+        loads.clear();
+        for (const size_t i : wave) {
+            loads.push_back(enqueue_load(*resources[i].entry));
+        }
 
-        // Create list of files to reload and unload the resources.
-        for (const FileInfo& file : m_file_list) {
-            if (should_reload(file)) {
-                std::unique_lock entry_lock(file.entry->mutex);
-                entries_to_reload.push_back(
-                    ReloadInfo{ *file.entry, file.entry->resource_type_id(), file.time_stamp });
-                file.entry->unload();
+        // Failures are logged by the loading resource, which is then left unloaded, to be retried
+        // on next access.
+        for (const std::shared_future<void>& load : loads) {
+            load.wait();
+        }
+
+        std::vector<size_t> next_wave;
+        for (const size_t i : wave) {
+            for (const size_t dependant : dependants[i]) {
+                if (--num_pending_dependencies[dependant] == 0) {
+                    next_wave.push_back(dependant);
+                }
             }
         }
+
+        num_reloaded += wave.size();
+        wave = std::move(next_wave);
+    }
+
+    if (num_reloaded < resources.size()) {
+        log_warning("<N/A>",
+                    "Cyclic dependencies between resources; some resources will be reloaded on "
+                    "next access.");
+    }
+}
+
+void ResourceCache::notify_file_changed_trackers(std::span<const ReloadInfo> resources)
+{
+    FlatMap<Identifier, std::vector<FileChangedEvent>, Identifier::HashCompare> events_by_type;
+
+    for (const ReloadInfo& info : resources) {
+        const BaseResourceHandle handle{ info.entry->resource_id(), *info.entry };
+        events_by_type[info.resource_type_id].push_back(
+            { handle, info.resource_type_id, info.new_time_stamp });
     }
 
-    // Notify trackers of file changes.
-    for (const auto& [entry, resource_type, new_time_stamp] : entries_to_reload) {
-        const BaseResourceHandle handle{ entry.resource_id(), entry };
-        auto trackers = m_file_changed_trackers_by_resource_type[resource_type];
-        for (std::weak_ptr<FileChangedTracker>& tracker : trackers) {
+    for (const auto& [resource_type, events] : events_by_type) {
+        auto it = m_file_changed_trackers_by_resource_type.find(resource_type);
+        if (it == m_file_changed_trackers_by_resource_type.end()) {
+            continue;
+        }
+
+        // Copy, since trackers may be added or removed by the callbacks.
+        const auto trackers = it->second;
+        for (const std::weak_ptr<FileChangedTracker>& tracker : trackers) {
             if (auto strong = tracker.lock(); strong != nullptr) {
-                strong->notify_update({ handle, resource_type, new_time_stamp });
+                strong->notify_updates(events);
             }
         }
     }
+}
 
-    // Clear out unused file changed trackers
-    for (auto&& [resource_type, trackers] : m_file_changed_trackers_by_resource_type) {
-        std::erase_if(trackers, [](std::weak_ptr<FileChangedTracker>& p) { return p.expired(); });
-    }
+std::vector<ResourceEntryBase*> ResourceCache::dependants_of(Identifier file) const
+{
+    std::lock_guard lock{ m_dependants_mutex };
+    const auto it = m_dependants.find(file);
+    return it != m_dependants.end() ? it->second : std::vector<ResourceEntryBase*>{};
 }
 
 // Compare FileInfo struct and Identifier by filename hash.
@@ -157,38 +359,160 @@ Opt<ResourceCache::FileInfo&> ResourceCache::file_info(Identifier file)
     return file_info_impl(m_file_list, file);
 }
 
-// Rebuilds available-file list data structure.
-void ResourceCache::rebuild_file_list()
+std::vector<Identifier> ResourceCache::update_file_list()
 {
     // Caller (i.e. refresh()) is responsible for locking m_file_list_mutex.
-    log_verbose("<N/A>", "(Re-) Building file list...");
+    std::vector<Identifier> changed_files;
+
+    for (auto&& p_loader : file_loaders()) {
+        MG_ASSERT(p_loader != nullptr);
+
+        Opt<FileListDelta> delta = p_loader->changed_files();
+        if (!delta) {
+            log.verbose("Refreshing file list for '{}'", p_loader->name());
+            delta = make_file_list_delta(*p_loader, p_loader->available_files());
+        }
+
+        apply_file_list_delta(*p_loader, *delta, changed_files);
+    }
+
+    return changed_files;
+}
+
+FileListDelta ResourceCache::make_file_list_delta(const IFileLoader& loader,
+                                                  std::span<const FileRecord> records) const
+{
+    FileListDelta delta;
+    delta.added_or_modified.assign(records.begin(), records.end());
 
-    // Update file list with the new file record.
-    const auto update_file_list = [&](const FileRecord& file_record, IFileLoader& loader) {
-        const auto filename = file_record.name;
-        auto it = std::lower_bound(m_file_list.begin(), m_file_list.end(), filename, cmp_filename);
+    // All listed files may have been added or modified; apply_file_list_delta() ignores those that
+    // are unchanged. Files from this loader that are no longer listed have been removed.
+    std::ranges::sort(delta.added_or_modified, Identifier::HashCompare{}, &FileRecord::name);
 
-        // If not found, insert new FileInfo
-        if (it == m_file_list.end() || it->filename != filename) {
-            m_file_list.insert(it, FileInfo{ filename, file_record.time_stamp, &loader, nullptr });
-            return;
+    for (const FileInfo& file : m_file_list) {
+        if (file.loader != &loader) {
+            continue;
         }
 
-        // Update old FileInfo, if new record has greater time stamp.
-        if (file_record.time_stamp > it->time_stamp) {
-            it->time_stamp = file_record.time_stamp;
-            it->loader = &loader;
+        const auto [first, last] = std::ranges::equal_range(delta.added_or_modified,
+                                                            file.filename,
+                                                            Identifier::HashCompare{},
+                                                            &FileRecord::name);
+        const bool is_listed = std::any_of(first, last, [&](const FileRecord& record) {
+            return record.name == file.filename;
+        });
+        if (!is_listed) {
+            delta.removed.push_back(file.filename);
         }
-    };
+    }
 
-    for (auto&& p_loader : file_loaders()) {
-        MG_ASSERT(p_loader != nullptr);
-        log.verbose("Refreshing file list for '{}'", p_loader->name());
+    return delta;
+}
+
+void ResourceCache::apply_file_list_delta(IFileLoader& loader,
+                                          const FileListDelta& delta,
+                                          std::vector<Identifier>& changed_files)
+{
+    // Caller (i.e. refresh()) is responsible for locking m_file_list_mutex.
+
+    // Files that are not yet in the list are merged in all at once afterwards, since inserting
+    // them one at a time into the sorted list would take quadratic time.
+    std::vector<FileInfo> new_files;
+
+    for (const FileRecord& record : delta.added_or_modified) {
+        Opt<FileInfo&> file = file_info(record.name);
+        if (!file) {
+            new_files.push_back(FileInfo{ record.name, record.time_stamp, &loader, nullptr });
+            continue;
+        }
+
+        // If the file is available in multiple loaders, use the one with the greater time stamp.
+        const bool has_changed = file->loader == &loader ? record.time_stamp != file->time_stamp
+                                                         : record.time_stamp > file->time_stamp;
+        if (has_changed) {
+            file->time_stamp = record.time_stamp;
+            file->loader = &loader;
+            changed_files.push_back(record.name);
+        }
+    }
+
+    bool has_removed_files = false;
+
+    for (const Identifier& removed_file : delta.removed) {
+        Opt<FileInfo&> file = file_info(removed_file);
+        if (!file || file->loader != &loader) {
+            continue;
+        }
+
+        // Fall back to the most recent version of the file in another loader, if there is one.
+        IFileLoader* replacement = nullptr;
+        std::time_t replacement_time_stamp{};
+        for (auto&& p_other_loader : file_loaders()) {
+            if (p_other_loader.get() == &loader || !p_other_loader->file_exists(removed_file)) {
+                continue;
+            }
+
+            const auto time_stamp = p_other_loader->file_time_stamp(removed_file);
+            if (replacement == nullptr || time_stamp > replacement_time_stamp) {
+                replacement = p_other_loader.get();
+                replacement_time_stamp = time_stamp;
+            }
+        }
+
+        if (replacement != nullptr) {
+            file->loader = replacement;
+            file->time_stamp = replacement_time_stamp;
+            changed_files.push_back(removed_file);
+        }
+        else if (file->entry == nullptr) {
+            file->loader = nullptr; // Mark for removal.
+            has_removed_files = true;
+        }
+        else {
+            // Resource handles may refer to the entry, so it must be kept.
+            log_verbose(removed_file, "File was removed, keeping the resource entry.");
+        }
+    }
+
+    if (has_removed_files) {
+        std::erase_if(m_file_list, [](const FileInfo& file) { return file.loader == nullptr; });
+    }
+
+    if (new_files.empty()) {
+        return;
+    }
 
-        for (auto&& fr : p_loader->available_files()) {
-            update_file_list(fr, *p_loader);
+    // Sort by hash, and by name for files with the same hash, so that duplicates are adjacent.
+    std::ranges::sort(new_files, [](const FileInfo& l, const FileInfo& r) {
+        if (l.filename.hash() != r.filename.hash()) {
+            return l.filename.hash() < r.filename.hash();
         }
+        return l.filename.str_view() < r.filename.str_view();
+    });
+
+    // If a loader lists the same file more than once, keep the record with greatest time stamp.
+    std::vector<FileInfo> unique_new_files;
+    unique_new_files.reserve(new_files.size());
+    for (FileInfo& file : new_files) {
+        if (!unique_new_files.empty() && unique_new_files.back().filename == file.filename) {
+            unique_new_files.back().time_stamp = std::max(unique_new_files.back().time_stamp,
+                                                          file.time_stamp);
+            continue;
+        }
+        unique_new_files.push_back(std::move(file));
     }
+
+    std::vector<FileInfo> merged_file_list;
+    merged_file_list.reserve(m_file_list.size() + unique_new_files.size());
+    std::merge(std::make_move_iterator(m_file_list.begin()),
+               std::make_move_iterator(m_file_list.end()),
+               std::make_move_iterator(unique_new_files.begin()),
+               std::make_move_iterator(unique_new_files.end()),
+               std::back_inserter(merged_file_list),
+               [](const FileInfo& l, const FileInfo& r) {
+                   return l.filename.hash() < r.filename.hash();
+               });
+    m_file_list = std::move(merged_file_list);
 }
 
 // Throw ResourceNotFound exception and write details to log.
@@ -239,71 +563,235 @@ void ResourceCache::log_error(Identifier resource, std::string_view message) con
 // Unload the least recently used resource for which is not currently in use.
 bool ResourceCache::unload_unused(bool unload_all_unused) const
 {
-    // unload_unused does not modify anything in the file list itself, so shared lock suffices.
-    std::shared_lock lock{ m_file_list_mutex };
+    if (unload_all_unused) {
+        log_verbose("<N/A>", "Unloading all unused resources.");
+    }
 
-    const auto is_unloadable = [](const ResourceEntryBase& entry) -> bool {
-        return entry.ref_count == 0 && entry.is_loaded();
-    };
+    const size_t max_num_to_unload = unload_all_unused ? std::numeric_limits<size_t>::max() : 1;
+    return unload_least_recently_used(max_num_to_unload, nullopt, nullptr) > 0;
+}
 
-    const auto try_unload = [&](const FileInfo& file_info) -> bool {
-        using namespace std::chrono_literals;
-        if (file_info.entry == nullptr || file_info.entry->ref_count != 0) {
-            return false;
-        }
+void ResourceCache::set_memory_budget(size_t num_bytes)
+{
+    m_memory_budget = num_bytes;
+    log_verbose("<N/A>", std::format("Memory budget set to {} bytes.", num_bytes));
+    unload_least_recently_used(std::numeric_limits<size_t>::max(), num_bytes, nullptr);
+}
 
-        ResourceEntryBase& entry = *file_info.entry;
-        std::unique_lock entry_lock{ entry.mutex, 100ms };
+ResourceCacheStatistics ResourceCache::statistics() const
+{
+    ResourceCacheStatistics result;
+    std::vector<const ResourceEntryBase*> entries;
 
-        if (!entry_lock.owns_lock() || !is_unloadable(entry)) {
-            return false;
+    // Entries are never destroyed while the cache exists, so they can be examined after releasing
+    // the lock.
+    {
+        std::shared_lock lock{ m_file_list_mutex };
+        for (const FileInfo& file_info : m_file_list) {
+            if (file_info.entry) {
+                entries.push_back(file_info.entry.get());
+            }
         }
+    }
 
-        entry.unload();
-        log_verbose(file_info.filename, "Unloaded unused resource.");
-        return true;
-    };
+    // The loaded resources are exactly those in the LRU list, and their resident sizes do not
+    // change while they are in it.
+    std::unordered_map<const ResourceEntryBase*, size_t> resident_sizes;
+    {
+        std::lock_guard lock{ m_lru_mutex };
+        for (const ResourceEntryBase* entry = m_lru_head; entry; entry = entry->m_lru_next) {
+            resident_sizes.emplace(entry, entry->resident_size_bytes());
+        }
+    }
 
-    if (unload_all_unused) {
-        log_verbose("<N/A>", "Unloading all unused resources.");
-        size_t num_unloaded = 0;
+    std::unordered_map<Identifier, ResourceTypeStatistics> type_statistics;
 
-        for (const FileInfo& file_info : m_file_list) {
-            if (try_unload(file_info)) {
-                ++num_unloaded;
-            }
+    for (const ResourceEntryBase* entry : entries) {
+        const auto load_ns = [](const std::atomic_int64_t& value) {
+            return std::chrono::nanoseconds{ value.load(std::memory_order_relaxed) };
+        };
+        const ResourceEntryBase::Counters& counters = entry->counters;
+
+        ResourceStatistics& stats = result.resources.emplace_back();
+        stats.resource_id = entry->resource_id();
+        stats.counters.num_hits = counters.num_hits.load(std::memory_order_relaxed);
+        stats.counters.num_misses = counters.num_misses.load(std::memory_order_relaxed);
+        stats.counters.num_loads = counters.num_loads.load(std::memory_order_relaxed);
+        stats.counters.bytes_read = counters.bytes_read.load(std::memory_order_relaxed);
+        stats.counters.io_time = load_ns(counters.io_time_ns);
+        stats.counters.load_time = load_ns(counters.load_time_ns);
+        stats.counters.lock_wait_time = load_ns(counters.lock_wait_time_ns);
+
+        if (auto it = resident_sizes.find(entry); it != resident_sizes.end()) {
+            stats.is_loaded = true;
+            stats.counters.resident_size_bytes = it->second;
+        }
+
+        if (entry->has_been_loaded()) {
+            stats.resource_type_id = entry->resource_type_id();
         }
 
-        return num_unloaded > 0;
+        ResourceTypeStatistics& type_stats = type_statistics[stats.resource_type_id];
+        type_stats.resource_type_id = stats.resource_type_id;
+        ++type_stats.num_resources;
+        type_stats.num_loaded += stats.is_loaded ? 1 : 0;
+        type_stats.counters += stats.counters;
+
+        result.total += stats.counters;
     }
 
-    // Create vector of FileInfos sorted so that ResourceEntry with earliest last-access time
-    // comes first (and thus unload resources in least-recently-used order).
-    std::vector<const FileInfo*> file_infos;
-    file_infos.reserve(m_file_list.size());
-    for (const FileInfo& file_info : m_file_list) {
-        file_infos.push_back(&file_info);
+    for (auto& [type_id, type_stats] : type_statistics) {
+        result.resource_types.push_back(type_stats);
     }
 
-    const auto lru_order = [](const FileInfo* l, const FileInfo* r) {
-        if (l->entry == nullptr) {
-            return false;
+    std::ranges::sort(result.resources,
+                      Identifier::LexicalCompare{},
+                      &ResourceStatistics::resource_id);
+    std::ranges::sort(result.resource_types,
+                      Identifier::LexicalCompare{},
+                      &ResourceTypeStatistics::resource_type_id);
+
+    return result;
+}
+
+void ResourceCache::on_resource_loaded(ResourceEntryBase& entry)
+{
+    // Caller (ResourceEntryBase::load_resource) holds unique lock on entry.mutex.
+    {
+        std::lock_guard lock{ m_dependants_mutex };
+        for (const ResourceEntryBase::Dependency& dependency : entry.dependencies) {
+            m_dependants[dependency.dependency_id].push_back(&entry);
         }
-        if (r->entry == nullptr) {
-            return true;
+    }
+
+    {
+        std::lock_guard lock{ m_lru_mutex };
+        entry.last_access = std::time(nullptr);
+        lru_push_front(entry);
+        m_resident_size_bytes += entry.resident_size_bytes();
+    }
+
+    const size_t budget = m_memory_budget;
+    if (m_resident_size_bytes > budget) {
+        unload_least_recently_used(std::numeric_limits<size_t>::max(), budget, &entry);
+    }
+}
+
+void ResourceCache::on_resource_unloaded(ResourceEntryBase& entry)
+{
+    // Caller (ResourceEntryBase::unload) holds unique lock on entry.mutex.
+    {
+        std::lock_guard lock{ m_dependants_mutex };
+        for (const ResourceEntryBase::Dependency& dependency : entry.dependencies) {
+            auto it = m_dependants.find(dependency.dependency_id);
+            if (it == m_dependants.end()) {
+                continue; // Not indexed, since the entry failed to load.
+            }
+            std::erase(it->second, &entry);
+            if (it->second.empty()) {
+                m_dependants.erase(it);
+            }
         }
-        return l->entry->last_access < r->entry->last_access;
+    }
+
+    std::lock_guard lock{ m_lru_mutex };
+
+    // Entries that failed to load were never inserted.
+    const bool is_in_list = entry.m_lru_prev != nullptr || m_lru_head == &entry;
+    if (is_in_list) {
+        lru_unlink(entry);
+        m_resident_size_bytes -= entry.resident_size_bytes();
+    }
+}
+
+void ResourceCache::on_resource_accessed(ResourceEntryBase& entry)
+{
+    // Caller (ResourceAccessGuard) holds shared lock on entry.mutex, so entry remains loaded.
+    std::lock_guard lock{ m_lru_mutex };
+    entry.last_access = std::time(nullptr);
+    if (m_lru_head != &entry) {
+        lru_unlink(entry);
+        lru_push_front(entry);
+    }
+}
+
+void ResourceCache::lru_push_front(ResourceEntryBase& entry) noexcept
+{
+    MG_ASSERT_DEBUG(entry.m_lru_prev == nullptr && entry.m_lru_next == nullptr);
+    entry.m_lru_next = m_lru_head;
+    if (m_lru_head != nullptr) {
+        m_lru_head->m_lru_prev = &entry;
+    }
+    m_lru_head = &entry;
+    if (m_lru_tail == nullptr) {
+        m_lru_tail = &entry;
+    }
+}
+
+void ResourceCache::lru_unlink(ResourceEntryBase& entry) noexcept
+{
+    if (entry.m_lru_prev != nullptr) {
+        entry.m_lru_prev->m_lru_next = entry.m_lru_next;
+    }
+    else {
+        m_lru_head = entry.m_lru_next;
+    }
+
+    if (entry.m_lru_next != nullptr) {
+        entry.m_lru_next->m_lru_prev = entry.m_lru_prev;
+    }
+    else {
+        m_lru_tail = entry.m_lru_prev;
+    }
+
+    entry.m_lru_prev = nullptr;
+    entry.m_lru_next = nullptr;
+}
+
+size_t ResourceCache::unload_least_recently_used(const size_t max_num_to_unload,
+                                                 const Opt<size_t> target_resident_size,
+                                                 const ResourceEntryBase* keep) const
+{
+    struct Victim {
+        ResourceEntryBase* entry;
+        std::unique_lock<std::shared_timed_mutex> lock;
     };
+    std::vector<Victim> victims;
 
-    sort(file_infos, lru_order);
+    // Select victims in a single pass from the back of the LRU list. Only try-lock entries, since
+    // we hold m_lru_mutex (see lock-order comment in header). Entries that are locked are either in
+    // use or being unloaded by another thread, either way we skip them.
+    {
+        std::lock_guard lru_lock{ m_lru_mutex };
+        size_t resident_size = m_resident_size_bytes;
+        const auto is_done = [&] {
+            return victims.size() >= max_num_to_unload ||
+                   (target_resident_size && resident_size <= *target_resident_size);
+        };
 
-    for (const FileInfo* p_file_info : file_infos) {
-        if (try_unload(*p_file_info)) {
-            return true;
+        for (ResourceEntryBase* entry = m_lru_tail; entry != nullptr && !is_done();
+             entry = entry->m_lru_prev) {
+            if (entry == keep || entry->ref_count != 0) {
+                continue;
+            }
+
+            std::unique_lock entry_lock{ entry->mutex, std::try_to_lock };
+            if (!entry_lock.owns_lock() || entry->ref_count != 0 || !entry->is_loaded()) {
+                continue;
+            }
+
+            resident_size -= std::min(resident_size, entry->resident_size_bytes());
+            victims.push_back({ entry, std::move(entry_lock) });
         }
     }
 
-    return false;
+    // Unload outside of m_lru_mutex, since unloading relocks it.
+    for (Victim& victim : victims) {
+        victim.entry->unload();
+        log_verbose(victim.entry->resource_id(), "Unloaded unused resource.");
+    }
+
+    return victims.size();
 }
 
 } // namespace Mg
@@ -0,0 +1,168 @@
+//**************************************************************************************************
+// This file is part of Mg Engine. Copyright (c) 2026, Magnus Bergsten.
+// Mg Engine is made available under the terms of the 3-Clause BSD License.
+// See LICENSE.txt in the project's root directory.
+//**************************************************************************************************
+
+#include "mg/core/resource_cache/mg_resource_cache_statistics.h"
+
+#include <format>
+#include <iterator>
+#include <string_view>
+
+namespace Mg {
+
+ResourceCounters& ResourceCounters::operator+=(const ResourceCounters& rhs) noexcept
+{
+    num_hits += rhs.num_hits;
+    num_misses += rhs.num_misses;
+    num_loads += rhs.num_loads;
+    bytes_read += rhs.bytes_read;
+    io_time += rhs.io_time;
+    load_time += rhs.load_time;
+    lock_wait_time += rhs.lock_wait_time;
+    resident_size_bytes += rhs.resident_size_bytes;
+    return *this;
+}
+
+namespace {
+
+double to_microseconds(std::chrono::nanoseconds duration)
+{
+    return std::chrono::duration<double, std::micro>(duration).count();
+}
+
+// Quote a CSV field if needed, see RFC 4180.
+void append_csv_field(std::string& out, std::string_view field)
+{
+    if (field.find_first_of(",\"\r\n") == std::string_view::npos) {
+        out += field;
+        return;
+    }
+
+    out += '"';
+    for (const char c : field) {
+        if (c == '"') {
+            out += '"';
+        }
+        out += c;
+    }
+    out += '"';
+}
+
+void append_json_string(std::string& out, std::string_view str)
+{
+    out += '"';
+    for (const char c : str) {
+        switch (c) {
+        case '"':
+            out += "\\\"";
+            break;
+        case '\\':
+            out += "\\\\";
+            break;
+        case '\n':
+            out += "\\n";
+            break;
+        case '\r':
+            out += "\\r";
+            break;
+        case '\t':
+            out += "\\t";
+            break;
+        default:
+            if (static_cast<unsigned char>(c) < 0x20) {
+                std::format_to(std::back_inserter(out), "\\u{:04x}", c);
+            }
+            else {
+                out += c;
+            }
+        }
+    }
+    out += '"';
+}
+
+// Append the counters as JSON object members, without enclosing braces.
+void append_json_counters(std::string& out, const ResourceCounters& counters)
+{
+    std::format_to(std::back_inserter(out),
+                   "\"num_hits\":{},\"num_misses\":{},\"num_loads\":{},\"bytes_read\":{},"
+                   "\"io_time_us\":{:.3f},\"load_time_us\":{:.3f},\"lock_wait_time_us\":{:.3f},"
+                   "\"resident_size_bytes\":{}",
+                   counters.num_hits,
+                   counters.num_misses,
+                   counters.num_loads,
+                   counters.bytes_read,
+                   to_microseconds(counters.io_time),
+                   to_microseconds(counters.load_time),
+                   to_microseconds(counters.lock_wait_time),
+                   counters.resident_size_bytes);
+}
+
+} // namespace
+
+std::string to_csv(const ResourceCacheStatistics& statistics)
+{
+    std::string result =
+        "resource,type,loaded,hits,misses,loads,bytes_read,io_time_us,load_time_us,"
+        "lock_wait_time_us,resident_size_bytes\n";
+
+    for (const ResourceStatistics& resource : statistics.resources) {
+        const ResourceCounters& counters = resource.counters;
+        append_csv_field(result, resource.resource_id.str_view());
+        result += ',';
+        append_csv_field(result, resource.resource_type_id.str_view());
+        std::format_to(std::back_inserter(result),
+                       ",{},{},{},{},{},{:.3f},{:.3f},{:.3f},{}\n",
+                       resource.is_loaded ? 1 : 0,
+                       counters.num_hits,
+                       counters.num_misses,
+                       counters.num_loads,
+                       counters.bytes_read,
+                       to_microseconds(counters.io_time),
+                       to_microseconds(counters.load_time),
+                       to_microseconds(counters.lock_wait_time),
+                       counters.resident_size_bytes);
+    }
+
+    return result;
+}
+
+std::string to_json(const ResourceCacheStatistics& statistics)
+{
+    std::string result = "{\"total\":{";
+    append_json_counters(result, statistics.total);
+    result += "},\"resource_types\":[";
+
+    for (size_t i = 0; i < statistics.resource_types.size(); ++i) {
+        const ResourceTypeStatistics& type = statistics.resource_types[i];
+        result += i == 0 ? "{\"type\":" : ",{\"type\":";
+        append_json_string(result, type.resource_type_id.str_view());
+        std::format_to(std::back_inserter(result),
+                       ",\"num_resources\":{},\"num_loaded\":{},",
+                       type.num_resources,
+                       type.num_loaded);
+        append_json_counters(result, type.counters);
+        result += '}';
+    }
+
+    result += "],\"resources\":[";
+
+    for (size_t i = 0; i < statistics.resources.size(); ++i) {
+        const ResourceStatistics& resource = statistics.resources[i];
+        result += i == 0 ? "{\"resource\":" : ",{\"resource\":";
+        append_json_string(result, resource.resource_id.str_view());
+        result += ",\"type\":";
+        append_json_string(result, resource.resource_type_id.str_view());
+        std::format_to(std::back_inserter(result),
+                       ",\"loaded\":{},",
+                       resource.is_loaded ? "true" : "false");
+        append_json_counters(result, resource.counters);
+        result += '}';
+    }
+
+    result += "]}";
+    return result;
+}
+
+} // namespace Mg
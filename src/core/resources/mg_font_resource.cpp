@@ -12,7 +12,7 @@ namespace Mg {
 
 LoadResourceResult FontResource::load_resource_impl(ResourceLoadingInput& input)
 {
-    m_font_data = input.take_resource_data();
+    m_font_data = input.share_resource_data();
     return LoadResourceResult::success();
 }
 
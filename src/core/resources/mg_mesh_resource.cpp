@@ -13,9 +13,14 @@
 #include "mg/core/resources/mg_mesh_resource_data.h"
 #include "mg/utils/mg_stl_helpers.h"
 
+#include <algorithm>
+#include <array>
+#include <cstdint>
 #include <cstdlib>
 #include <cstring>
 #include <format>
+#include <functional>
+#include <span>
 #include <type_traits>
 
 namespace Mg {
@@ -23,10 +28,20 @@ namespace Mg {
 using namespace gfx::mesh_data;
 
 struct MeshResource::Data {
-    Array<Vertex> vertices;
-    Array<Index> indices;
+    // Vertex, index, and influence data. These refer either directly into `file_data` (for mesh
+    // format version 3 and later), or to the corresponding `_storage` array.
+    std::span<const Vertex> vertices;
+    std::span<const CompactVertex> compact_vertices;
+    std::span<const Index> indices;
+    std::span<const Influences> influences;
+
+    SharedFileData file_data;
+    Array<Vertex> vertex_storage;
+    Array<CompactVertex> compact_vertex_storage;
+    Array<Index> index_storage;
+    Array<Influences> influence_storage;
+
     Array<Submesh> submeshes;
-    Array<Influences> influences;
     Array<Joint> joints;
     Array<AnimationClip> animation_clips;
 
@@ -67,6 +82,9 @@ template<typename T> size_t load_to_struct(std::span<const std::byte> bytestream
 struct LoadResult {
     std::unique_ptr<MeshResource::Data> data;
     std::string error_reason;
+
+    // Whether the data is known to be valid, so that index bounds need not be checked.
+    bool has_valid_indices = false;
 };
 
 template<typename T> Array<T> read_range(std::span<const std::byte> bytestream, FileDataRange range)
@@ -92,6 +110,40 @@ template<typename T> Array<T> read_range(std::span<const std::byte> bytestream,
     return result;
 }
 
+// Get a span of the elements in the given range, referring directly into the bytestream if the data
+// is suitably aligned, or else to a copy in `storage`. Returns false if the range is invalid.
+template<typename T>
+bool view_range(std::span<const std::byte> bytestream,
+                FileDataRange range,
+                std::span<const T>& out,
+                Array<T>& storage)
+{
+    static_assert(std::is_trivially_copyable_v<T>);
+
+    out = {};
+    if (range.begin == range.end) {
+        return true;
+    }
+
+    const size_t range_length_bytes = range.end - range.begin;
+    if (range.end < range.begin || range_length_bytes % sizeof(T) != 0 ||
+        range.end > bytestream.size()) {
+        return false;
+    }
+
+    // Ranges are aligned within version 3 and later files, but the buffer holding the file data
+    // may not be (depending on the file loader).
+    const std::byte* begin = &bytestream[range.begin];
+    if (reinterpret_cast<uintptr_t>(begin) % alignof(T) != 0) { // NOLINT
+        storage = read_range<T>(bytestream, range);
+        out = storage;
+        return true;
+    }
+
+    out = { reinterpret_cast<const T*>(begin), range_length_bytes / sizeof(T) }; // NOLINT
+    return true;
+}
+
 std::string_view read_string(std::span<const std::byte> bytestream, FileDataRange range)
 {
     const size_t range_length_bytes = range.end - range.begin;
@@ -102,13 +154,70 @@ std::string_view read_string(std::span<const std::byte> bytestream, FileDataRang
     return { reinterpret_cast<const char*>(&bytestream[range.begin]), range_length_bytes };
 }
 
-LoadResult load_version_2(ResourceLoadingInput& input, [[maybe_unused]] std::string_view meshname)
+// Read compressed animation clips (mesh format version 5 and later), and merge them with the
+// uncompressed ones. Compressed clips are placed at the index they had in the source file, and the
+// uncompressed ones fill the remaining positions in order.
+template<typename GetString>
+void read_compressed_animation_clips(std::span<const std::byte> bytestream,
+                                     const MeshResourceData::Header& header,
+                                     MeshResource::Data& data,
+                                     const GetString& get_string)
 {
-    const std::span<const std::byte> bytestream = input.resource_data();
+    const auto clip_records =
+        read_range<MeshResourceData::CompressedAnimationClip>(bytestream,
+                                                              header.compressed_animations);
+    if (clip_records.empty()) {
+        return;
+    }
 
-    MeshResourceData::Header header = {};
-    load_to_struct(bytestream, header);
+    using CompressedAnimationClipRecord = MeshResourceData::CompressedAnimationClip;
+    const size_t num_clips = data.animation_clips.size() + clip_records.size();
+    auto records_by_index = Array<const CompressedAnimationClipRecord*>::make(num_clips, nullptr);
+
+    for (const CompressedAnimationClipRecord& clip_record : clip_records) {
+        if (clip_record.index >= num_clips || records_by_index[clip_record.index]) {
+            log.warning("Invalid compressed animation clip indices; appending compressed clips.");
+            std::ranges::fill(records_by_index, nullptr);
+            for (size_t i = 0; i < clip_records.size(); ++i) {
+                records_by_index[data.animation_clips.size() + i] = &clip_records[i];
+            }
+            break;
+        }
+        records_by_index[clip_record.index] = &clip_record;
+    }
+
+    auto clips = Array<AnimationClip>::make(num_clips);
+    size_t next_uncompressed = 0;
+
+    for (size_t i = 0; i < num_clips; ++i) {
+        const CompressedAnimationClipRecord* clip_record = records_by_index[i];
+        if (!clip_record) {
+            clips[i] = std::move(data.animation_clips[next_uncompressed++]);
+            continue;
+        }
 
+        AnimationClip& clip = clips[i];
+        clip.name = Identifier::from_runtime_string(get_string(clip_record->name));
+        clip.duration_seconds = clip_record->duration;
+        clip.compressed.sample_rate = clip_record->sample_rate;
+        clip.compressed.channels =
+            read_range<CompressedAnimationChannel>(bytestream, clip_record->channels);
+        clip.compressed.frames = read_range<uint16_t>(bytestream, clip_record->frames);
+        clip.compressed.values = read_range<std::array<uint16_t, 3>>(bytestream,
+                                                                     clip_record->values);
+    }
+
+    data.animation_clips = std::move(clips);
+}
+
+// Read the parts of the mesh data that are converted when loading: submeshes, joints, and animation
+// clips. These are small compared to the vertex data.
+template<typename HeaderT>
+void read_records(std::span<const std::byte> bytestream,
+                  const HeaderT& header,
+                  MeshResource::Data& data,
+                  [[maybe_unused]] std::string_view meshname)
+{
     const std::string_view strings = read_string(bytestream, header.strings);
 
     auto get_string = [&strings](MeshResourceData::StringRange string) -> std::string_view {
@@ -118,26 +227,21 @@ LoadResult load_version_2(ResourceLoadingInput& input, [[maybe_unused]] std::str
         return strings.substr(string.begin, string.length);
     };
 
-    LoadResult result;
-    result.data = std::make_unique<MeshResource::Data>();
-    result.data->vertices = read_range<Vertex>(bytestream, header.vertices);
-    result.data->indices = read_range<Index>(bytestream, header.indices);
-    result.data->influences = read_range<Influences>(bytestream, header.influences);
-    result.data->bounding_sphere.centre = header.centre;
-    result.data->bounding_sphere.radius = header.radius;
-    result.data->skeleton_root_transform = header.skeleton_root_transform;
+    data.bounding_sphere.centre = header.centre;
+    data.bounding_sphere.radius = header.radius;
+    data.skeleton_root_transform = header.skeleton_root_transform;
 
     MG_LOG_DEBUG("Number of vertices: {}, indices: {}, triangles: {}",
-                 result.data->vertices.size(),
-                 result.data->indices.size(),
-                 result.data->indices.size() / 3u);
+                 data.vertices.size() + data.compact_vertices.size(),
+                 data.indices.size(),
+                 data.indices.size() / 3u);
 
     auto submesh_records = read_range<MeshResourceData::Submesh>(bytestream, header.submeshes);
-    result.data->submeshes = Array<Submesh>::make_for_overwrite(submesh_records.size());
+    data.submeshes = Array<Submesh>::make_for_overwrite(submesh_records.size());
 
     for (size_t i = 0; i < submesh_records.size(); ++i) {
         const MeshResourceData::Submesh& record = submesh_records[i];
-        Submesh& submesh = result.data->submeshes[i];
+        Submesh& submesh = data.submeshes[i];
 
         submesh.index_range.begin = record.begin;
         submesh.index_range.amount = record.num_indices;
@@ -146,15 +250,15 @@ LoadResult load_version_2(ResourceLoadingInput& input, [[maybe_unused]] std::str
         MG_LOG_DEBUG("Loading mesh '{}': found sub-mesh '{}'", meshname, submesh.name.str_view());
         MG_LOG_DEBUG("Submesh range {}:{}", record.begin, record.begin + record.num_indices);
         MG_LOG_DEBUG("Submesh material binding: {}", get_string(record.material));
-        MG_ASSERT_DEBUG(record.begin + record.num_indices <= result.data->indices.size());
+        MG_ASSERT_DEBUG(record.begin + record.num_indices <= data.indices.size());
     }
 
     auto joint_records = read_range<MeshResourceData::Joint>(bytestream, header.joints);
-    result.data->joints = Array<Joint>::make_for_overwrite(joint_records.size());
+    data.joints = Array<Joint>::make_for_overwrite(joint_records.size());
 
     for (size_t i = 0; i < joint_records.size(); ++i) {
         const MeshResourceData::Joint record = joint_records[i];
-        Joint& joint = result.data->joints[i];
+        Joint& joint = data.joints[i];
 
         joint.children = record.children;
         joint.inverse_bind_matrix = record.inverse_bind_matrix;
@@ -162,11 +266,11 @@ LoadResult load_version_2(ResourceLoadingInput& input, [[maybe_unused]] std::str
     }
 
     auto clip_records = read_range<MeshResourceData::AnimationClip>(bytestream, header.animations);
-    result.data->animation_clips = Array<AnimationClip>::make_for_overwrite(clip_records.size());
+    data.animation_clips = Array<AnimationClip>::make_for_overwrite(clip_records.size());
 
     for (size_t i = 0; i < clip_records.size(); ++i) {
         const MeshResourceData::AnimationClip& clip_record = clip_records[i];
-        AnimationClip& clip = result.data->animation_clips[i];
+        AnimationClip& clip = data.animation_clips[i];
         clip.name = Identifier::from_runtime_string(get_string(clip_record.name));
         clip.duration_seconds = narrow_cast<float>(clip_record.duration);
 
@@ -186,9 +290,208 @@ LoadResult load_version_2(ResourceLoadingInput& input, [[maybe_unused]] std::str
         }
     }
 
+    if constexpr (std::is_same_v<HeaderT, MeshResourceData::Header>) {
+        read_compressed_animation_clips(bytestream, header, data, get_string);
+    }
+}
+
+// Header of mesh format version 2. Unlike later versions, data ranges are not aligned, and there
+// is neither checksum nor bounding box (despite the abb_min and abb_max fields).
+struct HeaderV2 {
+    uint32_t four_cc;
+    uint32_t version;
+    glm::vec3 centre;
+    float radius;
+    glm::vec3 abb_min;
+    glm::vec3 abb_max;
+    glm::mat4 skeleton_root_transform;
+    FileDataRange vertices;
+    FileDataRange indices;
+    FileDataRange submeshes;
+    FileDataRange joints;
+    FileDataRange influences;
+    FileDataRange animations;
+    FileDataRange strings;
+};
+
+LoadResult load_version_2(ResourceLoadingInput& input, std::string_view meshname)
+{
+    const std::span<const std::byte> bytestream = input.resource_data();
+
+    HeaderV2 header = {};
+    load_to_struct(bytestream, header);
+
+    LoadResult result;
+    result.data = std::make_unique<MeshResource::Data>();
+    MeshResource::Data& data = *result.data;
+
+    data.vertex_storage = read_range<Vertex>(bytestream, header.vertices);
+    data.index_storage = read_range<Index>(bytestream, header.indices);
+    data.influence_storage = read_range<Influences>(bytestream, header.influences);
+    data.vertices = data.vertex_storage;
+    data.indices = data.index_storage;
+    data.influences = data.influence_storage;
+    data.axis_aligned_bounding_box = calculate_mesh_bounding_box(data.vertices);
+
+    read_records(bytestream, header, data, meshname);
     return result;
 }
 
+// Header of mesh format version 3. Same as version 4, but without compact vertices.
+struct HeaderV3 {
+    uint32_t four_cc;
+    uint32_t version;
+    glm::vec3 centre;
+    float radius;
+    glm::vec3 abb_min;
+    glm::vec3 abb_max;
+    glm::mat4 skeleton_root_transform;
+    FileDataRange vertices;
+    FileDataRange indices;
+    FileDataRange submeshes;
+    FileDataRange joints;
+    FileDataRange influences;
+    FileDataRange animations;
+    FileDataRange strings;
+    uint64_t data_checksum;
+};
+
+// Load mesh with format version 3 or later, where the header (of size `header_size`) has been
+// converted to the current version.
+LoadResult load_aligned_version(ResourceLoadingInput& input,
+                                const MeshResourceData::Header& header,
+                                [[maybe_unused]] const size_t header_size,
+                                std::string_view meshname)
+{
+    // Computing the checksum touches every page of the file, so it is verified only in debug
+    // builds. Release builds instead check index bounds, which touches only the index data.
+#ifndef NDEBUG
+    const auto checksum = MeshResourceData::calculate_checksum(
+        input.resource_data().subspan(header_size));
+    if (checksum != header.data_checksum) {
+        return { nullptr, "Checksum mismatch (file is corrupt).", false };
+    }
+    constexpr bool checksum_verified = true;
+#else
+    constexpr bool checksum_verified = false;
+#endif
+
+    LoadResult result;
+    result.data = std::make_unique<MeshResource::Data>();
+    MeshResource::Data& data = *result.data;
+
+    // Keep the file data, so that vertex, index, and influence data can be used in place.
+    data.file_data = input.share_resource_data();
+    const std::span<const std::byte> bytestream = data.file_data.bytes();
+
+    const bool ranges_valid =
+        view_range(bytestream, header.vertices, data.vertices, data.vertex_storage) &&
+        view_range(bytestream,
+                   header.compact_vertices,
+                   data.compact_vertices,
+                   data.compact_vertex_storage) &&
+        view_range(bytestream, header.indices, data.indices, data.index_storage) &&
+        view_range(bytestream, header.influences, data.influences, data.influence_storage);
+    if (!ranges_valid) {
+        return { nullptr, "Invalid data range.", false };
+    }
+
+    data.axis_aligned_bounding_box = { .min_corner = header.abb_min,
+                                       .max_corner = header.abb_max };
+
+    read_records(bytestream, header, data, meshname);
+
+    // The mesh converter validates indices when writing the file, and the checksum ensures that
+    // they are as written.
+    result.has_valid_indices = checksum_verified;
+    return result;
+}
+
+LoadResult load_version_3(ResourceLoadingInput& input, std::string_view meshname)
+{
+    HeaderV3 header_v3 = {};
+    if (load_to_struct(input.resource_data(), header_v3) < sizeof(header_v3)) {
+        return { nullptr, "File too small to contain header.", false };
+    }
+
+    MeshResourceData::Header header = {};
+    header.four_cc = header_v3.four_cc;
+    header.version = header_v3.version;
+    header.centre = header_v3.centre;
+    header.radius = header_v3.radius;
+    header.abb_min = header_v3.abb_min;
+    header.abb_max = header_v3.abb_max;
+    header.skeleton_root_transform = header_v3.skeleton_root_transform;
+    header.vertices = header_v3.vertices;
+    header.indices = header_v3.indices;
+    header.submeshes = header_v3.submeshes;
+    header.joints = header_v3.joints;
+    header.influences = header_v3.influences;
+    header.animations = header_v3.animations;
+    header.strings = header_v3.strings;
+    header.data_checksum = header_v3.data_checksum;
+
+    return load_aligned_version(input, header, sizeof(HeaderV3), meshname);
+}
+
+// Header of mesh format version 4. Same as the current version, but without compressed animations.
+struct HeaderV4 {
+    uint32_t four_cc;
+    uint32_t version;
+    glm::vec3 centre;
+    float radius;
+    glm::vec3 abb_min;
+    glm::vec3 abb_max;
+    glm::mat4 skeleton_root_transform;
+    FileDataRange vertices;
+    FileDataRange compact_vertices;
+    FileDataRange indices;
+    FileDataRange submeshes;
+    FileDataRange joints;
+    FileDataRange influences;
+    FileDataRange animations;
+    FileDataRange strings;
+    uint64_t data_checksum;
+};
+
+LoadResult load_version_4(ResourceLoadingInput& input, std::string_view meshname)
+{
+    HeaderV4 header_v4 = {};
+    if (load_to_struct(input.resource_data(), header_v4) < sizeof(header_v4)) {
+        return { nullptr, "File too small to contain header.", false };
+    }
+
+    MeshResourceData::Header header = {};
+    header.four_cc = header_v4.four_cc;
+    header.version = header_v4.version;
+    header.centre = header_v4.centre;
+    header.radius = header_v4.radius;
+    header.abb_min = header_v4.abb_min;
+    header.abb_max = header_v4.abb_max;
+    header.skeleton_root_transform = header_v4.skeleton_root_transform;
+    header.vertices = header_v4.vertices;
+    header.compact_vertices = header_v4.compact_vertices;
+    header.indices = header_v4.indices;
+    header.submeshes = header_v4.submeshes;
+    header.joints = header_v4.joints;
+    header.influences = header_v4.influences;
+    header.animations = header_v4.animations;
+    header.strings = header_v4.strings;
+    header.data_checksum = header_v4.data_checksum;
+
+    return load_aligned_version(input, header, sizeof(HeaderV4), meshname);
+}
+
+LoadResult load_version_5(ResourceLoadingInput& input, std::string_view meshname)
+{
+    MeshResourceData::Header header = {};
+    if (load_to_struct(input.resource_data(), header) < sizeof(header)) {
+        return { nullptr, "File too small to contain header.", false };
+    }
+
+    return load_aligned_version(input, header, sizeof(header), meshname);
+}
+
 } // namespace
 
 MeshResource::MeshResource(Identifier id) : BaseResource(id) {}
@@ -199,6 +502,7 @@ MeshDataView MeshResource::data_view() const noexcept
 {
     MeshDataView result{
         .vertices = vertices(),
+        .compact_vertices = compact_vertices(),
         .indices = indices(),
         .submeshes = submeshes(),
         .animation_data = nullopt,
@@ -221,6 +525,10 @@ std::span<const Vertex> MeshResource::vertices() const noexcept
 {
     return m_data ? m_data->vertices : std::span<const Vertex>{};
 }
+std::span<const CompactVertex> MeshResource::compact_vertices() const noexcept
+{
+    return m_data ? m_data->compact_vertices : std::span<const CompactVertex>{};
+}
 std::span<const Index> MeshResource::indices() const noexcept
 {
     return m_data ? m_data->indices : std::span<const Index>{};
@@ -269,6 +577,36 @@ AxisAlignedBoundingBox MeshResource::axis_aligned_bounding_box() const noexcept
     return m_data ? m_data->axis_aligned_bounding_box : AxisAlignedBoundingBox{};
 }
 
+Opt<size_t> MeshResource::resident_size_bytes() const noexcept
+{
+    if (!m_data) {
+        return 0;
+    }
+
+    size_t result = sizeof(Data);
+    result += m_data->file_data.bytes().size();
+    result += m_data->vertex_storage.size() * sizeof(Vertex);
+    result += m_data->compact_vertex_storage.size() * sizeof(CompactVertex);
+    result += m_data->index_storage.size() * sizeof(Index);
+    result += m_data->influence_storage.size() * sizeof(Influences);
+    result += m_data->submeshes.size() * sizeof(Submesh);
+    result += m_data->joints.size() * sizeof(Joint);
+
+    for (const AnimationClip& clip : m_data->animation_clips) {
+        result += sizeof(AnimationClip) + clip.channels.size() * sizeof(AnimationChannel);
+        result += clip.compressed.channels.size() * sizeof(CompressedAnimationChannel);
+        result += clip.compressed.frames.size() * sizeof(uint16_t);
+        result += clip.compressed.values.size() * sizeof(std::array<uint16_t, 3>);
+        for (const AnimationChannel& channel : clip.channels) {
+            result += channel.position_keys.size() * sizeof(PositionKey);
+            result += channel.rotation_keys.size() * sizeof(RotationKey);
+            result += channel.scale_keys.size() * sizeof(ScaleKey);
+        }
+    }
+
+    return result;
+}
+
 LoadResourceResult MeshResource::load_resource_impl(ResourceLoadingInput& input)
 {
     std::span<const std::byte> bytestream = input.resource_data();
@@ -290,6 +628,15 @@ LoadResourceResult MeshResource::load_resource_impl(ResourceLoadingInput& input)
     case 2:
         load_result = load_version_2(input, resource_id().str_view());
         break;
+    case 3:
+        load_result = load_version_3(input, resource_id().str_view());
+        break;
+    case 4:
+        load_result = load_version_4(input, resource_id().str_view());
+        break;
+    case 5:
+        load_result = load_version_5(input, resource_id().str_view());
+        break;
     default:
         return LoadResourceResult::data_error(
             std::format("Unsupported mesh version: {:d}.", header_common.version));
@@ -301,10 +648,7 @@ LoadResourceResult MeshResource::load_resource_impl(ResourceLoadingInput& input)
 
     m_data = std::move(load_result.data);
 
-    // TODO: store bounding box in mesh file.
-    m_data->axis_aligned_bounding_box = calculate_mesh_bounding_box(m_data->vertices);
-
-    if (!validate()) {
+    if (!validate_impl(!load_result.has_valid_indices)) {
         return LoadResourceResult::data_error("Mesh validation failed.");
     }
 
@@ -312,6 +656,11 @@ LoadResourceResult MeshResource::load_resource_impl(ResourceLoadingInput& input)
 }
 
 bool MeshResource::validate() const
+{
+    return validate_impl(true);
+}
+
+bool MeshResource::validate_impl(bool check_index_bounds) const
 {
     bool status = true;
     const auto mesh_error = [&]<typename... Ts>(std::format_string<Ts...> msg, Ts&&... args) {
@@ -323,7 +672,7 @@ bool MeshResource::validate() const
 
     // Check data
     const auto n_submeshes = submeshes().size();
-    const auto n_vertices = vertices().size();
+    const auto n_vertices = vertices().size() + compact_vertices().size();
     const auto n_indices = indices().size();
     const auto n_influences = influences().size();
     const auto n_joints = joints().size();
@@ -347,7 +696,7 @@ bool MeshResource::validate() const
     }
 
     // Check indices
-    for (size_t i = 0; i < n_indices; ++i) {
+    for (size_t i = 0; check_index_bounds && i < n_indices; ++i) {
         const Index& vi = indices()[i];
         if (vi >= n_vertices) {
             mesh_error("Index data out of bounds at index {}, was {}.", i, vi);
@@ -355,6 +704,10 @@ bool MeshResource::validate() const
     }
 
     // Check vertices
+    if (!vertices().empty() && !compact_vertices().empty()) {
+        mesh_error("Mesh has both standard and compact vertices.");
+    }
+
     if (n_vertices > max_vertices_per_mesh) {
         mesh_error("Too many vertices. Max is '{}', was '{}'.", max_vertices_per_mesh, n_vertices);
     }
@@ -402,14 +755,56 @@ bool MeshResource::validate() const
                 mesh_error("Animation clip has no name.");
             }
 
-            if (clip.channels.size() != n_joints) {
+            if (clip.num_channels() != n_joints) {
                 mesh_error(
                     "Animation clip '{}' does not contain one channel per joint; "
                     "had {} channels, expected {}.",
                     clip.name.str_view(),
-                    clip.channels.size(),
+                    clip.num_channels(),
                     n_joints);
             }
+
+            if (!clip.is_compressed()) {
+                continue;
+            }
+
+            // The sampler relies on a positive sample rate, on the key ranges being within
+            // bounds, and on the keys of each track being in increasing order of frame, since it
+            // finds keys by binary search.
+            const CompressedAnimation& compressed = clip.compressed;
+            if (!(compressed.sample_rate > 0.0f)) {
+                mesh_error("Compressed animation clip '{}' has invalid sample rate {}.",
+                           clip.name.str_view(),
+                           compressed.sample_rate);
+            }
+
+            const size_t n_keys = std::min(compressed.frames.size(), compressed.values.size());
+            if (compressed.frames.size() != compressed.values.size()) {
+                mesh_error("Compressed animation clip '{}' has {} frames but {} values.",
+                           clip.name.str_view(),
+                           compressed.frames.size(),
+                           compressed.values.size());
+            }
+
+            const auto is_track_valid = [&](const CompressedAnimationTrack& track) {
+                if (track.first_key > n_keys || track.num_keys > n_keys - track.first_key) {
+                    return false;
+                }
+                const auto frames = std::span<const uint16_t>(compressed.frames)
+                                        .subspan(track.first_key, track.num_keys);
+                return std::ranges::adjacent_find(frames, std::greater_equal{}) == frames.end();
+            };
+
+            for (size_t i = 0; i < compressed.channels.size(); ++i) {
+                const CompressedAnimationChannel& channel = compressed.channels[i];
+                if (!is_track_valid(channel.position_keys) ||
+                    !is_track_valid(channel.rotation_keys) || !is_track_valid(channel.scale_keys)) {
+                    mesh_error("In compressed animation clip '{}': channel {} has keys out of "
+                               "bounds or out of order.",
+                               clip.name.str_view(),
+                               i);
+                }
+            }
         }
     }
 
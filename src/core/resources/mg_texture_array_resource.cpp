@@ -22,12 +22,19 @@ LoadResourceResult TextureArrayResource::load_resource_impl(ResourceLoadingInput
 
     m_textures.clear();
 
+    // Request all textures first, so that they are loaded in parallel.
+    std::vector<ResourceLoadRequest<TextureResource>> requests;
+
     // NOLINTNEXTLINE(modernize-loop-convert) // Hjson::Value::begin/end are only valid for maps
     for (int i = 0; as<size_t>(i) < value.size(); ++i) {
-        m_textures.push_back(input.load_dependency<TextureResource>(
+        requests.push_back(input.request_dependency<TextureResource>(
             Identifier::from_runtime_string(value[i].to_string())));
     }
 
+    for (const auto& request : requests) {
+        m_textures.push_back(request.get());
+    }
+
     return LoadResourceResult::success();
 }
 
@@ -347,7 +347,8 @@ bool has_all_cubemap_faces(const DDS_HEADER& header)
 
 LoadResourceResult TextureResource::load_resource_impl(ResourceLoadingInput& input)
 {
-    std::span<const std::byte> dds_data = input.resource_data();
+    const SharedFileData file_data = input.share_resource_data();
+    std::span<const std::byte> dds_data = file_data.bytes();
 
     auto try_read_to = [&dds_data]<typename T>(T& destination) -> bool {
         static_assert(std::is_trivially_copyable_v<T>);
@@ -472,8 +473,9 @@ LoadResourceResult TextureResource::load_resource_impl(ResourceLoadingInput& inp
         m_format.mip_levels = 1;
     }
 
-    // Copy pixel data
-    m_pixel_data = Array<std::byte>::make_copy(dds_data);
+    // Keep pixel data in place.
+    const auto header_size = as<size_t>(dds_data.data() - file_data.bytes().data());
+    m_pixel_data = file_data.subview(header_size, dds_data.size());
 
     return LoadResourceResult::success();
 }
@@ -504,8 +506,8 @@ TextureResource::MipLevelData TextureResource::pixel_data(uint32_t mip_index,
         }
     }
 
-    MG_ASSERT(m_pixel_data.size() >= offset + size);
-    return MipLevelData{ std::span(m_pixel_data).subspan(offset, size), width, height };
+    MG_ASSERT(m_pixel_data.bytes().size() >= offset + size);
+    return MipLevelData{ m_pixel_data.bytes().subspan(offset, size), width, height };
 }
 
 } // namespace Mg
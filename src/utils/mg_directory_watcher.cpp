@@ -0,0 +1,196 @@
+//**************************************************************************************************
+// This file is part of Mg Engine. Copyright (c) 2026, Magnus Bergsten.
+// Mg Engine is made available under the terms of the 3-Clause BSD License.
+// See LICENSE.txt in the project's root directory.
+//**************************************************************************************************
+
+#include "mg/utils/mg_directory_watcher.h"
+
+#include "mg/utils/mg_u8string_casts.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <system_error>
+
+#ifdef __linux__
+#    include <sys/inotify.h>
+#    include <unistd.h>
+
+#    include <cerrno>
+#    include <cstring>
+#    include <unordered_map>
+#endif // __linux__
+
+namespace Mg::io {
+
+namespace fs = std::filesystem;
+
+#ifdef __linux__
+
+struct DirectoryWatcher::Impl {
+    Impl() = default;
+    ~Impl()
+    {
+        if (inotify_fd != -1) {
+            ::close(inotify_fd);
+        }
+    }
+
+    MG_MAKE_NON_COPYABLE(Impl);
+    MG_MAKE_NON_MOVABLE(Impl);
+
+    int inotify_fd = -1;
+
+    // Path of each watched directory, relative to the root directory. Key: inotify watch
+    // descriptor.
+    std::unordered_map<int, std::string> watched_directories;
+};
+
+namespace {
+
+constexpr uint32_t directory_watch_mask = IN_CREATE | IN_DELETE | IN_MODIFY | IN_CLOSE_WRITE |
+                                          IN_ATTRIB | IN_MOVED_FROM | IN_MOVED_TO |
+                                          IN_DELETE_SELF | IN_MOVE_SELF | IN_ONLYDIR;
+
+// Changes that the watcher cannot describe as a list of changed files.
+constexpr uint32_t requires_rescan_mask = IN_Q_OVERFLOW | IN_DELETE_SELF | IN_MOVE_SELF |
+                                          IN_IGNORED;
+constexpr uint32_t directory_changed_mask = IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO;
+
+} // namespace
+
+DirectoryWatcher::DirectoryWatcher() = default;
+
+std::pair<std::unique_ptr<DirectoryWatcher>, std::string>
+DirectoryWatcher::open(std::string_view directory)
+{
+    const auto last_error = [] { return std::system_category().message(errno); };
+
+    std::unique_ptr<DirectoryWatcher> watcher{ new DirectoryWatcher };
+    Impl& impl = *watcher->m_impl;
+
+    impl.inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (impl.inotify_fd == -1) {
+        return { nullptr, last_error() };
+    }
+
+    // inotify watches are not recursive, so each subdirectory needs its own watch.
+    const auto add_watch = [&](const fs::path& path, std::string relative_path) {
+        const int watch_descriptor = inotify_add_watch(impl.inotify_fd,
+                                                       path.c_str(),
+                                                       directory_watch_mask);
+        if (watch_descriptor == -1) {
+            return false;
+        }
+        impl.watched_directories[watch_descriptor] = std::move(relative_path);
+        return true;
+    };
+
+    const fs::path root{ cast_as_u8_unchecked(directory) };
+    if (!add_watch(root, "")) {
+        return { nullptr, last_error() };
+    }
+
+    std::error_code error;
+    const auto search_options = fs::directory_options::follow_directory_symlink;
+    for (fs::recursive_directory_iterator it{ root, search_options, error }, end; !error && it != end;
+         it.increment(error)) {
+        if (!it->is_directory(error)) {
+            continue;
+        }
+
+        const auto relative_path = cast_u8_to_char(
+            it->path().lexically_relative(root).generic_u8string());
+        if (!add_watch(it->path(), relative_path)) {
+            return { nullptr, last_error() };
+        }
+    }
+
+    if (error) {
+        return { nullptr, error.message() };
+    }
+
+    return { std::move(watcher), "" };
+}
+
+Opt<std::vector<std::string>> DirectoryWatcher::poll_changed_files()
+{
+    std::vector<std::string> result;
+    bool requires_rescan = false;
+
+    alignas(inotify_event) char buffer[4096];
+
+    // Drain all pending events, even after finding that a rescan is needed, so that they are not
+    // reported again.
+    for (;;) {
+        const ssize_t num_bytes = ::read(m_impl->inotify_fd, buffer, sizeof(buffer));
+        if (num_bytes == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                requires_rescan = true;
+            }
+            break;
+        }
+        if (num_bytes == 0) {
+            break;
+        }
+
+        for (ssize_t offset = 0; offset < num_bytes;) {
+            inotify_event event{};
+            std::memcpy(&event, &buffer[offset], sizeof(event));
+            const char* name = &buffer[offset + ssize_t(sizeof(inotify_event))];
+            offset += ssize_t(sizeof(inotify_event) + event.len);
+
+            const bool is_directory_change = (event.mask & IN_ISDIR) != 0 &&
+                                             (event.mask & directory_changed_mask) != 0;
+            if ((event.mask & requires_rescan_mask) != 0 || is_directory_change) {
+                requires_rescan = true;
+                continue;
+            }
+
+            const auto it = m_impl->watched_directories.find(event.wd);
+            if (it == m_impl->watched_directories.end() || event.len == 0 ||
+                (event.mask & IN_ISDIR) != 0) {
+                continue;
+            }
+
+            const std::string_view directory = it->second;
+            const std::string_view filename{ name }; // Zero-padded to event.len.
+            result.push_back(directory.empty() ? std::string(filename)
+                                               : std::string(directory) + '/' +
+                                                     std::string(filename));
+        }
+    }
+
+    if (requires_rescan) {
+        return nullopt;
+    }
+
+    // Editors typically generate several events per save.
+    std::ranges::sort(result);
+    result.erase(std::unique(result.begin(), result.end()), result.end());
+    return result;
+}
+
+#else
+
+struct DirectoryWatcher::Impl {};
+
+DirectoryWatcher::DirectoryWatcher() = default;
+
+std::pair<std::unique_ptr<DirectoryWatcher>, std::string>
+DirectoryWatcher::open(std::string_view /* directory */)
+{
+    return { nullptr, "Directory watching is not supported on this platform." };
+}
+
+Opt<std::vector<std::string>> DirectoryWatcher::poll_changed_files()
+{
+    return nullopt;
+}
+
+#endif // __linux__
+
+} // namespace Mg::io
@@ -0,0 +1,238 @@
+//**************************************************************************************************
+// This file is part of Mg Engine. Copyright (c) 2026, Magnus Bergsten.
+// Mg Engine is made available under the terms of the 3-Clause BSD License.
+// See LICENSE.txt in the project's root directory.
+//**************************************************************************************************
+
+#include "mg/utils/mg_lz4.h"
+
+#include "mg/utils/mg_macros.h"
+
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+namespace Mg {
+
+namespace {
+
+// Constants defined by the LZ4 block format.
+constexpr size_t min_match = 4;     // Shortest encodable match.
+constexpr size_t last_literals = 5; // The last bytes of a block are always literals.
+constexpr size_t match_limit = 12;  // The last match must start at least this far before the end.
+constexpr size_t max_offset = 65535;
+
+constexpr uint32_t hash_bits = 12;
+constexpr uint32_t no_position = std::numeric_limits<uint32_t>::max();
+
+uint32_t read_u32(const std::byte* p) noexcept
+{
+    uint32_t result = 0;
+    std::memcpy(&result, p, sizeof(result));
+    return result;
+}
+
+MG_USES_UNSIGNED_OVERFLOW uint32_t hash_sequence(uint32_t sequence) noexcept
+{
+    return (sequence * 2654435761u) >> (32u - hash_bits);
+}
+
+// Bounds-checked output stream for the compressor.
+class Output {
+public:
+    explicit Output(std::span<std::byte> buffer) noexcept : m_buffer(buffer) {}
+
+    bool put(uint8_t value) noexcept
+    {
+        if (m_position >= m_buffer.size()) {
+            return false;
+        }
+        m_buffer[m_position++] = std::byte{ value };
+        return true;
+    }
+
+    bool put(std::span<const std::byte> bytes) noexcept
+    {
+        if (m_buffer.size() - m_position < bytes.size()) {
+            return false;
+        }
+        if (!bytes.empty()) {
+            std::memcpy(&m_buffer[m_position], bytes.data(), bytes.size());
+        }
+        m_position += bytes.size();
+        return true;
+    }
+
+    // Write the part of a length that did not fit in the token's four bits.
+    bool put_length_extension(size_t length) noexcept
+    {
+        for (; length >= 255; length -= 255) {
+            if (!put(255)) {
+                return false;
+            }
+        }
+        return put(static_cast<uint8_t>(length));
+    }
+
+    size_t position() const noexcept { return m_position; }
+
+private:
+    std::span<std::byte> m_buffer;
+    size_t m_position = 0;
+};
+
+// Write a sequence: literals followed by a match. If match_length is 0, there is no match (only
+// allowed for the last sequence in a block).
+bool write_sequence(Output& out,
+                    std::span<const std::byte> literals,
+                    size_t offset,
+                    size_t match_length) noexcept
+{
+    const size_t literal_length = literals.size();
+    const size_t match_code = match_length > 0 ? match_length - min_match : 0;
+
+    const auto token = static_cast<uint8_t>((std::min<size_t>(literal_length, 15) << 4u) |
+                                            std::min<size_t>(match_code, 15));
+    if (!out.put(token)) {
+        return false;
+    }
+    if (literal_length >= 15 && !out.put_length_extension(literal_length - 15)) {
+        return false;
+    }
+    if (!out.put(literals)) {
+        return false;
+    }
+    if (match_length == 0) {
+        return true;
+    }
+    if (!out.put(static_cast<uint8_t>(offset & 0xffu)) ||
+        !out.put(static_cast<uint8_t>(offset >> 8u))) {
+        return false;
+    }
+    return match_code < 15 || out.put_length_extension(match_code - 15);
+}
+
+} // namespace
+
+size_t lz4_compress(std::span<const std::byte> source, std::span<std::byte> destination) noexcept
+{
+    Output out{ destination };
+    const size_t size = source.size();
+    size_t anchor = 0; // Start of pending literals.
+
+    if (size > match_limit) {
+        // Most recent position of each hashed four-byte sequence.
+        std::vector<uint32_t> table(size_t(1) << hash_bits, no_position);
+        const size_t last_match_start = size - match_limit;
+        const size_t last_match_end = size - last_literals;
+
+        size_t position = 0;
+        while (position <= last_match_start) {
+            const uint32_t sequence = read_u32(&source[position]);
+            uint32_t& table_entry = table[hash_sequence(sequence)];
+            const uint32_t candidate = table_entry;
+            table_entry = static_cast<uint32_t>(position);
+
+            const bool is_match = candidate != no_position &&
+                                  position - candidate <= max_offset &&
+                                  read_u32(&source[candidate]) == sequence;
+            if (!is_match) {
+                ++position;
+                continue;
+            }
+
+            size_t match_length = min_match;
+            while (position + match_length < last_match_end &&
+                   source[candidate + match_length] == source[position + match_length]) {
+                ++match_length;
+            }
+
+            if (!write_sequence(out,
+                                source.subspan(anchor, position - anchor),
+                                position - candidate,
+                                match_length)) {
+                return 0;
+            }
+
+            position += match_length;
+            anchor = position;
+        }
+    }
+
+    if (!write_sequence(out, source.subspan(anchor), 0, 0)) {
+        return 0;
+    }
+
+    return out.position();
+}
+
+bool lz4_decompress(std::span<const std::byte> source, std::span<std::byte> destination) noexcept
+{
+    size_t in = 0;
+    size_t out = 0;
+
+    // Read the part of a length that did not fit in the token's four bits.
+    const auto read_length_extension = [&](size_t& length) -> bool {
+        for (;;) {
+            if (in >= source.size()) {
+                return false;
+            }
+            const auto value = static_cast<uint8_t>(source[in++]);
+            length += value;
+            if (value != 255) {
+                return true;
+            }
+        }
+    };
+
+    while (in < source.size()) {
+        const auto token = static_cast<uint8_t>(source[in++]);
+
+        size_t literal_length = token >> 4u;
+        if (literal_length == 15 && !read_length_extension(literal_length)) {
+            return false;
+        }
+        if (source.size() - in < literal_length || destination.size() - out < literal_length) {
+            return false;
+        }
+        if (literal_length > 0) {
+            std::memcpy(&destination[out], &source[in], literal_length);
+        }
+        in += literal_length;
+        out += literal_length;
+
+        // The last sequence has only literals.
+        if (in == source.size()) {
+            break;
+        }
+
+        if (source.size() - in < 2) {
+            return false;
+        }
+        const size_t offset = static_cast<size_t>(source[in]) |
+                              (static_cast<size_t>(source[in + 1]) << 8u);
+        in += 2;
+        if (offset == 0 || offset > out) {
+            return false;
+        }
+
+        size_t match_length = token & 0xfu;
+        if (match_length == 15 && !read_length_extension(match_length)) {
+            return false;
+        }
+        match_length += min_match;
+        if (destination.size() - out < match_length) {
+            return false;
+        }
+
+        // Byte-wise copy, since the match may overlap the output (e.g. run-length patterns).
+        for (size_t i = 0; i < match_length; ++i, ++out) {
+            destination[out] = destination[out - offset];
+        }
+    }
+
+    return out == destination.size();
+}
+
+} // namespace Mg
@@ -0,0 +1,126 @@
+//**************************************************************************************************
+// This file is part of Mg Engine. Copyright (c) 2026, Magnus Bergsten.
+// Mg Engine is made available under the terms of the 3-Clause BSD License.
+// See LICENSE.txt in the project's root directory.
+//**************************************************************************************************
+
+#include "mg/utils/mg_mapped_file.h"
+
+#include "mg/utils/mg_u8string_casts.h"
+
+#include <filesystem>
+#include <system_error>
+
+#ifdef _WIN32
+#    define WIN32_LEAN_AND_MEAN
+#    include <Windows.h>
+#else
+#    include <fcntl.h>
+#    include <sys/mman.h>
+#    include <sys/stat.h>
+#    include <unistd.h>
+#endif // _WIN32
+
+namespace Mg::io {
+
+#ifdef _WIN32
+
+std::pair<Opt<MappedFile>, std::string> MappedFile::open(std::string_view filepath)
+{
+    const auto last_error = [] { return std::system_category().message(int(GetLastError())); };
+    const auto path = std::filesystem::path(cast_as_u8_unchecked(filepath));
+
+    HANDLE file = CreateFileW(path.wstring().c_str(),
+                              GENERIC_READ,
+                              FILE_SHARE_READ,
+                              nullptr,
+                              OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL,
+                              nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        return { nullopt, last_error() };
+    }
+
+    LARGE_INTEGER size{};
+    if (!GetFileSizeEx(file, &size)) {
+        auto error = last_error();
+        CloseHandle(file);
+        return { nullopt, std::move(error) };
+    }
+
+    // Empty files cannot be mapped.
+    if (size.QuadPart == 0) {
+        CloseHandle(file);
+        return { MappedFile(nullptr, 0), "" };
+    }
+
+    // The view keeps the mapping alive, so the handles can be closed right away.
+    HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    CloseHandle(file);
+    if (mapping == nullptr) {
+        return { nullopt, last_error() };
+    }
+
+    const void* data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(mapping);
+    if (data == nullptr) {
+        return { nullopt, last_error() };
+    }
+
+    return { MappedFile(static_cast<const std::byte*>(data), size_t(size.QuadPart)), "" };
+}
+
+MappedFile::~MappedFile()
+{
+    if (m_data != nullptr) {
+        UnmapViewOfFile(m_data);
+    }
+}
+
+#else
+
+std::pair<Opt<MappedFile>, std::string> MappedFile::open(std::string_view filepath)
+{
+    const auto last_error = [] { return std::system_category().message(errno); };
+    const std::string path{ filepath };
+
+    const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd == -1) {
+        return { nullopt, last_error() };
+    }
+
+    struct stat file_stat = {};
+    if (::fstat(fd, &file_stat) == -1) {
+        auto error = last_error();
+        ::close(fd);
+        return { nullopt, std::move(error) };
+    }
+
+    const auto size = static_cast<size_t>(file_stat.st_size);
+
+    // Empty files cannot be mapped.
+    if (size == 0) {
+        ::close(fd);
+        return { MappedFile(nullptr, 0), "" };
+    }
+
+    // The mapping remains valid after closing the file descriptor.
+    void* data = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (data == MAP_FAILED) {
+        return { nullopt, last_error() };
+    }
+
+    return { MappedFile(static_cast<const std::byte*>(data), size), "" };
+}
+
+MappedFile::~MappedFile()
+{
+    if (m_data != nullptr) {
+        ::munmap(const_cast<std::byte*>(m_data), m_size); // NOLINT
+    }
+}
+
+#endif // _WIN32
+
+} // namespace Mg::io
@@ -0,0 +1,546 @@
+#include "catch.hpp"
+
+#include <mg/components/mg_advance_animations.h>
+#include <mg/components/mg_update_animation_lods.h>
+#include <mg/core/ecs/mg_entity.h>
+#include <mg/core/gfx/mg_animation.h>
+#include <mg/core/gfx/mg_camera.h>
+#include <mg/core/gfx/mg_compressed_animation.h>
+#include <mg/core/gfx/mg_skeleton.h>
+#include <mg/core/mg_job_system.h>
+
+#include <glm/geometric.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+using namespace Mg;
+using namespace Mg::gfx;
+
+namespace {
+
+// A clip with one channel per joint, where each joint moves along the x axis with x == time, with
+// one position key per second. Joint i's keys start at time i, so that the channels' keys are not
+// aligned.
+mesh_data::AnimationClip make_clip(const size_t num_joints, const size_t num_keys)
+{
+    mesh_data::AnimationClip clip;
+    clip.name = Identifier{ "TestClip" };
+    clip.duration_seconds = float(num_keys);
+    clip.channels = Array<mesh_data::AnimationChannel>::make(num_joints);
+
+    for (size_t joint = 0; joint < num_joints; ++joint) {
+        auto& keys = clip.channels[joint].position_keys;
+        keys = Array<mesh_data::PositionKey>::make(num_keys - joint);
+        for (size_t i = 0; i < keys.size(); ++i) {
+            const double time = double(i + joint);
+            keys[i] = { time, glm::vec3(float(time), 0.0f, 0.0f) };
+        }
+    }
+
+    return clip;
+}
+
+// Add rotation keys, once per second, rotating each joint about the z axis at its own rate, and
+// position keys moving the last joint along a sine curve in y.
+void add_curved_motion(mesh_data::AnimationClip& clip)
+{
+    const auto num_keys = size_t(clip.duration_seconds) + 1;
+
+    for (size_t joint = 0; joint < clip.channels.size(); ++joint) {
+        auto& keys = clip.channels[joint].rotation_keys;
+        keys = Array<mesh_data::RotationKey>::make(num_keys);
+        for (size_t i = 0; i < num_keys; ++i) {
+            const float angle = 0.1f * float(joint + 1) * float(i);
+            keys[i] = { double(i), glm::angleAxis(angle, glm::vec3(0.0f, 0.0f, 1.0f)) };
+        }
+    }
+
+    auto& keys = clip.channels[clip.channels.size() - 1].position_keys;
+    keys = Array<mesh_data::PositionKey>::make(num_keys);
+    for (size_t i = 0; i < num_keys; ++i) {
+        keys[i] = { double(i), glm::vec3(0.0f, std::sin(float(i) * 0.2f), 0.0f) };
+    }
+}
+
+float angle_between(const glm::quat& l, glm::quat r)
+{
+    if (glm::dot(l, r) < 0.0f) {
+        r = -r;
+    }
+    return 4.0f * std::asin(std::min(glm::length(l - r) * 0.5f, 1.0f));
+}
+
+// Skeleton where JointIds are not in parent-before-child order:
+//   0 -> 3 -> 2
+//     -> 1 -> 4
+gfx::Skeleton make_unordered_skeleton()
+{
+    std::vector<mesh_data::Joint> joints(5);
+    for (mesh_data::Joint& joint : joints) {
+        joint.children.fill(mesh_data::joint_id_none);
+        joint.inverse_bind_matrix = glm::mat4(1.0f);
+    }
+    joints[0].children[0] = 3;
+    joints[0].children[1] = 1;
+    joints[3].children[0] = 2;
+    joints[1].children[0] = 4;
+
+    return gfx::Skeleton{ Identifier{ "TestSkeleton" }, glm::mat4(1.0f), joints };
+}
+
+} // namespace
+
+TEST_CASE("animate_joint")
+{
+    const mesh_data::AnimationClip clip = make_clip(1, 1000);
+    const mesh_data::AnimationChannel& channel = clip.channels[0];
+
+    JointPose pose;
+    pose.scale = 2.0f;
+
+    animate_joint(channel, 500.25, pose);
+    REQUIRE(pose.translation.x == Approx(500.25f));
+
+    // Channels without keys get the identity transformation.
+    REQUIRE(pose.scale == 1.0f);
+    REQUIRE(pose.rotation.is_equivalent(Rotation{}));
+
+    // Exactly on a key.
+    animate_joint(channel, 17.0, pose);
+    REQUIRE(pose.translation.x == 17.0f);
+
+    // Before the first key and after the last key, that key's value is used.
+    animate_joint(channel, -3.0, pose);
+    REQUIRE(pose.translation.x == 0.0f);
+    animate_joint(channel, 2000.0, pose);
+    REQUIRE(pose.translation.x == 999.0f);
+
+    mesh_data::AnimationChannel single_key;
+    single_key.scale_keys = Array<mesh_data::ScaleKey>::make(1, { 1.0, 3.0f });
+    animate_joint(single_key, 0.5, pose);
+    REQUIRE(pose.scale == 3.0f);
+}
+
+TEST_CASE("sample_animation_clip")
+{
+    constexpr size_t num_joints = 4;
+    const mesh_data::AnimationClip clip = make_clip(num_joints, 100);
+
+    std::vector<JointPose> expected(num_joints);
+    std::vector<JointPose> poses(num_joints);
+    AnimationCursor cursor;
+
+    const auto check = [&](const double time) {
+        sample_animation_clip(clip, time, expected);
+        sample_animation_clip(clip, time, poses, cursor);
+        for (size_t i = 0; i < num_joints; ++i) {
+            REQUIRE(poses[i].translation == expected[i].translation);
+        }
+    };
+
+    SECTION("without cursor")
+    {
+        sample_animation_clip(clip, 42.5, poses);
+        REQUIRE(poses[0].translation.x == Approx(42.5f));
+        REQUIRE(poses[3].translation.x == Approx(42.5f));
+
+        // Time wraps around at the end of the clip.
+        sample_animation_clip(clip, 142.5, poses);
+        REQUIRE(poses[0].translation.x == Approx(42.5f));
+
+        // Joint 3's first key is at time 3.
+        sample_animation_clip(clip, 1.0, poses);
+        REQUIRE(poses[0].translation.x == Approx(1.0f));
+        REQUIRE(poses[3].translation.x == 3.0f);
+    }
+
+    SECTION("cursor gives the same result as searching")
+    {
+        // Playback, with steps both shorter and longer than the interval between keys.
+        for (double time = 0.0; time < 100.0; time += 0.3) {
+            check(time);
+        }
+        for (double time = 0.0; time < 100.0; time += 7.7) {
+            check(time);
+        }
+
+        // Time moving backwards, and looping.
+        check(80.0);
+        check(20.0);
+        check(250.5);
+        check(-0.5);
+    }
+
+    SECTION("cursor can be used with different clips")
+    {
+        check(50.5);
+
+        const mesh_data::AnimationClip other_clip = make_clip(2, 10);
+        std::vector<JointPose> other_poses(2);
+        sample_animation_clip(other_clip, 5.5, other_poses, cursor);
+        REQUIRE(other_poses[0].translation.x == Approx(5.5f));
+        REQUIRE(cursor.channels.size() == 2);
+
+        check(60.5);
+    }
+}
+
+TEST_CASE("compress_rotation")
+{
+    const std::vector<glm::quat> rotations = {
+        glm::quat(1.0f, 0.0f, 0.0f, 0.0f),
+        glm::quat(-1.0f, 0.0f, 0.0f, 0.0f),
+        glm::angleAxis(2.0f, glm::normalize(glm::vec3(1.0f, 2.0f, 3.0f))),
+        glm::angleAxis(-0.5f, glm::normalize(glm::vec3(-3.0f, 0.5f, 1.0f))),
+        glm::normalize(glm::quat(0.1f, -0.9f, 0.2f, 0.3f)),
+        glm::normalize(glm::quat(0.5f, 0.5f, -0.5f, 0.5f)),
+    };
+
+    for (const glm::quat& rotation : rotations) {
+        const glm::quat result = mesh_data::decompress_rotation(
+            mesh_data::compress_rotation(rotation));
+
+        REQUIRE(angle_between(rotation, result) < 2e-4f);
+        REQUIRE(glm::length(result) == Approx(1.0f));
+    }
+}
+
+TEST_CASE("compress_animation_clip")
+{
+    constexpr size_t num_joints = 4;
+    mesh_data::AnimationClip clip = make_clip(num_joints, 20);
+    add_curved_motion(clip);
+
+    const mesh_data::AnimationCompressionSettings settings;
+    const Opt<mesh_data::AnimationClip> compressed = mesh_data::compress_animation_clip(clip,
+                                                                                        settings);
+    REQUIRE(compressed.has_value());
+    REQUIRE(compressed->is_compressed());
+    REQUIRE(compressed->channels.empty());
+    REQUIRE(compressed->num_channels() == num_joints);
+    REQUIRE(compressed->duration_seconds == clip.duration_seconds);
+
+    const mesh_data::CompressedAnimation& animation = compressed->compressed;
+    REQUIRE(animation.sample_rate == settings.sample_rate);
+    REQUIRE(animation.frames.size() == animation.values.size());
+
+    // Joint 0 moves linearly until its last key at time 19, and then stands still; joint 1 also
+    // stands still until its first key.
+    REQUIRE(animation.channels[0].position_keys.num_keys == 3);
+    REQUIRE(animation.channels[1].position_keys.num_keys == 4);
+
+    // Constant rotation at a constant rate needs few keys.
+    REQUIRE(animation.channels[0].rotation_keys.num_keys < 5);
+
+    // The sine curve needs more keys, but far fewer than the 601 frames.
+    REQUIRE(animation.channels[3].position_keys.num_keys > 5);
+    REQUIRE(animation.channels[3].position_keys.num_keys < 100);
+
+    // Scales are all identity, so no keys are needed.
+    for (const mesh_data::CompressedAnimationChannel& channel : animation.channels) {
+        REQUIRE(channel.scale_keys.num_keys == 0);
+    }
+
+    std::vector<JointPose> expected(num_joints);
+    std::vector<JointPose> poses(num_joints);
+    std::vector<JointPose> poses_with_cursor(num_joints);
+    AnimationCursor cursor;
+
+    // Between frames, the error may be somewhat larger than the tolerance.
+    constexpr float max_error = 0.001f;
+
+    for (double time = 0.0; time < 20.0; time += 0.0123) {
+        sample_animation_clip(clip, time, expected);
+        sample_animation_clip(*compressed, time, poses);
+        sample_animation_clip(*compressed, time, poses_with_cursor, cursor);
+
+        for (size_t i = 0; i < num_joints; ++i) {
+            REQUIRE(glm::distance(poses[i].translation, expected[i].translation) < max_error);
+
+            REQUIRE(angle_between(poses[i].rotation.to_quaternion(),
+                                  expected[i].rotation.to_quaternion()) < max_error);
+
+            REQUIRE(poses[i].scale == 1.0f);
+
+            REQUIRE(poses_with_cursor[i].translation == poses[i].translation);
+            REQUIRE(poses_with_cursor[i].rotation.to_quaternion() ==
+                    poses[i].rotation.to_quaternion());
+        }
+    }
+}
+
+TEST_CASE("compress_animation_clip edge cases")
+{
+    SECTION("sample rate is adjusted to fit the duration")
+    {
+        mesh_data::AnimationClip clip = make_clip(1, 10);
+        clip.duration_seconds = 1.01f;
+
+        const auto compressed = mesh_data::compress_animation_clip(clip);
+        REQUIRE(compressed.has_value());
+        REQUIRE(compressed->compressed.sample_rate * 1.01f == Approx(31.0f));
+
+        std::vector<JointPose> poses(1);
+        sample_animation_clip(*compressed, 1.0, poses);
+        REQUIRE(poses[0].translation.x == Approx(1.0f).margin(0.001f));
+    }
+
+    SECTION("zero duration")
+    {
+        mesh_data::AnimationClip clip = make_clip(1, 10);
+        clip.duration_seconds = 0.0f;
+
+        const auto compressed = mesh_data::compress_animation_clip(clip);
+        REQUIRE(compressed.has_value());
+
+        // Single-frame clip, sampled at time 0, where joint 0 is at the origin.
+        std::vector<JointPose> poses(1);
+        sample_animation_clip(*compressed, 3.0, poses);
+        REQUIRE(poses[0].translation == glm::vec3(0.0f));
+    }
+
+    SECTION("long linear track")
+    {
+        // 60000 frames, which are all redundant between the first and last.
+        mesh_data::AnimationClip clip = make_clip(1, 2);
+        clip.duration_seconds = 2000.0f;
+        clip.channels[0].position_keys[1] = { 2000.0, glm::vec3(2000.0f, 0.0f, 0.0f) };
+
+        const auto compressed = mesh_data::compress_animation_clip(clip);
+        REQUIRE(compressed.has_value());
+        REQUIRE(compressed->compressed.channels[0].position_keys.num_keys == 2);
+    }
+
+    SECTION("too long")
+    {
+        mesh_data::AnimationClip clip = make_clip(1, 10);
+        clip.duration_seconds = 10000.0f;
+        REQUIRE(!mesh_data::compress_animation_clip(clip).has_value());
+    }
+}
+
+TEST_CASE("Skeleton evaluation order")
+{
+    const Skeleton skeleton = make_unordered_skeleton();
+
+    const std::vector<mesh_data::JointId> expected_order = { 0, 3, 2, 1, 4 };
+    REQUIRE(std::ranges::equal(skeleton.evaluation_order(), expected_order));
+
+    const std::vector<mesh_data::JointId> expected_parents = {
+        mesh_data::joint_id_none, 0, 3, 0, 1
+    };
+    REQUIRE(std::ranges::equal(skeleton.parents(), expected_parents));
+
+    // Each joint is translated by one unit along x relative to its parent.
+    SkeletonPose pose = skeleton.make_new_pose();
+    for (JointPose& joint_pose : pose.joint_poses) {
+        joint_pose.translation = glm::vec3(1.0f, 0.0f, 0.0f);
+    }
+
+    std::vector<glm::mat4> matrices(5);
+    REQUIRE(calculate_pose_transformations(skeleton, pose, matrices));
+
+    const std::vector<float> expected_depths = { 1.0f, 2.0f, 3.0f, 2.0f, 3.0f };
+    for (size_t i = 0; i < matrices.size(); ++i) {
+        REQUIRE(matrices[i][3].x == expected_depths[i]);
+    }
+}
+
+TEST_CASE("Skeleton joints by depth")
+{
+    const Skeleton skeleton = make_unordered_skeleton();
+
+    const std::vector<mesh_data::JointId> expected_order = { 0, 3, 1, 2, 4 };
+    REQUIRE(std::ranges::equal(skeleton.joints_by_depth(), expected_order));
+
+    REQUIRE(std::ranges::equal(skeleton.joints_up_to_depth(0), std::vector{ 0 }));
+    REQUIRE(std::ranges::equal(skeleton.joints_up_to_depth(1), std::vector{ 0, 3, 1 }));
+    REQUIRE(std::ranges::equal(skeleton.joints_up_to_depth(2), expected_order));
+    REQUIRE(std::ranges::equal(skeleton.joints_up_to_depth(100), expected_order));
+    REQUIRE(skeleton.max_depth() == 2);
+
+    // Sampling only some joints leaves the others' poses unchanged.
+    const mesh_data::AnimationClip clip = make_clip(5, 10);
+    std::vector<JointPose> poses(5);
+    AnimationCursor cursor;
+    sample_animation_clip(clip, 7.5, poses, cursor, skeleton.joints_up_to_depth(1));
+
+    REQUIRE(poses[0].translation.x == Approx(7.5f));
+    REQUIRE(poses[1].translation.x == Approx(7.5f));
+    REQUIRE(poses[3].translation.x == Approx(7.5f));
+    REQUIRE(poses[2].translation.x == 0.0f);
+    REQUIRE(poses[4].translation.x == 0.0f);
+}
+
+TEST_CASE("calculate_skinning_matrices for many skeletons")
+{
+    const Skeleton skeleton = make_unordered_skeleton();
+    SkeletonPose pose = skeleton.make_new_pose();
+    pose.joint_poses[1].translation = glm::vec3(0.0f, 2.0f, 0.0f);
+    pose.joint_poses[2].scale = 2.0f;
+
+    constexpr size_t num_jobs = 100;
+    const size_t num_joints = skeleton.joints().size();
+    std::vector<glm::mat4> palettes(num_jobs * num_joints);
+    std::vector<SkinningMatricesJob> jobs(num_jobs);
+
+    for (size_t i = 0; i < num_jobs; ++i) {
+        jobs[i].transform[3] = glm::vec4(float(i), 0.0f, 0.0f, 1.0f);
+        jobs[i].skeleton = &skeleton;
+        jobs[i].pose = &pose;
+        jobs[i].skinning_matrices_out = std::span(palettes).subspan(i * num_joints, num_joints);
+    }
+
+    JobSystem job_system(3);
+    REQUIRE(calculate_skinning_matrices(job_system, jobs));
+
+    std::vector<glm::mat4> expected(num_joints);
+    for (const SkinningMatricesJob& job : jobs) {
+        REQUIRE(calculate_skinning_matrices(job.transform, skeleton, pose, expected));
+        REQUIRE(std::ranges::equal(job.skinning_matrices_out, expected));
+    }
+
+    // A pose for another skeleton fails.
+    SkeletonPose other_pose = pose;
+    other_pose.skeleton_id = Identifier{ "OtherSkeleton" };
+    jobs[50].pose = &other_pose;
+    REQUIRE(!calculate_skinning_matrices(job_system, jobs));
+}
+
+TEST_CASE("select_animation_lod_level")
+{
+    const AnimationLodSettings settings;
+    CHECK(select_animation_lod_level(settings, 1.0f).update_interval == 1);
+    CHECK(select_animation_lod_level(settings, 0.25f).update_interval == 1);
+    CHECK(select_animation_lod_level(settings, 0.2f).update_interval == 2);
+    CHECK(select_animation_lod_level(settings, 0.05f).update_interval == 4);
+    CHECK(select_animation_lod_level(settings, 0.05f).max_joint_depth == 8);
+    CHECK(select_animation_lod_level(settings, 0.0f).update_interval == 8);
+    CHECK(select_animation_lod_level(settings, 0.0f).max_joint_depth == 4);
+
+    // Sizes smaller than all levels use the last level.
+    const AnimationLodSettings coarse{ .levels = { { .min_screen_size = 0.5f },
+                                                   { .min_screen_size = 0.2f,
+                                                     .update_interval = 3 } } };
+    CHECK(select_animation_lod_level(coarse, 0.1f).update_interval == 3);
+
+    // Without levels, animations are updated in full.
+    const AnimationLodSettings no_levels{ .levels = {} };
+    const AnimationLodLevel level = select_animation_lod_level(no_levels, 0.0f);
+    CHECK(level.update_interval == 1);
+    CHECK(level.max_joint_depth == std::numeric_limits<uint32_t>::max());
+}
+
+TEST_CASE("update_animation_lods")
+{
+    gfx::AnimationData animation_data{ make_unordered_skeleton(), {} };
+    animation_data.clips.push_back(make_clip(5, 10));
+
+    gfx::Mesh mesh;
+    mesh.bounding_sphere = BoundingSphere{ glm::vec3(0.0f), 1.0f };
+    mesh.animation_data = &animation_data;
+
+    // Views the cube from -10 to 10 along each axis, so that the size on screen of a sphere is a
+    // tenth of its radius.
+    const OrthoCamera camera{ glm::vec3(-10.0f), glm::vec3(10.0f) };
+    AnimationLodSettings settings;
+
+    constexpr uint32_t num_entities = 16;
+    ecs::EntityCollection collection{ num_entities };
+    collection.init<TransformComponent, MeshComponent, AnimationComponent>();
+
+    // Small enough on screen for the last level: updated every 8 frames.
+    std::vector<ecs::Entity> entities;
+    for (uint32_t i = 0; i < num_entities; ++i) {
+        const ecs::Entity entity = collection.create_entity();
+        entities.push_back(entity);
+        collection.add_component<TransformComponent>(entity).transform.scale = glm::vec3(0.1f);
+        collection.add_component<MeshComponent>(entity).mesh = &mesh;
+        collection.add_component<AnimationComponent>(entity).current_clip = 0;
+    }
+
+    auto animation = [&](const ecs::Entity entity) -> AnimationComponent& {
+        return collection.get_component<AnimationComponent>(entity);
+    };
+
+    JobSystem job_system(3);
+    update_animation_lods(collection, job_system, camera, settings);
+
+    SECTION("level follows size on screen")
+    {
+        CHECK(animation(entities[0]).lod.update_interval == 8);
+        CHECK(animation(entities[0]).lod.max_joint_depth == 4);
+
+        collection.get_component<TransformComponent>(entities[0]).transform.scale =
+            glm::vec3(10.0f);
+        update_animation_lods(collection, job_system, camera, settings);
+
+        CHECK(animation(entities[0]).lod.update_interval == 1);
+        CHECK(animation(entities[0]).lod.frames_until_update == 0);
+        CHECK(animation(entities[0]).lod.max_joint_depth == std::numeric_limits<uint32_t>::max());
+    }
+
+    SECTION("updates are staggered")
+    {
+        for (const ecs::Entity entity : entities) {
+            CHECK(animation(entity).lod.frames_until_update == entity.index() % 8);
+        }
+
+        // All entities get a pose in the first frame, without losing their phase.
+        advance_animations(collection, job_system, 1.0f);
+        for (const ecs::Entity entity : entities) {
+            REQUIRE(animation(entity).time_in_clip == 1.0f);
+        }
+
+        // Then each entity is sampled once every 8 frames, two entities per frame.
+        for (uint32_t frame = 1; frame <= 16; ++frame) {
+            const float time = float(frame + 1);
+            advance_animations(collection, job_system, time);
+
+            size_t num_sampled = 0;
+            for (const ecs::Entity entity : entities) {
+                const AnimationComponent& a = animation(entity);
+                const bool is_due = entity.index() % 8 == frame % 8;
+                REQUIRE((a.time_in_clip == time) == is_due);
+                num_sampled += is_due ? 1 : 0;
+            }
+            REQUIRE(num_sampled == 2);
+        }
+    }
+
+    SECTION("poses freeze out of view")
+    {
+        settings.levels.clear();
+        for (size_t i = 0; i < num_entities; i += 2) {
+            collection.get_component<TransformComponent>(entities[i]).transform.position =
+                glm::vec3(100.0f, 0.0f, 0.0f);
+        }
+        update_animation_lods(collection, job_system, camera, settings);
+
+        // Entities out of view still get a pose in the first frame.
+        advance_animations(collection, job_system, 1.0f);
+        advance_animations(collection, job_system, 2.0f);
+
+        for (size_t i = 0; i < num_entities; ++i) {
+            const AnimationComponent& a = animation(entities[i]);
+            const bool in_view = i % 2 != 0;
+            REQUIRE(a.lod.in_view == in_view);
+            REQUIRE(a.time_in_clip == (in_view ? 2.0f : 1.0f));
+            REQUIRE(a.pose.joint_poses[0].translation.x == Approx(a.time_in_clip));
+        }
+
+        settings.freeze_out_of_view = false;
+        update_animation_lods(collection, job_system, camera, settings);
+        advance_animations(collection, job_system, 3.0f);
+
+        for (const ecs::Entity entity : entities) {
+            REQUIRE(animation(entity).lod.in_view);
+            REQUIRE(animation(entity).time_in_clip == 3.0f);
+        }
+    }
+}
@@ -0,0 +1,262 @@
+#include "catch.hpp"
+
+#include <mg/core/ecs/mg_command_buffer.h>
+#include <mg/core/ecs/mg_entity.h>
+#include <mg/core/ecs/mg_parallel_for_each.h>
+#include <mg/core/mg_job_system.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+struct CommandTestA : Mg::ecs::BaseComponent<CommandTestA> {
+    uint32_t value = 0;
+};
+
+struct CommandTestB : Mg::ecs::BaseComponent<CommandTestB> {
+    std::string name;
+};
+
+struct CommandTestC : Mg::ecs::BaseComponent<CommandTestC> {
+    std::shared_ptr<int> counter;
+};
+
+} // namespace
+
+TEST_CASE("CommandBuffer")
+{
+    using namespace Mg::ecs;
+
+    EntityCollection collection{ 256 };
+    collection.init<CommandTestA, CommandTestB, CommandTestC>();
+
+    CommandBuffer commands;
+
+    SECTION("changes are deferred until applied")
+    {
+        const Entity existing = collection.create_entity();
+        collection.add_component<CommandTestA>(existing, 1u);
+
+        const PendingEntity spawned = commands.create_entity();
+        commands.add_component<CommandTestA>(spawned, 2u);
+        commands.add_component<CommandTestB>(spawned, "spawned");
+        commands.add_component<CommandTestB>(existing, "existing");
+        commands.remove_component<CommandTestA>(existing);
+
+        REQUIRE(commands.size() == 5);
+        REQUIRE(collection.num_entities() == 1);
+        REQUIRE(collection.has_component<CommandTestA>(existing));
+        REQUIRE(!collection.has_component<CommandTestB>(existing));
+
+        commands.apply(collection);
+        REQUIRE(commands.empty());
+        REQUIRE(commands.bytes_allocated() == 0);
+
+        REQUIRE(collection.num_entities() == 2);
+        REQUIRE(!collection.has_component<CommandTestA>(existing));
+        REQUIRE(collection.get_component<CommandTestB>(existing).name == "existing");
+
+        size_t num_spawned = 0;
+        for (auto [entity, a, b] : collection.get_with<CommandTestA, CommandTestB>()) {
+            REQUIRE(a.value == 2u);
+            REQUIRE(b.name == "spawned");
+            ++num_spawned;
+        }
+        REQUIRE(num_spawned == 1);
+    }
+
+    SECTION("commands on deleted entities are skipped")
+    {
+        const Entity entity = collection.create_entity();
+        const Entity deleted_before_apply = collection.create_entity();
+
+        auto counter = std::make_shared<int>(0);
+        commands.delete_entity(entity);
+        commands.add_component<CommandTestC>(entity, counter);
+        commands.add_component<CommandTestC>(deleted_before_apply, counter);
+        commands.remove_component<CommandTestA>(entity);
+        REQUIRE(counter.use_count() == 3);
+
+        collection.delete_entity(deleted_before_apply);
+        commands.apply(collection);
+
+        REQUIRE(collection.num_entities() == 0);
+
+        // The skipped components were destroyed.
+        REQUIRE(counter.use_count() == 1);
+    }
+
+    SECTION("commands are applied in sort key order")
+    {
+        const Entity entity = collection.create_entity();
+
+        commands.set_sort_key(2);
+        commands.remove_component<CommandTestA>(entity);
+        commands.set_sort_key(1);
+        commands.add_component<CommandTestA>(entity, 10u);
+        commands.set_sort_key(3);
+        commands.add_component<CommandTestA>(entity, 20u);
+
+        commands.apply(collection);
+        REQUIRE(collection.get_component<CommandTestA>(entity).value == 20u);
+
+        // Applying resets the sort key.
+        REQUIRE(commands.sort_key() == 0);
+    }
+
+    SECTION("pending entities are created even if sorted after their components")
+    {
+        commands.set_sort_key(1);
+        const PendingEntity spawned = commands.create_entity();
+        commands.set_sort_key(0);
+        commands.add_component<CommandTestA>(spawned, 3u);
+
+        commands.apply(collection);
+        REQUIRE(collection.num_entities() == 1);
+        for (auto [entity, a] : collection.get_with<CommandTestA>()) {
+            REQUIRE(a.value == 3u);
+        }
+    }
+
+    SECTION("clear destroys recorded components")
+    {
+        auto counter = std::make_shared<int>(0);
+        const PendingEntity spawned = commands.create_entity();
+        commands.add_component<CommandTestC>(spawned, counter);
+        REQUIRE(counter.use_count() == 2);
+
+        commands.clear();
+        REQUIRE(commands.empty());
+        REQUIRE(counter.use_count() == 1);
+
+        commands.apply(collection);
+        REQUIRE(collection.num_entities() == 0);
+    }
+
+    SECTION("many components spanning several arena blocks")
+    {
+        constexpr uint32_t num_entities = 200;
+        for (uint32_t i = 0; i < num_entities; ++i) {
+            const PendingEntity spawned = commands.create_entity();
+            commands.add_component<CommandTestA>(spawned, i);
+            commands.add_component<CommandTestB>(spawned, std::string(100, 'x'));
+        }
+
+        commands.apply(collection);
+        REQUIRE(collection.num_entities() == num_entities);
+
+        std::vector<uint32_t> values;
+        for (auto [entity, a, b] : collection.get_with<CommandTestA, CommandTestB>()) {
+            values.push_back(a.value);
+            REQUIRE(b.name.size() == 100);
+        }
+        std::ranges::sort(values);
+        for (uint32_t i = 0; i < num_entities; ++i) {
+            REQUIRE(values[i] == i);
+        }
+    }
+}
+
+TEST_CASE("ParallelCommandBuffer")
+{
+    using namespace Mg::ecs;
+
+    constexpr uint32_t num_entities = 2000;
+
+    EntityCollection collection{ 2 * num_entities };
+    collection.init<CommandTestA, CommandTestB, CommandTestC>();
+
+    for (uint32_t i = 0; i < num_entities; ++i) {
+        collection.add_component<CommandTestA>(collection.create_entity(), i);
+    }
+
+    Mg::JobSystem job_system{ 3 };
+    ParallelCommandBuffer commands;
+
+    // Spawn an entity for each odd value and delete the entities with even values, from within a
+    // parallel query.
+    parallel_for_each<const CommandTestA>(
+        collection, job_system, [&](Entity entity, const CommandTestA& a) {
+            CommandBuffer& local = commands.local();
+            local.set_sort_key(a.value);
+            if (a.value % 2 == 0) {
+                local.delete_entity(entity);
+            }
+            else {
+                const PendingEntity spawned = local.create_entity();
+                local.add_component<CommandTestA>(spawned, a.value + num_entities);
+                local.add_component<CommandTestB>(spawned, "spawned");
+            }
+        });
+
+    REQUIRE(commands.size() == num_entities / 2 * 4);
+    REQUIRE(collection.num_entities() == num_entities);
+
+    commands.apply(collection);
+    REQUIRE(commands.empty());
+
+    REQUIRE(collection.num_entities() == num_entities);
+
+    std::vector<uint32_t> values;
+    for (auto [entity, a] : collection.get_with<CommandTestA>()) {
+        values.push_back(a.value);
+    }
+    std::ranges::sort(values);
+
+    std::vector<uint32_t> expected;
+    for (uint32_t i = 1; i < num_entities; i += 2) {
+        expected.push_back(i);
+    }
+    for (uint32_t i = 1; i < num_entities; i += 2) {
+        expected.push_back(i + num_entities);
+    }
+    REQUIRE(values == expected);
+
+    size_t num_spawned = 0;
+    for (auto [entity, a, b] : collection.get_with<const CommandTestA, const CommandTestB>()) {
+        REQUIRE(a.value >= num_entities);
+        ++num_spawned;
+    }
+    REQUIRE(num_spawned == num_entities / 2);
+}
+
+TEST_CASE("ParallelCommandBuffer merges threads by sort key")
+{
+    using namespace Mg::ecs;
+
+    EntityCollection collection{ 256 };
+    collection.init<CommandTestA, CommandTestB, CommandTestC>();
+
+    ParallelCommandBuffer commands;
+
+    // Two threads record interleaved sort keys, each spawning an entity per key.
+    const auto record = [&](const uint32_t first_key) {
+        CommandBuffer& local = commands.local();
+        for (uint32_t key = first_key; key < 20; key += 2) {
+            local.set_sort_key(key);
+            local.add_component<CommandTestA>(local.create_entity(), key);
+        }
+    };
+    std::thread odd{ record, 1u };
+    std::thread even{ record, 0u };
+    odd.join();
+    even.join();
+
+    commands.apply(collection);
+
+    // Components were added in sort key order, regardless of thread.
+    std::vector<uint32_t> values;
+    for (auto [entity, a] : collection.get_with<const CommandTestA>()) {
+        values.push_back(a.value);
+    }
+
+    REQUIRE(values.size() == 20);
+    for (uint32_t i = 0; i < 20; ++i) {
+        REQUIRE(values[i] == i);
+    }
+}
@@ -2,6 +2,8 @@
 
 #include <mg/core/ecs/mg_entity.h>
 
+#include <algorithm>
+#include <string>
 #include <utility>
 #include <vector>
 
@@ -193,6 +195,247 @@ TEST_CASE("Entity")
         CHECK(num_test_components == 3);
     }
 
+    SECTION("create_entities")
+    {
+        const Mg::ecs::Entity existing = entity_collection.create_entity();
+        entity_collection.add_component<Position>(existing, 1.0f, 2.0f);
+
+        std::vector<Mg::ecs::Entity> es(1000);
+        entity_collection.create_entities<TestComponent, Position>(es);
+        REQUIRE(entity_collection.num_entities() == 1001);
+
+        // The new entities are created directly in their final archetype, without passing through
+        // the intermediate ones.
+        const size_t num_archetypes = entity_collection.num_archetypes();
+        REQUIRE(num_archetypes == 3);
+
+        for (uint32_t i = 0; i < es.size(); ++i) {
+            REQUIRE(entity_collection.exists(es[i]));
+            REQUIRE(entity_collection.has_component<TestComponent>(es[i]));
+            REQUIRE(!entity_collection.has_component<IndexComponent>(es[i]));
+
+            auto& test_component = entity_collection.get_component<TestComponent>(es[i]);
+            REQUIRE(test_component.string == "init value");
+            test_component.value = i;
+        }
+
+        size_t num_found = 0;
+        for (auto [entity, test_component, position] :
+             entity_collection.get_with<const TestComponent, const Position>()) {
+            REQUIRE(entity_collection.get_component<TestComponent>(es[test_component.value])
+                        .value == test_component.value);
+            REQUIRE(position.x == 0.0f);
+            ++num_found;
+        }
+        REQUIRE(num_found == es.size());
+        REQUIRE(entity_collection.get_component<Position>(existing).y == 2.0f);
+
+        entity_collection.delete_entity(es[10]);
+        REQUIRE(!entity_collection.exists(es[10]));
+        REQUIRE(entity_collection.get_component<TestComponent>(es[999]).value == 999);
+    }
+
+    SECTION("components survive moving between archetypes")
+    {
+        std::vector<Mg::ecs::Entity> es;
+        for (uint32_t i = 0; i < 1000; ++i) {
+            es.push_back(entity_collection.create_entity());
+            entity_collection.add_component<IndexComponent>(es.back(), i);
+            entity_collection.add_component<TestComponent>(es.back(), i, std::to_string(i));
+        }
+
+        // Move every other entity to another archetype, and delete every third.
+        for (uint32_t i = 0; i < 1000; i += 2) {
+            entity_collection.add_component<Position>(es[i], float(i), 0.0f);
+            entity_collection.remove_component<TestComponent>(es[i]);
+        }
+        for (uint32_t i = 0; i < 1000; i += 3) {
+            entity_collection.delete_entity(es[i]);
+        }
+
+        // {}, {Index}, {Index, Test}, {Index, Test, Position}, {Index, Position}
+        CHECK(entity_collection.num_archetypes() == 5);
+
+        size_t num_iterated = 0;
+        for (auto [entity, index, test_component, position] :
+             entity_collection.get_with<IndexComponent,
+                                        Mg::ecs::Maybe<TestComponent>,
+                                        Mg::ecs::Maybe<Position>>()) {
+            ++num_iterated;
+            REQUIRE(index.index % 3 != 0);
+            REQUIRE(entity_collection.get_component<IndexComponent>(entity).index == index.index);
+
+            if (index.index % 2 == 0) {
+                REQUIRE(test_component == nullptr);
+                REQUIRE(position != nullptr);
+                REQUIRE(position->x == float(index.index));
+            }
+            else {
+                REQUIRE(position == nullptr);
+                REQUIRE(test_component != nullptr);
+                REQUIRE(test_component->value == index.index);
+                REQUIRE(test_component->string == std::to_string(index.index));
+            }
+        }
+
+        CHECK(num_iterated == 666);
+        CHECK(entity_collection.num_entities() == 666);
+    }
+
+    SECTION("iteration spanning several chunks")
+    {
+        constexpr uint32_t num_entities = 5000;
+        for (uint32_t i = 0; i < num_entities; ++i) {
+            auto entity = entity_collection.create_entity();
+            entity_collection.add_component<IndexComponent>(entity, i);
+            if (i % 2 == 0) {
+                entity_collection.add_component<Position>(entity, float(i), float(i));
+            }
+        }
+
+        std::vector<bool> visited(num_entities, false);
+        for (auto [entity, index] :
+             entity_collection.get_with<IndexComponent, Mg::ecs::Not<Position>>()) {
+            REQUIRE(index.index % 2 == 1);
+            REQUIRE(!visited[index.index]);
+            visited[index.index] = true;
+        }
+
+        for (auto [entity, index, position] :
+             entity_collection.get_with<IndexComponent, Position>()) {
+            REQUIRE(position.x == float(index.index));
+            REQUIRE(!visited[index.index]);
+            visited[index.index] = true;
+        }
+
+        CHECK(std::ranges::all_of(visited, [](bool b) { return b; }));
+
+        entity_collection.reset();
+        CHECK(entity_collection.num_entities() == 0);
+        size_t num_after_reset = 0;
+        for ([[maybe_unused]] auto cs : entity_collection.get_with<IndexComponent>()) {
+            ++num_after_reset;
+        }
+        CHECK(num_after_reset == 0);
+    }
+
+    SECTION("cached queries include archetypes created later")
+    {
+        const auto count = [&](auto view) {
+            size_t n = 0;
+            for ([[maybe_unused]] auto cs : view) {
+                ++n;
+            }
+            return n;
+        };
+
+        // Make the queries before any entity has the components.
+        CHECK(count(entity_collection.get_with<Position>()) == 0);
+        CHECK(count(entity_collection.get_with<IndexComponent, Mg::ecs::Not<Position>>()) == 0);
+        CHECK(entity_collection.matching_archetypes<Position>().empty());
+
+        std::vector<Mg::ecs::Entity> es;
+        for (uint32_t i = 0; i < 100; ++i) {
+            es.push_back(entity_collection.create_entity());
+            entity_collection.add_component<IndexComponent>(es.back(), i);
+        }
+        for (uint32_t i = 0; i < 100; i += 4) {
+            entity_collection.add_component<Position>(es[i]);
+        }
+
+        CHECK(count(entity_collection.get_with<Position>()) == 25);
+        CHECK(count(entity_collection.get_with<IndexComponent, Mg::ecs::Not<Position>>()) == 75);
+
+        CHECK(entity_collection.matching_archetypes<Position>().size() == 1);
+        CHECK(entity_collection.matching_archetypes<IndexComponent, Mg::ecs::Not<Position>>()
+                  .size() == 1);
+    }
+
+    SECTION("change tracking")
+    {
+        using Mg::ecs::Changed;
+        using Mg::ecs::Tracked;
+
+        const auto count = [&](auto view) {
+            size_t n = 0;
+            for ([[maybe_unused]] auto cs : view) {
+                ++n;
+            }
+            return n;
+        };
+
+        // Enough entities to span several chunks.
+        constexpr uint32_t num_entities = 2000;
+        std::vector<Mg::ecs::Entity> es;
+        for (uint32_t i = 0; i < num_entities; ++i) {
+            es.push_back(entity_collection.create_entity());
+            entity_collection.add_component<IndexComponent>(es.back(), i);
+            if (i % 2 == 0) {
+                entity_collection.add_component<Position>(es.back());
+            }
+        }
+
+        const uint32_t creation_tick = entity_collection.change_tick();
+        CHECK(entity_collection.component_change_tick<IndexComponent>(es[0]) == creation_tick);
+
+        const uint32_t tick = entity_collection.advance_change_tick();
+        CHECK(tick == creation_tick + 1);
+
+        CHECK(count(entity_collection.get_with<Changed<const IndexComponent>>(tick)) == 0);
+        CHECK(count(entity_collection.get_with<Changed<const IndexComponent>>(creation_tick)) ==
+              num_entities);
+
+        // Writes through plain references are not tracked.
+        entity_collection.get_component<IndexComponent>(es[1]).index = 1001;
+        CHECK(count(entity_collection.get_with<Changed<const IndexComponent>>(tick)) == 0);
+
+        // Tracked writes, through write_component and through TrackedRef.
+        entity_collection.write_component<IndexComponent>(es[3]).index = 3;
+        for (auto [entity, index] : entity_collection.get_with<Tracked<IndexComponent>>()) {
+            if (index->index % 100 == 0) {
+                index.write().index += 1;
+            }
+        }
+
+        std::vector<uint32_t> changed;
+        for (auto [entity, index] :
+             entity_collection.get_with<Changed<const IndexComponent>>(tick)) {
+            changed.push_back(index.index);
+        }
+        std::ranges::sort(changed);
+
+        std::vector<uint32_t> expected = { 3 };
+        for (uint32_t i = 0; i < num_entities; i += 100) {
+            expected.push_back(i + 1);
+        }
+        std::ranges::sort(expected);
+        CHECK(changed == expected);
+
+        // Changed<> combines with other designators.
+        CHECK(count(entity_collection.get_with<Changed<const IndexComponent>, Position>(tick)) ==
+              num_entities / 100);
+        CHECK(count(entity_collection.get_with<Changed<const IndexComponent>,
+                                               Mg::ecs::Not<Position>>(tick)) == 1);
+
+        // Components keep their change ticks when the entity moves to another archetype; added
+        // components count as changed.
+        const uint32_t tick2 = entity_collection.advance_change_tick();
+        entity_collection.add_component<Position>(es[5]);
+        CHECK(entity_collection.component_change_tick<IndexComponent>(es[5]) == creation_tick);
+        CHECK(entity_collection.component_change_tick<Position>(es[5]) == tick2);
+        CHECK(count(entity_collection.get_with<Changed<const Position>>(tick2)) == 1);
+        CHECK(count(entity_collection.get_with<Changed<const IndexComponent>>(tick2)) == 0);
+
+        // Change ticks follow components moved to fill the rows of deleted entities.
+        entity_collection.delete_entity(es[0]);
+        entity_collection.delete_entity(es[2]);
+        CHECK(count(entity_collection.get_with<Changed<const IndexComponent>>(tick)) ==
+              expected.size() - 1);
+        CHECK(entity_collection.component_change_tick<IndexComponent>(es[num_entities - 2]) ==
+              creation_tick);
+        CHECK(entity_collection.component_change_tick<Position>(es[5]) == tick2);
+    }
+
     SECTION("maximum capacity")
     {
         std::array<Mg::ecs::Entity, num_elems> es;
@@ -233,4 +476,28 @@ TEST_CASE("Entity")
             CHECK(mask == expected_mask);
         }
     }
+
+    SECTION("growing beyond initial capacity")
+    {
+        std::vector<Mg::ecs::Entity> es;
+        std::vector<bool> deleted(3 * num_elems, false);
+
+        // The capacity only determines the up-front allocation; the collection grows as needed,
+        // without invalidating existing entities.
+        for (uint32_t i = 0; i < 3 * num_elems; ++i) {
+            es.push_back(entity_collection.create_entity());
+            entity_collection.add_component<IndexComponent>(es.back(), i);
+            if (i % 4 == 0) {
+                entity_collection.delete_entity(es[i / 2]);
+                deleted[i / 2] = true;
+            }
+        }
+
+        for (uint32_t i = 0; i < 3 * num_elems; ++i) {
+            REQUIRE(entity_collection.exists(es[i]) == !deleted[i]);
+            if (!deleted[i]) {
+                REQUIRE(entity_collection.get_component<IndexComponent>(es[i]).index == i);
+            }
+        }
+    }
 } // TEST_CASE("Entity")
@@ -0,0 +1,296 @@
+#include "catch.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <random>
+
+// Use Mg::FlatMap just to test it a bit, too.
+#include <mg/core/containers/mg_flat_map.h>
+
+#include <mg/core/mg_job_system.h>
+
+#include <array>
+#include <atomic>
+#include <numeric>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Some tests check the time taken to verify that jobs are executed in parallel. Of course, such
+// tests are brittle and may fail in some environments. Therefore, they are disabled by default.
+#ifndef PERFORM_TIMING_SENSITIVE_TESTS
+#define PERFORM_TIMING_SENSITIVE_TESTS 0
+#endif
+
+#if PERFORM_TIMING_SENSITIVE_TESTS
+TEST_CASE("JobSystem: timing test")
+{
+    using namespace std::chrono;
+
+    puts("Starting timing_test");
+
+    Mg::JobSystem pool{ 2 };
+    Mg::JobCounter counter;
+    size_t job_count = 2;
+
+    auto start_time = high_resolution_clock::now();
+
+    for (size_t i = 0u; i < job_count; ++i) {
+        pool.add_job([] { std::this_thread::sleep_for(milliseconds(100u)); }, counter);
+    }
+
+    pool.wait(counter);
+    CHECK(counter.is_done());
+
+    auto end_time = high_resolution_clock::now();
+    auto diff = duration_cast<milliseconds>(end_time - start_time).count();
+
+    // Check that jobs ran in parallel
+    CHECK(diff >= 90);
+    CHECK(diff <= 110);
+}
+#endif
+
+TEST_CASE("JobSystem: return test")
+{
+    puts("Starting return_test");
+    Mg::JobSystem pool{ 4 };
+
+    auto future_a = pool.add_job([] { return true; });
+    auto future_b = pool.add_job([] { return false; });
+
+    puts("Launched job");
+
+    REQUIRE(future_a.get() == true);
+    REQUIRE(future_b.get() == false);
+
+    puts("Finished return_test");
+}
+
+TEST_CASE("JobSystem: many jobs")
+{
+    Mg::JobSystem pool{ std::thread::hardware_concurrency() };
+    Mg::FlatMap<int, int> job_to_expected_result_map;
+    Mg::FlatMap<int, std::future<int>> job_to_future_map;
+
+    std::default_random_engine r(123);
+    std::uniform_int_distribution<int> dist;
+
+    for (int i = 0; i < 100; ++i) {
+        const auto result = dist(r);
+        const auto wait_time_us = dist(r) % 5;
+
+        job_to_expected_result_map.insert({ i, result });
+
+        auto future = pool.add_job([result, wait_time_us] {
+            std::this_thread::sleep_for(std::chrono::microseconds(wait_time_us));
+            return result;
+        });
+
+        job_to_future_map.insert({ i, std::move(future) });
+    }
+
+    for (const auto& [job_index, expected_result] : job_to_expected_result_map) {
+        std::future<int>& future = job_to_future_map[job_index];
+        REQUIRE(future.get() == expected_result);
+    }
+}
+
+TEST_CASE("JobSystem: parallel_for")
+{
+    using namespace std::chrono;
+
+    Mg::JobSystem pool{ std::thread::hardware_concurrency() };
+
+    struct Elem {
+        size_t i{};
+        std::string s;
+    };
+
+    std::vector<Elem> elems;
+    elems.resize(10000);
+
+    auto init = [&elems] {
+        size_t i = 0;
+        for (Elem& elem : elems) {
+            elem.i = i++;
+            elem.s.clear();
+        }
+    };
+
+    init();
+
+    auto job = [](Elem& elem) { elem.s = std::to_string(elem.i); };
+
+#if PERFORM_TIMING_SENSITIVE_TESTS
+    // Warm up
+    {
+        for (Elem& v : elems) {
+            job(v);
+        }
+        for (Elem& v : elems) {
+            job(v);
+        }
+    }
+#endif
+
+    [[maybe_unused]] milliseconds time_parallel{};
+    [[maybe_unused]] milliseconds time_sequential{};
+
+#if PERFORM_TIMING_SENSITIVE_TESTS
+    {
+        init();
+        auto start_time = high_resolution_clock::now();
+        for (Elem& v : elems) {
+            job(v);
+        }
+        auto end_time = high_resolution_clock::now();
+        time_sequential = duration_cast<milliseconds>(end_time - start_time);
+        REQUIRE(
+            std::ranges::all_of(elems, [](const Elem& v) { return v.s == std::to_string(v.i); }));
+    }
+#endif
+
+    {
+        init();
+        auto start_time = high_resolution_clock::now();
+        pool.parallel_for(elems, 1000, job);
+        auto end_time = high_resolution_clock::now();
+        time_parallel = duration_cast<milliseconds>(end_time - start_time);
+        REQUIRE(
+            std::ranges::all_of(elems, [](const Elem& v) { return v.s == std::to_string(v.i); }));
+    }
+
+#if PERFORM_TIMING_SENSITIVE_TESTS
+    REQUIRE(time_parallel < time_sequential);
+#endif
+}
+
+TEST_CASE("JobSystem: parallel_for with automatic job size")
+{
+    Mg::JobSystem pool{ std::thread::hardware_concurrency() };
+
+    std::vector<int> values(100'000, 1);
+    pool.parallel_for(values, [](int& v) { v *= 2; });
+    REQUIRE(std::ranges::all_of(values, [](int v) { return v == 2; }));
+
+    // Sub-ranges must cover all elements exactly once.
+    std::vector<std::atomic_int> visits(12'345);
+    std::atomic_bool got_empty_range = false;
+    pool.parallel_for_ranges(visits.size(), 0, [&](size_t begin, size_t end) {
+        if (begin >= end) {
+            got_empty_range = true;
+        }
+        for (size_t i = begin; i < end; ++i) {
+            ++visits[i];
+        }
+    });
+    REQUIRE(!got_empty_range);
+    REQUIRE(std::ranges::all_of(visits, [](const std::atomic_int& v) { return v == 1; }));
+
+    // Empty range.
+    std::vector<int> empty;
+    pool.parallel_for(empty, [](int&) { FAIL("Should not be called."); });
+}
+
+TEST_CASE("JobSystem: child jobs")
+{
+    Mg::JobSystem pool{ 3 };
+    Mg::JobCounter counter;
+    std::atomic_int num_leaves = 0;
+
+    // Each job adds child jobs on the same counter, so waiting for the counter includes them.
+    for (int i = 0; i < 10; ++i) {
+        pool.add_job(
+            [&] {
+                for (int j = 0; j < 10; ++j) {
+                    pool.add_job(
+                        [&] {
+                            for (int k = 0; k < 10; ++k) {
+                                pool.add_job([&] { ++num_leaves; }, counter);
+                            }
+                        },
+                        counter);
+                }
+            },
+            counter);
+    }
+
+    pool.wait(counter);
+    REQUIRE(counter.is_done());
+    REQUIRE(num_leaves == 1000);
+}
+
+TEST_CASE("JobSystem: nested wait")
+{
+    Mg::JobSystem pool{ 2 };
+    std::array<int, 64> sums = {};
+
+    // Jobs waiting for their own sub-jobs must not deadlock, even with more waiting jobs than
+    // worker threads.
+    pool.parallel_for_ranges(sums.size(), 1, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            std::vector<int> values(1000);
+            std::iota(values.begin(), values.end(), 0);
+            std::atomic_int sum = 0;
+            pool.parallel_for(values, 10, [&sum](int v) { sum += v; });
+            sums[i] = sum;
+        }
+    });
+
+    REQUIRE(std::ranges::all_of(sums, [](int v) { return v == 999 * 1000 / 2; }));
+}
+
+TEST_CASE("JobSystem: large jobs and no worker threads")
+{
+    Mg::JobSystem pool{ 0 };
+    REQUIRE(pool.num_worker_threads() == 0);
+
+    Mg::JobCounter counter;
+    std::array<size_t, 64> large_capture = {};
+    large_capture.back() = 42;
+    size_t result = 0;
+
+    // Too large to be stored inline in the job.
+    pool.add_job([large_capture, &result] { result = large_capture.back(); }, counter);
+    REQUIRE(!counter.is_done());
+
+    // With no worker threads, the waiting thread has to run the job.
+    pool.wait(counter);
+    REQUIRE(result == 42);
+}
+
+TEST_CASE("JobSystem: jobs from other threads")
+{
+    Mg::JobSystem pool{ 2 };
+    std::atomic_int num_done = 0;
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 4; ++i) {
+        threads.emplace_back([&] {
+            Mg::JobCounter counter;
+            for (int j = 0; j < 100; ++j) {
+                pool.add_job([&] { ++num_done; }, counter);
+            }
+            pool.wait(counter);
+        });
+    }
+
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+
+    REQUIRE(num_done == 400);
+}
+
+TEST_CASE("JobSystem: destructor finishes jobs")
+{
+    std::atomic_int num_done = 0;
+    {
+        Mg::JobSystem pool{ 2 };
+        for (int i = 0; i < 2000; ++i) {
+            pool.add_job_fire_and_forget([&] { ++num_done; });
+        }
+    }
+    REQUIRE(num_done == 2000);
+}
@@ -0,0 +1,135 @@
+#include "catch.hpp"
+
+#include <mg/core/ecs/mg_entity.h>
+#include <mg/core/ecs/mg_parallel_for_each.h>
+#include <mg/core/mg_job_system.h>
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+namespace {
+
+struct ParallelTestA : Mg::ecs::BaseComponent<ParallelTestA> {
+    uint32_t value = 0;
+};
+
+struct ParallelTestB : Mg::ecs::BaseComponent<ParallelTestB> {
+    uint32_t value = 0;
+};
+
+struct ParallelTestC : Mg::ecs::BaseComponent<ParallelTestC> {
+    uint32_t value = 0;
+};
+
+} // namespace
+
+TEST_CASE("parallel_for_each")
+{
+    using namespace Mg::ecs;
+
+    constexpr uint32_t num_entities = 20000;
+
+    EntityCollection collection{ num_entities };
+    collection.init<ParallelTestA, ParallelTestB, ParallelTestC>();
+
+    Mg::JobSystem job_system{ 3 };
+
+    // Spread the entities over several archetypes.
+    std::vector<Entity> entities;
+    for (uint32_t i = 0; i < num_entities; ++i) {
+        const Entity entity = collection.create_entity();
+        entities.push_back(entity);
+        collection.add_component<ParallelTestA>(entity, i);
+        if (i % 2 == 0) {
+            collection.add_component<ParallelTestB>(entity);
+        }
+        if (i % 3 == 0) {
+            collection.add_component<ParallelTestC>(entity);
+        }
+    }
+
+    SECTION("visits each matching entity once")
+    {
+        std::atomic_uint32_t num_visited = 0;
+        parallel_for_each<const ParallelTestA, ParallelTestB>(
+            collection, job_system, [&](Entity, const ParallelTestA& a, ParallelTestB& b) {
+                b.value += a.value + 1;
+                ++num_visited;
+            });
+
+        CHECK(num_visited == num_entities / 2);
+
+        for (uint32_t i = 0; i < num_entities; i += 2) {
+            REQUIRE(collection.get_component<ParallelTestB>(entities[i]).value == i + 1);
+        }
+    }
+
+    SECTION("Not and Maybe")
+    {
+        std::atomic_uint32_t num_with_c = 0;
+        std::atomic_bool has_b = false;
+        parallel_for_each<ParallelTestA, Not<ParallelTestB>, Maybe<const ParallelTestC>>(
+            collection, job_system, [&](Entity, ParallelTestA& a, const ParallelTestC* c) {
+                // Catch assertions are not thread-safe, check afterwards instead.
+                if (a.value % 2 == 0) {
+                    has_b = true;
+                }
+                if (c) {
+                    ++num_with_c;
+                }
+                a.value = ~a.value;
+            });
+
+        CHECK(!has_b);
+
+        // Odd multiples of 3.
+        CHECK(num_with_c == (num_entities / 3) / 2);
+
+        for (uint32_t i = 0; i < num_entities; ++i) {
+            const uint32_t expected = i % 2 == 0 ? i : ~i;
+            REQUIRE(collection.get_component<ParallelTestA>(entities[i]).value == expected);
+        }
+    }
+
+    SECTION("Changed and Tracked")
+    {
+        const uint32_t tick = collection.advance_change_tick();
+
+        // Mark every tenth B as changed.
+        parallel_for_each<const ParallelTestA, Tracked<ParallelTestB>>(
+            collection,
+            job_system,
+            [](Entity, const ParallelTestA& a, TrackedRef<ParallelTestB> b) {
+                if (a.value % 10 == 0) {
+                    b.write().value = a.value;
+                }
+            });
+
+        std::atomic_uint32_t num_visited = 0;
+        std::atomic_bool has_unexpected = false;
+        parallel_for_each<Changed<const ParallelTestB>>(
+            collection,
+            job_system,
+            [&](Entity, const ParallelTestB& b) {
+                if (b.value % 10 != 0) {
+                    has_unexpected = true;
+                }
+                ++num_visited;
+            },
+            tick);
+
+        CHECK(!has_unexpected);
+        CHECK(num_visited == num_entities / 10);
+    }
+
+    SECTION("no matches")
+    {
+        collection.reset();
+        bool called = false;
+        parallel_for_each<ParallelTestA>(collection, job_system, [&](Entity, ParallelTestA&) {
+            called = true;
+        });
+        CHECK(!called);
+    }
+}
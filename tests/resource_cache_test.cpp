@@ -2,8 +2,17 @@
 #include "mg/core/mg_file_loader.h"
 
 #include <mg/core/resource_cache/mg_resource_cache.h>
+#include <mg/core/resource_cache/mg_resource_exceptions.h>
+#include <mg/core/resource_cache/mg_resource_loading_input.h>
 #include <mg/core/resources/mg_text_resource.h>
 
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+
 static bool has_loader_with_name(const Mg::ResourceCache& cache, std::string_view name)
 {
     for (auto&& p_loader : cache.file_loaders()) {
@@ -14,6 +23,41 @@ static bool has_loader_with_name(const Mg::ResourceCache& cache, std::string_vie
     return false;
 }
 
+// Resource consisting of the concatenated contents of the files named on each line of its file.
+// Files ending in ".concat" are loaded as ConcatResource, others as TextResource.
+class ConcatResource : public Mg::BaseResource {
+public:
+    using BaseResource::BaseResource;
+
+    bool should_reload_on_file_change() const override { return true; }
+
+    Mg::Identifier type_id() const override { return "ConcatResource"; }
+
+    std::string text;
+
+protected:
+    Mg::LoadResourceResult load_resource_impl(Mg::ResourceLoadingInput& input) override
+    {
+        text.clear();
+        std::string_view lines = input.resource_data_as_text();
+        while (!lines.empty()) {
+            const auto line_end = std::min(lines.find('\n'), lines.size());
+            const auto file = Mg::Identifier::from_runtime_string(lines.substr(0, line_end));
+            lines.remove_prefix(std::min(line_end + 1, lines.size()));
+
+            if (file.str_view().ends_with(".concat")) {
+                auto access = Mg::ResourceAccessGuard(input.load_dependency<ConcatResource>(file));
+                text += access->text;
+            }
+            else {
+                auto access = Mg::ResourceAccessGuard(input.load_dependency<Mg::TextResource>(file));
+                text += access->text();
+            }
+        }
+        return Mg::LoadResourceResult::success();
+    }
+};
+
 TEST_CASE("ResourceCache test")
 {
     constexpr auto directory_name = "data/test-archive";
@@ -151,6 +195,121 @@ TEST_CASE("ResourceCache test")
         REQUIRE(cache.unload_unused());
         REQUIRE(!cache.is_cached("test-file-1.txt"));
     }
+
+    SECTION("memory_budget")
+    {
+        puts("Starting memory_budget test");
+
+        REQUIRE(cache.resident_size_bytes() == 0);
+
+        size_t size_2 = 0;
+        size_t size_3 = 0;
+        {
+            auto access2 = cache.access_resource<Mg::TextResource>("test-file-2.txt");
+            size_2 = access2->text().size();
+            auto access3 = cache.access_resource<Mg::TextResource>("test-file-3.txt");
+            size_3 = access3->text().size();
+        }
+        REQUIRE(cache.resident_size_bytes() == size_2 + size_3);
+
+        // Least recently used resource is unloaded first.
+        cache.set_memory_budget(size_2 + size_3 - 1);
+        REQUIRE(cache.memory_budget() == size_2 + size_3 - 1);
+        REQUIRE(!cache.is_cached("test-file-2.txt"));
+        REQUIRE(cache.is_cached("test-file-3.txt"));
+        REQUIRE(cache.resident_size_bytes() == size_3);
+
+        // Loading a resource that exceeds the budget unloads others, but not the new resource.
+        cache.set_memory_budget(size_3);
+        {
+            auto access4 = cache.access_resource<Mg::TextResource>("subdirectory/test-file-4.txt");
+            REQUIRE(!cache.is_cached("test-file-3.txt"));
+            REQUIRE(cache.is_cached("subdirectory/test-file-4.txt"));
+
+            // Resources in use are never unloaded.
+            cache.set_memory_budget(0);
+            REQUIRE(cache.is_cached("subdirectory/test-file-4.txt"));
+            REQUIRE(cache.resident_size_bytes() == access4->text().size());
+        }
+
+        REQUIRE(cache.unload_unused());
+        REQUIRE(cache.resident_size_bytes() == 0);
+    }
+
+    SECTION("request_load")
+    {
+        puts("Starting request_load test");
+
+        auto request0 = cache.request_load<Mg::TextResource>("test-file-1.txt");
+        auto request1 = cache.request_load<Mg::TextResource>("test-file-2.txt");
+        auto request2 = cache.request_load<Mg::TextResource>("subdirectory/test-file-4.txt");
+
+        request0.wait();
+        REQUIRE(request0.is_ready());
+        REQUIRE(cache.is_cached("test-file-1.txt"));
+
+        // get() waits for the load to finish.
+        Mg::ResourceAccessGuard access1(request1.get());
+        REQUIRE(access1->text() == "test-file-2");
+
+        Mg::ResourceAccessGuard access2(request2.get());
+        REQUIRE(cache.is_cached("subdirectory/test-file-4.txt"));
+
+        // Requesting an already loaded resource is immediately ready.
+        auto request3 = cache.request_load<Mg::TextResource>("test-file-2.txt");
+        REQUIRE(request3.is_ready());
+    }
+
+    SECTION("statistics")
+    {
+        puts("Starting statistics test");
+
+        {
+            auto access = cache.access_resource<Mg::TextResource>("test-file-2.txt");
+        }
+        {
+            auto access = cache.access_resource<Mg::TextResource>("test-file-2.txt");
+        }
+        auto handle = cache.resource_handle<Mg::TextResource>("test-file-3.txt", false);
+
+        const Mg::ResourceCacheStatistics stats = cache.statistics();
+        REQUIRE(stats.resources.size() == 2);
+
+        const Mg::ResourceStatistics& loaded = stats.resources[0];
+        REQUIRE(loaded.resource_id == "test-file-2.txt");
+        REQUIRE(loaded.resource_type_id == "TextResource");
+        REQUIRE(loaded.is_loaded);
+        REQUIRE(loaded.counters.num_loads == 1);
+        REQUIRE(loaded.counters.num_misses == 1);
+        REQUIRE(loaded.counters.num_hits == 1);
+        REQUIRE(loaded.counters.bytes_read == std::string_view("test-file-2").size());
+        REQUIRE(loaded.counters.resident_size_bytes > 0);
+
+        const Mg::ResourceStatistics& unloaded = stats.resources[1];
+        REQUIRE(unloaded.resource_id == "test-file-3.txt");
+        REQUIRE(!unloaded.is_loaded);
+        REQUIRE(unloaded.counters.num_loads == 0);
+
+        REQUIRE(stats.total.resident_size_bytes == cache.resident_size_bytes());
+        REQUIRE(stats.resource_types.size() == 2); // TextResource and "<unset>".
+
+        const std::string csv = Mg::to_csv(stats);
+        REQUIRE(csv.starts_with("resource,type,loaded,hits,misses,loads,"));
+        REQUIRE(csv.find("\ntest-file-2.txt,TextResource,1,1,1,1,") != std::string::npos);
+
+        const std::string json = Mg::to_json(stats);
+        REQUIRE(json.starts_with(R"({"total":{"num_hits":1,)"));
+        REQUIRE(json.find(R"({"resource":"test-file-3.txt","type":"<unset>","loaded":false,)") !=
+                std::string::npos);
+    }
+
+    SECTION("request_load_not_found")
+    {
+        puts("Starting request_load_not_found test");
+
+        REQUIRE_THROWS_AS(cache.request_load<Mg::TextResource>("no-such-file.txt"),
+                          Mg::ResourceNotFound);
+    }
 }
 
 TEST_CASE("alternative constructor")
@@ -166,3 +325,246 @@ TEST_CASE("alternative constructor")
     REQUIRE(has_loader_with_name(cache, directory_name));
     REQUIRE(has_loader_with_name(cache, archive_name));
 }
+
+TEST_CASE("ResourceCache::refresh")
+{
+    namespace fs = std::filesystem;
+    using namespace std::chrono_literals;
+
+    const fs::path directory = fs::temp_directory_path() / "mg_resource_cache_refresh_test";
+    fs::remove_all(directory);
+    fs::create_directories(directory);
+
+    const auto write_file = [&](const char* filename, std::string_view content) {
+        std::ofstream{ directory / filename } << content;
+    };
+
+    write_file("a.txt", "version 1");
+    write_file("b.txt", "b");
+
+    {
+        Mg::ResourceCache cache(std::make_unique<Mg::BasicFileLoader>(directory.string()));
+        {
+            auto access = cache.access_resource<Mg::TextResource>("a.txt");
+            REQUIRE(access->text() == "version 1");
+        }
+
+        // Time stamps have a resolution of one second, so move the time stamp forward explicitly.
+        write_file("a.txt", "version 2");
+        fs::last_write_time(directory / "a.txt", fs::last_write_time(directory / "a.txt") + 10s);
+        write_file("c.txt", "c");
+        fs::remove(directory / "b.txt");
+
+        cache.refresh();
+
+        // Changed resources are reloaded right away.
+        REQUIRE(cache.is_cached("a.txt"));
+        {
+            auto access = cache.access_resource<Mg::TextResource>("a.txt");
+            REQUIRE(access->text() == "version 2");
+        }
+        REQUIRE(cache.file_exists("c.txt"));
+        REQUIRE(!cache.file_exists("b.txt"));
+
+        // Refreshing again without changes does not unload anything.
+        cache.refresh();
+        REQUIRE(cache.is_cached("a.txt"));
+    }
+
+#ifdef __linux__
+    SECTION("changed_files")
+    {
+        Mg::BasicFileLoader loader(directory.string());
+        loader.available_files();
+
+        write_file("d.txt", "d");
+        fs::remove(directory / "c.txt");
+
+        const Mg::Opt<Mg::FileListDelta> delta = loader.changed_files();
+        REQUIRE(delta.has_value());
+        REQUIRE(delta->added_or_modified.size() == 1);
+        REQUIRE(delta->added_or_modified[0].name == "d.txt");
+        REQUIRE(delta->removed.size() == 1);
+        REQUIRE(delta->removed[0] == "c.txt");
+
+        REQUIRE(loader.changed_files().has_value());
+        REQUIRE(loader.changed_files()->added_or_modified.empty());
+    }
+#endif
+
+    fs::remove_all(directory);
+}
+
+TEST_CASE("ResourceCache::refresh reloads dependants")
+{
+    namespace fs = std::filesystem;
+    using namespace std::chrono_literals;
+
+    const fs::path directory = fs::temp_directory_path() / "mg_resource_cache_dependants_test";
+    fs::remove_all(directory);
+    fs::create_directories(directory);
+
+    const auto write_file = [&](const char* filename, std::string_view content) {
+        std::ofstream{ directory / filename } << content;
+    };
+
+    write_file("leaf.txt", "leaf 1");
+    write_file("other.txt", "other");
+    write_file("mid.concat", "leaf.txt");
+    write_file("top.concat", "mid.concat\nother.txt");
+    write_file("unrelated.concat", "other.txt");
+
+    {
+        Mg::ResourceCache cache(std::make_unique<Mg::BasicFileLoader>(directory.string()));
+
+        struct TrackerState {
+            size_t num_batches = 0;
+            std::vector<Mg::Identifier> reloaded;
+        } concat_state;
+
+        auto concat_tracker = cache.make_file_change_tracker(
+            "ConcatResource",
+            [](void* data, std::span<const Mg::FileChangedEvent> events) {
+                auto& state = *static_cast<TrackerState*>(data);
+                ++state.num_batches;
+                for (const Mg::FileChangedEvent& event : events) {
+                    state.reloaded.push_back(event.resource.resource_id());
+                }
+            },
+            &concat_state);
+
+        {
+            auto top = cache.access_resource<ConcatResource>("top.concat");
+            REQUIRE(top->text == "leaf 1other");
+            auto unrelated = cache.access_resource<ConcatResource>("unrelated.concat");
+            REQUIRE(unrelated->text == "other");
+        }
+
+        write_file("leaf.txt", "leaf 2");
+        fs::last_write_time(directory / "leaf.txt",
+                            fs::last_write_time(directory / "leaf.txt") + 10s);
+
+        cache.refresh();
+
+        // Both dependants were reloaded, transitively, and reported in a single batch.
+        REQUIRE(concat_state.num_batches == 1);
+        REQUIRE(concat_state.reloaded.size() == 2);
+        REQUIRE(std::ranges::count(concat_state.reloaded, Mg::Identifier("mid.concat")) == 1);
+        REQUIRE(std::ranges::count(concat_state.reloaded, Mg::Identifier("top.concat")) == 1);
+
+        // Resources were reloaded eagerly.
+        REQUIRE(cache.is_cached("top.concat"));
+        REQUIRE(cache.is_cached("unrelated.concat"));
+        {
+            auto top = cache.access_resource<ConcatResource>("top.concat");
+            REQUIRE(top->text == "leaf 2other");
+        }
+    }
+
+    fs::remove_all(directory);
+}
+
+TEST_CASE("BasicFileLoader::map_file")
+{
+    // Loose files may be rewritten while loaded, so they are copied instead of mapped.
+    Mg::BasicFileLoader loader("data/test-archive");
+    REQUIRE(!loader.map_file("test-file-2.txt").has_value());
+}
+
+TEST_CASE("ZipFileLoader")
+{
+    Mg::ZipFileLoader loader("data/test-archive.zip");
+
+    SECTION("index")
+    {
+        const auto files = loader.available_files();
+
+        // Directory entries are not listed.
+        REQUIRE(files.size() == 3);
+        REQUIRE(loader.file_exists("test-file-1.txt"));
+        REQUIRE(loader.file_exists("subdirectory/test-file-5.txt"));
+        REQUIRE(!loader.file_exists("subdirectory/"));
+        REQUIRE(!loader.file_exists("test-file-2.txt"));
+        REQUIRE(loader.file_size("test-file-1.txt") == 11);
+
+        // Names are looked up case-insensitively.
+        REQUIRE(loader.file_exists("Test-File-1.TXT"));
+        REQUIRE(loader.file_size("SUBDIRECTORY/test-file-5.txt") == 11);
+    }
+
+    SECTION("concurrent_load_file")
+    {
+        constexpr size_t num_threads = 8;
+        constexpr size_t num_iterations = 50;
+        std::atomic_size_t num_failures = 0;
+
+        std::vector<std::thread> threads;
+        for (size_t i = 0; i < num_threads; ++i) {
+            threads.emplace_back([&, i] {
+                const Mg::Identifier file = (i % 2 == 0) ? "test-file-1.txt" : "test-file-3.txt";
+                const std::string_view expected = (i % 2 == 0) ? "test-file-1" : "test-file-3";
+
+                for (size_t j = 0; j < num_iterations; ++j) {
+                    std::array<std::byte, 11> buffer = {};
+                    loader.load_file(file, buffer);
+                    const std::string_view text{ reinterpret_cast<const char*>(buffer.data()),
+                                                 buffer.size() };
+                    if (text != expected) {
+                        ++num_failures;
+                    }
+                }
+            });
+        }
+
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+
+        REQUIRE(num_failures == 0);
+    }
+}
+
+TEST_CASE("PackFileLoader")
+{
+    // Created with `pack_tool --compress data/test-archive data/test-archive.mgpak`, so that it
+    // contains both compressed and uncompressed files.
+    Mg::PackFileLoader loader("data/test-archive.mgpak");
+
+    const auto read_text = [&](Mg::Identifier file) {
+        std::string result(loader.file_size(file), '\0');
+        loader.load_file(file, std::as_writable_bytes(std::span{ result }));
+        return result;
+    };
+
+    SECTION("index")
+    {
+        const auto files = loader.available_files();
+        REQUIRE(files.size() == 5);
+        REQUIRE(loader.file_exists("test-file-2.txt"));
+        REQUIRE(loader.file_exists("subdirectory/test-file-4.txt"));
+        REQUIRE(!loader.file_exists("test-file-1.txt"));
+        REQUIRE(loader.file_size("test-file-large-1.dat") == 816);
+    }
+
+    SECTION("load_file")
+    {
+        REQUIRE(read_text("test-file-2.txt") == "test-file-2");
+        REQUIRE(read_text("subdirectory/test-file-4.txt") == "test-file-4\n");
+
+        const auto large = read_text("test-file-large-1.dat");
+        REQUIRE(large.size() == 816);
+        REQUIRE(large.starts_with("datadatadata"));
+    }
+
+    SECTION("map_file")
+    {
+        Mg::Opt<Mg::SharedFileData> mapped = loader.map_file("test-file-3.txt");
+        REQUIRE(mapped.has_value());
+        const std::string_view text{ reinterpret_cast<const char*>(mapped->bytes().data()),
+                                     mapped->bytes().size() };
+        REQUIRE(text == "test-file-3");
+
+        // Compressed files cannot be mapped.
+        REQUIRE(!loader.map_file("test-file-large-1.dat").has_value());
+    }
+}
@@ -3,18 +3,19 @@
 #include <algorithm>
 #include <array>
 #include <format>
+#include <memory_resource>
 #include <random>
 #include <set>
 #include <string>
+#include <vector>
 
 #include <mg/core/containers/mg_slot_map.h>
 #include <mg/utils/mg_instance_counter.h>
 
 using namespace Mg;
 
-// TODO: test swap (both member and free); test SlotMapInserter; test
-// growing; test that handles are valid after resize, move, and copy; test exception safety; test
-// range-erase
+// TODO: test swap (both member and free); test SlotMapInserter; test that handles are valid after
+// move and copy; test exception safety
 
 struct Type {
     Type() = default;
@@ -513,6 +514,29 @@ TEST_CASE("Large Slot_map")
     REQUIRE(*(smap.begin() + 5000) == "Emplace string");
 }
 
+TEST_CASE("Slot_map: erase elements that have been moved")
+{
+    Slot_map<uint32_t> smap(16);
+    std::vector<Slot_map_handle> handles;
+
+    for (uint32_t i = 0; i < 8; ++i) {
+        handles.push_back(smap.insert(i));
+    }
+
+    // Erasing the first element moves the last one into its place; erasing the moved element must
+    // then invalidate its own handle, not that of the erased element's.
+    smap.erase(handles[0]);
+    smap.erase(handles[7]);
+
+    REQUIRE(!smap.is_handle_valid(handles[0]));
+    REQUIRE(!smap.is_handle_valid(handles[7]));
+
+    for (uint32_t i = 1; i < 7; ++i) {
+        REQUIRE(smap.is_handle_valid(handles[i]));
+        REQUIRE(smap[handles[i]] == i);
+    }
+}
+
 // Check that objects are properly destroyed on Slot_map destruction
 TEST_CASE("Slot_map: check element destruction")
 {
@@ -531,3 +555,129 @@ TEST_CASE("Slot_map: check element destruction")
 
     REQUIRE(InstanceCounter<Type>::get_counter() == 0);
 }
+
+TEST_CASE("Slot_map: growing keeps handles valid")
+{
+    Slot_map<uint32_t> smap;
+    REQUIRE(smap.capacity() == 0);
+
+    std::vector<Slot_map_handle> handles;
+    std::vector<bool> erased(1000, false);
+    for (uint32_t i = 0; i < 1000; ++i) {
+        handles.push_back(smap.insert(i));
+        if (i % 3 == 0) {
+            smap.erase(handles[i / 2]);
+            erased[i / 2] = true;
+        }
+    }
+
+    for (uint32_t i = 0; i < 1000; ++i) {
+        REQUIRE(smap.is_handle_valid(handles[i]) == !erased[i]);
+        if (!erased[i]) {
+            REQUIRE(smap[handles[i]] == i);
+        }
+    }
+
+    // Reducing the capacity also keeps handles valid, even those with indices beyond the new
+    // capacity.
+    smap.resize(smap.size());
+    REQUIRE(smap.capacity() == smap.size());
+    REQUIRE(smap[handles[999]] == 999);
+    const Slot_map_handle inserted = smap.insert(1000u);
+    REQUIRE(smap[inserted] == 1000);
+    REQUIRE(smap[handles[999]] == 999);
+}
+
+TEST_CASE("Slot_map: emplace_n and erase_n")
+{
+    Slot_map<std::string> smap{ 4 };
+    const Slot_map_handle single = smap.emplace("single");
+
+    std::array<Slot_map_handle, 100> handles;
+    smap.emplace_n(handles, 3, 'x');
+
+    REQUIRE(smap.size() == 101);
+    REQUIRE(smap.capacity() >= 101);
+    for (const Slot_map_handle handle : handles) {
+        REQUIRE(smap[handle] == "xxx");
+    }
+
+    smap.erase_n(std::span{ handles }.subspan(10));
+    REQUIRE(smap.size() == 11);
+    REQUIRE(smap[single] == "single");
+    for (size_t i = 0; i < handles.size(); ++i) {
+        REQUIRE(smap.is_handle_valid(handles[i]) == (i < 10));
+    }
+}
+
+TEST_CASE("Slot_map: clear invalidates handles")
+{
+    Slot_map<uint32_t> smap{ 4 };
+    const Slot_map_handle h0 = smap.insert(0u);
+    const Slot_map_handle h1 = smap.insert(1u);
+
+    smap.clear();
+    REQUIRE(smap.empty());
+    REQUIRE(smap.capacity() == 4);
+
+    // Re-filling past the number of previously used keys must not run out of keys, and must not
+    // make the old handles valid again.
+    std::vector<Slot_map_handle> handles;
+    for (uint32_t i = 0; i < 8; ++i) {
+        handles.push_back(smap.insert(i));
+    }
+
+    REQUIRE(!smap.is_handle_valid(h0));
+    REQUIRE(!smap.is_handle_valid(h1));
+    for (uint32_t i = 0; i < 8; ++i) {
+        REQUIRE(smap[handles[i]] == i);
+    }
+}
+
+TEST_CASE("Slot_map: range erase keeps handles valid")
+{
+    Slot_map<uint32_t> smap;
+    std::vector<Slot_map_handle> handles;
+    for (uint32_t i = 0; i < 10; ++i) {
+        handles.push_back(smap.insert(i));
+    }
+
+    const auto it = smap.erase(smap.begin() + 2, smap.begin() + 5);
+    REQUIRE(it == smap.begin() + 2);
+    REQUIRE(smap.size() == 7);
+
+    for (uint32_t i = 0; i < 10; ++i) {
+        const bool erased = i >= 2 && i < 5;
+        REQUIRE(smap.is_handle_valid(handles[i]) == !erased);
+        if (!erased) {
+            REQUIRE(smap[handles[i]] == i);
+            REQUIRE(smap.make_handle(&smap[handles[i]]) == handles[i]);
+        }
+    }
+}
+
+TEST_CASE("Slot_map: polymorphic allocator")
+{
+    std::array<std::byte, 4096> buffer{};
+    std::pmr::monotonic_buffer_resource arena{ buffer.data(), buffer.size(),
+                                               std::pmr::null_memory_resource() };
+
+    pmr::Slot_map<uint32_t> smap{ 16, &arena };
+    REQUIRE(smap.get_allocator().resource() == &arena);
+
+    std::array<Slot_map_handle, 32> handles;
+    smap.emplace_n(handles, 7u);
+    REQUIRE(smap.size() == 32);
+    REQUIRE(smap[handles[31]] == 7);
+
+    // Moving to a Slot_map with a different memory resource moves the elements individually and
+    // keeps the handles valid.
+    pmr::Slot_map<uint32_t> moved{ std::move(smap), std::pmr::new_delete_resource() };
+    REQUIRE(moved.get_allocator().resource() == std::pmr::new_delete_resource());
+    REQUIRE(moved.size() == 32);
+    REQUIRE(moved[handles[0]] == 7);
+    REQUIRE(smap.empty()); // NOLINT
+
+    const pmr::Slot_map<uint32_t> copy{ moved, &arena };
+    REQUIRE(copy[handles[0]] == 7);
+}
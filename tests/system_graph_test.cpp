@@ -0,0 +1,197 @@
+#include "catch.hpp"
+
+#include <mg/core/ecs/mg_entity.h>
+#include <mg/core/ecs/mg_system_graph.h>
+#include <mg/core/mg_job_system.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace {
+
+struct GraphTestA : Mg::ecs::BaseComponent<GraphTestA> {
+    int value = 0;
+};
+
+struct GraphTestB : Mg::ecs::BaseComponent<GraphTestB> {
+    int value = 0;
+};
+
+std::vector<size_t> to_vector(std::span<const size_t> span)
+{
+    return { span.begin(), span.end() };
+}
+
+} // namespace
+
+TEST_CASE("SystemGraph: dependencies")
+{
+    using Mg::ecs::SystemAccess;
+
+    Mg::ecs::EntityCollection entities{ 16 };
+    entities.init<GraphTestA, GraphTestB>();
+
+    Mg::ecs::SystemGraph graph;
+    graph.add_system("write_a", SystemAccess{}.writes<GraphTestA>(), [] {});
+    graph.add_system("read_a_1", SystemAccess{}.reads<GraphTestA>(), [] {});
+    graph.add_system("read_a_2", SystemAccess{}.reads<GraphTestA>(), [] {});
+    graph.add_system("write_a_again", SystemAccess{}.writes<GraphTestA>(), [] {});
+    graph.add_system("write_b", SystemAccess{}.writes<GraphTestB>(), [] {});
+    graph.add_system("read_res", SystemAccess{}.reads_resource("Res"), [] {});
+    graph.add_system("write_res", SystemAccess{}.writes_resource("Res"), [] {});
+    graph.add_system("exclusive", SystemAccess::exclusive(), [] {});
+
+    REQUIRE(graph.num_systems() == 8);
+    CHECK(graph.dependencies(0).empty());
+    CHECK(to_vector(graph.dependencies(1)) == std::vector<size_t>{ 0 });
+    CHECK(to_vector(graph.dependencies(2)) == std::vector<size_t>{ 0 });
+
+    // Depends on write_a only through the readers.
+    CHECK(to_vector(graph.dependencies(3)) == std::vector<size_t>{ 1, 2 });
+
+    CHECK(graph.dependencies(4).empty());
+    CHECK(graph.dependencies(5).empty());
+    CHECK(to_vector(graph.dependencies(6)) == std::vector<size_t>{ 5 });
+
+    // Conflicts with everything, but implied dependencies are omitted.
+    CHECK(to_vector(graph.dependencies(7)) == std::vector<size_t>{ 3, 4, 6 });
+}
+
+TEST_CASE("SystemAccess: queries")
+{
+    using Mg::ecs::Changed;
+    using Mg::ecs::Maybe;
+    using Mg::ecs::Not;
+    using Mg::ecs::SystemAccess;
+    using Mg::ecs::Tracked;
+
+    Mg::ecs::EntityCollection entities{ 16 };
+    entities.init<GraphTestA, GraphTestB>();
+
+    const auto read_a = SystemAccess{}.queries<const GraphTestA>();
+    const auto read_changed_a = SystemAccess{}.queries<Changed<const GraphTestA>>();
+    const auto tracked_write_a = SystemAccess{}.queries<Tracked<GraphTestA>>();
+    const auto write_a = SystemAccess{}.queries<GraphTestA>();
+    const auto maybe_write_a = SystemAccess{}.queries<const GraphTestB, Maybe<GraphTestA>>();
+    const auto write_b_without_a = SystemAccess{}.queries<GraphTestB, Not<GraphTestA>>();
+
+    CHECK(!read_a.conflicts_with(SystemAccess{}.reads<GraphTestA>()));
+    CHECK(read_a.conflicts_with(write_a));
+    CHECK(maybe_write_a.conflicts_with(read_a));
+    CHECK(!write_b_without_a.conflicts_with(write_a));
+    CHECK(write_b_without_a.conflicts_with(maybe_write_a));
+    CHECK(!read_changed_a.conflicts_with(read_a));
+    CHECK(tracked_write_a.conflicts_with(read_changed_a));
+}
+
+TEST_CASE("SystemGraph: run order")
+{
+    using Mg::ecs::SystemAccess;
+
+    Mg::ecs::EntityCollection entities{ 16 };
+    entities.init<GraphTestA, GraphTestB>();
+
+    Mg::JobSystem job_system{ 3 };
+    Mg::ecs::SystemGraph graph;
+
+    std::atomic_int clock = 0;
+    std::array<int, 6> stamps = {};
+    const auto stamp = [&](size_t i) {
+        return [&, i] {
+            std::this_thread::sleep_for(std::chrono::microseconds(50));
+            stamps[i] = ++clock;
+        };
+    };
+
+    std::thread::id main_thread_system_thread_id;
+
+    graph.add_system("0", SystemAccess{}.writes<GraphTestA>(), stamp(0));
+    graph.add_system("1", SystemAccess{}.reads<GraphTestA>().writes<GraphTestB>(), stamp(1));
+    graph.add_system("2", SystemAccess{}.reads<GraphTestA>(), stamp(2));
+    graph.add_system("3", SystemAccess{}.reads<GraphTestB>().on_main_thread(), [&] {
+        main_thread_system_thread_id = std::this_thread::get_id();
+        stamp(3)();
+    });
+    graph.add_system("4", SystemAccess{}.writes<GraphTestA>(), stamp(4));
+    graph.add_system("5", SystemAccess{}.writes_resource("Other"), stamp(5));
+
+    for (int i = 0; i < 100; ++i) {
+        clock = 0;
+        stamps = {};
+        graph.run(job_system);
+
+        REQUIRE(std::ranges::all_of(stamps, [](int s) { return s > 0; }));
+        REQUIRE(stamps[0] < stamps[1]);
+        REQUIRE(stamps[0] < stamps[2]);
+        REQUIRE(stamps[1] < stamps[3]);
+        REQUIRE(stamps[1] < stamps[4]);
+        REQUIRE(stamps[2] < stamps[4]);
+        REQUIRE(main_thread_system_thread_id == std::this_thread::get_id());
+    }
+}
+
+TEST_CASE("SystemGraph: concurrent systems")
+{
+    using Mg::ecs::SystemAccess;
+
+    Mg::JobSystem job_system{ 2 };
+    Mg::ecs::SystemGraph graph;
+
+    // Each system waits for the other to start, which only succeeds if they run concurrently.
+    std::atomic_bool a_started = false;
+    std::atomic_bool b_started = false;
+    std::atomic_bool timed_out = false;
+
+    const auto wait_for = [&](std::atomic_bool& flag) {
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+        while (!flag) {
+            if (std::chrono::steady_clock::now() > deadline) {
+                timed_out = true;
+                return;
+            }
+            std::this_thread::yield();
+        }
+    };
+
+    graph.add_system("a", SystemAccess{}.writes_resource("A"), [&] {
+        a_started = true;
+        wait_for(b_started);
+    });
+    graph.add_system("b", SystemAccess{}.writes_resource("B"), [&] {
+        b_started = true;
+        wait_for(a_started);
+    });
+
+    graph.run(job_system);
+    REQUIRE(!timed_out);
+}
+
+TEST_CASE("SystemGraph: exceptions")
+{
+    using Mg::ecs::SystemAccess;
+
+    Mg::JobSystem job_system{ 2 };
+    Mg::ecs::SystemGraph graph;
+
+    bool dependant_ran = false;
+    graph.add_system("throws", SystemAccess{}.writes_resource("R"), [] {
+        throw std::runtime_error("test");
+    });
+    graph.add_system("dependant", SystemAccess{}.reads_resource("R"), [&] {
+        dependant_ran = true;
+    });
+
+    REQUIRE_THROWS_AS(graph.run(job_system), std::runtime_error);
+    REQUIRE(!dependant_ran);
+
+    // The graph can be run again after an exception.
+    graph.clear();
+    graph.add_system("ok", SystemAccess{}, [&] { dependant_ran = true; });
+    graph.run(job_system);
+    REQUIRE(dependant_ran);
+}
@@ -1,8 +1,17 @@
 #include "catch.hpp"
 
 #include <cmath>
-
+#include <cstdint>
+#include <limits>
+#include <thread>
+#include <vector>
+
+#include <mg/core/gfx/mg_compact_vertex.h>
+#include <mg/core/mg_frame_arena.h>
+#include <mg/core/mg_linear_arena.h>
+#include <mg/core/mg_transform.h>
 #include <mg/utils/mg_iteration_utils.h>
+#include <mg/utils/mg_lz4.h>
 #include <mg/utils/mg_math_utils.h>
 #include <mg/utils/mg_point_normal_plane.h>
 #include <mg/utils/mg_string_utils.h>
@@ -569,6 +578,335 @@ TEST_CASE("zip different length 2")
     REQUIRE(num_iterations == 5);
 }
 
+TEST_CASE("lz4 roundtrip")
+{
+    const auto roundtrip = [](std::span<const std::byte> data) {
+        std::vector<std::byte> compressed(lz4_compress_bound(data.size()));
+        const size_t compressed_size = lz4_compress(data, compressed);
+        REQUIRE(compressed_size > 0);
+        compressed.resize(compressed_size);
+
+        std::vector<std::byte> decompressed(data.size());
+        REQUIRE(lz4_decompress(compressed, decompressed));
+        REQUIRE(std::ranges::equal(data, decompressed));
+
+        // Wrong output size is an error.
+        std::vector<std::byte> too_large(data.size() + 1);
+        REQUIRE(!lz4_decompress(compressed, too_large));
+
+        return compressed_size;
+    };
+
+    roundtrip({});
+    roundtrip(std::as_bytes(std::span{ "short" }));
+
+    std::string repetitive;
+    for (int i = 0; i < 1000; ++i) {
+        repetitive += "repetitive data " + std::to_string(i % 10);
+    }
+    REQUIRE(roundtrip(std::as_bytes(std::span{ repetitive })) < repetitive.size() / 4);
+
+    std::vector<std::byte> noise(5000);
+    uint32_t state = 1;
+    for (std::byte& b : noise) {
+        state = state * 1664525u + 1013904223u;
+        b = std::byte(state >> 24u);
+    }
+    REQUIRE(roundtrip(noise) <= lz4_compress_bound(noise.size()));
+}
+
+TEST_CASE("half float conversion")
+{
+    using gfx::mesh_data::float_to_half;
+    using gfx::mesh_data::half_to_float;
+
+    REQUIRE(float_to_half(0.0f) == 0x0000);
+    REQUIRE(float_to_half(-0.0f) == 0x8000);
+    REQUIRE(float_to_half(1.0f) == 0x3C00);
+    REQUIRE(float_to_half(-2.0f) == 0xC000);
+    REQUIRE(float_to_half(65504.0f) == 0x7BFF);
+    REQUIRE(float_to_half(1.0e6f) == 0x7C00);
+    REQUIRE(float_to_half(std::numeric_limits<float>::infinity()) == 0x7C00);
+    REQUIRE(std::isnan(half_to_float(float_to_half(std::numeric_limits<float>::quiet_NaN()))));
+
+    // Smallest subnormal half.
+    REQUIRE(float_to_half(0x1p-24f) == 0x0001);
+    REQUIRE(half_to_float(0x0001) == 0x1p-24f);
+
+    // Ties round to even.
+    REQUIRE(float_to_half(1.0f + 0x1p-11f) == 0x3C00);
+    REQUIRE(float_to_half(1.0f + 3 * 0x1p-11f) == 0x3C02);
+
+    for (float f = -100.0f; f < 100.0f; f += 0.173f) {
+        const float roundtrip = half_to_float(float_to_half(f));
+        REQUIRE(std::abs(roundtrip - f) <= std::abs(f) * 0x1p-11f);
+    }
+}
+
+TEST_CASE("compact vertex roundtrip")
+{
+    using namespace gfx::mesh_data;
+
+    const AxisAlignedBoundingBox box = { .min_corner = { -2.0f, 0.0f, -1.0f },
+                                         .max_corner = { 2.0f, 8.0f, 1.0f } };
+
+    const auto check_vertex = [&](const glm::vec3& position,
+                                  const glm::vec3& normal,
+                                  const glm::vec3& tangent,
+                                  const glm::vec3& bitangent) {
+        Vertex vertex;
+        vertex.position = position;
+        vertex.tex_coord = { 0.25f, -3.5f, 0.0f };
+        vertex.normal = normal;
+        vertex.tangent = tangent;
+        vertex.bitangent = bitangent;
+
+        const Vertex result = decompress_vertex(compress_vertex(vertex, box), box);
+
+        const glm::vec3 position_error = glm::abs(result.position - position);
+        const glm::vec3 max_position_error = (box.max_corner - box.min_corner) / 65535.0f;
+        REQUIRE(position_error.x <= max_position_error.x);
+        REQUIRE(position_error.y <= max_position_error.y);
+        REQUIRE(position_error.z <= max_position_error.z);
+
+        REQUIRE(result.tex_coord == vertex.tex_coord);
+
+        REQUIRE(glm::dot(result.normal.get(), normal) > 0.999f);
+        REQUIRE(glm::dot(result.tangent.get(), tangent) > 0.999f);
+        REQUIRE(glm::dot(result.bitangent.get(), bitangent) > 0.999f);
+    };
+
+    const glm::vec3 x{ 1.0f, 0.0f, 0.0f };
+    const glm::vec3 y{ 0.0f, 1.0f, 0.0f };
+    const glm::vec3 z{ 0.0f, 0.0f, 1.0f };
+    const float s = std::sqrt(0.5f);
+
+    check_vertex({ 0.0f, 0.0f, 0.0f }, z, x, y);
+    check_vertex({ 2.0f, 8.0f, 1.0f }, y, z, x);
+    check_vertex({ -1.3f, 4.1f, 0.7f }, { s, s, 0.0f }, { -s, s, 0.0f }, z);
+
+    // Mirrored tangent frame (left-handed), as with mirrored texture coordinates.
+    check_vertex({ 0.5f, 1.0f, -0.5f }, z, x, -y);
+
+    // Rotation by 180 degrees, where the quaternion's w is zero before biasing.
+    check_vertex({ 0.0f, 2.0f, 0.0f }, -z, -x, y);
+    check_vertex({ 0.0f, 2.0f, 0.0f }, -z, -x, -y);
+
+    // Positions outside the box are clamped.
+    const Vertex outside{ .position = { 10.0f, -10.0f, 0.0f } };
+    const CompactVertex clamped = compress_vertex(outside, box);
+    REQUIRE(clamped.position[0] == 65535);
+    REQUIRE(clamped.position[1] == 0);
+}
+
+namespace {
+
+bool approx_equal(const glm::mat4& l, const glm::mat4& r, const float epsilon)
+{
+    for (glm::length_t column = 0; column < 4; ++column) {
+        for (glm::length_t row = 0; row < 4; ++row) {
+            if (std::abs(l[column][row] - r[column][row]) > epsilon) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+TEST_CASE("Transform")
+{
+    const Transform transform{ { 1.0f, -2.0f, 3.0f },
+                               { 2.0f, 3.0f, 0.5f },
+                               Rotation{ { 0.3f, -0.5f, 1.2f } } };
+
+    const glm::mat4 expected = glm::translate(transform.position) *
+                               transform.rotation.to_matrix() * glm::scale(transform.scale);
+    REQUIRE(approx_equal(transform.matrix(), expected, 1e-5f));
+
+    const Transform decomposed = Transform::from_matrix(expected);
+    REQUIRE(glm::distance(decomposed.position, transform.position) < 1e-5f);
+    REQUIRE(glm::distance(decomposed.scale, transform.scale) < 1e-5f);
+    REQUIRE(decomposed.rotation.is_equivalent(transform.rotation));
+
+    // Interpolation preserves scale.
+    Transform moved = transform;
+    moved.position += glm::vec3{ 4.0f, 0.0f, 0.0f };
+    moved.rotation.yaw(Angle::from_degrees(30.0f));
+    const Transform halfway = Transform::mix(transform, moved, 0.5f);
+    REQUIRE(glm::distance(halfway.position, transform.position + glm::vec3{ 2.0f, 0.0f, 0.0f }) <
+            1e-5f);
+    REQUIRE(halfway.scale == transform.scale);
+
+    REQUIRE(approx_equal(Transform::mix(transform, moved, 0.0f).matrix(), expected, 1e-5f));
+    REQUIRE(approx_equal(
+        Transform::mix(transform, moved, 1.0f).matrix(), moved.matrix(), 1e-5f));
+
+    // Transforms that did not change are not perturbed.
+    const Transform unchanged = Transform::mix(transform, transform, 0.37f);
+    REQUIRE(unchanged.position == transform.position);
+    REQUIRE(unchanged.scale == transform.scale);
+}
+
+TEST_CASE("TransformInterpolationBatch")
+{
+    TransformInterpolationBatch batch;
+    std::vector<Transform> from;
+    std::vector<Transform> to;
+
+    // Enough for a partially filled last block.
+    for (int i = 0; i < 19; ++i) {
+        const float f = float(i);
+        Transform& a = from.emplace_back();
+        a.position = { f, -f, 0.5f * f };
+        a.rotation = Rotation{ { 0.1f * f, 0.2f, -0.05f * f } };
+        a.scale = { 1.0f + 0.1f * f, 1.0f, 2.0f };
+
+        Transform& b = to.emplace_back(a);
+        b.position += glm::vec3{ 1.0f, 2.0f, 3.0f };
+        b.rotation.yaw(Angle::from_radians(0.1f * f));
+        b.scale *= 2.0f;
+
+        // The same rotation, as the negated quaternion, must not make interpolation take the long
+        // way around.
+        if (i % 5 == 0) {
+            b.rotation = Rotation{ -a.rotation.to_quaternion() };
+        }
+
+        batch.push_back(a, b);
+    }
+    REQUIRE(batch.size() == 19);
+
+    std::vector<glm::mat4> matrices(batch.size());
+    batch.interpolate(0.25f, matrices);
+
+    for (size_t i = 0; i < matrices.size(); ++i) {
+        const glm::mat4 expected = Transform::mix(from[i], to[i], 0.25f).matrix();
+        REQUIRE(approx_equal(matrices[i], expected, 1e-4f));
+    }
+    REQUIRE(Transform::mix(from[0], to[0], 0.25f).rotation.is_equivalent(from[0].rotation));
+
+    batch.clear();
+    REQUIRE(batch.empty());
+}
+
+TEST_CASE("LinearArena")
+{
+    LinearArena arena{ 256 };
+    REQUIRE(arena.bytes_allocated() == 0);
+    REQUIRE(arena.capacity() == 0);
+
+    auto* a = arena.create<uint32_t>(1u);
+    auto* b = arena.create<double>(2.0);
+    REQUIRE(*a == 1u);
+    REQUIRE(*b == 2.0);
+    REQUIRE(reinterpret_cast<uintptr_t>(b) % alignof(double) == 0);
+
+    void* aligned = arena.allocate(10, 64);
+    REQUIRE(reinterpret_cast<uintptr_t>(aligned) % 64 == 0);
+
+    // Allocations that do not fit in the current block go into a new one.
+    std::vector<void*> allocations;
+    for (int i = 0; i < 20; ++i) {
+        allocations.push_back(arena.allocate(100, 8));
+    }
+    const size_t capacity = arena.capacity();
+    REQUIRE(capacity > 256);
+
+    // Oversized allocations get a block of their own.
+    void* large = arena.allocate(1000, 16);
+    REQUIRE(large != nullptr);
+    REQUIRE(arena.capacity() >= capacity + 1000);
+
+    // Blocks are reused after reset.
+    const size_t capacity_before_reset = arena.capacity();
+    arena.reset();
+    REQUIRE(arena.bytes_allocated() == 0);
+    for (int i = 0; i < 20; ++i) {
+        (void)arena.allocate(100, 8);
+    }
+    (void)arena.allocate(1000, 16);
+    REQUIRE(arena.capacity() == capacity_before_reset);
+    REQUIRE(arena.num_block_allocations() == 0);
+    REQUIRE(arena.high_water_mark() >= arena.bytes_allocated());
+
+    const size_t high_water_mark = arena.high_water_mark();
+    arena.reset();
+    (void)arena.allocate(10, 8);
+    REQUIRE(arena.high_water_mark() == high_water_mark);
+
+    arena.release();
+    REQUIRE(arena.capacity() == 0);
+    REQUIRE(arena.high_water_mark() == 0);
+}
+
+TEST_CASE("ArenaAllocator")
+{
+    LinearArena arena{ 256 };
+
+    ArenaVector<uint32_t> values{ ArenaAllocator<uint32_t>{ arena } };
+    for (uint32_t i = 0; i < 100; ++i) {
+        values.push_back(i);
+    }
+    for (uint32_t i = 0; i < 100; ++i) {
+        REQUIRE(values[i] == i);
+    }
+    REQUIRE(arena.bytes_allocated() >= 100 * sizeof(uint32_t));
+
+    const ArenaAllocator<double> other{ arena };
+    REQUIRE(values.get_allocator() == ArenaAllocator<uint32_t>{ other });
+    REQUIRE(&other.arena() == &arena);
+}
+
+TEST_CASE("FrameArena")
+{
+    FrameArena frame_arena{ 256 };
+
+    auto allocate_frame = [&] {
+        LinearArena& arena = frame_arena.local();
+        for (int i = 0; i < 10; ++i) {
+            (void)arena.allocate(100, 8);
+        }
+    };
+
+    // Data allocated during a frame survives into the next frame.
+    uint32_t* value = frame_arena.local().create<uint32_t>(42u);
+    allocate_frame();
+    frame_arena.next_frame();
+    REQUIRE(frame_arena.frame_count() == 1);
+    REQUIRE(frame_arena.last_frame_stats().bytes_allocated >= 1000);
+    REQUIRE(frame_arena.last_frame_stats().num_block_allocations > 0);
+
+    allocate_frame();
+    REQUIRE(*value == 42u);
+    frame_arena.next_frame();
+
+    // Each thread gets its own arena.
+    LinearArena* worker_arena = nullptr;
+    std::thread worker{ [&] {
+        worker_arena = &frame_arena.local();
+        (void)worker_arena->allocate(100, 8);
+    } };
+    worker.join();
+    REQUIRE(worker_arena != &frame_arena.local());
+
+    const size_t high_water_mark = frame_arena.last_frame_stats().high_water_mark;
+    allocate_frame();
+    frame_arena.next_frame();
+    REQUIRE(frame_arena.last_frame_stats().bytes_allocated > 1000);
+    REQUIRE(frame_arena.last_frame_stats().high_water_mark > high_water_mark);
+
+    // Once both arenas have grown to hold a frame, frames do not allocate new blocks.
+    for (int i = 0; i < 4; ++i) {
+        allocate_frame();
+        frame_arena.next_frame();
+        REQUIRE(frame_arena.last_frame_stats().num_block_allocations == 0);
+    }
+    REQUIRE(frame_arena.last_frame_stats().bytes_allocated < 1100);
+    REQUIRE(frame_arena.last_frame_stats().capacity > 0);
+}
+
 #if TEST_COMPILE_ERROR_ON_ITERATION_UTILS_FROM_RVALUE_CONTAINER
 TEST_CASE("Iteration utils cannot construct from rvalue")
 {
@@ -19,12 +19,16 @@ namespace fs = std::filesystem;
 namespace Mg {
 
 namespace {
-bool convert(const fs::path& filename, const bool debug_logging)
+bool convert(const fs::path& filename,
+             const bool debug_logging,
+             const bool compact_vertices,
+             const bool compress_animations)
 {
     fs::path out_filename = filename;
     out_filename.replace_extension(".mgm");
 
-    if (!convert_mesh(filename, out_filename, debug_logging)) {
+    if (!convert_mesh(
+            filename, out_filename, debug_logging, compact_vertices, compress_animations)) {
         std::cerr << "Failed to convert file '" << cast_u8_to_char(filename.u8string()) << "'."
                   << std::endl;
         return false;
@@ -63,6 +67,8 @@ struct AutoConverterSettings {
     bool ignore_timestamps = false;
     bool repeat_forever = false;
     bool debug_logging = false;
+    bool compact_vertices = false;
+    bool compress_animations = false;
 };
 
 // Converts meshes if they have been modified more
@@ -106,7 +112,10 @@ void convert_modified_files(const std::vector<fs::path>& input_files,
             }
         }
 
-        convert(in_file, settings.debug_logging);
+        convert(in_file,
+                settings.debug_logging,
+                settings.compact_vertices,
+                settings.compress_animations);
     }
 }
 
@@ -208,6 +217,12 @@ int main(int argc, char* argv[])
         else if (arg == "--debug-logging") {
             settings.debug_logging = true;
         }
+        else if (arg == "--compact-vertices") {
+            settings.compact_vertices = true;
+        }
+        else if (arg == "--compress-animations") {
+            settings.compress_animations = true;
+        }
         else if (arg == "--file") {
             if (args.empty()) {
                 std::cerr << "Expected file name after --file\n";
@@ -242,11 +257,24 @@ int main(int argc, char* argv[])
                      "will repeat checking for model files to convert every second until the "
                      "application is cancelled.\n";
 
+        std::cerr << "\t--compact-vertices Store vertices in compact format, with quantized "
+                     "positions, half-precision texture coordinates, and tangent frames encoded as "
+                     "quaternions. Uses less than half the memory.\n";
+
+        std::cerr << "\t--compress-animations Store animation clips in compressed format, "
+                     "resampled at 30 frames per second with quantized keys, and with keys that "
+                     "are redundant within a small error tolerance removed.\n";
+
         return error ? 1 : 0;
     }
 
     if (!file.empty()) {
-        return Mg::convert(file, settings.debug_logging) ? 0 : 1;
+        return Mg::convert(file,
+                           settings.debug_logging,
+                           settings.compact_vertices,
+                           settings.compress_animations)
+                   ? 0
+                   : 1;
     }
 
     Mg::auto_mesh_converter(fs::current_path(), settings);
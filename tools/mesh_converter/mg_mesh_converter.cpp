@@ -5,6 +5,8 @@
 #include "../shared/mg_file_writer.h"
 #include "mg_assimp_utils.h"
 
+#include <mg/core/gfx/mg_compact_vertex.h>
+#include <mg/core/gfx/mg_compressed_animation.h>
 #include <mg/core/resources/mg_mesh_resource_data.h>
 #include <mg/utils/mg_assert.h>
 #include <mg/utils/mg_optional.h>
@@ -25,6 +27,7 @@
 #include <assimp/postprocess.h>
 #include <assimp/scene.h>
 
+#include <algorithm>
 #include <iostream>
 #include <iterator>
 #include <map>
@@ -33,6 +36,8 @@ namespace Mg {
 
 using namespace Mg::gfx;
 using namespace Mg::MeshResourceData;
+using Mg::gfx::mesh_data::compress_animation_clip;
+using Mg::gfx::mesh_data::compress_vertex;
 using namespace std::literals;
 using glm::vec1, glm::vec2, glm::vec3, glm::vec4, glm::mat4, glm::quat;
 
@@ -457,6 +462,23 @@ void AnimationData::add_animation_clip(const JointData& joint_data,
     });
 }
 
+// Get clip in the runtime's format, for compression.
+mesh_data::AnimationClip to_animation_clip(const AnimationData::Clip& clip)
+{
+    mesh_data::AnimationClip result;
+    result.duration_seconds = narrow_cast<float>(clip.duration_seconds);
+    result.channels = Array<mesh_data::AnimationChannel>::make(clip.position_channels.size());
+
+    for (size_t i = 0; i < result.channels.size(); ++i) {
+        mesh_data::AnimationChannel& channel = result.channels[i];
+        channel.position_keys = Array<PositionKey>::make_copy(clip.position_channels[i]);
+        channel.rotation_keys = Array<RotationKey>::make_copy(clip.rotation_channels[i]);
+        channel.scale_keys = Array<ScaleKey>::make_copy(clip.scale_channels[i]);
+    }
+
+    return result;
+}
+
 //--------------------------------------------------------------------------------------------------
 
 // Data for the mesh itself: the vertices, indices, and submeshes.
@@ -790,8 +812,18 @@ bool write_file(const std::filesystem::path& file_path,
                 const MeshData& mesh_data,
                 const Opt<JointData>& joint_data,
                 const Opt<AnimationData>& animation_data,
-                const StringData& string_data)
+                const StringData& string_data,
+                const bool compact_vertices,
+                const bool compress_animations)
 {
+    // Validate here, so that the runtime can rely on the checksum instead of validating indices
+    // when loading.
+    const size_t num_vertices = mesh_data.vertices().size();
+    if (std::ranges::any_of(mesh_data.indices(), [&](Index i) { return i >= num_vertices; })) {
+        notify("Error: index data out of bounds.");
+        return false;
+    }
+
     FileWriter writer;
 
     Header header = {};
@@ -802,67 +834,149 @@ bool write_file(const std::filesystem::path& file_path,
         const BoundingSphere bounding_sphere = calculate_mesh_bounding_sphere(mesh_data.vertices());
         header.centre = bounding_sphere.centre;
         header.radius = bounding_sphere.radius;
+
+        const AxisAlignedBoundingBox aabb = calculate_mesh_bounding_box(mesh_data.vertices());
+        header.abb_min = aabb.min_corner;
+        header.abb_max = aabb.max_corner;
     }
 
     header.skeleton_root_transform = joint_data.map_or(&JointData::skeleton_root_transform,
                                                        mat4(1.0f));
 
+    // Must be defined in this scope, see note below.
+    std::vector<CompactVertex> compressed_vertices;
+    if (compact_vertices) {
+        const AxisAlignedBoundingBox quantization_box = { .min_corner = header.abb_min,
+                                                          .max_corner = header.abb_max };
+        compressed_vertices.reserve(num_vertices);
+        for (const Vertex& vertex : mesh_data.vertices()) {
+            compressed_vertices.push_back(compress_vertex(vertex, quantization_box));
+        }
+    }
+
     // Note: everything that is enqueued in the writer is referenced by address until the writer has
     // finished writing, so be sure that everything is created in the correct scope and that vectors
     // etc. will not be reallocated.
 
     writer.enqueue(header);
-    header.submeshes = writer.enqueue_array(mesh_data.submeshes());
-    header.vertices = writer.enqueue_array(mesh_data.vertices());
-    header.indices = writer.enqueue_array(mesh_data.indices());
-    header.influences = writer.enqueue_array(mesh_data.influences());
+    header.submeshes = writer.enqueue_array(mesh_data.submeshes(), data_alignment);
+    if (compact_vertices) {
+        header.compact_vertices = writer.enqueue_array(std::span(compressed_vertices),
+                                                       data_alignment);
+    }
+    else {
+        header.vertices = writer.enqueue_array(mesh_data.vertices(), data_alignment);
+    }
+    header.indices = writer.enqueue_array(mesh_data.indices(), data_alignment);
+    header.influences = writer.enqueue_array(mesh_data.influences(), data_alignment);
 
     // Must be defined in this scope, see above note.
     std::vector<AnimationClip> animation_clips;
     std::vector<std::vector<AnimationChannel>> channels_per_clip;
+    std::vector<CompressedAnimationClip> compressed_animation_clips;
+    std::vector<mesh_data::AnimationClip> compressed_clips;
 
     if (joint_data && animation_data) {
-        header.joints = writer.enqueue_array(joint_data->joints());
-
-        animation_clips.resize(animation_data->clips().size());
-        header.animations = writer.enqueue_array<AnimationClip>(animation_clips);
+        header.joints = writer.enqueue_array(joint_data->joints(), data_alignment);
+
+        const size_t num_channels = joint_data->joints().size();
+
+        // Compress clips first, so that the number of clips of each format is known. Clips that
+        // cannot be compressed are stored uncompressed. Compressed clips record their index in
+        // the source, so that the loader can restore the order of the clips.
+        std::vector<const AnimationData::Clip*> uncompressed_clips;
+        std::vector<const AnimationData::Clip*> compressed_clip_sources;
+        std::vector<uint32_t> compressed_clip_indices;
+
+        const std::span<const AnimationData::Clip> clips = animation_data->clips();
+        for (size_t source_index = 0; source_index < clips.size(); ++source_index) {
+            const AnimationData::Clip& clip = clips[source_index];
+            MG_ASSERT(clip.position_channels.size() == num_channels);
+            MG_ASSERT(clip.rotation_channels.size() == num_channels);
+            MG_ASSERT(clip.scale_channels.size() == num_channels);
+
+            Opt<mesh_data::AnimationClip> compressed_clip =
+                compress_animations ? compress_animation_clip(to_animation_clip(clip)) : nullopt;
+
+            if (compressed_clip) {
+                compressed_clip_sources.push_back(&clip);
+                compressed_clip_indices.push_back(narrow<uint32_t>(source_index));
+                compressed_clips.push_back(std::move(*compressed_clip));
+            }
+            else {
+                if (compress_animations) {
+                    warn("animation clip '",
+                         string_data.get(clip.name),
+                         "' is too long to compress; storing it uncompressed.");
+                }
+                uncompressed_clips.push_back(&clip);
+            }
+        }
 
-        channels_per_clip.resize(animation_data->clips().size());
+        animation_clips.resize(uncompressed_clips.size());
+        header.animations = writer.enqueue_array<AnimationClip>(animation_clips, data_alignment);
 
-        for (size_t clip_index = 0; clip_index < animation_data->clips().size(); ++clip_index) {
-            const size_t num_channels = joint_data->joints().size();
-            const auto& position_channels = animation_data->clips()[clip_index].position_channels;
-            const auto& rotation_channels = animation_data->clips()[clip_index].rotation_channels;
-            const auto& scale_channels = animation_data->clips()[clip_index].scale_channels;
+        channels_per_clip.resize(uncompressed_clips.size());
 
-            MG_ASSERT(position_channels.size() == num_channels);
-            MG_ASSERT(rotation_channels.size() == num_channels);
-            MG_ASSERT(scale_channels.size() == num_channels);
+        for (size_t clip_index = 0; clip_index < uncompressed_clips.size(); ++clip_index) {
+            const AnimationData::Clip& clip = *uncompressed_clips[clip_index];
 
             channels_per_clip[clip_index].resize(num_channels);
             const std::span<AnimationChannel> channels = channels_per_clip[clip_index];
 
             AnimationClip& animation_clip = animation_clips[clip_index];
-            animation_clip.name = animation_data->clips()[clip_index].name;
-            animation_clip.duration = animation_data->clips()[clip_index].duration_seconds;
-            animation_clip.channels = writer.enqueue_array(channels);
+            animation_clip.name = clip.name;
+            animation_clip.duration = clip.duration_seconds;
+            animation_clip.channels = writer.enqueue_array(channels, data_alignment);
 
-            for (size_t i = 0; i < position_channels.size(); ++i) {
-                channels[i].position_keys = writer.enqueue_array(std::span(position_channels[i]));
+            for (size_t i = 0; i < num_channels; ++i) {
+                channels[i].position_keys = writer.enqueue_array(
+                    std::span(clip.position_channels[i]), data_alignment);
             }
 
-            for (size_t i = 0; i < rotation_channels.size(); ++i) {
-                channels[i].rotation_keys = writer.enqueue_array(std::span(rotation_channels[i]));
+            for (size_t i = 0; i < num_channels; ++i) {
+                channels[i].rotation_keys = writer.enqueue_array(
+                    std::span(clip.rotation_channels[i]), data_alignment);
             }
 
-            for (size_t i = 0; i < scale_channels.size(); ++i) {
-                channels[i].scale_keys = writer.enqueue_array(std::span(scale_channels[i]));
+            for (size_t i = 0; i < num_channels; ++i) {
+                channels[i].scale_keys = writer.enqueue_array(std::span(clip.scale_channels[i]),
+                                                              data_alignment);
             }
         }
+
+        compressed_animation_clips.resize(compressed_clips.size());
+        header.compressed_animations =
+            writer.enqueue_array<CompressedAnimationClip>(compressed_animation_clips,
+                                                          data_alignment);
+
+        for (size_t clip_index = 0; clip_index < compressed_clips.size(); ++clip_index) {
+            const mesh_data::CompressedAnimation& compressed =
+                compressed_clips[clip_index].compressed;
+
+            CompressedAnimationClip& record = compressed_animation_clips[clip_index];
+            record.name = compressed_clip_sources[clip_index]->name;
+            record.duration = compressed_clips[clip_index].duration_seconds;
+            record.sample_rate = compressed.sample_rate;
+            record.index = compressed_clip_indices[clip_index];
+            record.channels = writer.enqueue_array(
+                std::span<const CompressedAnimationChannel>(compressed.channels), data_alignment);
+            record.frames = writer.enqueue_array(std::span<const uint16_t>(compressed.frames),
+                                                 data_alignment);
+            record.values = writer.enqueue_array(
+                std::span<const std::array<uint16_t, 3>>(compressed.values), data_alignment);
+        }
     }
 
     header.strings = writer.enqueue_string(string_data.all_strings());
 
+    // All ranges are known now, so the checksum can be computed. The header is excluded, since it
+    // contains the checksum.
+    {
+        const std::vector<std::byte> contents = writer.contents();
+        header.data_checksum = calculate_checksum(std::span(contents).subspan(sizeof(Header)));
+    }
+
     const bool success = writer.write(file_path);
     if (success) {
         notify("Wrote file '", cast_u8_to_char(file_path.u8string()), "'.");
@@ -875,7 +989,9 @@ bool write_file(const std::filesystem::path& file_path,
 
 bool convert_mesh(const std::filesystem::path& path_in,
                   const std::filesystem::path& path_out,
-                  const bool debug_logging)
+                  const bool debug_logging,
+                  const bool compact_vertices,
+                  const bool compress_animations)
 {
     const bool is_gltf = path_in.extension() == ".glb" || path_in.extension() == ".gltf";
 
@@ -935,7 +1051,13 @@ bool convert_mesh(const std::filesystem::path& path_in,
         importer.reset();
 
         // Write processed data.
-        return write_file(path_out, mesh_data, joint_data, animation_data, string_data);
+        return write_file(path_out,
+                          mesh_data,
+                          joint_data,
+                          animation_data,
+                          string_data,
+                          compact_vertices,
+                          compress_animations);
     }
     catch (const std::exception& e) {
         error("Failed to process '", cast_u8_to_char(path_in.u8string()), "': ", e.what());
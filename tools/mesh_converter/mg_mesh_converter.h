@@ -8,8 +8,14 @@
 
 namespace Mg {
 
+/** Convert the mesh file at path_in to Mg mesh format. If compact_vertices is set, the vertices are
+ * written as mesh_data::CompactVertex, which uses less than half the memory at reduced precision.
+ * If compress_animations is set, animation clips are written as mesh_data::CompressedAnimation.
+ */
 bool convert_mesh(const std::filesystem::path& path_in,
                   const std::filesystem::path& path_out,
-                  bool debug_logging);
+                  bool debug_logging,
+                  bool compact_vertices,
+                  bool compress_animations);
 
 } // namespace Mg
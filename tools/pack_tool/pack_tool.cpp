@@ -0,0 +1,209 @@
+//**************************************************************************************************
+// This file is part of Mg Engine. Copyright (c) 2026, Magnus Bergsten.
+// Mg Engine is made available under the terms of the 3-Clause BSD License.
+// See LICENSE.txt in the project's root directory.
+//**************************************************************************************************
+
+// Creates an Mg pack file (see mg_pack_file_data.h) from all files in a directory.
+
+#include <mg/core/mg_pack_file_data.h>
+#include <mg/utils/mg_file_io.h>
+#include <mg/utils/mg_file_time_helper.h>
+#include <mg/utils/mg_hash_fnv1a.h>
+#include <mg/utils/mg_lz4.h>
+#include <mg/utils/mg_u8string_casts.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace Mg {
+
+namespace {
+
+struct InputFile {
+    fs::path path;
+    std::string name; // Path relative to input directory, in generic format.
+    PackFileData::Entry entry = {};
+};
+
+uint64_t align_up(uint64_t value, uint64_t alignment)
+{
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+// Find all files under directory, sorted by name hash (and name, for hash collisions), as required
+// by the pack format.
+std::vector<InputFile> find_input_files(const fs::path& directory)
+{
+    std::vector<InputFile> result;
+
+    for (const auto& file :
+         fs::recursive_directory_iterator{ directory,
+                                           fs::directory_options::follow_directory_symlink }) {
+        if (!fs::is_regular_file(file)) {
+            continue;
+        }
+
+        InputFile& input = result.emplace_back();
+        input.path = file.path();
+        input.name = cast_u8_to_char(
+            file.path().lexically_relative(directory).generic_u8string());
+        input.entry.name_hash = hash_fnv1a(input.name);
+    }
+
+    std::ranges::sort(result, [](const InputFile& l, const InputFile& r) {
+        return l.entry.name_hash != r.entry.name_hash ? l.entry.name_hash < r.entry.name_hash
+                                                      : l.name < r.name;
+    });
+
+    return result;
+}
+
+bool read_file(const fs::path& path, std::vector<std::byte>& out)
+{
+    auto [stream, error_msg] = io::make_input_filestream(cast_u8_to_char(path.u8string()),
+                                                         io::Mode::binary);
+    if (!stream) {
+        std::cerr << "Could not read " << path << ": " << error_msg << '\n';
+        return false;
+    }
+
+    out.resize(size_t(io::file_size(*stream)));
+    return io::read_binary_array(*stream, std::span{ out }) == out.size();
+}
+
+bool write_pack(const fs::path& directory, const fs::path& output_file, const bool compress)
+{
+    using namespace PackFileData;
+
+    std::vector<InputFile> inputs = find_input_files(directory);
+
+    // Names can be laid out right away, which determines where file data begins.
+    std::string names;
+    for (InputFile& input : inputs) {
+        input.entry.name_offset = names.size();
+        input.entry.name_length = uint32_t(input.name.size());
+        names += input.name;
+    }
+
+    Header header = {};
+    header.four_cc = PackFileData::fourcc;
+    header.version = PackFileData::version;
+    header.num_entries = inputs.size();
+    header.names_offset = sizeof(Header) + inputs.size() * sizeof(Entry);
+    header.names_size = names.size();
+
+    std::ofstream out{ output_file, std::ios::binary | std::ios::trunc };
+    if (!out) {
+        std::cerr << "Could not open " << output_file << " for writing.\n";
+        return false;
+    }
+
+    // Write file data first, one file at a time, then go back and write the header and entries
+    // once the data offsets are known.
+    uint64_t offset = header.names_offset + header.names_size;
+    std::vector<std::byte> data;
+    std::vector<std::byte> compressed;
+    uint64_t total_size = 0;
+    uint64_t total_stored_size = 0;
+
+    for (InputFile& input : inputs) {
+        if (!read_file(input.path, data)) {
+            return false;
+        }
+
+        Entry& entry = input.entry;
+        entry.size = data.size();
+        entry.time_stamp = int64_t(last_write_time_t(input.path));
+        entry.compression = Compression::none;
+
+        std::span<const std::byte> stored = data;
+        if (compress && !data.empty()) {
+            compressed.resize(lz4_compress_bound(data.size()));
+            const size_t compressed_size = lz4_compress(data, compressed);
+
+            // Only keep compressed data if it pays off.
+            if (compressed_size > 0 && compressed_size < data.size()) {
+                entry.compression = Compression::lz4;
+                stored = std::span{ compressed }.first(compressed_size);
+            }
+        }
+
+        const bool is_large = entry.size >= large_data_threshold;
+        entry.data_offset = align_up(offset, is_large ? large_data_alignment : data_alignment);
+        entry.stored_size = stored.size();
+
+        out.seekp(std::streamoff(entry.data_offset));
+        out.write(reinterpret_cast<const char*>(stored.data()), std::streamsize(stored.size()));
+        offset = entry.data_offset + entry.stored_size;
+
+        total_size += entry.size;
+        total_stored_size += entry.stored_size;
+    }
+
+    out.seekp(0);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    for (const InputFile& input : inputs) {
+        out.write(reinterpret_cast<const char*>(&input.entry), sizeof(Entry));
+    }
+    out.write(names.data(), std::streamsize(names.size()));
+
+    if (!out) {
+        std::cerr << "Failed to write " << output_file << '\n';
+        return false;
+    }
+
+    std::cout << "Wrote " << inputs.size() << " files (" << total_size << " bytes, "
+              << total_stored_size << " bytes stored) to " << output_file << '\n';
+    return true;
+}
+
+} // namespace
+
+} // namespace Mg
+
+int main(int argc, char* argv[])
+{
+    std::vector<std::string_view> positional_args;
+    bool compress = false;
+    bool error = false;
+
+    for (int i = 1; i < argc; ++i) {
+        const std::string_view arg = argv[i]; // NOLINT
+        if (arg == "--compress") {
+            compress = true;
+        }
+        else if (arg.starts_with("--")) {
+            std::cerr << "Unrecognized argument: " << arg << '\n';
+            error = true;
+        }
+        else {
+            positional_args.push_back(arg);
+        }
+    }
+
+    if (error || positional_args.size() != 2) {
+        std::cerr << "Usage: pack_tool [--compress] <input directory> <output file>\n";
+        std::cerr << "\t--compress Store files with LZ4 compression, where that makes them "
+                     "smaller. Compressed files cannot be memory-mapped directly when loading.\n";
+        return 1;
+    }
+
+    const fs::path directory{ Mg::cast_as_u8_unchecked(positional_args[0]) };
+    const fs::path output_file{ Mg::cast_as_u8_unchecked(positional_args[1]) };
+
+    if (!fs::is_directory(directory)) {
+        std::cerr << directory << " is not a directory.\n";
+        return 1;
+    }
+
+    return Mg::write_pack(directory, output_file, compress) ? 0 : 1;
+}
@@ -8,6 +8,7 @@
 
 #include "mg/core/mg_log.h"
 
+#include <cstring>
 #include <fstream>
 
 namespace Mg {
@@ -23,15 +24,28 @@ uint32_t get_current_pos(std::ofstream& stream)
 }
 } // namespace
 
-FileDataRange FileWriter::enqueue(const char* data, uint32_t length)
+FileDataRange FileWriter::enqueue(const char* data, uint32_t length, uint32_t alignment)
 {
-    const uint32_t start = m_enqueued.empty() ? 0 : m_enqueued.back().range.end;
+    MG_ASSERT(alignment > 0);
+    const uint32_t previous_end = size();
+    const uint32_t start = (previous_end + alignment - 1) / alignment * alignment;
     FileDataRange range = { start, 0 };
     range.end = range.begin + length;
-    m_enqueued.push_back({ range, data, length });
+    m_enqueued.push_back({ range, data, length, start - previous_end });
     return range;
 }
 
+std::vector<std::byte> FileWriter::contents() const
+{
+    std::vector<std::byte> result(size());
+    for (const QueuedWrite& item : m_enqueued) {
+        if (item.length > 0) {
+            std::memcpy(&result[item.range.begin], item.data, item.length);
+        }
+    }
+    return result;
+}
+
 bool FileWriter::write(const std::filesystem::path& out_path)
 {
     auto tmp_path = out_path;
@@ -46,6 +60,10 @@ bool FileWriter::write(const std::filesystem::path& out_path)
     }
 
     for (const QueuedWrite& item : m_enqueued) {
+        for (size_t i = 0; i < item.padding; ++i) {
+            out_file.put('\0');
+        }
+
         if (get_current_pos(out_file) != item.range.begin) {
             log.error("FileWriter: unexpected error. Stream write position does not match queue.");
             return false;
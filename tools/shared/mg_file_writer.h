@@ -11,8 +11,10 @@
 #pragma once
 
 #include <mg/core/mg_file_data_range.h>
+#include <mg/utils/mg_assert.h>
 #include <mg/utils/mg_gsl.h>
 
+#include <cstddef>
 #include <filesystem>
 #include <string>
 #include <type_traits>
@@ -27,12 +29,18 @@ namespace Mg {
 class FileWriter {
 public:
     /** Enqueue a vector of data for writing.
+     * @param alignment Alignment of the data's offset within the file. Must be a multiple of the
+     * alignment of T.
      * @return A FileDataRange describing where in the file the data will be.
      */
-    template<typename T> FileDataRange enqueue_array(const std::span<T> items)
+    template<typename T>
+    FileDataRange enqueue_array(const std::span<T> items, uint32_t alignment = alignof(T))
     {
         static_assert(std::is_trivially_copyable_v<T>);
-        return enqueue(reinterpret_cast<const char*>(items.data()), items.size_bytes());
+        MG_ASSERT(alignment % alignof(T) == 0);
+        return enqueue(reinterpret_cast<const char*>(items.data()),
+                       narrow<uint32_t>(items.size_bytes()),
+                       alignment);
     }
 
     /** Enqueue a struct for writing.
@@ -52,10 +60,17 @@ public:
         return enqueue(string.c_str(), narrow<uint32_t>(string.size()));
     }
 
-    /** Enqueue arbitrary data for writing.
+    /** Enqueue arbitrary data for writing. The data is preceded by zero bytes as needed to make its
+     * offset a multiple of `alignment`.
      * @return A FileDataRange describing where in the file the data will be.
      */
-    FileDataRange enqueue(const char* data, uint32_t length);
+    FileDataRange enqueue(const char* data, uint32_t length, uint32_t alignment = 1);
+
+    /** Get the total size of the enqueued data, i.e. the size of the file to be written. */
+    uint32_t size() const noexcept { return m_enqueued.empty() ? 0 : m_enqueued.back().range.end; }
+
+    /** Get the enqueued data as it will be written to the file, e.g. to compute a checksum. */
+    std::vector<std::byte> contents() const;
 
     /** Perform all enqueued writes.
      * @return Whether write was successful.
@@ -67,6 +82,7 @@ private:
         FileDataRange range;
         const char* data = nullptr;
         size_t length = 0;
+        size_t padding = 0; // Number of zero bytes to write before data.
     };
 
     std::vector<QueuedWrite> m_enqueued;